@@ -0,0 +1,393 @@
+//========================================================================================
+// Filename      : CheckerboardRenderer.cpp
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Implementation of the CheckerboardRenderer class (see CheckerboardRenderer.h)
+//========================================================================================
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+
+#include "CheckerboardRenderer.h"
+
+namespace
+{
+    const int SSIM_WINDOW = 8;
+    const int SSIM_STEP = 4;
+    const int BAD_PIXEL_ERROR = 16;
+
+    // CLN: column-major 4x4 product, result = a * b
+    void Multiply(const float* a, const float* b, float* result)
+    {
+        for (int column = 0; column < 4; ++column)
+        {
+            for (int row = 0; row < 4; ++row)
+            {
+                float sum = 0.0f;
+                for (int k = 0; k < 4; ++k)
+                    sum += a[k * 4 + row] * b[column * 4 + k];
+                result[column * 4 + row] = sum;
+            }
+        }
+    }
+
+    double Luma(const unsigned char* pixel)
+    {
+        return 0.299 * pixel[0] + 0.587 * pixel[1] + 0.114 * pixel[2];
+    }
+}
+
+
+CheckerboardRenderer::CheckerboardRenderer()
+    : width(0), height(0), enabled(false), stampProgram(0), reconstructProgram(0), emptyVao(0),
+      resolveFramebuffers(), resolvedColor(), resolvedDepth(), frame(0), stampedFramebuffer(0),
+      stampedWidth(0), stampedHeight(0), historyValid(false), viewProjection(), inverseViewProjection(),
+      previousViewProjection(), reconstructedFrames(0)
+{
+}
+
+
+bool CheckerboardRenderer::Create(int width, int height, GLuint stampProgram, GLuint reconstructProgram)
+{
+    this->width = width;
+    this->height = height;
+    this->stampProgram = stampProgram;
+    this->reconstructProgram = reconstructProgram;
+    glGenVertexArrays(1, &emptyVao);
+
+    glUseProgram(reconstructProgram);
+    glUniform1i(glGetUniformLocation(reconstructProgram, "sceneColorTexture"), 0);
+    glUniform1i(glGetUniformLocation(reconstructProgram, "sceneDepthTexture"), 1);
+    glUniform1i(glGetUniformLocation(reconstructProgram, "historyColorTexture"), 2);
+    glUniform1i(glGetUniformLocation(reconstructProgram, "historyDepthTexture"), 3);
+    glUseProgram(0);
+
+    return CreateTargets();
+}
+
+
+bool CheckerboardRenderer::Resize(int width, int height)
+{
+    if (!IsCreated() || (width == this->width && height == this->height) || width <= 0 || height <= 0)
+        return true;    // CLN: minimized windows report 0 x 0, keep the old targets until it comes back
+
+    this->width = width;
+    this->height = height;
+    historyValid = false;
+    DestroyTargets();
+    return CreateTargets();
+}
+
+
+void CheckerboardRenderer::Destroy()
+{
+    DestroyTargets();
+    glDeleteVertexArrays(1, &emptyVao);
+    emptyVao = 0;
+}
+
+
+bool CheckerboardRenderer::CreateTargets()
+{
+    bool complete = true;
+    glGenTextures(2, resolvedColor);
+    glGenTextures(2, resolvedDepth);
+    glGenFramebuffers(2, resolveFramebuffers);
+    for (int i = 0; i < 2; ++i)
+    {
+        // CLN: both read unfiltered: filtered history blurs a little more every frame, and a blend of two surfaces'
+        //      depths would match neither
+        glBindTexture(GL_TEXTURE_2D, resolvedColor[i]);
+        glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, width, height);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+        glBindTexture(GL_TEXTURE_2D, resolvedDepth[i]);
+        glTexStorage2D(GL_TEXTURE_2D, 1, GL_R32F, width, height);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, resolveFramebuffers[i]);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, resolvedColor[i], 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, resolvedDepth[i], 0);
+        const GLenum drawBuffers[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+        glDrawBuffers(2, drawBuffers);
+        complete = complete && glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if (!complete)
+    {
+        std::cout << "Failed to create the checkerboard reconstruction targets (" << width << " x " << height << ")" << std::endl;
+        DestroyTargets();
+        return false;
+    }
+    return true;
+}
+
+
+void CheckerboardRenderer::DestroyTargets()
+{
+    glDeleteFramebuffers(2, resolveFramebuffers);
+    glDeleteTextures(2, resolvedColor);
+    glDeleteTextures(2, resolvedDepth);
+    for (int i = 0; i < 2; ++i)
+        resolveFramebuffers[i] = resolvedColor[i] = resolvedDepth[i] = 0;
+    stampedFramebuffer = 0;
+}
+
+
+void CheckerboardRenderer::SetEnabled(bool enabled)
+{
+    this->enabled = enabled && IsCreated();
+    historyValid = false;
+}
+
+
+// CLN: stencil 1 in the 2x2 blocks where x / 2 + y / 2 is odd, 0 in the others. Nothing else writes the stencil
+//      and the scene clear leaves it alone, so this only runs again when the scene framebuffer is recreated
+void CheckerboardRenderer::StampPattern(GLuint sceneFramebuffer)
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, sceneFramebuffer);
+    glClearStencil(0);
+    glClear(GL_STENCIL_BUFFER_BIT);
+
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    glDepthMask(GL_FALSE);
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_STENCIL_TEST);
+    glStencilFunc(GL_ALWAYS, 1, 1);
+    glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
+
+    glUseProgram(stampProgram);
+    glBindVertexArray(emptyVao);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+
+    glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    glDepthMask(GL_TRUE);
+    glEnable(GL_DEPTH_TEST);
+
+    stampedFramebuffer = sceneFramebuffer;
+    stampedWidth = width;
+    stampedHeight = height;
+}
+
+
+void CheckerboardRenderer::BeginFrame(GLuint sceneFramebuffer, const float* viewProjection, const float* inverseViewProjection)
+{
+    if (!enabled)
+        return;
+
+    if (sceneFramebuffer != stampedFramebuffer || width != stampedWidth || height != stampedHeight)
+        StampPattern(sceneFramebuffer);
+
+    memcpy(this->viewProjection, viewProjection, sizeof(this->viewProjection));
+    memcpy(this->inverseViewProjection, inverseViewProjection, sizeof(this->inverseViewProjection));
+
+    // CLN: shade only where the stencil equals this frame's parity; the test runs before the fragment shader, so the
+    //      other blocks' quads are never launched
+    glEnable(GL_STENCIL_TEST);
+    glStencilFunc(GL_EQUAL, GetParity(), 1);
+    glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+}
+
+
+void CheckerboardRenderer::Reconstruct(GLuint sceneFramebuffer, GLuint sceneColorTexture, GLuint sceneDepthTexture)
+{
+    if (!enabled)
+        return;
+    glDisable(GL_STENCIL_TEST);
+
+    // CLN: clip space of this frame to clip space of the last, to reproject the unshaded blocks
+    float currentToPrevious[16];
+    Multiply(previousViewProjection, inverseViewProjection, currentToPrevious);
+    const bool cameraMoved = memcmp(previousViewProjection, viewProjection, sizeof(viewProjection)) != 0;
+
+    const int current = GetParity();
+    const int previous = 1 - current;
+    glBindFramebuffer(GL_FRAMEBUFFER, resolveFramebuffers[current]);
+    glViewport(0, 0, width, height);
+    glDisable(GL_DEPTH_TEST);
+
+    glUseProgram(reconstructProgram);
+    glUniformMatrix4fv(glGetUniformLocation(reconstructProgram, "currentToPrevious"), 1, GL_FALSE, currentToPrevious);
+    glUniform1i(glGetUniformLocation(reconstructProgram, "parity"), current);
+    glUniform1i(glGetUniformLocation(reconstructProgram, "historyValid"), historyValid);
+    glUniform1i(glGetUniformLocation(reconstructProgram, "clampHistory"), cameraMoved);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, sceneColorTexture);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, sceneDepthTexture);
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_2D, resolvedColor[previous]);
+    glActiveTexture(GL_TEXTURE3);
+    glBindTexture(GL_TEXTURE_2D, resolvedDepth[previous]);
+    glBindVertexArray(emptyVao);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+
+    for (int unit = 3; unit >= 0; --unit)
+    {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+    glUseProgram(0);
+    glEnable(GL_DEPTH_TEST);
+
+    // CLN: the full frame replaces the half-shaded scene color, and stays as next frame's history
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, resolveFramebuffers[current]);
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, sceneFramebuffer);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, sceneFramebuffer);
+
+    memcpy(previousViewProjection, viewProjection, sizeof(viewProjection));
+    historyValid = true;
+    ++frame;
+    ++reconstructedFrames;
+}
+
+
+void CheckerboardRenderer::PrintStats(std::ostream& out) const
+{
+    if (!enabled)
+    {
+        out << "INFO: Checkerboard rendering off" << std::endl;
+        return;
+    }
+    out << "INFO: Checkerboard rendering: " << width << " x " << height << ", half the 2x2 blocks shaded per frame, "
+        << reconstructedFrames << " frame(s) reconstructed" << std::endl;
+}
+
+
+void CheckerboardRenderer::ReadColor(GLuint framebuffer, int width, int height, std::vector<unsigned char>& pixels)
+{
+    pixels.resize((size_t)width * height * 4);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+}
+
+
+ImageComparison CheckerboardRenderer::CompareImages(const std::vector<unsigned char>& reference, const std::vector<unsigned char>& image,
+                                                    int width, int height)
+{
+    ImageComparison comparison;
+    comparison.width = width;
+    comparison.height = height;
+    const size_t pixels = (size_t)width * height;
+    if (pixels == 0 || reference.size() < pixels * 4 || image.size() < pixels * 4)
+        return comparison;
+
+    double squaredError = 0.0, absoluteError = 0.0;
+    size_t badPixels = 0;
+    for (size_t i = 0; i < pixels; ++i)
+    {
+        int worst = 0;
+        for (int channel = 0; channel < 3; ++channel)
+        {
+            const int error = abs((int)reference[i * 4 + channel] - (int)image[i * 4 + channel]);
+            squaredError += (double)error * error;
+            absoluteError += error;
+            worst = std::max(worst, error);
+        }
+        if (worst > BAD_PIXEL_ERROR)
+            ++badPixels;
+    }
+    const double meanSquaredError = squaredError / (pixels * 3);
+    comparison.psnr = meanSquaredError > 0.0 ? 10.0 * log10(255.0 * 255.0 / meanSquaredError) : std::numeric_limits<double>::infinity();
+    comparison.meanAbsoluteError = absoluteError / (pixels * 3);
+    comparison.badPixelFraction = (double)badPixels / pixels;
+
+    // CLN: SSIM (Wang et al.) of the luma, averaged over overlapping windows
+    const double c1 = (0.01 * 255.0) * (0.01 * 255.0);
+    const double c2 = (0.03 * 255.0) * (0.03 * 255.0);
+    const double windowPixels = SSIM_WINDOW * SSIM_WINDOW;
+    double ssimSum = 0.0;
+    int windows = 0;
+    for (int y = 0; y + SSIM_WINDOW <= height; y += SSIM_STEP)
+    {
+        for (int x = 0; x + SSIM_WINDOW <= width; x += SSIM_STEP)
+        {
+            double sumA = 0.0, sumB = 0.0, sumAA = 0.0, sumBB = 0.0, sumAB = 0.0;
+            for (int wy = 0; wy < SSIM_WINDOW; ++wy)
+            {
+                for (int wx = 0; wx < SSIM_WINDOW; ++wx)
+                {
+                    const size_t offset = ((size_t)(y + wy) * width + x + wx) * 4;
+                    const double a = Luma(&reference[offset]);
+                    const double b = Luma(&image[offset]);
+                    sumA += a;
+                    sumB += b;
+                    sumAA += a * a;
+                    sumBB += b * b;
+                    sumAB += a * b;
+                }
+            }
+            const double meanA = sumA / windowPixels, meanB = sumB / windowPixels;
+            const double varianceA = sumAA / windowPixels - meanA * meanA;
+            const double varianceB = sumBB / windowPixels - meanB * meanB;
+            const double covariance = sumAB / windowPixels - meanA * meanB;
+            ssimSum += ((2.0 * meanA * meanB + c1) * (2.0 * covariance + c2))
+                     / ((meanA * meanA + meanB * meanB + c1) * (varianceA + varianceB + c2));
+            ++windows;
+        }
+    }
+    comparison.ssim = windows > 0 ? ssimSum / windows : 1.0;
+    return comparison;
+}
+
+
+void CheckerboardRenderer::PrintComparison(const ImageComparison& comparison, std::ostream& out)
+{
+    const std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(2)
+        << "INFO: Checkerboard vs native (" << comparison.width << " x " << comparison.height << "): PSNR " << comparison.psnr
+        << " dB, SSIM " << std::setprecision(4) << comparison.ssim << ", mean error " << std::setprecision(2) << comparison.meanAbsoluteError
+        << " of 255, " << 100.0 * comparison.badPixelFraction << "% of the pixels off by more than " << BAD_PIXEL_ERROR << std::endl;
+    out.unsetf(std::ios_base::floatfield);
+    out.precision(precision);
+}
+
+
+bool CheckerboardRenderer::WriteReport(const std::string& filename, const ImageComparison& comparison, double checkerboardFrameMs, double nativeFrameMs)
+{
+    std::ofstream file(filename.c_str());
+    if (!file)
+    {
+        std::cout << "Failed to write the checkerboard report " << filename << std::endl;
+        return false;
+    }
+
+    // CLN: (JSON has no infinity; identical images report a PSNR of 0 with "identical": true)
+    const bool identical = std::isinf(comparison.psnr);
+    file << std::fixed << std::setprecision(4)
+         << "{\n"
+         << "  \"width\": " << comparison.width << ",\n"
+         << "  \"height\": " << comparison.height << ",\n"
+         << "  \"identical\": " << (identical ? "true" : "false") << ",\n"
+         << "  \"psnr\": " << (identical ? 0.0 : comparison.psnr) << ",\n"
+         << "  \"ssim\": " << comparison.ssim << ",\n"
+         << "  \"meanAbsoluteError\": " << comparison.meanAbsoluteError << ",\n"
+         << "  \"badPixelFraction\": " << comparison.badPixelFraction << ",\n"
+         << "  \"checkerboardFrameMs\": " << checkerboardFrameMs << ",\n"
+         << "  \"nativeFrameMs\": " << nativeFrameMs << "\n"
+         << "}\n";
+    return (bool)file;
+}
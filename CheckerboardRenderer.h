@@ -0,0 +1,113 @@
+//========================================================================================
+// Filename      : CheckerboardRenderer.h
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Checkerboard rendering for fill-rate bound GPUs. Each frame shades
+//               : only the 2x2 pixel blocks of one color of a checkerboard, alternating
+//               : every frame, and a reconstruction pass fills in the other half:
+//               :    - from the previous frame, where one of the pixel's neighbouring
+//               :      surfaces reprojects onto a pixel that frame shaded (depth
+//               :      compared)
+//               :    - from the nearest shaded pixels left, right, below and above
+//               :      where none does (disocclusion, off screen), interpolated along
+//               :      the edge (the pair that differs least)
+//               : While the camera moves, the reprojected color is clamped to the
+//               : range of the neighbours, so stale history doesn't smear.
+//               :
+//               : The half is masked with the stencil of the scene framebuffer (the
+//               : pattern is stamped once per framebuffer), and fragments that fail
+//               : the stencil test are discarded before they are shaded. The blocks
+//               : are 2x2 because GPUs shade whole quads: a per-pixel pattern would
+//               : leave half of every quad running as helper invocations and save
+//               : nothing. A half-width target would need custom sample positions to
+//               : make the pattern alternate per row.
+//               :
+//               : CompareImages() measures the result against a natively rendered
+//               : frame (PSNR, SSIM, mean error), used by --checkerboard-report.
+//========================================================================================
+
+#ifndef CHECKERBOARD_RENDERER_H
+#define CHECKERBOARD_RENDERER_H
+
+#include <GL/glew.h>
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+struct ImageComparison
+{
+    int width = 0;
+    int height = 0;
+    double psnr = 0.0;                  // dB over RGB, 8-bit; infinity for identical images
+    double ssim = 1.0;                  // mean SSIM of the luma over 8 x 8 windows (step 4)
+    double meanAbsoluteError = 0.0;     // per channel, 0..255
+    double badPixelFraction = 0.0;      // pixels with a channel off by more than 16
+};
+
+class CheckerboardRenderer
+{
+public:
+    CheckerboardRenderer();
+
+    // stampProgram discards the pixels of one color (checkerboardStampFragmentShaderSource), reconstructProgram fills
+    // in the unshaded ones (checkerboardReconstructFragmentShaderSource); both full-screen triangles, see main
+    bool Create(int width, int height, GLuint stampProgram, GLuint reconstructProgram);
+    bool Resize(int width, int height);     // the history starts over
+    void Destroy();
+    bool IsCreated() const      { return resolveFramebuffers[0] != 0; }
+
+    void SetEnabled(bool enabled);
+    bool IsEnabled() const      { return enabled; }
+    int GetParity() const       { return (int)(frame & 1); }
+    int GetWidth() const        { return width; }
+    int GetHeight() const       { return height; }
+
+    // after the scene framebuffer is cleared: stamps the pattern into its stencil if needed and masks the opaque and
+    // transparent passes to this frame's half. viewProjection (and its inverse) are column-major, as drawn
+    void BeginFrame(GLuint sceneFramebuffer, const float* viewProjection, const float* inverseViewProjection);
+    // after the transparent pass: ends the mask, fills in the other half and copies the full frame into the scene
+    // color (the depth stays half; nothing after the reconstruction depth tests against unshaded pixels)
+    void Reconstruct(GLuint sceneFramebuffer, GLuint sceneColorTexture, GLuint sceneDepthTexture);
+
+    void PrintStats(std::ostream& out) const;
+
+    // RGBA8 rows of the framebuffer's first color attachment, bottom row first
+    static void ReadColor(GLuint framebuffer, int width, int height, std::vector<unsigned char>& pixels);
+    // reference and image are RGBA8 rows of the same size
+    static ImageComparison CompareImages(const std::vector<unsigned char>& reference, const std::vector<unsigned char>& image,
+                                         int width, int height);
+    static void PrintComparison(const ImageComparison& comparison, std::ostream& out);
+    // writes the comparison and the frame times of both modes as JSON
+    static bool WriteReport(const std::string& filename, const ImageComparison& comparison, double checkerboardFrameMs, double nativeFrameMs);
+
+private:
+    bool CreateTargets();
+    void DestroyTargets();
+    void StampPattern(GLuint sceneFramebuffer);
+
+    int width;
+    int height;
+    bool enabled;
+    GLuint stampProgram;
+    GLuint reconstructProgram;
+    GLuint emptyVao;
+
+    // full frames, this one and the last: color (RGBA8) and depth (R32F, estimated where the pixel wasn't shaded)
+    GLuint resolveFramebuffers[2];
+    GLuint resolvedColor[2];
+    GLuint resolvedDepth[2];
+
+    unsigned long long frame;           // its parity picks the shaded blocks
+    GLuint stampedFramebuffer;          // scene framebuffer whose stencil holds the pattern
+    int stampedWidth;
+    int stampedHeight;
+    bool historyValid;
+    float viewProjection[16];
+    float inverseViewProjection[16];
+    float previousViewProjection[16];
+    unsigned long long reconstructedFrames;
+};
+
+#endif
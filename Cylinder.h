@@ -29,6 +29,9 @@
 class Cylinder
 {
 public:
+    // CLN: [GeometryCache] Bump whenever the generated vertices or indices change, so cached meshes are regenerated
+    static const int GENERATOR_VERSION = 1;
+
     // ctor/dtor
     Cylinder(float baseRadius=1.0f, float topRadius=1.0f, float height=1.0f,
              int sectorCount=36, int stackCount=1, bool smooth=true);
@@ -0,0 +1,502 @@
+//========================================================================================
+// Filename      : DebugDraw.cpp
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Implementation of the DebugDraw class (see DebugDraw.h)
+//========================================================================================
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cctype>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+#include "DebugDraw.h"
+
+namespace
+{
+    // CLN: the vertex buffer starts at this many vertices and doubles when a frame needs more
+    const size_t INITIAL_VBO_VERTICES = 65536;
+
+    std::atomic<unsigned int> gNextDebugDrawId(1);
+
+    // CLN: each thread remembers the buffer it drew into last, so recording only takes the buffer's own mutex
+    struct CachedThreadBuffer
+    {
+        unsigned int owner;
+        void* buffer;
+    };
+    thread_local CachedThreadBuffer tCachedBuffer = { 0, nullptr };
+
+    inline void PushLine(DebugDrawVertex*& out, const float* from, const float* to, GLuint color)
+    {
+        out[0].position[0] = from[0]; out[0].position[1] = from[1]; out[0].position[2] = from[2];
+        out[1].position[0] = to[0];   out[1].position[1] = to[1];   out[1].position[2] = to[2];
+        out[0].color = out[1].color = color;
+        out += 2;
+    }
+
+    // CLN: corner i of a box takes x from bit 0, y from bit 1 and z from bit 2 of i (0 = low, 1 = high); every
+    //      edge joins two corners that differ in one bit
+    void PushBoxEdges(DebugDrawVertex*& out, const float corners[8][3], GLuint color)
+    {
+        for (int i = 0; i < 8; ++i)
+        {
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                if (!((i >> axis) & 1))
+                    PushLine(out, corners[i], corners[i | (1 << axis)], color);
+            }
+        }
+    }
+
+    // CLN: point = origin + a * x + b * y
+    inline void PlanePoint(const float* origin, const float* a, const float* b, float x, float y, float* point)
+    {
+        for (int i = 0; i < 3; ++i)
+            point[i] = origin[i] + a[i] * x + b[i] * y;
+    }
+
+    // CLN: Strokes of the text font on a 3 x 5 grid, as "x0y0x1y1" groups (y up, baseline at 0)
+    const char* GetGlyph(char c)
+    {
+        switch (toupper((unsigned char)c))
+        {
+        case '0': case 'O': return "0424 0020 0004 2024";
+        case '1':   return "1014 0314 0020";
+        case '2':   return "0424 2422 2202 0200 0020";
+        case '3':   return "0424 2420 0020 0222";
+        case '4':   return "0402 0222 2420";
+        case '5': case 'S': return "2404 0402 0222 2220 2000";
+        case '6':   return "2404 0400 0020 2022 2202";
+        case '7':   return "0424 2420";
+        case '8':   return "0424 0020 0004 2024 0222";
+        case '9':   return "0222 0204 0424 2420 2000";
+        case 'A':   return "0004 0424 2420 0222";
+        case 'B':   return "0004 0414 1423 2312 0212 1221 2110 1000";
+        case 'C':   return "2404 0400 0020";
+        case 'D':   return "0004 0414 1423 2321 2110 1000";
+        case 'E':   return "2404 0400 0020 0212";
+        case 'F':   return "2404 0400 0212";
+        case 'G':   return "2404 0400 0020 2022 2212";
+        case 'H':   return "0004 2024 0222";
+        case 'I':   return "0424 1014 0020";
+        case 'J':   return "0424 1410 1000 0001";
+        case 'K':   return "0004 0224 1220";
+        case 'L':   return "0400 0020";
+        case 'M':   return "0004 0412 1224 2420";
+        case 'N':   return "0004 0420 2024";
+        case 'P':   return "0004 0424 2422 2202";
+        case 'Q':   return "0424 0020 0004 2024 1120";
+        case 'R':   return "0004 0424 2422 2202 1220";
+        case 'T':   return "0424 1410";
+        case 'U':   return "0400 0020 2024";
+        case 'V':   return "0410 1024";
+        case 'W':   return "0400 0011 1120 2024";
+        case 'X':   return "0024 0420";
+        case 'Y':   return "0412 2412 1210";
+        case 'Z':   return "0424 2400 0020";
+        case '-':   return "0222";
+        case '+':   return "0222 1113";
+        case '_':   return "0020";
+        case '/':   return "0024";
+        case '.':   return "1011";
+        case ':':   return "1011 1314";
+        case '=':   return "0121 0323";
+        default:    return "";      // space and characters the font doesn't have
+        }
+    }
+}
+
+
+DebugDraw::DebugDraw()
+    : id(gNextDebugDrawId++), program(0), vao(0), vbo(0), vboCapacity(0),
+      lastLineCount(0), lastOverlayLineCount(0), lastDroppedLineCount(0), lastThreadCount(0), lastFlushMs(0.0)
+{
+    cameraRight[0] = 1.0f; cameraRight[1] = 0.0f; cameraRight[2] = 0.0f;
+    cameraUp[0] = 0.0f; cameraUp[1] = 1.0f; cameraUp[2] = 0.0f;
+}
+
+
+bool DebugDraw::Create(GLuint program)
+{
+    while (glGetError() != GL_NO_ERROR) {}  // CLN: so only errors from here on are checked below
+
+    this->program = program;
+    vboCapacity = INITIAL_VBO_VERTICES;
+
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+    glGenBuffers(1, &vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, vboCapacity * sizeof(DebugDrawVertex), NULL, GL_STREAM_DRAW);
+
+    glVertexAttribPointer(POSITION_LOCATION, 3, GL_FLOAT, GL_FALSE, sizeof(DebugDrawVertex), (void*)offsetof(DebugDrawVertex, position));
+    glEnableVertexAttribArray(POSITION_LOCATION);
+    glVertexAttribPointer(COLOR_LOCATION, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(DebugDrawVertex), (void*)offsetof(DebugDrawVertex, color));
+    glEnableVertexAttribArray(COLOR_LOCATION);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    if (glGetError() != GL_NO_ERROR)
+    {
+        std::cout << "Failed to create the debug draw buffers" << std::endl;
+        Destroy();
+        return false;
+    }
+    return true;
+}
+
+
+void DebugDraw::Destroy()
+{
+    glDeleteVertexArrays(1, &vao);
+    glDeleteBuffers(1, &vbo);
+    vao = vbo = 0;
+    vboCapacity = 0;
+}
+
+
+GLuint DebugDraw::Color(float r, float g, float b, float a)
+{
+    // CLN: the bytes are R, G, B, A in memory order, as the normalized GL_UNSIGNED_BYTE attribute reads them
+    const float channels[4] = { r, g, b, a };
+    GLubyte bytes[4];
+    for (int i = 0; i < 4; ++i)
+        bytes[i] = (GLubyte)(std::min(std::max(channels[i], 0.0f), 1.0f) * 255.0f + 0.5f);
+
+    GLuint color;
+    memcpy(&color, bytes, sizeof(color));
+    return color;
+}
+
+
+DebugDraw::ThreadBuffer& DebugDraw::GetThreadBuffer()
+{
+    if (tCachedBuffer.owner == id)
+        return *static_cast<ThreadBuffer*>(tCachedBuffer.buffer);
+
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    const std::thread::id thread = std::this_thread::get_id();
+    ThreadBuffer* buffer = nullptr;
+    for (const std::unique_ptr<ThreadBuffer>& existing : threadBuffers)
+    {
+        if (existing->thread == thread)
+            buffer = existing.get();
+    }
+    if (!buffer)
+    {
+        threadBuffers.emplace_back(new ThreadBuffer);
+        buffer = threadBuffers.back().get();
+        buffer->thread = thread;
+    }
+
+    tCachedBuffer.owner = id;
+    tCachedBuffer.buffer = buffer;
+    return *buffer;
+}
+
+
+void DebugDraw::GetCameraAxes(float* right, float* up)
+{
+    std::lock_guard<std::mutex> lock(cameraMutex);
+    std::copy(cameraRight, cameraRight + 3, right);
+    std::copy(cameraUp, cameraUp + 3, up);
+}
+
+
+DebugDrawVertex* DebugDraw::Reserve(ThreadBuffer& buffer, bool overlay, size_t lineCount)
+{
+    const int layer = overlay ? 1 : 0;
+    std::vector<DebugDrawVertex>& vertices = buffer.vertices[layer];
+    const size_t first = buffer.used[layer];
+    const size_t end = first + lineCount * 2;
+    if (end > MAX_VERTICES)
+    {
+        buffer.droppedLines += lineCount;
+        return nullptr;
+    }
+    if (end > vertices.size())
+        vertices.resize(std::max(end, vertices.size() * 2));
+    buffer.used[layer] = end;
+    return vertices.data() + first;
+}
+
+
+void DebugDraw::Line(const float* from, const float* to, GLuint color, bool overlay)
+{
+    ThreadBuffer& buffer = GetThreadBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    if (DebugDrawVertex* out = Reserve(buffer, overlay, 1))
+        PushLine(out, from, to, color);
+}
+
+
+void DebugDraw::Lines(const float* points, size_t lineCount, GLuint color, bool overlay)
+{
+    ThreadBuffer& buffer = GetThreadBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    if (DebugDrawVertex* out = Reserve(buffer, overlay, lineCount))
+    {
+        for (size_t i = 0; i < lineCount; ++i)
+            PushLine(out, points + i * 6, points + i * 6 + 3, color);
+    }
+}
+
+
+void DebugDraw::LineStrip(const float* points, size_t pointCount, GLuint color, bool overlay)
+{
+    if (pointCount < 2)
+        return;
+
+    ThreadBuffer& buffer = GetThreadBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    if (DebugDrawVertex* out = Reserve(buffer, overlay, pointCount - 1))
+    {
+        for (size_t i = 0; i + 1 < pointCount; ++i)
+            PushLine(out, points + i * 3, points + i * 3 + 3, color);
+    }
+}
+
+
+void DebugDraw::Box(const float* minimum, const float* maximum, GLuint color, bool overlay)
+{
+    float corners[8][3];
+    for (int i = 0; i < 8; ++i)
+    {
+        for (int axis = 0; axis < 3; ++axis)
+            corners[i][axis] = (i >> axis) & 1 ? maximum[axis] : minimum[axis];
+    }
+
+    ThreadBuffer& buffer = GetThreadBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    if (DebugDrawVertex* out = Reserve(buffer, overlay, 12))
+    {
+        PushBoxEdges(out, corners, color);
+    }
+}
+
+
+void DebugDraw::Sphere(const float* center, float radius, GLuint color, bool overlay)
+{
+    static const float AXES[3][3] = { { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f } };
+
+    ThreadBuffer& buffer = GetThreadBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    if (DebugDrawVertex* out = Reserve(buffer, overlay, 3 * CIRCLE_SEGMENTS))
+    {
+        // CLN: one circle in each of the XY, YZ and ZX planes
+        for (int circle = 0; circle < 3; ++circle)
+        {
+            const float* a = AXES[circle];
+            const float* b = AXES[(circle + 1) % 3];
+            float previous[3], point[3];
+            PlanePoint(center, a, b, radius, 0.0f, previous);
+            for (int i = 1; i <= CIRCLE_SEGMENTS; ++i)
+            {
+                const float angle = 6.2831853f * i / CIRCLE_SEGMENTS;
+                PlanePoint(center, a, b, radius * cosf(angle), radius * sinf(angle), point);
+                PushLine(out, previous, point, color);
+                std::copy(point, point + 3, previous);
+            }
+        }
+    }
+}
+
+
+void DebugDraw::Frustum(const float* inverseViewProjection, GLuint color, bool overlay)
+{
+    // CLN: the corners of the clip volume in world space, numbered as in PushBoxEdges()
+    const float* m = inverseViewProjection;     // column major
+    float corners[8][3];
+    for (int i = 0; i < 8; ++i)
+    {
+        const float ndc[4] = { i & 1 ? 1.0f : -1.0f, i & 2 ? 1.0f : -1.0f, i & 4 ? 1.0f : -1.0f, 1.0f };
+        float world[4];
+        for (int row = 0; row < 4; ++row)
+            world[row] = m[row] * ndc[0] + m[4 + row] * ndc[1] + m[8 + row] * ndc[2] + m[12 + row] * ndc[3];
+        for (int axis = 0; axis < 3; ++axis)
+            corners[i][axis] = world[axis] / world[3];
+    }
+
+    ThreadBuffer& buffer = GetThreadBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    if (DebugDrawVertex* out = Reserve(buffer, overlay, 12))
+    {
+        PushBoxEdges(out, corners, color);
+    }
+}
+
+
+void DebugDraw::Marker(const float* position, float size, GLuint color, bool overlay)
+{
+    const float h = size * 0.5f;
+    const float points[6][3] = {
+        { position[0] - h, position[1], position[2] }, { position[0] + h, position[1], position[2] },
+        { position[0], position[1] - h, position[2] }, { position[0], position[1] + h, position[2] },
+        { position[0], position[1], position[2] - h }, { position[0], position[1], position[2] + h } };
+    Lines(&points[0][0], 3, color, overlay);
+}
+
+
+void DebugDraw::Text(const float* position, const std::string& text, float height, GLuint color, bool overlay)
+{
+    float right[3], up[3];
+    GetCameraAxes(right, up);
+
+    // CLN: glyphs are 2 x 4 grid units with 1 unit between them
+    const float unit = height * 0.25f;
+    const float width = (text.size() * 3.0f - 1.0f) * unit;
+    float origin[3];
+    PlanePoint(position, right, up, -0.5f * width, 0.5f * unit, origin);
+
+    size_t lineCount = 0;
+    for (char c : text)
+        lineCount += (strlen(GetGlyph(c)) + 1) / 5;
+
+    ThreadBuffer& buffer = GetThreadBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    DebugDrawVertex* out = Reserve(buffer, overlay, lineCount);
+    if (!out)
+        return;
+
+    for (size_t i = 0; i < text.size(); ++i)
+    {
+        for (const char* stroke = GetGlyph(text[i]); stroke[0] != '\0'; stroke += stroke[4] == ' ' ? 5 : 4)
+        {
+            float from[3], to[3];
+            PlanePoint(origin, right, up, (i * 3 + stroke[0] - '0') * unit, (stroke[1] - '0') * unit, from);
+            PlanePoint(origin, right, up, (i * 3 + stroke[2] - '0') * unit, (stroke[3] - '0') * unit, to);
+            PushLine(out, from, to, color);
+        }
+    }
+}
+
+
+void DebugDraw::SetCamera(const float* view)
+{
+    // CLN: the rows of the view rotation are the camera axes in world space (column major)
+    std::lock_guard<std::mutex> lock(cameraMutex);
+    for (int i = 0; i < 3; ++i)
+    {
+        cameraRight[i] = view[i * 4];
+        cameraUp[i] = view[i * 4 + 1];
+    }
+}
+
+
+void DebugDraw::Flush(const float* viewProjection)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    // CLN: hold every thread's buffer while it is copied; recording threads wait at most this long
+    std::lock_guard<std::mutex> registryLock(buffersMutex);
+    std::vector<std::unique_lock<std::mutex>> locks;
+    locks.reserve(threadBuffers.size());
+    size_t counts[2] = { 0, 0 };
+    size_t dropped = 0;
+    size_t threads = 0;
+    for (const std::unique_ptr<ThreadBuffer>& buffer : threadBuffers)
+    {
+        locks.emplace_back(buffer->mutex);
+        counts[0] += buffer->used[0];
+        counts[1] += buffer->used[1];
+        dropped += buffer->droppedLines;
+        threads += buffer->used[0] + buffer->used[1] > 0;
+    }
+
+    const size_t total = counts[0] + counts[1];
+    if (total > 0 && IsCreated())
+    {
+        // CLN: a fresh data store each frame (orphaning), so the upload never waits for last frame's draws
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        while (vboCapacity < total)
+            vboCapacity *= 2;
+        glBufferData(GL_ARRAY_BUFFER, vboCapacity * sizeof(DebugDrawVertex), NULL, GL_STREAM_DRAW);
+
+        // CLN: all the depth-tested lines first, then all the overlay lines, so each layer is one draw
+        GLintptr offset = 0;
+        for (int layer = 0; layer < 2; ++layer)
+        {
+            for (const std::unique_ptr<ThreadBuffer>& buffer : threadBuffers)
+            {
+                if (buffer->used[layer] == 0)
+                    continue;
+                const GLsizeiptr bytes = buffer->used[layer] * sizeof(DebugDrawVertex);
+                glBufferSubData(GL_ARRAY_BUFFER, offset, bytes, buffer->vertices[layer].data());
+                offset += bytes;
+            }
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        glUseProgram(program);
+        glUniformMatrix4fv(glGetUniformLocation(program, "viewProjection"), 1, GL_FALSE, viewProjection);
+        glBindVertexArray(vao);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glDepthMask(GL_FALSE);
+
+        if (counts[0] > 0)
+        {
+            glEnable(GL_DEPTH_TEST);
+            glDrawArrays(GL_LINES, 0, (GLsizei)counts[0]);
+        }
+        if (counts[1] > 0)
+        {
+            glDisable(GL_DEPTH_TEST);
+            glDrawArrays(GL_LINES, (GLint)counts[0], (GLsizei)counts[1]);
+        }
+
+        glDepthMask(GL_TRUE);
+        glEnable(GL_DEPTH_TEST);
+        glDisable(GL_BLEND);
+        glBindVertexArray(0);
+        glUseProgram(0);
+    }
+
+    // CLN: the arrays keep their size, so a steady amount of debug drawing stops allocating after the first frames
+    for (const std::unique_ptr<ThreadBuffer>& buffer : threadBuffers)
+    {
+        buffer->used[0] = buffer->used[1] = 0;
+        buffer->droppedLines = 0;
+    }
+
+    lastLineCount = total / 2;
+    lastOverlayLineCount = counts[1] / 2;
+    lastDroppedLineCount = dropped;
+    lastThreadCount = threads;
+    lastFlushMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+void DebugDraw::Clear()
+{
+    std::lock_guard<std::mutex> registryLock(buffersMutex);
+    for (const std::unique_ptr<ThreadBuffer>& buffer : threadBuffers)
+    {
+        std::lock_guard<std::mutex> lock(buffer->mutex);
+        buffer->used[0] = buffer->used[1] = 0;
+        buffer->droppedLines = 0;
+    }
+}
+
+
+void DebugDraw::PrintStats(std::ostream& out) const
+{
+    const std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(3)
+        << "INFO: Debug draw: " << lastLineCount << " lines (" << lastOverlayLineCount << " on top) from "
+        << lastThreadCount << " threads, " << lastFlushMs << " ms CPU to upload and draw";
+    if (lastDroppedLineCount > 0)
+        out << ", " << lastDroppedLineCount << " dropped (over " << MAX_VERTICES / 2 << " lines per thread)";
+    out << "\n";
+    out.unsetf(std::ios::floatfield);
+    out.precision(precision);
+    out.flush();
+}
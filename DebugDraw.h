@@ -0,0 +1,112 @@
+//========================================================================================
+// Filename      : DebugDraw.h
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Batched immediate-mode debug drawing: lines, boxes, spheres, frustums,
+//               : markers and text labels for visualizing bounds, light radii, camera
+//               : paths and the like.
+//               :
+//               : The shape calls can be made from any thread. Each thread appends its
+//               : line vertices to its own arrays (registered the first time it draws),
+//               : so recording threads never wait on each other. Once a frame, Flush()
+//               : on the GL thread uploads every thread's lines into one streaming
+//               : vertex buffer and draws them with at most two glDrawArrays() calls:
+//               : the depth-tested lines, then the overlay lines on top of the scene.
+//               :
+//               : Text is drawn with a small stroke font (digits, letters, a few
+//               : symbols; lower case is shown as upper case), facing the camera set by
+//               : SetCamera().
+//========================================================================================
+
+#ifndef DEBUG_DRAW_H
+#define DEBUG_DRAW_H
+
+#include <GL/glew.h>
+
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct DebugDrawVertex
+{
+    float position[3];
+    GLuint color;       // RGBA8, see DebugDraw::Color()
+};
+
+class DebugDraw
+{
+public:
+    static const size_t MAX_VERTICES = 1 << 21;     // per frame and thread; lines beyond it are dropped (and counted)
+    static const int CIRCLE_SEGMENTS = 32;
+    static const int POSITION_LOCATION = 0;
+    static const int COLOR_LOCATION = 1;
+
+    DebugDraw();
+
+    DebugDraw(const DebugDraw&) = delete;
+    DebugDraw& operator=(const DebugDraw&) = delete;
+
+    // program draws the lines (see debugDrawVertexShaderSource in main)
+    bool Create(GLuint program);
+    void Destroy();
+    bool IsCreated() const      { return vbo != 0; }
+
+    static GLuint Color(float r, float g, float b, float a = 1.0f);
+
+    // recording, from any thread. Points are world space xyz; overlay lines are drawn without the depth test
+    void Line(const float* from, const float* to, GLuint color, bool overlay = false);
+    void Lines(const float* points, size_t lineCount, GLuint color, bool overlay = false);  // lineCount pairs of points
+    void LineStrip(const float* points, size_t pointCount, GLuint color, bool overlay = false);
+    void Box(const float* minimum, const float* maximum, GLuint color, bool overlay = false);
+    void Sphere(const float* center, float radius, GLuint color, bool overlay = false);      // three great circles
+    void Frustum(const float* inverseViewProjection, GLuint color, bool overlay = false);    // the 12 edges of its clip volume
+    void Marker(const float* position, float size, GLuint color, bool overlay = true);       // axis cross
+    void Text(const float* position, const std::string& text, float height, GLuint color, bool overlay = true);  // centered above position
+
+    // GL thread
+    void SetCamera(const float* view);              // orientation of the text, until the next call
+    void Flush(const float* viewProjection);        // draws everything recorded since the last Flush() or Clear() into the bound framebuffer
+    void Clear();                                   // drops it instead
+
+    size_t GetLastLineCount() const         { return lastLineCount; }     // both layers
+    size_t GetLastOverlayLineCount() const  { return lastOverlayLineCount; }
+    size_t GetLastDroppedLineCount() const  { return lastDroppedLineCount; }
+    double GetLastFlushMs() const           { return lastFlushMs; }       // CPU time of the upload and draw calls
+    void PrintStats(std::ostream& out) const;
+
+private:
+    struct ThreadBuffer
+    {
+        std::thread::id thread;
+        std::mutex mutex;                           // only contended while Flush() copies the buffer
+        std::vector<DebugDrawVertex> vertices[2];   // depth-tested, overlay; only grows (resizing per shape costs more than drawing it)
+        size_t used[2] = { 0, 0 };                  // vertices recorded into them this frame
+        size_t droppedLines = 0;
+    };
+
+    ThreadBuffer& GetThreadBuffer();
+    static DebugDrawVertex* Reserve(ThreadBuffer& buffer, bool overlay, size_t lineCount);  // room for the lines, nullptr (counted as dropped) when full
+    void GetCameraAxes(float* right, float* up);
+
+    const unsigned int id;                          // tells the instances apart in each thread's cached buffer
+    GLuint program;
+    GLuint vao;
+    GLuint vbo;
+    size_t vboCapacity;                             // vertices
+    std::mutex buffersMutex;                        // guards threadBuffers (registration and Flush())
+    std::vector<std::unique_ptr<ThreadBuffer>> threadBuffers;
+    std::mutex cameraMutex;
+    float cameraRight[3];
+    float cameraUp[3];
+    size_t lastLineCount;
+    size_t lastOverlayLineCount;
+    size_t lastDroppedLineCount;
+    size_t lastThreadCount;                         // threads that drew in the last frame
+    double lastFlushMs;
+};
+
+#endif
@@ -0,0 +1,521 @@
+//========================================================================================
+// Filename      : FlightRecorder.cpp
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Implementation of the FlightRecorder class (see FlightRecorder.h)
+//========================================================================================
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#ifndef _WIN32
+#include <signal.h>         // sigaction
+#endif
+
+#include "FlightRecorder.h"
+
+namespace
+{
+    std::atomic<unsigned int> gNextFlightRecorderId(1);
+
+    // CLN: the calling thread's ring of the instance it used last, so the common case needs no lock or search
+    struct CachedThreadRing
+    {
+        unsigned int owner;     // FlightRecorder id, 0 for none
+        void* ring;
+    };
+    thread_local CachedThreadRing tCachedRing = { 0, nullptr };
+
+    // CLN: set by the SIGUSR1 handler, taken by the next EndFrame()
+    volatile std::sig_atomic_t gDumpRequested = 0;
+
+#ifndef _WIN32
+    extern "C" void OnDumpSignal(int)
+    {
+        gDumpRequested = 1;
+    }
+#endif
+
+    const size_t RING_MASK = FlightRecorder::EVENTS_PER_THREAD - 1;
+    const int CALIBRATION_EVENTS = 4096;
+
+    void WriteJsonString(std::ostream& out, const char* text)
+    {
+        out << '"';
+        for (const char* c = text; *c; ++c)
+        {
+            if (*c == '"' || *c == '\\')
+                out << '\\' << *c;
+            else if ((unsigned char)*c >= ' ')
+                out << *c;
+        }
+        out << '"';
+    }
+
+    // CLN: (self-test) whether text is well-formed JSON as far as the trace needs: balanced braces and brackets outside
+    //      the strings, and only valid escapes and no control characters inside them
+    bool IsWellFormedJson(const std::string& text)
+    {
+        int depth = 0;
+        bool inString = false;
+        for (size_t i = 0; i < text.size(); ++i)
+        {
+            const char c = text[i];
+            if (inString)
+            {
+                if ((unsigned char)c < ' ')
+                    return false;
+                if (c == '\\')
+                {
+                    if (++i == text.size() || strchr("\"\\/bfnrtu", text[i]) == nullptr)
+                        return false;
+                }
+                else if (c == '"')
+                    inString = false;
+            }
+            else if (c == '"')
+                inString = true;
+            else if (c == '{' || c == '[')
+                ++depth;
+            else if ((c == '}' || c == ']') && --depth < 0)
+                return false;
+        }
+        return depth == 0 && !inString;
+    }
+}
+
+
+FlightRecorder::FlightRecorder()
+    : id(gNextFlightRecorderId++), enabled(true), spikeMs(50.0), seconds(5.0), frames(0), lastDumpNs(0),
+      lastEventTotal(0), averageEventsPerFrame(0.0), averageFrameMs(0.0), eventCostNs(0.0), dumps(0)
+{
+}
+
+
+void FlightRecorder::Configure(bool enabled, double spikeMs, double seconds, const std::string& directory)
+{
+    this->enabled = enabled;
+    this->spikeMs = spikeMs;
+    this->seconds = seconds;
+    this->directory = directory;
+}
+
+
+unsigned long long FlightRecorder::Now()
+{
+    return (unsigned long long)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+FlightRecorder::ThreadRing& FlightRecorder::GetThreadRing()
+{
+    if (tCachedRing.owner == id)
+        return *static_cast<ThreadRing*>(tCachedRing.ring);
+
+    std::lock_guard<std::mutex> lock(ringsMutex);
+    const std::thread::id thread = std::this_thread::get_id();
+    ThreadRing* ring = nullptr;
+    for (const std::unique_ptr<ThreadRing>& existing : rings)
+    {
+        if (existing->id == thread)
+            ring = existing.get();
+    }
+    if (!ring)
+    {
+        rings.emplace_back(new ThreadRing);
+        ring = rings.back().get();
+        ring->thread = (unsigned int)rings.size() - 1;
+        ring->id = thread;
+        ring->events.resize(EVENTS_PER_THREAD);
+    }
+
+    tCachedRing.owner = id;
+    tCachedRing.ring = ring;
+    return *ring;
+}
+
+
+// CLN: only the owning thread writes a ring, so a plain store of the event and a release store of head are enough;
+//      Snapshot() reads head with acquire and can't see an event before it is complete
+void FlightRecorder::Record(const char* name, unsigned long long startNs, unsigned long long durationNs, double value, FlightEventType type)
+{
+    ThreadRing& ring = GetThreadRing();
+    const unsigned long long head = ring.head.load(std::memory_order_relaxed);
+    FlightEvent& event = ring.events[head & RING_MASK];
+    event.startNs = startNs;
+    event.durationNs = durationNs;
+    event.name = name;
+    event.value = value;
+    event.thread = ring.thread;
+    event.type = type;
+    ring.head.store(head + 1, std::memory_order_release);
+}
+
+
+void FlightRecorder::Zone(const char* name, unsigned long long startNs, unsigned long long endNs)
+{
+    if (enabled)
+        Record(name, startNs, endNs - startNs, 0.0, FLIGHT_ZONE);
+}
+
+
+void FlightRecorder::Counter(const char* name, double value)
+{
+    if (enabled)
+        Record(name, Now(), 0, value, FLIGHT_COUNTER);
+}
+
+
+void FlightRecorder::Instant(const char* name, double value)
+{
+    if (enabled)
+        Record(name, Now(), 0, value, FLIGHT_INSTANT);
+}
+
+
+bool FlightRecorder::EndFrame(unsigned long long frameStartNs, std::string& reason)
+{
+    if (!enabled)
+        return false;
+
+    const unsigned long long now = Now();
+    Record("frame", frameStartNs, now - frameStartNs, 0.0, FLIGHT_FRAME);
+    ++frames;
+
+    // CLN: events the calling (main) thread recorded in the frame and the frame time, smoothed, for the overhead
+    //      estimate in PrintStats(). Other threads' events don't add to the frame time, so they aren't counted
+    const unsigned long long eventTotal = GetThreadRing().head.load(std::memory_order_relaxed);
+    const double frameMs = (now - frameStartNs) / 1e6;
+    const double frameEvents = (double)(eventTotal - lastEventTotal);
+    lastEventTotal = eventTotal;
+    averageEventsPerFrame = frames == 1 ? frameEvents : averageEventsPerFrame * 0.95 + frameEvents * 0.05;
+    averageFrameMs = frames == 1 ? frameMs : averageFrameMs * 0.95 + frameMs * 0.05;
+
+    if (gDumpRequested)
+    {
+        gDumpRequested = 0;
+        reason = "SIGUSR1 received";
+    }
+    // CLN: (not the first frame, which includes the driver's lazy setup, and not again within the window of the
+    //      last dump, since a second one would mostly repeat it)
+    else if (frameMs > spikeMs && frames > 1 && now - lastDumpNs > (unsigned long long)(seconds * 1e9))
+    {
+        std::ostringstream text;
+        text << std::fixed << std::setprecision(1) << "frame " << frames << " took " << frameMs << " ms (spike threshold " << spikeMs << " ms)";
+        reason = text.str();
+    }
+    else
+        return false;
+
+    lastDumpNs = now;
+    return true;
+}
+
+
+// CLN: the writers keep going while the rings are copied. An event is kept only if it was published before the copy
+//      started and its slot can't have been reused before the copy ended (a writer may be filling slot head % N)
+void FlightRecorder::Snapshot(std::vector<FlightEvent>& events) const
+{
+    events.clear();
+    const unsigned long long now = Now();
+    const unsigned long long windowNs = (unsigned long long)(seconds * 1e9);
+    const unsigned long long windowStart = now > windowNs ? now - windowNs : 0;
+
+    std::lock_guard<std::mutex> lock(ringsMutex);
+    std::vector<FlightEvent> copy(EVENTS_PER_THREAD);
+    events.reserve(rings.size() * EVENTS_PER_THREAD / 4);
+    for (const std::unique_ptr<ThreadRing>& ring : rings)
+    {
+        const unsigned long long head = ring->head.load(std::memory_order_acquire);
+        const unsigned long long first = head > EVENTS_PER_THREAD ? head - EVENTS_PER_THREAD : 0;
+        for (unsigned long long i = first; i < head; ++i)
+            copy[i & RING_MASK] = ring->events[i & RING_MASK];
+
+        const unsigned long long headAfter = ring->head.load(std::memory_order_acquire);
+        const unsigned long long firstValid = std::max(first, headAfter >= EVENTS_PER_THREAD ? headAfter - EVENTS_PER_THREAD + 1 : 0);
+        for (unsigned long long i = firstValid; i < head; ++i)
+        {
+            const FlightEvent& event = copy[i & RING_MASK];
+            if (event.startNs + event.durationNs >= windowStart)
+                events.push_back(event);
+        }
+    }
+}
+
+
+std::string FlightRecorder::NextDumpFilename()
+{
+    ++dumps;
+    const std::string filename = "flight_record_" + std::to_string(frames) + ".json";
+    if (directory.empty())
+        return filename;
+    const char last = directory[directory.size() - 1];
+    return last == '/' || last == '\\' ? directory + filename : directory + "/" + filename;
+}
+
+
+// CLN: Chrome trace event format: zones are complete events ("X"), counters "C" and input "i", in microseconds from
+//      the first event. The thread that recorded first (the main thread, through MeasureEventCost()) is tid 0
+bool FlightRecorder::WriteTrace(const std::string& filename, std::vector<FlightEvent>& events, const std::string& reason)
+{
+    std::sort(events.begin(), events.end(), [](const FlightEvent& a, const FlightEvent& b) { return a.startNs < b.startNs; });
+
+
+    std::ofstream out(filename);
+    if (!out)
+    {
+        std::cout << "Failed to open flight record " << filename << std::endl;
+        return false;
+    }
+
+    const unsigned long long origin = events.empty() ? 0 : events[0].startNs;
+    unsigned int threads = 0;
+    out << std::fixed << std::setprecision(3) << "{\"otherData\":{\"reason\":";
+    WriteJsonString(out, reason.c_str());
+    out << "},\n\"traceEvents\":[";
+    for (size_t i = 0; i < events.size(); ++i)
+    {
+        const FlightEvent& event = events[i];
+        threads = std::max(threads, event.thread + 1);
+        out << (i == 0 ? "\n" : ",\n") << "{\"name\":";
+        WriteJsonString(out, event.name);
+        out << ",\"pid\":1,\"tid\":" << event.thread << ",\"ts\":" << (event.startNs - origin) / 1e3;
+        switch (event.type)
+        {
+        case FLIGHT_ZONE:
+        case FLIGHT_FRAME:
+            out << ",\"ph\":\"X\",\"dur\":" << event.durationNs / 1e3 << ",\"cat\":\"" << (event.type == FLIGHT_FRAME ? "frame" : "cpu") << "\"}";
+            break;
+        case FLIGHT_COUNTER:
+            out << ",\"ph\":\"C\",\"args\":{\"value\":" << event.value << "}}";
+            break;
+        default:
+            out << ",\"ph\":\"i\",\"s\":\"t\",\"args\":{\"value\":" << event.value << "}}";
+            break;
+        }
+    }
+    for (unsigned int thread = 0; thread < threads; ++thread)
+    {
+        out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread << ",\"args\":{\"name\":\""
+            << (thread == 0 ? std::string("main thread") : "thread " + std::to_string(thread)) << "\"}}";
+    }
+    out << "\n]}\n";
+
+    if (!out)
+    {
+        std::cout << "Failed to write flight record " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+
+void FlightRecorder::InstallSignalHandler()
+{
+#ifndef _WIN32
+    struct sigaction action = {};
+    action.sa_handler = OnDumpSignal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    if (sigaction(SIGUSR1, &action, nullptr) != 0)
+        std::cout << "WARNING: Failed to install the SIGUSR1 handler; flight records are only written on spikes" << std::endl;
+#endif
+}
+
+
+// CLN: a burst of zones (two clock reads and a ring write each, the most expensive kind) whose events are then
+//      dropped again by rewinding head; only the calling thread writes its ring, so that is safe here
+void FlightRecorder::MeasureEventCost()
+{
+    if (!enabled)
+        return;
+
+    ThreadRing& ring = GetThreadRing();
+    const unsigned long long head = ring.head.load(std::memory_order_relaxed);
+    const unsigned long long start = Now();
+    for (int i = 0; i < CALIBRATION_EVENTS; ++i)
+        FlightZone zone(*this, "calibration");
+    eventCostNs = (double)(Now() - start) / CALIBRATION_EVENTS;
+    ring.head.store(head, std::memory_order_release);
+}
+
+
+void FlightRecorder::PrintStats(std::ostream& out) const
+{
+    if (!enabled)
+    {
+        out << "INFO: Flight recorder: off" << std::endl;
+        return;
+    }
+
+    size_t threads;
+    {
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        threads = rings.size();
+    }
+    const double overheadMs = averageEventsPerFrame * eventCostNs / 1e6;
+    const std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(1)
+        << "INFO: Flight recorder: " << threads << " thread(s), last " << seconds << " s kept, dumps frames over " << spikeMs << " ms; "
+        << averageEventsPerFrame << " main thread events per frame at " << eventCostNs << " ns each = " << std::setprecision(3) << overheadMs << " ms ("
+        << (averageFrameMs > 0.0 ? 100.0 * overheadMs / averageFrameMs : 0.0) << "% of the frame time), " << dumps << " dump(s)" << std::endl;
+    out.unsetf(std::ios_base::floatfield);
+    out.precision(precision);
+}
+
+
+bool FlightRecorder::SelfTest(std::ostream& out)
+{
+    bool passed = true;
+    auto check = [&out, &passed](bool condition, const char* what) {
+        if (!condition)
+        {
+            out << "Failed flight recorder self-test: " << what << std::endl;
+            passed = false;
+        }
+    };
+
+    // CLN: a ring written past its size keeps the newest events, in order. Snapshot() leaves out the oldest slot,
+    //      which a writer could be filling, so EVENTS_PER_THREAD - 1 come back
+    {
+        FlightRecorder recorder;
+        recorder.Configure(true, 50.0, 60.0, "");
+        const size_t written = EVENTS_PER_THREAD + 100;
+        for (size_t i = 0; i < written; ++i)
+            recorder.Instant("wrap", (double)i);
+        std::vector<FlightEvent> events;
+        recorder.Snapshot(events);
+        bool ordered = events.size() == EVENTS_PER_THREAD - 1;
+        for (size_t i = 0; ordered && i < events.size(); ++i)
+            ordered = events[i].value == (double)(written - events.size() + i) && events[i].type == FLIGHT_INSTANT;
+        check(ordered, "a wrapped ring didn't keep its newest events in order");
+    }
+
+    // CLN: Snapshot() keeps what ended inside the window, zones that started before it included
+    {
+        FlightRecorder recorder;
+        recorder.Configure(true, 50.0, 5.0, "");
+        const unsigned long long now = Now();
+        const unsigned long long second = 1000000000ull;
+        recorder.Zone("before the window", now - 10 * second, now - 9 * second);
+        recorder.Zone("across the start", now - 6 * second, now - 4 * second);
+        recorder.Zone("inside", now - 2 * second, now - 1 * second);
+        recorder.Counter("now", 1.0);
+        recorder.Counter("padding", 0.0);     // CLN: the slot Snapshot() leaves out is the oldest one, not this
+        std::vector<FlightEvent> events;
+        recorder.Snapshot(events);
+        std::string names;
+        for (const FlightEvent& event : events)
+            names += std::string(event.name) + ";";
+        check(names == "across the start;inside;now;padding;", "the window kept the wrong events");
+    }
+
+    // CLN: with a thread writing all the time, every event a snapshot returns is one the writer published and no
+    //      later lap overwrote: the values of each snapshot count up without a gap
+    {
+        FlightRecorder recorder;
+        recorder.Configure(true, 50.0, 60.0, "");
+        recorder.Counter("main", 0.0);  // CLN: the main thread is thread 0, the writer 1
+        std::atomic<bool> stop(false);
+        std::atomic<unsigned long long> writes(0);
+        std::thread writer([&] {
+            for (unsigned long long i = 0; !stop.load(std::memory_order_relaxed); ++i)
+            {
+                recorder.Zone("writer", i, i + 2000000000000000000ull);    // CLN: ends far in the future, so always in the window
+                writes.store(i + 1, std::memory_order_relaxed);
+            }
+        });
+        while (writes.load() < EVENTS_PER_THREAD * 2)
+            std::this_thread::yield();
+
+        bool consistent = true;
+        size_t largest = 0;
+        std::vector<FlightEvent> events;
+        for (int snapshot = 0; snapshot < 20; ++snapshot)
+        {
+            recorder.Snapshot(events);
+            unsigned long long expected = 0;
+            size_t count = 0;
+            for (const FlightEvent& event : events)
+            {
+                if (event.thread != 1)
+                    continue;
+                if (count > 0 && event.startNs != expected)
+                    consistent = false;
+                if (strcmp(event.name, "writer") != 0 || event.durationNs != 2000000000000000000ull)
+                    consistent = false;
+                expected = event.startNs + 1;
+                ++count;
+            }
+            largest = std::max(largest, count);
+            std::this_thread::yield();
+        }
+        stop = true;
+        writer.join();
+        check(consistent, "a snapshot returned an event overwritten during the copy");
+        check(largest > 0, "a snapshot lost every event of a writing thread");
+    }
+
+    // CLN: the first frame never dumps, a slow frame does, the next ones not until the window of that dump has passed,
+    //      and a disabled recorder never does
+    {
+        FlightRecorder recorder;
+        recorder.Configure(true, 5.0, 0.05, "");
+        const unsigned long long millisecond = 1000000ull;
+        std::string reason;
+        const bool firstFrame = recorder.EndFrame(Now() - 20 * millisecond, reason);
+        const bool fastFrame = recorder.EndFrame(Now() - 1 * millisecond, reason);
+        const bool spike = recorder.EndFrame(Now() - 20 * millisecond, reason);
+        check(!firstFrame && !fastFrame && spike, "the spikes dumped were the wrong ones");
+        check(reason.find("frame 3 took 2") == 0 && reason.find("(spike threshold 5.0 ms)") != std::string::npos,
+              "a spike's reason is wrong");
+        check(!recorder.EndFrame(Now() - 20 * millisecond, reason), "a spike inside the last dump's window dumped again");
+        std::this_thread::sleep_for(std::chrono::milliseconds(60));
+        check(recorder.EndFrame(Now() - 20 * millisecond, reason), "a spike after the last dump's window didn't dump");
+
+        recorder.Configure(false, 5.0, 0.05, "");
+        std::this_thread::sleep_for(std::chrono::milliseconds(60));
+        check(!recorder.EndFrame(Now() - 20 * millisecond, reason), "a disabled recorder dumped");
+    }
+
+    // CLN: names and reasons with quotes, backslashes and control characters still make valid JSON, sorted by time
+    {
+        const char* const names[] = { "quote \"here\"", "back\\slash", "tab\tand\nnewline", "plain" };
+        std::vector<FlightEvent> events(4);
+        for (int i = 0; i < 4; ++i)
+        {
+            events[i].startNs = 1000000ull * (4 - i);
+            events[i].durationNs = 500;
+            events[i].name = names[i];
+            events[i].value = 0.5;
+            events[i].thread = (unsigned int)i % 2;
+            events[i].type = i;
+        }
+        const std::string filename = "flight_recorder_self_test.json";
+        const bool written = WriteTrace(filename, events, "reason with \"quotes\"\n");
+        std::ifstream file(filename.c_str());
+        std::stringstream contents;
+        contents << file.rdbuf();
+        file.close();
+        std::remove(filename.c_str());
+
+        const std::string json = contents.str();
+        check(written && IsWellFormedJson(json), "the trace isn't well-formed JSON");
+        check(json.find("\"reason\":\"reason with \\\"quotes\\\"\"") != std::string::npos, "the reason wasn't escaped");
+        check(json.find("\"name\":\"quote \\\"here\\\"\"") != std::string::npos && json.find("\"name\":\"back\\\\slash\"") != std::string::npos
+              && json.find("\"name\":\"tabandnewline\"") != std::string::npos, "a name wasn't escaped");
+        const size_t plain = json.find("\"name\":\"plain"), tab = json.find("\"name\":\"tab"), back = json.find("\"name\":\"back");
+        check(plain < tab && tab < back && back < json.find("\"name\":\"quote"), "the events aren't sorted by time");
+        check(json.find("\"tid\":1,\"args\":{\"name\":\"thread 1\"}") != std::string::npos, "a thread wasn't named");
+    }
+
+    return passed;
+}
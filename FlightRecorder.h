@@ -0,0 +1,136 @@
+//========================================================================================
+// Filename      : FlightRecorder.h
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Always-on recorder of the last few seconds of CPU zones, GPU timings,
+//               : counters and input events, for spikes too rare to catch with a
+//               : profiler attached. When a frame takes longer than the spike
+//               : threshold, or the process gets SIGUSR1 (POSIX), the recorded
+//               : window is dumped as a Chrome trace event file (open it in
+//               : chrome://tracing or ui.perfetto.dev).
+//               :
+//               : Each thread records into its own ring buffer of fixed-size events,
+//               : so recording is a clock read and a few stores, with no lock and no
+//               : allocation; the oldest events are overwritten. Snapshot() copies the
+//               : rings while they are written and drops any event that may have been
+//               : overwritten during the copy. Event names must be string literals
+//               : (or otherwise outlive the recorder), only the pointer is stored.
+//               :
+//               : The cost of one event is measured at startup, so the T stats can
+//               : show the recorder's share of the frame time.
+//========================================================================================
+
+#ifndef FLIGHT_RECORDER_H
+#define FLIGHT_RECORDER_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum FlightEventType
+{
+    FLIGHT_ZONE,        // CPU zone
+    FLIGHT_COUNTER,     // a value over time (frame time, GPU pass times, memory use)
+    FLIGHT_INSTANT,     // input and other one-off events, with a value (key code, button, ...)
+    FLIGHT_FRAME        // a whole frame, as a zone
+};
+
+struct FlightEvent
+{
+    unsigned long long startNs;
+    unsigned long long durationNs;
+    const char* name;
+    double value;
+    unsigned int thread;    // order in which threads first recorded, the main thread is 0
+    unsigned int type;      // FlightEventType
+};
+
+class FlightRecorder
+{
+public:
+    static const size_t EVENTS_PER_THREAD = 1 << 16;    // power of two; about 2.5 MB per recording thread
+
+    FlightRecorder();
+
+    FlightRecorder(const FlightRecorder&) = delete;
+    FlightRecorder& operator=(const FlightRecorder&) = delete;
+
+    // spikeMs: frames longer than this are dumped; seconds: window written to the dump
+    void Configure(bool enabled, double spikeMs, double seconds, const std::string& directory);
+    bool IsEnabled() const                  { return enabled; }
+
+    static unsigned long long Now();        // steady clock, ns
+
+    // recording, from any thread
+    void Zone(const char* name, unsigned long long startNs, unsigned long long endNs);
+    void Counter(const char* name, double value);
+    void Instant(const char* name, double value);
+
+    // main thread, once per frame: records the frame, and returns true with the reason when the window should be
+    // dumped (a spike, not within a window of the last dump, or SIGUSR1)
+    bool EndFrame(unsigned long long frameStartNs, std::string& reason);
+
+    // copies the events of the last `seconds` (thread by thread, not in time order). Called right after EndFrame(),
+    // before the rings wrap; the writing can go to another thread
+    void Snapshot(std::vector<FlightEvent>& events) const;
+    std::string NextDumpFilename();
+    static bool WriteTrace(const std::string& filename, std::vector<FlightEvent>& events, const std::string& reason);   // sorts events by time
+
+    static void InstallSignalHandler();     // SIGUSR1 requests a dump (does nothing on Windows)
+    void MeasureEventCost();                // times a burst of events for the overhead estimate
+    void PrintStats(std::ostream& out) const;
+
+    // checks the ring wrap, Snapshot()'s window and its copy under a concurrent writer, the spike detection and the
+    // window without a second dump, and the JSON WriteTrace() produces for awkward names (--self-test)
+    static bool SelfTest(std::ostream& out);
+
+private:
+    struct ThreadRing
+    {
+        unsigned int thread;
+        std::thread::id id;
+        std::atomic<unsigned long long> head{ 0 };      // events ever written; the slot is head % EVENTS_PER_THREAD
+        std::vector<FlightEvent> events;
+    };
+
+    ThreadRing& GetThreadRing();
+    void Record(const char* name, unsigned long long startNs, unsigned long long durationNs, double value, FlightEventType type);
+
+    const unsigned int id;                  // tells the instances apart in each thread's cached ring
+    bool enabled;
+    double spikeMs;
+    double seconds;
+    std::string directory;
+    mutable std::mutex ringsMutex;          // guards rings (registration, Snapshot() and EndFrame())
+    std::vector<std::unique_ptr<ThreadRing>> rings;
+    unsigned long long frames;
+    unsigned long long lastDumpNs;
+    unsigned long long lastEventTotal;      // events in the main thread's ring at the end of the last frame
+    double averageEventsPerFrame;
+    double averageFrameMs;
+    double eventCostNs;
+    unsigned int dumps;
+};
+
+// Records the enclosing scope as a zone
+class FlightZone
+{
+public:
+    FlightZone(FlightRecorder& recorder, const char* name) : recorder(recorder), name(name), start(FlightRecorder::Now()) {}
+    ~FlightZone()   { recorder.Zone(name, start, FlightRecorder::Now()); }
+
+    FlightZone(const FlightZone&) = delete;
+    FlightZone& operator=(const FlightZone&) = delete;
+
+private:
+    FlightRecorder& recorder;
+    const char* name;
+    unsigned long long start;
+};
+
+#endif
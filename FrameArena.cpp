@@ -0,0 +1,381 @@
+//========================================================================================
+// Filename      : FrameArena.cpp
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Implementation of the FrameArena class (see FrameArena.h)
+//========================================================================================
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+
+#include "FrameArena.h"
+#include "NumaTopology.h"
+
+namespace
+{
+    std::atomic<unsigned int> gNextFrameArenaId(1);
+
+    // CLN: the calling thread's arena of the instance it used last, so the common case needs no lock or search
+    struct CachedThreadArena
+    {
+        unsigned int owner;     // FrameArena id, 0 for none
+        void* arena;
+    };
+    thread_local CachedThreadArena tCachedArena = { 0, nullptr };
+
+    char* AlignUp(char* pointer, size_t alignment)
+    {
+        const uintptr_t address = (uintptr_t)pointer;
+        return (char*)((address + alignment - 1) & ~(uintptr_t)(alignment - 1));
+    }
+}
+
+
+FrameArena::FrameArena(size_t bytesPerThread, int framesInFlight)
+    : id(gNextFrameArenaId++), bytesPerThread(bytesPerThread),
+      framesInFlight(std::min(std::max(framesInFlight, 1), (int)MAX_FRAMES_IN_FLIGHT)), frame(0),
+      lastFrameBytes(0), lastOverflowBytes(0), worstOverflowBytes(0), overflowFrames(0)
+{
+}
+
+
+FrameArena::~FrameArena()
+{
+    for (const std::unique_ptr<ThreadArena>& arena : threadArenas)
+    {
+        for (Block& block : arena->blocks)
+        {
+            ReleaseOverflow(block);
+            NumaTopology::Free(block.memory, bytesPerThread);
+        }
+    }
+}
+
+
+FrameArena::ThreadArena& FrameArena::GetThreadArena()
+{
+    if (tCachedArena.owner == id)
+        return *static_cast<ThreadArena*>(tCachedArena.arena);
+
+    std::lock_guard<std::mutex> lock(arenasMutex);
+    const std::thread::id thread = std::this_thread::get_id();
+    ThreadArena* arena = nullptr;
+    for (const std::unique_ptr<ThreadArena>& existing : threadArenas)
+    {
+        if (existing->thread == thread)
+            arena = existing.get();
+    }
+    if (!arena)
+    {
+        threadArenas.emplace_back(new ThreadArena);
+        arena = threadArenas.back().get();
+        arena->thread = thread;
+        // CLN: on the node the thread runs on, the one that will touch the blocks (null just means every allocation
+        //      overflows)
+        const int node = NumaTopology::Get().GetCurrentNode();
+        for (int i = 0; i < framesInFlight; ++i)
+            arena->blocks[i].memory = (char*)NumaTopology::AllocateOnNode(bytesPerThread, node);
+    }
+
+    tCachedArena.owner = id;
+    tCachedArena.arena = arena;
+    return *arena;
+}
+
+
+void* FrameArena::Allocate(size_t bytes, size_t alignment)
+{
+    ThreadArena& arena = GetThreadArena();
+    const unsigned long long current = frame.load(std::memory_order_acquire);
+    if (arena.currentFrame != current)
+        BeginThreadFrame(arena, current);
+    Block& block = *arena.current;
+
+    block.demand.store(block.demand.load(std::memory_order_relaxed) + bytes, std::memory_order_relaxed);
+    if (block.memory)
+    {
+        char* start = AlignUp(block.memory + block.used, alignment);
+        if (start + bytes <= block.memory + bytesPerThread)
+        {
+            block.used = start + bytes - block.memory;
+            return start;
+        }
+    }
+    return AllocateOverflow(block, bytes, alignment);
+}
+
+
+// CLN: first allocation of a thread in a new frame: switch to that frame's block, whose data is framesInFlight
+//      frames old, and reuse it (the block search and the modulo stay out of the per-allocation path)
+void FrameArena::BeginThreadFrame(ThreadArena& arena, unsigned long long current)
+{
+    Block& block = arena.blocks[current % framesInFlight];
+    arena.current = &block;
+    arena.currentFrame = current;
+    if (block.frame.load(std::memory_order_relaxed) != current)
+    {
+        const size_t oldDemand = block.demand.load(std::memory_order_relaxed);
+        if (oldDemand > arena.highWater.load(std::memory_order_relaxed))
+            arena.highWater.store(oldDemand, std::memory_order_relaxed);
+        ReleaseOverflow(block);
+        block.used = 0;
+        block.demand.store(0, std::memory_order_relaxed);
+        block.frame.store(current, std::memory_order_relaxed);
+    }
+}
+
+
+void* FrameArena::AllocateOverflow(Block& block, size_t bytes, size_t alignment)
+{
+    char* memory = (char*)malloc(bytes + alignment);
+    if (!memory)
+        throw std::bad_alloc();
+    block.overflow.push_back(memory);
+    return AlignUp(memory, alignment);
+}
+
+
+void FrameArena::ReleaseOverflow(Block& block)
+{
+    for (void* memory : block.overflow)
+        free(memory);
+    block.overflow.clear();
+}
+
+
+void FrameArena::NextFrame()
+{
+    const unsigned long long finished = frame.load(std::memory_order_relaxed);
+    size_t frameBytes = 0, overflowBytes = 0, threadsOver = 0;
+    {
+        std::lock_guard<std::mutex> lock(arenasMutex);
+        for (const std::unique_ptr<ThreadArena>& arena : threadArenas)
+        {
+            const Block& block = arena->blocks[finished % framesInFlight];
+            if (block.frame.load(std::memory_order_relaxed) != finished)
+                continue;   // CLN: the thread didn't allocate this frame
+            const size_t demand = block.demand.load(std::memory_order_relaxed);
+            frameBytes += demand;
+            if (demand > bytesPerThread)
+            {
+                overflowBytes += demand - bytesPerThread;
+                ++threadsOver;
+            }
+        }
+    }
+    lastFrameBytes = frameBytes;
+    lastOverflowBytes = overflowBytes;
+
+    if (overflowBytes > 0)
+    {
+        ++overflowFrames;
+        if (overflowBytes > worstOverflowBytes)
+        {
+            worstOverflowBytes = overflowBytes;
+            std::cout << "WARNING: Frame arena overflowed by " << (overflowBytes + 1023) / 1024 << " KB on " << threadsOver
+                      << " thread(s) in frame " << finished << "; the excess came from the heap. High-water mark "
+                      << (GetHighWaterBytes() + 1023) / 1024 << " KB per thread, arena " << bytesPerThread / 1024 << " KB" << std::endl;
+        }
+    }
+
+    frame.store(finished + 1, std::memory_order_release);
+}
+
+
+size_t FrameArena::GetHighWaterBytes() const
+{
+    std::lock_guard<std::mutex> lock(arenasMutex);
+    size_t highWater = 0;
+    for (const std::unique_ptr<ThreadArena>& arena : threadArenas)
+    {
+        // CLN: the blocks fold their demand into highWater when they are reset, so the live ones are checked too
+        highWater = std::max(highWater, arena->highWater.load(std::memory_order_relaxed));
+        for (int i = 0; i < framesInFlight; ++i)
+            highWater = std::max(highWater, arena->blocks[i].demand.load(std::memory_order_relaxed));
+    }
+    return highWater;
+}
+
+
+void FrameArena::PrintStats(std::ostream& out) const
+{
+    size_t threads;
+    {
+        std::lock_guard<std::mutex> lock(arenasMutex);
+        threads = threadArenas.size();
+    }
+    const std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(1)
+        << "INFO: Frame arena: " << threads << " thread(s) x " << framesInFlight << " frames x " << bytesPerThread / 1024.0 << " KB, "
+        << lastFrameBytes / 1024.0 << " KB used last frame, high-water mark " << GetHighWaterBytes() / 1024.0 << " KB per thread";
+    if (overflowFrames > 0)
+        out << ", overflowed in " << overflowFrames << " frame(s) (last " << lastOverflowBytes / 1024.0 << " KB)";
+    out << std::endl;
+    out.unsetf(std::ios_base::floatfield);
+    out.precision(precision);
+}
+
+
+bool FrameArena::SelfTest(std::ostream& out)
+{
+    bool passed = true;
+    auto check = [&out, &passed](bool condition, const char* what) {
+        if (!condition)
+        {
+            out << "Failed frame arena self-test: " << what << std::endl;
+            passed = false;
+        }
+    };
+    auto inside = [](const void* pointer, const void* start, size_t bytes) {
+        return (const char*)pointer >= (const char*)start && (const char*)pointer < (const char*)start + bytes;
+    };
+
+    // CLN: every power of two alignment is honored after an odd-sized allocation, and the allocations don't overlap
+    {
+        FrameArena arena(4096, 2);
+        char* previousEnd = nullptr;
+        for (size_t alignment = 1; alignment <= 256; alignment *= 2)
+        {
+            char* odd = (char*)arena.Allocate(3, 1);
+            char* aligned = (char*)arena.Allocate(5, alignment);
+            check((uintptr_t)aligned % alignment == 0, "an allocation isn't aligned");
+            check(odd >= previousEnd && aligned >= odd + 3, "allocations overlap");
+            previousEnd = aligned + 5;
+        }
+        double* values = arena.AllocateArray<double>(7);
+        check((uintptr_t)values % alignof(double) == 0, "an array isn't aligned for its type");
+
+        FrameVector<int> list{ FrameAllocator<int>(arena) };
+        list.reserve(100);
+        for (int i = 0; i < 100; ++i)
+            list.push_back(i);
+        check(list[99] == 99 && inside(list.data(), values, 4096), "a FrameVector didn't allocate from the arena");
+    }
+
+    // CLN: what doesn't fit comes from the heap, and NextFrame() warns once per new worst overflow. The warning goes to
+    //      std::cout, so it is captured here
+    {
+        FrameArena arena(1024, 2);
+        std::ostringstream warnings;
+        std::streambuf* const console = std::cout.rdbuf(warnings.rdbuf());
+
+        char* first = (char*)arena.Allocate(600);
+        char* second = (char*)arena.Allocate(600);
+        memset(second, 0x5A, 600);   // CLN: heap memory, the address sanitizer would catch a short one
+        check(!inside(second, first, 1024), "an allocation past the end of the block came from the block");
+        arena.NextFrame();
+        const std::string firstWarning = warnings.str();
+        check(arena.GetLastFrameBytes() == 1200 && arena.overflowFrames == 1, "an overflowing frame was counted wrong");
+
+        arena.Allocate(600);
+        arena.Allocate(600);
+        arena.NextFrame();
+        const std::string repeatedWarning = warnings.str().substr(firstWarning.size());
+
+        arena.Allocate(600);
+        arena.Allocate(3000);
+        arena.NextFrame();
+        const std::string worseWarning = warnings.str().substr(firstWarning.size() + repeatedWarning.size());
+
+        arena.Allocate(100);
+        arena.NextFrame();
+        std::cout.rdbuf(console);
+
+        check(firstWarning.find("WARNING: Frame arena overflowed by 1 KB on 1 thread(s) in frame 0") != std::string::npos,
+              "the first overflow wasn't reported");
+        check(repeatedWarning.empty(), "an overflow no worse than before was reported again");
+        check(worseWarning.find("overflowed by 3 KB") != std::string::npos && worseWarning.find("in frame 2") != std::string::npos,
+              "a worse overflow wasn't reported");
+        check(arena.overflowFrames == 3 && arena.lastOverflowBytes == 0, "the overflow stats are wrong after a frame that fit");
+    }
+
+    // CLN: a frame's memory survives framesInFlight - 1 NextFrame() calls, and its block is reused after framesInFlight
+    {
+        const int framesInFlight = 3;
+        FrameArena arena(1024, framesInFlight);
+        unsigned char* frames[framesInFlight + 1];
+        for (int i = 0; i <= framesInFlight; ++i)
+        {
+            frames[i] = (unsigned char*)arena.Allocate(256);
+            if (i < framesInFlight)
+                memset(frames[i], 0x10 + i, 256);
+            for (int older = 0; older < i && older < framesInFlight; ++older)
+            {
+                if (i - older < framesInFlight)
+                    check(frames[older][0] == 0x10 + older && frames[older][255] == 0x10 + older, "data of a frame in flight changed");
+                check(frames[older] != frames[i] || i - older == framesInFlight, "a block was reused while its frame was in flight");
+            }
+            arena.NextFrame();
+        }
+        check(frames[framesInFlight] == frames[0], "the oldest block wasn't reused");
+    }
+
+    // CLN: a thread that allocates in frame 0, then skips frames 1 to 5, isn't counted in them (frame 3 has the slot of
+    //      frame 0, whose block is stale), and starts frame 6 (the same slot again) on a reset block
+    {
+        FrameArena arena(1024, 3);
+        std::atomic<int> step(0);
+        char* threadFirst = nullptr;
+        char* threadLater = nullptr;
+        std::thread worker([&] {
+            threadFirst = (char*)arena.Allocate(500);
+            arena.Allocate(400);
+            step = 1;
+            while (step.load() != 2)
+                std::this_thread::yield();
+            threadLater = (char*)arena.Allocate(500);
+            step = 3;
+        });
+        while (step.load() != 1)
+            std::this_thread::yield();
+
+        size_t frameBytes[6];
+        for (int i = 0; i < 6; ++i)
+        {
+            arena.Allocate(100);
+            arena.NextFrame();
+            frameBytes[i] = arena.GetLastFrameBytes();
+        }
+        step = 2;
+        while (step.load() != 3)
+            std::this_thread::yield();
+        worker.join();
+        arena.NextFrame();
+
+        check(frameBytes[0] == 1000, "frame 0 didn't count both threads");
+        for (int i = 1; i < 6; ++i)
+            check(frameBytes[i] == 100, "a thread was counted in a frame it skipped");
+        check(threadLater == threadFirst, "the skipping thread continued a stale block");
+        check(arena.GetLastFrameBytes() == 500, "the skipping thread's new frame was counted wrong");
+        check(arena.GetHighWaterBytes() == 900, "the high-water mark lost the skipping thread's old frame");
+    }
+
+    // CLN: the high-water mark is the largest demand of one thread in one frame, overflow included, and outlives the
+    //      reset of its block
+    {
+        FrameArena arena(1024, 2);
+        std::ostringstream warnings;
+        std::streambuf* const console = std::cout.rdbuf(warnings.rdbuf());
+        const size_t demands[] = { 300, 700, 1500, 100, 200, 50 };
+        size_t highWater[6];
+        for (int i = 0; i < 6; ++i)
+        {
+            arena.Allocate(demands[i]);
+            highWater[i] = arena.GetHighWaterBytes();
+            arena.NextFrame();
+        }
+        std::cout.rdbuf(console);
+        check(highWater[0] == 300 && highWater[1] == 700 && highWater[2] == 1500, "the high-water mark didn't follow a growing demand");
+        check(highWater[3] == 1500 && highWater[4] == 1500 && highWater[5] == 1500, "the high-water mark was lost with its block");
+    }
+
+    return passed;
+}
@@ -0,0 +1,135 @@
+//========================================================================================
+// Filename      : FrameArena.h
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Linear (bump) allocator for per-frame transient data: draw lists,
+//               : sort keys, culling results, uniform staging. Allocating is a pointer
+//               : bump and nothing is freed one by one; the memory of a frame is
+//               : reused as a whole a few frames later.
+//               :
+//               : Every thread that allocates gets its own blocks, on the NUMA node it
+//               : runs on, so allocations never lock or contend. There is one block per
+//               : frame in flight: memory from frame N stays valid until NextFrame()
+//               : has been called framesInFlight times, long enough for data the GPU is
+//               : still reading. A thread resets its own block the first time it
+//               : allocates in a new frame, so NextFrame() only has to advance the
+//               : frame number.
+//               :
+//               : When a block runs out, the allocation falls back to the heap (freed
+//               : when the block is next reset) and NextFrame() prints a warning with
+//               : the shortfall, so the arena can be sized from the high-water mark.
+//               :
+//               : FrameAllocator adapts the arena for the standard containers
+//               : (FrameVector<T>); reserve() up front, since memory a container grows
+//               : out of is only reclaimed with the frame.
+//========================================================================================
+
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+class FrameArena
+{
+public:
+    static const int MAX_FRAMES_IN_FLIGHT = 4;
+    static const size_t DEFAULT_BYTES_PER_THREAD = 4 << 20;     // per thread and frame
+
+    explicit FrameArena(size_t bytesPerThread = DEFAULT_BYTES_PER_THREAD, int framesInFlight = 3);
+    ~FrameArena();
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // any thread; valid for framesInFlight frames
+    void* Allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+
+    template <typename T>
+    T* AllocateArray(size_t count)      { return static_cast<T*>(Allocate(count * sizeof(T), alignof(T))); }
+
+    // main thread, once at the end of each frame
+    void NextFrame();
+
+    unsigned long long GetFrame() const { return frame.load(std::memory_order_relaxed); }
+    size_t GetBytesPerThread() const    { return bytesPerThread; }
+    size_t GetHighWaterBytes() const;   // most one thread asked for in one frame, overflow included
+    size_t GetLastFrameBytes() const    { return lastFrameBytes; }      // all threads, the frame before the last NextFrame()
+    void PrintStats(std::ostream& out) const;
+
+    // checks the alignment, the heap fallback and its warning, the reuse of a block framesInFlight frames later, a
+    // thread that skips frames and the high-water mark, on arenas of its own (--self-test)
+    static bool SelfTest(std::ostream& out);
+
+private:
+    struct Block
+    {
+        char* memory = nullptr;
+        size_t used = 0;
+        std::atomic<size_t> demand{ 0 };                    // bytes asked for this frame, overflow included (read by NextFrame())
+        std::atomic<unsigned long long> frame{ ~0ull };     // frame the block was last reset for
+        std::vector<void*> overflow;                        // heap fallbacks of that frame
+    };
+
+    struct ThreadArena
+    {
+        std::thread::id thread;
+        Block blocks[MAX_FRAMES_IN_FLIGHT];
+        std::atomic<size_t> highWater{ 0 };                 // largest demand of the blocks before their last reset
+        Block* current = nullptr;                           // block of currentFrame
+        unsigned long long currentFrame = ~0ull;
+    };
+
+    ThreadArena& GetThreadArena();
+    void BeginThreadFrame(ThreadArena& arena, unsigned long long current);
+    void* AllocateOverflow(Block& block, size_t bytes, size_t alignment);
+    static void ReleaseOverflow(Block& block);
+
+    const unsigned int id;                  // tells the instances apart in each thread's cached arena
+    const size_t bytesPerThread;
+    const int framesInFlight;
+    std::atomic<unsigned long long> frame;
+    mutable std::mutex arenasMutex;         // guards threadArenas (registration and the stats)
+    std::vector<std::unique_ptr<ThreadArena>> threadArenas;
+    size_t lastFrameBytes;
+    size_t lastOverflowBytes;
+    size_t worstOverflowBytes;              // the warning is repeated only when an overflow is worse than any before
+    unsigned long long overflowFrames;
+};
+
+
+// Standard library allocator on a FrameArena; deallocate() does nothing, the frame frees everything
+template <typename T>
+class FrameAllocator
+{
+public:
+    typedef T value_type;
+
+    explicit FrameAllocator(FrameArena& arena) : arena(&arena) {}
+    template <typename U>
+    FrameAllocator(const FrameAllocator<U>& other) : arena(other.GetArena()) {}
+
+    T* allocate(size_t count)               { return arena->AllocateArray<T>(count); }
+    void deallocate(T*, size_t)             {}
+
+    FrameArena* GetArena() const            { return arena; }
+
+private:
+    FrameArena* arena;
+};
+
+template <typename T, typename U>
+bool operator==(const FrameAllocator<T>& a, const FrameAllocator<U>& b)     { return a.GetArena() == b.GetArena(); }
+template <typename T, typename U>
+bool operator!=(const FrameAllocator<T>& a, const FrameAllocator<U>& b)     { return a.GetArena() != b.GetArena(); }
+
+template <typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+#endif
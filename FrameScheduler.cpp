@@ -0,0 +1,250 @@
+//========================================================================================
+// Filename      : FrameScheduler.cpp
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Implementation of the FrameScheduler class (see FrameScheduler.h)
+//========================================================================================
+
+#include <algorithm>
+#include <iomanip>
+#include "FrameScheduler.h"
+
+FrameScheduler::FrameScheduler(double budgetMs)
+    : budgetMs(budgetMs), nextSequence(0), lastFrameMs(0.0), framesRun(0), framesWithWork(0),
+      framesOverBudget(0), totalWorkMs(0.0), totalOverrunMs(0.0), worstOverrunMs(0.0),
+      itemsCompleted(0), itemsDeferred(0), itemsCancelled(0), maxFramesDeferred(0)
+{
+}
+
+
+// CLN: std heap functions keep the "largest" element on top, so "a runs before b" means b < a
+bool FrameScheduler::RunsBefore(const WorkItem& a, const WorkItem& b)
+{
+    if (a.priority != b.priority)
+        return a.priority < b.priority;
+    return a.sequence < b.sequence;
+}
+
+
+void FrameScheduler::Enqueue(const std::string& name, WorkPriority priority, WorkStep step, CancelStep cancel)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    WorkItem item;
+    item.name = name;
+    item.priority = priority;
+    item.sequence = nextSequence++;
+    item.framesDeferred = 0;
+    item.step = std::move(step);
+    item.cancel = std::move(cancel);
+
+    queue.push_back(std::move(item));
+    std::push_heap(queue.begin(), queue.end(), [](const WorkItem& a, const WorkItem& b) { return RunsBefore(b, a); });
+}
+
+
+size_t FrameScheduler::CancelAll()
+{
+    size_t count = 0;
+    for (;;)
+    {
+        std::vector<WorkItem> cancelled;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            cancelled.swap(queue);
+        }
+        if (cancelled.empty())
+            break;
+
+        // CLN: outside the lock, like the steps; anything a callback queues is cancelled in the next round
+        for (WorkItem& item : cancelled)
+        {
+            if (item.cancel)
+                item.cancel();
+        }
+        count += cancelled.size();
+    }
+    itemsCancelled += count;
+    return count;
+}
+
+
+size_t FrameScheduler::GetPendingCount()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return queue.size();
+}
+
+
+void FrameScheduler::RunFrame()
+{
+    typedef FrameDeadline::Clock Clock;
+    auto heapOrder = [](const WorkItem& a, const WorkItem& b) { return RunsBefore(b, a); };
+
+    const Clock::time_point frameStart = Clock::now();
+    const Clock::time_point frameEnd = frameStart + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(budgetMs));
+    const FrameDeadline deadline(frameEnd);
+
+    ++framesRun;
+    bool ranWork = false;
+
+    for (;;)
+    {
+        WorkItem item;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (queue.empty() || deadline.Expired())
+                break;
+
+            std::pop_heap(queue.begin(), queue.end(), heapOrder);
+            item = std::move(queue.back());
+            queue.pop_back();
+        }
+
+        // CLN: run the step without holding the lock, so a step may queue follow-up work
+        ranWork = true;
+        bool finished = item.step(deadline);
+        Clock::time_point stepEnd = Clock::now();
+
+        std::string itemName = item.name;
+        if (finished)
+        {
+            ++itemsCompleted;
+        }
+        else
+        {
+            // CLN: the item keeps its sequence number, so it resumes ahead of newer work of the same priority
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.push_back(std::move(item));
+            std::push_heap(queue.begin(), queue.end(), heapOrder);
+        }
+
+        if (stepEnd > frameEnd)
+        {
+            // CLN: a single step ran past the deadline, remember who did it so it can be split up
+            double overrunMs = std::chrono::duration<double, std::milli>(stepEnd - frameEnd).count();
+            totalOverrunMs += overrunMs;
+            if (overrunMs > worstOverrunMs)
+            {
+                worstOverrunMs = overrunMs;
+                worstOverrunItem = itemName;
+            }
+            break;
+        }
+    }
+
+    lastFrameMs = std::chrono::duration<double, std::milli>(Clock::now() - frameStart).count();
+    if (ranWork)
+    {
+        ++framesWithWork;
+        totalWorkMs += lastFrameMs;
+        if (lastFrameMs > budgetMs)
+            ++framesOverBudget;
+    }
+
+    // CLN: everything still queued carries over to the next frame
+    std::lock_guard<std::mutex> lock(mutex);
+    itemsDeferred += queue.size();
+    for (WorkItem& item : queue)
+    {
+        ++item.framesDeferred;
+        maxFramesDeferred = std::max(maxFramesDeferred, item.framesDeferred);
+    }
+}
+
+
+void FrameScheduler::PrintStats(std::ostream& out)
+{
+    size_t pending = GetPendingCount();
+
+    out << std::fixed << std::setprecision(3);
+    out << "INFO: Frame scheduler (budget " << budgetMs << " ms/frame)\n"
+        << "      frames with work : " << framesWithWork << " of " << framesRun << "\n"
+        << "      avg work / frame : " << (framesWithWork > 0 ? totalWorkMs / framesWithWork : 0.0) << " ms\n"
+        << "      items completed  : " << itemsCompleted << "\n"
+        << "      items pending    : " << pending << "\n"
+        << "      items cancelled  : " << itemsCancelled << "\n"
+        << "      deferred (item-frames carried over): " << itemsDeferred << ", longest carry-over " << maxFramesDeferred << " frames\n"
+        << "      frames over budget: " << framesOverBudget << ", total overrun " << totalOverrunMs << " ms";
+    if (!worstOverrunItem.empty())
+        out << ", worst " << worstOverrunMs << " ms in '" << worstOverrunItem << "'";
+    out << std::endl;
+    out.unsetf(std::ios::floatfield);
+}
+
+
+bool FrameScheduler::SelfTest(std::ostream& out)
+{
+    bool passed = true;
+    auto check = [&out, &passed](bool condition, const char* what) {
+        if (!condition)
+        {
+            out << "Failed frame scheduler self-test: " << what << std::endl;
+            passed = false;
+        }
+    };
+
+    // CLN: with a budget no step reaches, one RunFrame() runs everything: by priority, FIFO within one, an unfinished
+    //      item resumes ahead of newer work of its priority, and high priority work queued by a step runs next
+    {
+        FrameScheduler scheduler(1000.0);
+        std::string order;
+        int resumes = 0;
+        auto record = [&order](char name) { return [&order, name](const FrameDeadline&) { order += name; return true; }; };
+        scheduler.Enqueue("low", WORK_PRIORITY_LOW, record('l'));
+        scheduler.Enqueue("normal 1", WORK_PRIORITY_NORMAL, [&](const FrameDeadline&) {
+            order += 'n';
+            if (resumes == 0)
+                scheduler.Enqueue("high from a step", WORK_PRIORITY_HIGH, record('H'));
+            return ++resumes == 3;
+        });
+        scheduler.Enqueue("high 1", WORK_PRIORITY_HIGH, record('h'));
+        scheduler.Enqueue("normal 2", WORK_PRIORITY_NORMAL, record('m'));
+        scheduler.Enqueue("high 2", WORK_PRIORITY_HIGH, record('i'));
+        scheduler.RunFrame();
+
+        check(order == "hinHnnml", "items ran out of priority/FIFO order");
+        check(scheduler.GetPendingCount() == 0 && scheduler.itemsCompleted == 6, "items were left over or counted wrong");
+    }
+
+    // CLN: a step that works until the deadline runs once per frame and carries over until it is done
+    {
+        FrameScheduler scheduler(1.0);
+        int calls = 0;
+        int framesRun = 0;
+        scheduler.Enqueue("long", WORK_PRIORITY_NORMAL, [&calls](const FrameDeadline& deadline) {
+            while (!deadline.Expired())
+                ;
+            return ++calls == 3;
+        });
+        while (scheduler.GetPendingCount() > 0 && framesRun < 10)
+        {
+            scheduler.RunFrame();
+            ++framesRun;
+            check(calls == framesRun, "an item ran more than once in a frame past its deadline");
+        }
+        check(framesRun == 3 && scheduler.itemsDeferred == 2 && scheduler.maxFramesDeferred == 2, "carry-over counted wrong");
+    }
+
+    // CLN: CancelAll() calls every item's cancel callback, also for one queued by a callback, and runs no step
+    {
+        FrameScheduler scheduler(1000.0);
+        int steps = 0;
+        int cancels = 0;
+        auto step = [&steps](const FrameDeadline&) { ++steps; return true; };
+        scheduler.Enqueue("a", WORK_PRIORITY_NORMAL, step, [&] {
+            ++cancels;
+            scheduler.Enqueue("queued by a cancel", WORK_PRIORITY_HIGH, step, [&cancels] { ++cancels; });
+        });
+        scheduler.Enqueue("b", WORK_PRIORITY_LOW, step);
+        scheduler.Enqueue("c", WORK_PRIORITY_HIGH, step, [&cancels] { ++cancels; });
+
+        check(scheduler.CancelAll() == 4, "CancelAll() miscounted the items");
+        check(cancels == 3 && steps == 0 && scheduler.GetPendingCount() == 0, "CancelAll() ran a step or missed a callback");
+        scheduler.RunFrame();
+        check(steps == 0, "a cancelled item ran");
+    }
+
+    return passed;
+}
@@ -0,0 +1,121 @@
+//========================================================================================
+// Filename      : FrameScheduler.h
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Time-sliced scheduler for expensive background work (texture and
+//               : mesh uploads, mesh rebuilds, LOD generation, ...). Work items are
+//               : queued with a priority from any thread and are only run from the
+//               : render loop, inside a fixed time budget per frame (2 ms by default)
+//               : measured with a high-resolution clock.
+//               :
+//               : A work item is resumable: it is called with a FrameDeadline, does as
+//               : much as it can before the deadline expires, and returns false to be
+//               : resumed on a later frame or true once it is finished. Work that does
+//               : not fit in a frame carries over, and the deferred and over-budget
+//               : work is tracked in the stats printed by PrintStats().
+//               :
+//               : An item may also give a cancel callback, which CancelAll() calls in
+//               : place of the remaining steps (at exit), so whatever the steps created
+//               : so far (e.g. the buffers of a half-finished upload) is released.
+//========================================================================================
+
+#ifndef FRAME_SCHEDULER_H
+#define FRAME_SCHEDULER_H
+
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Lower value runs first
+enum WorkPriority
+{
+    WORK_PRIORITY_HIGH = 0,
+    WORK_PRIORITY_NORMAL = 1,
+    WORK_PRIORITY_LOW = 2
+};
+
+// Point in time at which the current frame's budget runs out
+class FrameDeadline
+{
+public:
+    typedef std::chrono::high_resolution_clock Clock;
+
+    explicit FrameDeadline(Clock::time_point end) : end(end) {}
+
+    bool Expired() const        { return Clock::now() >= end; }
+    double RemainingMs() const  { return std::chrono::duration<double, std::milli>(end - Clock::now()).count(); }
+
+private:
+    Clock::time_point end;
+};
+
+class FrameScheduler
+{
+public:
+    // returns true when the work item is finished, false to be resumed next frame
+    typedef std::function<bool(const FrameDeadline&)> WorkStep;
+    // releases what the steps created so far, when the item is dropped before it finished
+    typedef std::function<void()> CancelStep;
+
+    explicit FrameScheduler(double budgetMs = 2.0);
+
+    // thread-safe, may be called from worker threads
+    void Enqueue(const std::string& name, WorkPriority priority, WorkStep step, CancelStep cancel = CancelStep());
+
+    // runs queued work until the budget for this frame is used up (main thread only)
+    void RunFrame();
+
+    // drops every queued item, calling their cancel callbacks; returns how many there were (main thread only, while
+    // the GL context is alive)
+    size_t CancelAll();
+
+    void SetBudgetMs(double budgetMs)   { this->budgetMs = budgetMs; }
+    double GetBudgetMs() const          { return budgetMs; }
+    size_t GetPendingCount();
+
+    // stats
+    double GetLastFrameMs() const       { return lastFrameMs; }
+    void PrintStats(std::ostream& out);
+
+    // checks the run order (priority, then FIFO, resumed items first), the budget and CancelAll() on schedulers of its
+    // own (--self-test)
+    static bool SelfTest(std::ostream& out);
+
+private:
+    struct WorkItem
+    {
+        std::string name;
+        WorkPriority priority;
+        unsigned long long sequence;    // FIFO order within a priority
+        unsigned int framesDeferred;    // frames this item has been carried over
+        WorkStep step;
+        CancelStep cancel;
+    };
+
+    static bool RunsBefore(const WorkItem& a, const WorkItem& b);
+
+    double budgetMs;
+    std::vector<WorkItem> queue;        // kept as a heap ordered by RunsBefore()
+    std::mutex mutex;
+    unsigned long long nextSequence;
+
+    // stats
+    double lastFrameMs;                 // time spent on work in the last frame
+    unsigned long long framesRun;
+    unsigned long long framesWithWork;
+    unsigned long long framesOverBudget;
+    double totalWorkMs;
+    double totalOverrunMs;
+    double worstOverrunMs;
+    std::string worstOverrunItem;
+    unsigned long long itemsCompleted;
+    unsigned long long itemsDeferred;   // item-frames carried over to a later frame
+    unsigned long long itemsCancelled;
+    unsigned int maxFramesDeferred;
+};
+
+#endif
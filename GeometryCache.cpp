@@ -0,0 +1,397 @@
+//========================================================================================
+// Filename      : GeometryCache.cpp
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Implementation of the GeometryCache class (see GeometryCache.h)
+//               :
+//               : Cache file layout (native byte order):
+//               :    page 0      : header ("GEO1", format version, key, counts, offsets,
+//               :                  checksum), zero padded to PAGE_SIZE
+//               :    vertexOffset: floatCount floats (interleaved V/N/T), page aligned
+//               :    indexOffset : indexCount unsigned shorts, page aligned
+//========================================================================================
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include "GeometryCache.h"
+#include "Sphere.h"
+#include "Cylinder.h"
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    const char CACHE_MAGIC[4] = { 'G', 'E', 'O', '1' };
+    const uint32_t CACHE_FORMAT_VERSION = 1;
+
+    // CLN: blocks start on page boundaries so the mapped vertex data can be handed to the driver as is
+    const uint64_t PAGE_SIZE = 4096;
+
+    const uint64_t FNV_OFFSET = 14695981039346656037ull;
+    const uint64_t FNV_PRIME = 1099511628211ull;
+
+    struct CacheFileHeader
+    {
+        char magic[4];
+        uint32_t formatVersion;
+        GeometryKey key;
+        uint32_t floatCount;
+        uint32_t indexCount;
+        uint64_t vertexOffset;
+        uint64_t indexOffset;
+        uint64_t checksum;      // of the vertex and index blocks
+    };
+
+    uint64_t AlignToPage(uint64_t offset)
+    {
+        return (offset + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1);
+    }
+
+    // CLN: FNV-1a over 64-bit words (the trailing bytes one at a time), fast enough to check every load
+    uint64_t Checksum(const void* data, size_t bytes, uint64_t hash)
+    {
+        const unsigned char* p = (const unsigned char*)data;
+        size_t i = 0;
+        for (; i + 8 <= bytes; i += 8)
+        {
+            uint64_t word;
+            memcpy(&word, p + i, sizeof(word));
+            hash = (hash ^ word) * FNV_PRIME;
+        }
+        for (; i < bytes; ++i)
+            hash = (hash ^ p[i]) * FNV_PRIME;
+        return hash;
+    }
+
+    void WritePadding(std::ofstream& file, uint64_t bytes)
+    {
+        static const char zeros[PAGE_SIZE] = {};
+        file.write(zeros, (std::streamsize)bytes);
+    }
+
+    GeometryKey MakeKey(const char* type, float a, float b, float c, int sectorCount, int stackCount, bool smooth, int generatorVersion)
+    {
+        GeometryKey key;
+        memset(&key, 0, sizeof(key));   // CLN: the key is hashed and compared bytewise, so no uninitialized padding
+        strncpy(key.type, type, sizeof(key.type) - 1);
+        key.parameters[0] = a;
+        key.parameters[1] = b;
+        key.parameters[2] = c;
+        key.sectorCount = sectorCount;
+        key.stackCount = stackCount;
+        key.smooth = smooth ? 1 : 0;
+        key.generatorVersion = (uint32_t)generatorVersion;
+        return key;
+    }
+
+    std::string Describe(const GeometryKey& key)
+    {
+        std::ostringstream text;
+        text << key.type << " " << key.sectorCount << "x" << key.stackCount << (key.smooth ? "" : " flat");
+        return text.str();
+    }
+
+    double SecondsSince(std::chrono::high_resolution_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+}
+
+
+GeometryKey GeometryKey::ForSphere(float radius, int sectorCount, int stackCount, bool smooth)
+{
+    return MakeKey("sphere", radius, 0.0f, 0.0f, sectorCount, stackCount, smooth, Sphere::GENERATOR_VERSION);
+}
+
+
+GeometryKey GeometryKey::ForCylinder(float baseRadius, float topRadius, float height, int sectorCount, int stackCount, bool smooth)
+{
+    return MakeKey("cylinder", baseRadius, topRadius, height, sectorCount, stackCount, smooth, Cylinder::GENERATOR_VERSION);
+}
+
+
+GeometryCache::GeometryCache(const std::string& directory)
+    : directory(directory), hits(0), misses(0), tempCounter(0)
+{
+    if (directory.empty())
+        return;
+#ifdef _WIN32
+    _mkdir(directory.c_str());
+#else
+    mkdir(directory.c_str(), 0755);
+#endif
+}
+
+
+// CLN: the generator version is left out of the name, so a newer generator overwrites the stale file instead of
+//      leaving it behind
+std::string GeometryCache::GetFilename(const GeometryKey& key) const
+{
+    GeometryKey named = key;
+    named.generatorVersion = 0;
+
+    uint64_t hash = FNV_OFFSET;
+    const unsigned char* bytes = (const unsigned char*)&named;
+    for (size_t i = 0; i < sizeof(named); ++i)
+        hash = (hash ^ bytes[i]) * FNV_PRIME;
+
+    std::ostringstream name;
+    name << directory << "/" << key.type << "_" << std::hex << std::setw(16) << std::setfill('0') << hash << ".geo";
+    return name.str();
+}
+
+
+std::shared_ptr<CachedGeometry> GeometryCache::Load(const GeometryKey& key) const
+{
+    if (directory.empty())
+        return nullptr;
+
+    std::shared_ptr<CachedGeometry> entry = std::make_shared<CachedGeometry>();
+    if (!entry->file.Open(GetFilename(key)))
+        return nullptr;     // not cached yet
+
+    const unsigned char* data = entry->file.GetData();
+    const uint64_t size = entry->file.GetSize();
+    CacheFileHeader header;
+    if (size < sizeof(header))
+        return nullptr;
+    memcpy(&header, data, sizeof(header));
+
+    // CLN: a different key here is either a stale generator version or a file name hash collision
+    if (memcmp(header.magic, CACHE_MAGIC, sizeof(header.magic)) != 0 || header.formatVersion != CACHE_FORMAT_VERSION ||
+        memcmp(&header.key, &key, sizeof(key)) != 0)
+        return nullptr;
+
+    const uint64_t vertexBytes = (uint64_t)header.floatCount * sizeof(float);
+    const uint64_t indexBytes = (uint64_t)header.indexCount * sizeof(unsigned short);
+    if (header.vertexOffset % PAGE_SIZE != 0 || header.indexOffset % PAGE_SIZE != 0 ||
+        header.vertexOffset > size || vertexBytes > size - header.vertexOffset ||
+        header.indexOffset > size || indexBytes > size - header.indexOffset)
+        return nullptr;
+
+    const unsigned char* vertices = data + header.vertexOffset;
+    const unsigned char* indices = data + header.indexOffset;
+    if (Checksum(indices, (size_t)indexBytes, Checksum(vertices, (size_t)vertexBytes, FNV_OFFSET)) != header.checksum)
+    {
+        std::cout << "INFO: Geometry cache entry " << GetFilename(key) << " failed its checksum, regenerating" << std::endl;
+        return nullptr;
+    }
+
+    entry->vertices = (const float*)vertices;
+    entry->indices = (const unsigned short*)indices;
+    entry->floatCount = header.floatCount;
+    entry->indexCount = header.indexCount;
+    return entry;
+}
+
+
+bool GeometryCache::Store(const GeometryKey& key, const float* vertices, size_t floatCount, const unsigned short* indices, size_t indexCount)
+{
+    if (directory.empty())
+        return false;
+
+    CacheFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CACHE_MAGIC, sizeof(header.magic));
+    header.formatVersion = CACHE_FORMAT_VERSION;
+    header.key = key;
+    header.floatCount = (uint32_t)floatCount;
+    header.indexCount = (uint32_t)indexCount;
+    header.vertexOffset = PAGE_SIZE;
+    header.indexOffset = AlignToPage(header.vertexOffset + floatCount * sizeof(float));
+    header.checksum = Checksum(indices, indexCount * sizeof(unsigned short), Checksum(vertices, floatCount * sizeof(float), FNV_OFFSET));
+
+    // CLN: written under a temporary name and renamed into place, so a reader never maps a half-written file
+    const std::string filename = GetFilename(key);
+    std::ostringstream tempName;
+    tempName << filename << "." << tempCounter++ << ".tmp";
+    {
+        std::ofstream file(tempName.str(), std::ios::binary);
+        if (!file)
+        {
+            std::cout << "Failed to create geometry cache file " << tempName.str() << std::endl;
+            return false;
+        }
+        file.write((const char*)&header, sizeof(header));
+        WritePadding(file, PAGE_SIZE - sizeof(header));
+        file.write((const char*)vertices, floatCount * sizeof(float));
+        WritePadding(file, header.indexOffset - header.vertexOffset - floatCount * sizeof(float));
+        file.write((const char*)indices, indexCount * sizeof(unsigned short));
+        if (!file)
+        {
+            std::cout << "Failed to write geometry cache file " << tempName.str() << std::endl;
+            file.close();
+            std::remove(tempName.str().c_str());
+            return false;
+        }
+    }
+
+#ifdef _WIN32
+    std::remove(filename.c_str());      // CLN: rename() does not replace an existing file on Windows
+#endif
+    if (std::rename(tempName.str().c_str(), filename.c_str()) != 0)
+    {
+        std::remove(tempName.str().c_str());
+        return false;
+    }
+    return true;
+}
+
+
+std::shared_ptr<CachedGeometry> GeometryCache::LoadOrStore(const GeometryKey& key, std::vector<float>& vertices,
+                                                           std::vector<unsigned short>& indices, double generateSeconds)
+{
+    ++misses;
+    std::cout << "INFO: Geometry cache miss: " << Describe(key) << " generated in " << generateSeconds * 1000.0 << " ms" << std::endl;
+
+    // CLN: map the freshly written entry, so hits and misses upload from the same place
+    if (Store(key, vertices.data(), vertices.size(), indices.data(), indices.size()))
+    {
+        std::shared_ptr<CachedGeometry> stored = Load(key);
+        if (stored)
+            return stored;
+    }
+
+    std::shared_ptr<CachedGeometry> entry = std::make_shared<CachedGeometry>();
+    entry->ownedVertices.swap(vertices);
+    entry->ownedIndices.swap(indices);
+    entry->vertices = entry->ownedVertices.data();
+    entry->indices = entry->ownedIndices.data();
+    entry->floatCount = entry->ownedVertices.size();
+    entry->indexCount = entry->ownedIndices.size();
+    return entry;
+}
+
+
+std::shared_ptr<CachedGeometry> GeometryCache::GetSphere(float radius, int sectorCount, int stackCount, bool smooth)
+{
+    const GeometryKey key = GeometryKey::ForSphere(radius, sectorCount, stackCount, smooth);
+    std::shared_ptr<CachedGeometry> cached = Load(key);
+    if (cached)
+    {
+        ++hits;
+        return cached;
+    }
+
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+    Sphere sphere(radius, sectorCount, stackCount, smooth);
+    std::vector<float> vertices(sphere.getVertices(), sphere.getVertices() + sphere.getVertexSize() / sizeof(float));
+    std::vector<unsigned short> indices(sphere.getIndices(), sphere.getIndices() + sphere.getIndexCount());
+    return LoadOrStore(key, vertices, indices, SecondsSince(start));
+}
+
+
+std::shared_ptr<CachedGeometry> GeometryCache::GetCylinder(float baseRadius, float topRadius, float height, int sectorCount, int stackCount, bool smooth)
+{
+    const GeometryKey key = GeometryKey::ForCylinder(baseRadius, topRadius, height, sectorCount, stackCount, smooth);
+    std::shared_ptr<CachedGeometry> cached = Load(key);
+    if (cached)
+    {
+        ++hits;
+        return cached;
+    }
+
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+    Cylinder cylinder(baseRadius, topRadius, height, sectorCount, stackCount, smooth);
+    std::vector<float> vertices(cylinder.getVertices(), cylinder.getVertices() + cylinder.getVertexSize() / sizeof(float));
+    std::vector<unsigned short> indices(cylinder.getIndices(), cylinder.getIndices() + cylinder.getIndexCount());
+    return LoadOrStore(key, vertices, indices, SecondsSince(start));
+}
+
+
+bool GeometryCache::SelfTest(std::ostream& out)
+{
+    bool passed = true;
+    auto check = [&out, &passed](bool condition, const char* what) {
+        if (!condition)
+        {
+            out << "Failed geometry cache self-test: " << what << std::endl;
+            passed = false;
+        }
+    };
+    auto holds = [](const std::shared_ptr<CachedGeometry>& entry, const std::vector<float>& vertices, const std::vector<unsigned short>& indices) {
+        return entry && entry->GetVertexBytes() == vertices.size() * sizeof(float) && entry->GetIndexCount() == indices.size() &&
+               std::equal(vertices.begin(), vertices.end(), entry->GetVertices()) &&
+               std::equal(indices.begin(), indices.end(), entry->GetIndices());
+    };
+
+    const std::string directory = "geometry_cache_self_test";
+    GeometryCache cache(directory);
+    std::vector<float> vertices(8 * 700);
+    for (size_t i = 0; i < vertices.size(); ++i)
+        vertices[i] = (float)i * 0.25f;
+    std::vector<unsigned short> indices(3 * 600);
+    for (size_t i = 0; i < indices.size(); ++i)
+        indices[i] = (unsigned short)(i % 700);
+
+    // CLN: a round trip, mapped and with the vertex block on its own page
+    const GeometryKey key = GeometryKey::ForSphere(1.5f, 12, 6, true);
+    check(!cache.Load(key), "an entry was found before it was stored");
+    check(cache.Store(key, vertices.data(), vertices.size(), indices.data(), indices.size()), "an entry could not be stored");
+    std::shared_ptr<CachedGeometry> entry = cache.Load(key);
+    check(holds(entry, vertices, indices) && entry->IsMapped() && (uintptr_t)entry->GetVertices() % PAGE_SIZE == 0,
+          "a stored entry did not load back as written");
+    entry.reset();
+
+    // CLN: another key, or the same one from a newer generator, misses; storing the newer one replaces the old file
+    check(!cache.Load(GeometryKey::ForSphere(1.5f, 12, 6, false)), "a flat sphere loaded the smooth one");
+    GeometryKey newer = key;
+    ++newer.generatorVersion;
+    check(cache.GetFilename(newer) == cache.GetFilename(key) && !cache.Load(newer), "a stale generator version loaded");
+    vertices[0] = -1.0f;
+    cache.Store(newer, vertices.data(), vertices.size(), indices.data(), indices.size());
+    check(holds(cache.Load(newer), vertices, indices) && !cache.Load(key), "a newer generator version didn't replace the entry");
+
+    // CLN: a flipped data byte fails the checksum, a cut-off file the size checks
+    const std::string filename = cache.GetFilename(newer);
+    {
+        std::fstream file(filename, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp((std::streamoff)(PAGE_SIZE + 5));
+        file.put((char)0x5a);
+    }
+    check(!cache.Load(newer), "a corrupted entry loaded");
+    {
+        std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+        file.write((const char*)CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    }
+    check(!cache.Load(newer), "a truncated entry loaded");
+
+    // CLN: a miss generates and stores, the next request hits and maps the same mesh
+    std::shared_ptr<CachedGeometry> generated = cache.GetSphere(0.5f, 8, 4);
+    std::shared_ptr<CachedGeometry> mapped = cache.GetSphere(0.5f, 8, 4);
+    Sphere sphere(0.5f, 8, 4);
+    const std::vector<float> sphereVertices(sphere.getVertices(), sphere.getVertices() + sphere.getVertexSize() / sizeof(float));
+    const std::vector<unsigned short> sphereIndices(sphere.getIndices(), sphere.getIndices() + sphere.getIndexCount());
+    check(cache.GetMissCount() == 1 && cache.GetHitCount() == 1 && holds(generated, sphereVertices, sphereIndices) &&
+          holds(mapped, sphereVertices, sphereIndices) && mapped->IsMapped(), "a sphere wasn't generated once and then mapped");
+    generated.reset();
+    mapped.reset();
+
+    // CLN: without a directory nothing is stored and the generated mesh is kept in memory
+    GeometryCache disabled("");
+    std::shared_ptr<CachedGeometry> owned = disabled.GetSphere(0.5f, 8, 4);
+    check(!disabled.Store(key, vertices.data(), vertices.size(), indices.data(), indices.size()) && !disabled.Load(key) &&
+          holds(owned, sphereVertices, sphereIndices) && !owned->IsMapped(), "a disabled cache stored or lost a mesh");
+
+    std::remove(filename.c_str());
+    std::remove(cache.GetFilename(GeometryKey::ForSphere(0.5f, 8, 4, true)).c_str());
+#ifdef _WIN32
+    _rmdir(directory.c_str());
+#else
+    rmdir(directory.c_str());
+#endif
+    return passed;
+}
@@ -0,0 +1,101 @@
+//========================================================================================
+// Filename      : GeometryCache.h
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Persistent on-disk cache for the generated Sphere and Cylinder meshes.
+//               :
+//               : Each mesh is stored in its own file, named after a hash of its key
+//               : (type, parameters, smooth/flat). The header page holds the full key,
+//               : the generator version and a checksum of the data; the vertex and index
+//               : blocks start on page boundaries. Later runs memory-map the file
+//               : (MappedFile) and upload straight from the mapping instead of running
+//               : the generator again.
+//               :
+//               : Entries written by an older generator (Sphere::GENERATOR_VERSION,
+//               : Cylinder::GENERATOR_VERSION) or that fail the checksum are treated as
+//               : misses, regenerated and overwritten in place.
+//========================================================================================
+
+#ifndef GEOMETRY_CACHE_H
+#define GEOMETRY_CACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+
+// Identifies one generated mesh; all bytes take part in the file name hash and the header check
+struct GeometryKey
+{
+    char type[16];              // "sphere", "cylinder"
+    float parameters[3];        // sphere: radius; cylinder: base radius, top radius, height
+    int32_t sectorCount;
+    int32_t stackCount;
+    uint32_t smooth;
+    uint32_t generatorVersion;
+
+    static GeometryKey ForSphere(float radius, int sectorCount, int stackCount, bool smooth);
+    static GeometryKey ForCylinder(float baseRadius, float topRadius, float height, int sectorCount, int stackCount, bool smooth);
+};
+
+// A mesh from the cache. The data is either mapped from the cache file or, when the cache is disabled
+// or could not be written, held in memory; the pointers stay valid for the life of the object
+class CachedGeometry
+{
+public:
+    const float* GetVertices() const            { return vertices; }
+    const unsigned short* GetIndices() const    { return indices; }
+    size_t GetVertexBytes() const               { return floatCount * sizeof(float); }
+    size_t GetIndexBytes() const                { return indexCount * sizeof(unsigned short); }
+    size_t GetIndexCount() const                { return indexCount; }
+    bool IsMapped() const                       { return file.IsOpen(); }
+
+private:
+    friend class GeometryCache;
+
+    MappedFile file;
+    std::vector<float> ownedVertices;
+    std::vector<unsigned short> ownedIndices;
+    const float* vertices = nullptr;
+    const unsigned short* indices = nullptr;
+    size_t floatCount = 0;
+    size_t indexCount = 0;
+};
+
+class GeometryCache
+{
+public:
+    // an empty directory disables the cache, every request then runs the generator
+    explicit GeometryCache(const std::string& directory);
+
+    // Returns the mesh from the cache, generating and storing it first on a miss. Thread-safe
+    std::shared_ptr<CachedGeometry> GetSphere(float radius, int sectorCount, int stackCount, bool smooth = true);
+    std::shared_ptr<CachedGeometry> GetCylinder(float baseRadius, float topRadius, float height, int sectorCount, int stackCount, bool smooth = true);
+
+    // maps a valid entry; nullptr if it is missing, stale or corrupt
+    std::shared_ptr<CachedGeometry> Load(const GeometryKey& key) const;
+    bool Store(const GeometryKey& key, const float* vertices, size_t floatCount, const unsigned short* indices, size_t indexCount);
+
+    unsigned int GetHitCount() const    { return hits; }
+    unsigned int GetMissCount() const   { return misses; }
+
+    // stores, loads and overwrites entries in a scratch directory and checks that stale, corrupt and truncated
+    // files are misses (--self-test)
+    static bool SelfTest(std::ostream& out);
+
+private:
+    std::shared_ptr<CachedGeometry> LoadOrStore(const GeometryKey& key, std::vector<float>& vertices, std::vector<unsigned short>& indices, double generateSeconds);
+    std::string GetFilename(const GeometryKey& key) const;
+
+    std::string directory;
+    std::atomic<unsigned int> hits;
+    std::atomic<unsigned int> misses;
+    std::atomic<unsigned int> tempCounter;
+};
+
+#endif
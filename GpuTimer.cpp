@@ -0,0 +1,104 @@
+//========================================================================================
+// Filename      : GpuTimer.cpp
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Implementation of the GpuTimer class (see GpuTimer.h)
+//========================================================================================
+
+#include <iomanip>
+
+#include "GpuTimer.h"
+
+namespace
+{
+    // CLN: weight of a new result in the running average (about the last 30 frames)
+    const double AVERAGE_WEIGHT = 1.0 / 30.0;
+
+    // CLN: results above this are dropped: some drivers (Mesa llvmpipe) report the time since context creation
+    //      for the first query of a context
+    const double MAX_PLAUSIBLE_MS = 1000.0;
+}
+
+
+GpuTimer::GpuTimer(const std::string& name)
+    : name(name), next(0), active(false), averageMs(0.0), lastMs(0.0), samples(0)
+{
+    for (int i = 0; i < QUERY_COUNT; ++i)
+    {
+        queries[i] = 0;
+        pending[i] = false;
+    }
+}
+
+
+void GpuTimer::CollectResults()
+{
+    for (int i = 0; i < QUERY_COUNT; ++i)
+    {
+        if (!pending[i])
+            continue;
+        GLint available = GL_FALSE;
+        glGetQueryObjectiv(queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            continue;
+
+        GLuint64 nanoseconds = 0;
+        glGetQueryObjectui64v(queries[i], GL_QUERY_RESULT, &nanoseconds);
+        pending[i] = false;
+        if (nanoseconds / 1e6 > MAX_PLAUSIBLE_MS)
+            continue;
+
+        lastMs = nanoseconds / 1e6;
+        averageMs = samples == 0 ? lastMs : averageMs + (lastMs - averageMs) * AVERAGE_WEIGHT;
+        ++samples;
+    }
+}
+
+
+void GpuTimer::Begin()
+{
+    if (queries[0] == 0)
+        glGenQueries(QUERY_COUNT, queries);
+
+    CollectResults();
+
+    // CLN: if the GPU is more than QUERY_COUNT frames behind, skip this frame rather than wait for it
+    active = !pending[next];
+    if (active)
+        glBeginQuery(GL_TIME_ELAPSED, queries[next]);
+}
+
+
+void GpuTimer::End()
+{
+    if (!active)
+        return;
+    glEndQuery(GL_TIME_ELAPSED);
+    pending[next] = true;
+    next = (next + 1) % QUERY_COUNT;
+    active = false;
+}
+
+
+void GpuTimer::Destroy()
+{
+    if (queries[0] != 0)
+        glDeleteQueries(QUERY_COUNT, queries);
+    for (int i = 0; i < QUERY_COUNT; ++i)
+    {
+        queries[i] = 0;
+        pending[i] = false;
+    }
+}
+
+
+void GpuTimer::PrintStats(std::ostream& out) const
+{
+    const std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(3)
+        << "INFO: GPU " << name << ": " << averageMs << " ms average, " << lastMs << " ms last (" << samples << " frames)\n";
+    out.unsetf(std::ios::floatfield);
+    out.precision(precision);
+    out.flush();
+}
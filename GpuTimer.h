@@ -0,0 +1,56 @@
+//========================================================================================
+// Filename      : GpuTimer.h
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Measures how long the GPU spends on one section of the frame with
+//               : GL_TIME_ELAPSED timer queries.
+//               :
+//               : Each frame uses the next of a small ring of query objects, and a
+//               : result is only read once the GPU reports it available, so timing
+//               : never stalls the pipeline. The results arrive a few frames late and
+//               : are smoothed into a running average. GL_TIME_ELAPSED queries can't
+//               : nest, so timed sections must not overlap.
+//========================================================================================
+
+#ifndef GPU_TIMER_H
+#define GPU_TIMER_H
+
+#include <GL/glew.h>
+
+#include <ostream>
+#include <string>
+
+class GpuTimer
+{
+public:
+    static const int QUERY_COUNT = 4;   // frames in flight
+
+    explicit GpuTimer(const std::string& name);
+
+    void Begin();
+    void End();
+    void Destroy();
+
+    const std::string& GetName() const  { return name; }
+    double GetAverageMs() const         { return averageMs; }
+    double GetLastMs() const            { return lastMs; }
+    unsigned int GetSampleCount() const { return samples; }
+    void ResetAverage()                 { samples = 0; averageMs = 0.0; }
+
+    void PrintStats(std::ostream& out) const;
+
+private:
+    void CollectResults();
+
+    std::string name;
+    GLuint queries[QUERY_COUNT];
+    bool pending[QUERY_COUNT];
+    int next;
+    bool active;        // Begin() found a free query
+    double averageMs;
+    double lastMs;
+    unsigned int samples;
+};
+
+#endif
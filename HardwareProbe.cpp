@@ -0,0 +1,410 @@
+//========================================================================================
+// Filename      : HardwareProbe.cpp
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Implementation of the HardwareProbe class (see HardwareProbe.h)
+//========================================================================================
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include "HardwareProbe.h"
+
+namespace
+{
+    const char* CACHE_TAG = "HARDWAREPROBE";
+    const unsigned int CACHE_VERSION = 1;
+
+    const int FILL_PASSES = 32;             // full-screen quads of the fill test
+    const int VERTEX_TRIANGLES = 200000;    // zero-area triangles of the vertex test
+    const int VERTEX_PASSES = 2;
+    const int TEXTURE_SIZE = 1024;          // sampled texture, larger than the texture caches
+    const int TEXTURE_PASSES = 8;
+    const int TEXTURE_TAPS = 4;             // per pixel (probeTextureFragmentShaderSource)
+    const int SUBMIT_DRAWS = 2000;
+
+    // CLN: vertex buffer layout: full-screen quad, a one-pixel triangle for the submit test, then the zero-area triangles
+    const int QUAD_FIRST = 0;
+    const int TINY_FIRST = 6;
+    const int ZERO_AREA_FIRST = 9;
+
+    // CLN: runs the draws once to warm up the driver (shader compile on first use, buffer residency), then times
+    //      them from an idle GPU until it is idle again
+    template <typename Draw>
+    double TimeDrawsMs(Draw draw)
+    {
+        draw();
+        glFinish();
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        draw();
+        glFinish();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // CLN: millions per second from a count and milliseconds
+    double MillionsPerSecond(double count, double ms)
+    {
+        return ms > 0.0 ? count / (ms * 1000.0) : 0.0;
+    }
+}
+
+
+// CLN: "high" keeps the tessellation, LOD error and resolution the scene was written with
+const QualityProfile HardwareProbe::PROFILES[PROFILE_COUNT] = {
+    //  name        sphere    cylinder  LOD bias  resolution scale
+    { "low",        16,  8,   16,       4.0f,     0.5f },
+    { "medium",     24, 12,   24,       2.0f,     0.75f },
+    { "high",       36, 18,   36,       1.0f,     1.0f },
+    { "ultra",      72, 36,   72,       0.5f,     1.0f },
+};
+
+
+int HardwareProbe::FindProfile(const std::string& name)
+{
+    for (int i = 0; i < PROFILE_COUNT; ++i)
+    {
+        if (name == PROFILES[i].name)
+            return i;
+    }
+    return -1;
+}
+
+
+bool HardwareProbe::Measure(GLuint solidProgram, GLuint textureProgram, HardwareProbeResult& result)
+{
+    while (glGetError() != GL_NO_ERROR) {}  // CLN: so only errors from here on are checked below
+
+    GLuint colorTexture, framebuffer;
+    glGenTextures(1, &colorTexture);
+    glBindTexture(GL_TEXTURE_2D, colorTexture);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, TARGET_SIZE, TARGET_SIZE);
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
+    const bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+
+    // CLN: the sampled texture gets a pattern, so no driver can take a shortcut for constant data
+    std::vector<GLubyte> texels((size_t)TEXTURE_SIZE * TEXTURE_SIZE * 4);
+    for (size_t i = 0; i < texels.size(); ++i)
+        texels[i] = (GLubyte)(i * 2654435761u >> 24);
+    GLuint sampledTexture;
+    glGenTextures(1, &sampledTexture);
+    glBindTexture(GL_TEXTURE_2D, sampledTexture);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, TEXTURE_SIZE, TEXTURE_SIZE);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, TEXTURE_SIZE, TEXTURE_SIZE, GL_RGBA, GL_UNSIGNED_BYTE, texels.data());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+    const float pixel = 2.0f / TARGET_SIZE;
+    std::vector<GLfloat> positions = {
+        -1.0f, -1.0f,   1.0f, -1.0f,   1.0f,  1.0f,   -1.0f, -1.0f,   1.0f,  1.0f,   -1.0f,  1.0f,
+         0.0f,  0.0f,   pixel, 0.0f,   0.0f, pixel };
+    positions.resize(positions.size() + VERTEX_TRIANGLES * 3 * 2);
+    for (int i = 0; i < VERTEX_TRIANGLES; ++i)
+    {
+        // CLN: three copies of one point: the vertex shader runs three times, the rasterizer drops the triangle
+        const float x = -1.0f + 2.0f * (i % 997) / 997.0f;
+        const float y = -1.0f + 2.0f * (i % 991) / 991.0f;
+        for (int corner = 0; corner < 3; ++corner)
+        {
+            positions[(ZERO_AREA_FIRST + i * 3 + corner) * 2] = x;
+            positions[(ZERO_AREA_FIRST + i * 3 + corner) * 2 + 1] = y;
+        }
+    }
+
+    GLuint vao, vbo;
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+    glGenBuffers(1, &vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(GLfloat), positions.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(GLfloat), 0);
+    glEnableVertexAttribArray(0);
+
+    glViewport(0, 0, TARGET_SIZE, TARGET_SIZE);
+    glDisable(GL_DEPTH_TEST);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    glUseProgram(solidProgram);
+    const GLint offsetLocation = glGetUniformLocation(solidProgram, "offset");
+    glUniform2f(offsetLocation, 0.0f, 0.0f);
+    glUniform4f(glGetUniformLocation(solidProgram, "color"), 0.5f, 0.5f, 0.5f, 0.1f);
+
+    // CLN: fill rate, blended like the transparent and composite passes
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    const double fillMs = TimeDrawsMs([] {
+        for (int i = 0; i < FILL_PASSES; ++i)
+            glDrawArrays(GL_TRIANGLES, QUAD_FIRST, 6);
+    });
+    glDisable(GL_BLEND);
+
+    const double vertexMs = TimeDrawsMs([] {
+        for (int i = 0; i < VERTEX_PASSES; ++i)
+            glDrawArrays(GL_TRIANGLES, ZERO_AREA_FIRST, VERTEX_TRIANGLES * 3);
+    });
+
+    // CLN: CPU side only: the time the calls take to return, not the GPU time they queue
+    glFinish();
+    const std::chrono::steady_clock::time_point submitStart = std::chrono::steady_clock::now();
+    for (int i = 0; i < SUBMIT_DRAWS; ++i)
+    {
+        glUniform2f(offsetLocation, (i % 64) * pixel, (i / 64 % 64) * pixel);
+        glDrawArrays(GL_TRIANGLES, TINY_FIRST, 3);
+    }
+    const double submitMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - submitStart).count();
+    glFinish();
+
+    glUseProgram(textureProgram);
+    glUniform1i(glGetUniformLocation(textureProgram, "probeTexture"), 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, sampledTexture);
+    const double textureMs = TimeDrawsMs([] {
+        for (int i = 0; i < TEXTURE_PASSES; ++i)
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+    });
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glUseProgram(0);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glEnable(GL_DEPTH_TEST);
+    glDeleteBuffers(1, &vbo);
+    glDeleteVertexArrays(1, &vao);
+    glDeleteFramebuffers(1, &framebuffer);
+    glDeleteTextures(1, &colorTexture);
+    glDeleteTextures(1, &sampledTexture);
+
+    if (!complete || glGetError() != GL_NO_ERROR)
+    {
+        std::cout << "Failed to run the hardware probe" << std::endl;
+        return false;
+    }
+
+    const double targetPixels = (double)TARGET_SIZE * TARGET_SIZE;
+    result.fillMPixelsPerSecond = MillionsPerSecond(targetPixels * FILL_PASSES, fillMs);
+    result.vertexMVerticesPerSecond = MillionsPerSecond(VERTEX_TRIANGLES * 3.0 * VERTEX_PASSES, vertexMs);
+    result.textureMTexelsPerSecond = MillionsPerSecond(targetPixels * TEXTURE_PASSES * TEXTURE_TAPS, textureMs);
+    result.submitMicrosecondsPerDraw = submitMs * 1000.0 / SUBMIT_DRAWS;
+    return true;
+}
+
+
+double HardwareProbe::EstimateFrameMs(const HardwareProbeResult& result, const FrameWorkload& workload)
+{
+    if (result.fillMPixelsPerSecond <= 0.0 || result.vertexMVerticesPerSecond <= 0.0 || result.textureMTexelsPerSecond <= 0.0)
+        return 0.0;
+
+    // CLN: the stages overlap on a real GPU, so their sum is an upper bound that keeps the choice on the safe side
+    return workload.pixelsShaded / (result.fillMPixelsPerSecond * 1000.0)
+         + workload.texelsFetched / (result.textureMTexelsPerSecond * 1000.0)
+         + workload.vertices / (result.vertexMVerticesPerSecond * 1000.0)
+         + workload.drawCalls * result.submitMicrosecondsPerDraw / 1000.0;
+}
+
+
+// CLN: the plane and objects overlap about 1.5 deep, plus the transparent pass, OIT composite and the copy to the window
+FrameWorkload HardwareProbe::EstimateWorkload(const QualityProfile& profile, int width, int height)
+{
+    const double pixels = (double)width * height * profile.resolutionScale * profile.resolutionScale;
+    const double sphereVertices = (profile.sphereSectors + 1.0) * (profile.sphereStacks + 1.0);
+    const double cylinderVertices = (profile.cylinderSectors + 1.0) * 6.0;
+    const double otherVertices = 200.0;     // plane, tri-case, logo and the three cubes, after welding
+
+    FrameWorkload workload;
+    workload.pixelsShaded = pixels * 3.0;
+    workload.texelsFetched = pixels * 1.5;  // one texture tap per opaque scene fragment
+    workload.vertices = sphereVertices + cylinderVertices + otherVertices;
+    workload.drawCalls = 12.0;
+    return workload;
+}
+
+
+int HardwareProbe::SelectProfile(const HardwareProbeResult& result, int width, int height, double targetFrameMs, double& frameMs)
+{
+    // CLN: a result without rates (a damaged cache line) estimates every frame at 0 ms, which would pick the best one
+    frameMs = 0.0;
+    if (result.fillMPixelsPerSecond <= 0.0 || result.vertexMVerticesPerSecond <= 0.0 || result.textureMTexelsPerSecond <= 0.0)
+        return DEFAULT_PROFILE;
+
+    // CLN: best first; the lowest profile is the last resort even if it doesn't fit
+    int profile = PROFILE_COUNT - 1;
+    for (; profile >= 0; --profile)
+    {
+        frameMs = EstimateFrameMs(result, EstimateWorkload(PROFILES[profile], width, height));
+        if (frameMs <= targetFrameMs || profile == 0)
+            break;
+    }
+    return profile;
+}
+
+
+bool HardwareProbe::LoadCached(const std::string& filename, const std::string& renderer, HardwareProbeResult& result)
+{
+    std::ifstream file(filename.c_str());
+    std::string tag;
+    unsigned int version = 0;
+    if (!file || !(file >> tag >> version) || tag != CACHE_TAG || version != CACHE_VERSION)
+        return false;
+
+    // CLN: one line per renderer: its GL_RENDERER string, a tab, then the four rates
+    std::string line;
+    while (std::getline(file, line))
+    {
+        const size_t tab = line.find('\t');
+        if (tab == std::string::npos || line.compare(0, tab, renderer) != 0 || tab != renderer.size())
+            continue;
+
+        std::istringstream values(line.substr(tab + 1));
+        HardwareProbeResult cached;
+        if (values >> cached.fillMPixelsPerSecond >> cached.vertexMVerticesPerSecond >> cached.textureMTexelsPerSecond >> cached.submitMicrosecondsPerDraw)
+        {
+            result = cached;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+bool HardwareProbe::SaveCached(const std::string& filename, const std::string& renderer, const HardwareProbeResult& result)
+{
+    // CLN: keep the entries of the other renderers (e.g. both GPUs of a laptop)
+    std::vector<std::string> lines;
+    {
+        std::ifstream file(filename.c_str());
+        std::string tag;
+        unsigned int version = 0;
+        if (file && (file >> tag >> version) && tag == CACHE_TAG && version == CACHE_VERSION)
+        {
+            std::string line;
+            while (std::getline(file, line))
+            {
+                if (!line.empty() && line.compare(0, renderer.size() + 1, renderer + "\t") != 0)
+                    lines.push_back(line);
+            }
+        }
+    }
+
+    std::ofstream file(filename.c_str());
+    if (!file)
+    {
+        std::cout << "Failed to write the hardware probe cache " << filename << std::endl;
+        return false;
+    }
+
+    file << CACHE_TAG << " " << CACHE_VERSION << "\n";
+    for (const std::string& line : lines)
+        file << line << "\n";
+    file << renderer << "\t" << result.fillMPixelsPerSecond << " " << result.vertexMVerticesPerSecond << " "
+         << result.textureMTexelsPerSecond << " " << result.submitMicrosecondsPerDraw << "\n";
+    return (bool)file;
+}
+
+
+void HardwareProbe::PrintResult(const HardwareProbeResult& result, std::ostream& out)
+{
+    const std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(1)
+        << "INFO: Hardware probe: " << result.fillMPixelsPerSecond << " Mpixels/s fill, "
+        << result.vertexMVerticesPerSecond << " Mvertices/s, " << result.textureMTexelsPerSecond << " Mtexels/s, "
+        << std::setprecision(2) << result.submitMicrosecondsPerDraw << " us per draw call\n";
+    out.unsetf(std::ios::floatfield);
+    out.precision(precision);
+    out.flush();
+}
+
+
+bool HardwareProbe::SelfTest(std::ostream& out)
+{
+    bool passed = true;
+    auto check = [&out, &passed](bool condition, const char* what) {
+        if (!condition)
+        {
+            out << "Failed hardware probe self-test: " << what << std::endl;
+            passed = false;
+        }
+    };
+
+    // CLN: the profiles are found by name, and each one asks at least as much of the hardware as the one below
+    for (int i = 0; i < PROFILE_COUNT; ++i)
+        check(FindProfile(PROFILES[i].name) == i, "a profile isn't found by its name");
+    check(FindProfile("") == -1 && FindProfile("extreme") == -1 && FindProfile("High") == -1, "an unknown name found a profile");
+    check(strcmp(PROFILES[DEFAULT_PROFILE].name, "high") == 0, "the default profile isn't \"high\"");
+    for (int i = 1; i < PROFILE_COUNT; ++i)
+    {
+        const QualityProfile& lower = PROFILES[i - 1];
+        const QualityProfile& profile = PROFILES[i];
+        check(profile.sphereSectors >= lower.sphereSectors && profile.sphereStacks >= lower.sphereStacks
+              && profile.cylinderSectors >= lower.cylinderSectors, "a profile tessellates less than the one below");
+        check(profile.lodBias <= lower.lodBias && profile.resolutionScale >= lower.resolutionScale,
+              "a profile has a higher LOD bias or a lower resolution than the one below");
+    }
+
+    // CLN: 2M pixels at 1000 Mpixels/s, 1M texels at 500 Mtexels/s, 100K vertices at 100 Mvertices/s and 100 draws
+    //      of 10 us take 2 + 2 + 1 + 1 ms; a result without rates estimates nothing
+    HardwareProbeResult reference;
+    reference.fillMPixelsPerSecond = 1000.0;
+    reference.vertexMVerticesPerSecond = 100.0;
+    reference.textureMTexelsPerSecond = 500.0;
+    reference.submitMicrosecondsPerDraw = 10.0;
+    FrameWorkload workload;
+    workload.pixelsShaded = 2e6;
+    workload.texelsFetched = 1e6;
+    workload.vertices = 1e5;
+    workload.drawCalls = 100.0;
+    check(fabs(EstimateFrameMs(reference, workload) - 6.0) < 1e-9, "the frame estimate is not the sum of the stages");
+    check(EstimateFrameMs(HardwareProbeResult(), workload) == 0.0, "a result without rates estimated a frame");
+
+    // CLN: every profile costs more than the one below, at any window size, or some could never be chosen
+    const int sizes[3][2] = { { 640, 480 }, { 1920, 1080 }, { 3840, 2160 } };
+    double frameMs[PROFILE_COUNT];
+    for (const int* size : sizes)
+    {
+        for (int i = 0; i < PROFILE_COUNT; ++i)
+            frameMs[i] = EstimateFrameMs(reference, EstimateWorkload(PROFILES[i], size[0], size[1]));
+        for (int i = 1; i < PROFILE_COUNT; ++i)
+            check(frameMs[i] > frameMs[i - 1], "a profile is estimated cheaper than the one below");
+    }
+
+    // CLN: at 1920 x 1080, a target exactly at a profile's estimate picks it, one between it and the estimate of the
+    //      profile below picks that one, and the estimate returned is that of the choice
+    for (int i = 0; i < PROFILE_COUNT; ++i)
+        frameMs[i] = EstimateFrameMs(reference, EstimateWorkload(PROFILES[i], 1920, 1080));
+    double chosenMs = -1.0;
+    for (int i = 0; i < PROFILE_COUNT; ++i)
+    {
+        check(SelectProfile(reference, 1920, 1080, frameMs[i], chosenMs) == i && chosenMs == frameMs[i],
+              "a target equal to a profile's estimate didn't pick it");
+        if (i > 0)
+        {
+            const double between = (frameMs[i - 1] + frameMs[i]) * 0.5;
+            check(SelectProfile(reference, 1920, 1080, between, chosenMs) == i - 1 && chosenMs == frameMs[i - 1],
+                  "a target under a profile's estimate didn't pick the one below");
+        }
+    }
+    check(SelectProfile(reference, 1920, 1080, 1e9, chosenMs) == PROFILE_COUNT - 1, "an unlimited target didn't pick the best profile");
+    check(SelectProfile(reference, 1920, 1080, frameMs[0] * 0.5, chosenMs) == 0 && chosenMs == frameMs[0],
+          "a target nothing fits didn't fall back to the lowest profile");
+
+    // CLN: a smaller window fits a profile at least as high, and a result without rates keeps the default
+    for (int i = 0; i < PROFILE_COUNT; ++i)
+    {
+        check(SelectProfile(reference, 640, 480, frameMs[i], chosenMs) >= SelectProfile(reference, 1920, 1080, frameMs[i], chosenMs),
+              "a smaller window picked a lower profile");
+    }
+    check(SelectProfile(HardwareProbeResult(), 1920, 1080, 16.7, chosenMs) == DEFAULT_PROFILE && chosenMs == 0.0,
+          "a result without rates didn't keep the default profile");
+
+    return passed;
+}
@@ -0,0 +1,91 @@
+//========================================================================================
+// Filename      : HardwareProbe.h
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Startup benchmark of the GPU and driver, used to pick the quality
+//               : profile (tessellation, LOD bias, resolution scale) instead of one
+//               : hard-coded setting for every machine.
+//               :
+//               : Measure() draws four micro-scenes into an offscreen framebuffer and
+//               : times each with glFinish() and the wall clock (timer queries are not
+//               : trustworthy on every driver, software rasterizers especially):
+//               :    fill rate          : blended full-screen quads
+//               :    vertex throughput  : zero-area triangles (vertex work only, nothing rasterized)
+//               :    texture bandwidth  : full-screen passes of spread out texture taps
+//               :    CPU submit cost    : one-triangle draws with a uniform change each
+//               : EstimateFrameMs() turns the rates into the cost of a frame's workload,
+//               : and SelectProfile() chooses the best profile whose frame fits the
+//               : target time.
+//               :
+//               : The results are cached per GL_RENDERER string in a small text file,
+//               : so the probe only runs the first time a GPU is seen.
+//========================================================================================
+
+#ifndef HARDWARE_PROBE_H
+#define HARDWARE_PROBE_H
+
+#include <GL/glew.h>
+
+#include <ostream>
+#include <string>
+
+struct HardwareProbeResult
+{
+    double fillMPixelsPerSecond = 0.0;
+    double vertexMVerticesPerSecond = 0.0;
+    double textureMTexelsPerSecond = 0.0;
+    double submitMicrosecondsPerDraw = 0.0;
+};
+
+// the work of one frame, in the units the probe measures
+struct FrameWorkload
+{
+    double pixelsShaded = 0.0;      // fragments, overdraw and full-screen passes included
+    double texelsFetched = 0.0;
+    double vertices = 0.0;
+    double drawCalls = 0.0;
+};
+
+struct QualityProfile
+{
+    const char* name;
+    int sphereSectors;
+    int sphereStacks;
+    int cylinderSectors;
+    float lodBias;              // multiplies --lod-pixel-error: above 1 the simplified meshes are used sooner
+    float resolutionScale;      // scene framebuffer size relative to the window
+};
+
+class HardwareProbe
+{
+public:
+    static const int PROFILE_COUNT = 4;
+    static const QualityProfile PROFILES[PROFILE_COUNT];    // lowest first
+    static const int DEFAULT_PROFILE = 2;                   // "high", the settings the scene was authored with
+    static const int TARGET_SIZE = 512;                     // offscreen framebuffer of the micro-scenes
+
+    static int FindProfile(const std::string& name);        // -1 if there is none by that name
+
+    // solidProgram is probeVertexShaderSource with probeSolidFragmentShaderSource, textureProgram a full-screen
+    // triangle with probeTextureFragmentShaderSource (see main). Needs the GL context; a fraction of a second on a GPU
+    static bool Measure(GLuint solidProgram, GLuint textureProgram, HardwareProbeResult& result);
+    static double EstimateFrameMs(const HardwareProbeResult& result, const FrameWorkload& workload);
+
+    // rough per-frame work of the 3D scene with a profile, in a window of width x height
+    static FrameWorkload EstimateWorkload(const QualityProfile& profile, int width, int height);
+    // index of the best profile whose estimated frame fits targetFrameMs; the lowest if none does, DEFAULT_PROFILE
+    // if the result has no rates. frameMs is the estimate of the profile chosen
+    static int SelectProfile(const HardwareProbeResult& result, int width, int height, double targetFrameMs, double& frameMs);
+
+    static bool LoadCached(const std::string& filename, const std::string& renderer, HardwareProbeResult& result);
+    static bool SaveCached(const std::string& filename, const std::string& renderer, const HardwareProbeResult& result);
+
+    static void PrintResult(const HardwareProbeResult& result, std::ostream& out);
+
+    // checks the profile table, FindProfile(), EstimateFrameMs() and where SelectProfile() switches from one profile
+    // to the next, with made-up probe results (--self-test)
+    static bool SelfTest(std::ostream& out);
+};
+
+#endif
@@ -0,0 +1,735 @@
+//========================================================================================
+// Filename      : HlodTree.cpp
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Implementation of the HlodTree class (see HlodTree.h)
+//========================================================================================
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <unordered_map>
+
+#include "HlodTree.h"
+#include "MeshSimplifier.h"
+#include "WorkerPool.h"
+
+namespace
+{
+    // CLN: of the atlas tile, on every side; the tile's mipmaps stay clear of its neighbours down to 1/16 size
+    const int TILE_GUTTER_DIVISOR = 16;
+    const int ATLAS_MIP_LEVELS = 5;
+
+    float Length3(const float* v)
+    {
+        return sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    }
+
+    unsigned int FindRoot(std::vector<unsigned int>& parent, unsigned int v)
+    {
+        while (parent[v] != v)
+            v = parent[v] = parent[parent[v]];
+        return v;
+    }
+
+    // CLN: removes the connected parts (vertices joined by triangles or by sharing a position) whose bounding box
+    //      diagonal is at most minSize, and the vertices left unused; returns the largest diagonal removed. Edge
+    //      collapses can't make a small closed object vanish without flipping its triangles, so this is what lets
+    //      the proxies of large regions shed the props that are too small to see at their distance
+    float RemoveSmallParts(MeshData& mesh, float minSize)
+    {
+        const unsigned int stride = MeshData::FLOATS_PER_VERTEX;
+        const unsigned int vertexCount = mesh.GetVertexCount();
+        std::vector<unsigned int> parent(vertexCount);
+        for (unsigned int v = 0; v < vertexCount; ++v)
+            parent[v] = v;
+
+        std::unordered_map<uint64_t, unsigned int> firstAt;
+        firstAt.reserve(vertexCount);
+        for (unsigned int v = 0; v < vertexCount; ++v)
+        {
+            // CLN: (a hash of the position bits; a collision only joins two parts, which keeps both)
+            uint32_t bits[3];
+            memcpy(bits, &mesh.vertices[v * stride], sizeof(bits));
+            const uint64_t key = ((uint64_t)bits[0] * 0x9E3779B97F4A7C15ull) ^ ((uint64_t)bits[1] << 21) ^ ((uint64_t)bits[2] * 0xC2B2AE3D27D4EB4Full);
+            const unsigned int first = firstAt.insert(std::make_pair(key, v)).first->second;
+            parent[FindRoot(parent, v)] = FindRoot(parent, first);
+        }
+        for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+        {
+            parent[FindRoot(parent, mesh.indices[i + 1])] = FindRoot(parent, mesh.indices[i]);
+            parent[FindRoot(parent, mesh.indices[i + 2])] = FindRoot(parent, mesh.indices[i]);
+        }
+
+        std::vector<float> bounds(vertexCount * 6);
+        for (unsigned int v = 0; v < vertexCount; ++v)
+        {
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                bounds[v * 6 + axis] = FLT_MAX;
+                bounds[v * 6 + 3 + axis] = -FLT_MAX;
+            }
+        }
+        for (unsigned int v = 0; v < vertexCount; ++v)
+        {
+            const unsigned int root = FindRoot(parent, v);
+            const float* position = &mesh.vertices[v * stride];
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                bounds[root * 6 + axis] = std::min(bounds[root * 6 + axis], position[axis]);
+                bounds[root * 6 + 3 + axis] = std::max(bounds[root * 6 + 3 + axis], position[axis]);
+            }
+        }
+
+        float removed = 0.0f;
+        std::vector<unsigned int> newIndex(vertexCount, ~0u);
+        std::vector<unsigned char> small(vertexCount, 0);
+        for (unsigned int v = 0; v < vertexCount; ++v)
+        {
+            if (parent[v] != v)
+                continue;
+            const float diagonal[3] = { bounds[v * 6 + 3] - bounds[v * 6], bounds[v * 6 + 4] - bounds[v * 6 + 1], bounds[v * 6 + 5] - bounds[v * 6 + 2] };
+            const float size = Length3(diagonal);
+            if (size <= minSize)
+            {
+                small[v] = 1;
+                removed = std::max(removed, size);
+            }
+        }
+
+        MeshData kept;
+        for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+        {
+            if (small[FindRoot(parent, mesh.indices[i])])
+                continue;
+            for (int k = 0; k < 3; ++k)
+            {
+                const unsigned int v = mesh.indices[i + k];
+                if (newIndex[v] == ~0u)
+                {
+                    newIndex[v] = kept.GetVertexCount();
+                    kept.vertices.insert(kept.vertices.end(), mesh.vertices.begin() + v * stride, mesh.vertices.begin() + (v + 1) * stride);
+                }
+                kept.indices.push_back((unsigned short)newIndex[v]);
+            }
+        }
+        mesh = std::move(kept);
+        return removed;
+    }
+}
+
+
+HlodTree::HlodTree()
+    : textureCount(0), atlasColumns(1), enabled(false), atlas(0), selectedObjects(0), buildMs(0.0), threads(0), sourceTriangles(0)
+{
+}
+
+
+bool HlodTree::Build(const std::vector<StressObject>& objects, const std::vector<MeshData>& meshes, int textureCount,
+                     const HlodSettings& settings, WorkerPool& pool)
+{
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    this->settings = settings;
+    this->settings.leafObjects = std::max(this->settings.leafObjects, 1u);
+    this->textureCount = std::max(textureCount, 1);
+    atlasColumns = (int)ceil(sqrt((double)this->textureCount));
+    nodes.clear();
+    levels.clear();
+    if (objects.empty() || meshes.size() < STRESS_PRIMITIVE_COUNT)
+        return false;
+
+    objectOrder.resize(objects.size());
+    for (size_t i = 0; i < objects.size(); ++i)
+        objectOrder[i] = (unsigned int)i;
+    nodes.reserve(objects.size() / this->settings.leafObjects * 2 + 1);
+    BuildNodes(objects, meshes, 0, (unsigned int)objects.size(), 0);
+
+    sourceTriangles = 0;
+    for (const StressObject& object : objects)
+        sourceTriangles += meshes[object.primitive].GetTriangleCount();
+
+    // CLN: the deepest level first, each level's nodes in parallel; a node only needs its children's proxies
+    threads = 0;
+    for (size_t level = levels.size(); level > 0; --level)
+    {
+        const std::vector<int>& levelNodes = levels[level - 1];
+        threads = std::max(threads, pool.ParallelFor(levelNodes.size(), [&](size_t i) {
+            HlodNode& node = nodes[levelNodes[i]];
+            if (node.children[0] < 0)
+                BuildLeafProxy(node, objects, meshes);
+            else
+                BuildInnerProxy(node);
+        }));
+    }
+
+    buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+
+int HlodTree::BuildNodes(const std::vector<StressObject>& objects, const std::vector<MeshData>& meshes, unsigned int first,
+                         unsigned int count, int depth)
+{
+    const int index = (int)nodes.size();
+    nodes.push_back(HlodNode());
+    if ((int)levels.size() <= depth)
+        levels.resize(depth + 1);
+    levels[depth].push_back(index);
+
+    // CLN: the bounding box of the object centers picks the split axis; the bounding sphere encloses the objects' own
+    float low[3] = { FLT_MAX, FLT_MAX, FLT_MAX }, high[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    size_t vertices = 0;
+    std::vector<unsigned int> lightUses;
+    for (unsigned int i = first; i < first + count; ++i)
+    {
+        const StressObject& object = objects[objectOrder[i]];
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            low[axis] = std::min(low[axis], object.model[12 + axis] - object.radius);
+            high[axis] = std::max(high[axis], object.model[12 + axis] + object.radius);
+        }
+        vertices += meshes[object.primitive].GetVertexCount();
+        if (lightUses.size() <= object.light)
+            lightUses.resize(object.light + 1, 0);
+        ++lightUses[object.light];
+    }
+
+    HlodNode& node = nodes[index];
+    float radius = 0.0f;
+    for (int axis = 0; axis < 3; ++axis)
+        node.center[axis] = (low[axis] + high[axis]) * 0.5f;
+    for (unsigned int i = first; i < first + count; ++i)
+    {
+        const StressObject& object = objects[objectOrder[i]];
+        const float offset[3] = { object.model[12] - node.center[0], object.model[13] - node.center[1], object.model[14] - node.center[2] };
+        radius = std::max(radius, Length3(offset) + object.radius);
+    }
+    node.radius = radius;
+    node.error = -1.0f;
+    node.children[0] = node.children[1] = -1;
+    node.firstObject = first;
+    node.objectCount = count;
+    node.light = (unsigned short)(std::max_element(lightUses.begin(), lightUses.end()) - lightUses.begin());
+    node.proxyTriangles = 0;
+    node.vao = 0;
+    node.vbos[0] = node.vbos[1] = 0;
+
+    // CLN: a leaf has to merge into one mesh of 16-bit indices as well
+    if (count <= 1 || (count <= settings.leafObjects && vertices < MeshData::MAX_VERTICES))
+        return index;
+
+    int axis = 0;
+    for (int i = 1; i < 3; ++i)
+    {
+        if (high[i] - low[i] > high[axis] - low[axis])
+            axis = i;
+    }
+    const unsigned int half = count / 2;
+    std::nth_element(objectOrder.begin() + first, objectOrder.begin() + first + half, objectOrder.begin() + first + count,
+                     [&objects, axis](unsigned int a, unsigned int b) { return objects[a].model[12 + axis] < objects[b].model[12 + axis]; });
+
+    // CLN: (nodes may move while the children are added, so the node is looked up again)
+    const int left = BuildNodes(objects, meshes, first, half, depth + 1);
+    const int right = BuildNodes(objects, meshes, first + half, count - half, depth + 1);
+    nodes[index].children[0] = left;
+    nodes[index].children[1] = right;
+    return index;
+}
+
+
+// CLN: the leaf's objects in world space (relative to the node center), each one's texture coordinates moved into
+//      its texture's tile
+void HlodTree::BuildLeafProxy(HlodNode& node, const std::vector<StressObject>& objects, const std::vector<MeshData>& meshes)
+{
+    const unsigned int stride = MeshData::FLOATS_PER_VERTEX;
+    MeshData merged;
+    for (unsigned int i = node.firstObject; i < node.firstObject + node.objectCount; ++i)
+    {
+        const StressObject& object = objects[objectOrder[i]];
+        const MeshData& mesh = meshes[object.primitive];
+        const float* m = object.model;
+        float tile[4];
+        GetTileRect(object.texture, tile);
+
+        // CLN: normals go through the transposed adjugate (the inverse transpose up to the determinant, whose sign is kept)
+        const float adjugate[9] = {
+            m[5] * m[10] - m[6] * m[9], m[6] * m[8] - m[4] * m[10], m[4] * m[9] - m[5] * m[8],
+            m[9] * m[2] - m[10] * m[1], m[10] * m[0] - m[8] * m[2], m[8] * m[1] - m[9] * m[0],
+            m[1] * m[6] - m[2] * m[5], m[2] * m[4] - m[0] * m[6], m[0] * m[5] - m[1] * m[4] };
+        const float determinant = m[0] * adjugate[0] + m[1] * adjugate[1] + m[2] * adjugate[2];
+        const float sign = determinant < 0.0f ? -1.0f : 1.0f;
+
+        const unsigned short base = (unsigned short)merged.GetVertexCount();
+        for (unsigned int v = 0; v < mesh.GetVertexCount(); ++v)
+        {
+            const float* in = &mesh.vertices[v * stride];
+            float out[MeshData::FLOATS_PER_VERTEX];
+            for (int row = 0; row < 3; ++row)
+                out[row] = m[row] * in[0] + m[4 + row] * in[1] + m[8 + row] * in[2] + m[12 + row] - node.center[row];
+            for (int row = 0; row < 3; ++row)
+                out[3 + row] = sign * (adjugate[row] * in[3] + adjugate[3 + row] * in[4] + adjugate[6 + row] * in[5]);
+            const float length = Length3(out + 3);
+            for (int row = 0; row < 3; ++row)
+                out[3 + row] = length > 0.0f ? out[3 + row] / length : 0.0f;
+            out[6] = tile[0] + std::min(std::max(in[6], 0.0f), 1.0f) * (tile[2] - tile[0]);
+            out[7] = tile[1] + std::min(std::max(in[7], 0.0f), 1.0f) * (tile[3] - tile[1]);
+            merged.vertices.insert(merged.vertices.end(), out, out + stride);
+        }
+        // CLN: triangles that index past the mesh's vertices are dropped, as the GPU would (the smooth Cylinder
+        //      keeps positions only in its vertex array, so its higher indices have nothing behind them)
+        const unsigned int meshVertices = mesh.GetVertexCount();
+        for (size_t t = 0; t + 2 < mesh.indices.size(); t += 3)
+        {
+            if (mesh.indices[t] >= meshVertices || mesh.indices[t + 1] >= meshVertices || mesh.indices[t + 2] >= meshVertices)
+                continue;
+            for (int k = 0; k < 3; ++k)
+                merged.indices.push_back((unsigned short)(base + mesh.indices[t + k]));
+        }
+    }
+    SimplifyProxy(node, merged, 0.0f);
+}
+
+
+// CLN: the children's proxies side by side, simplified again; their errors carry over
+void HlodTree::BuildInnerProxy(HlodNode& node)
+{
+    const HlodNode& left = nodes[node.children[0]];
+    const HlodNode& right = nodes[node.children[1]];
+    if (left.error < 0.0f || right.error < 0.0f ||
+        left.proxy.GetVertexCount() + right.proxy.GetVertexCount() >= MeshData::MAX_VERTICES)
+        return;     // CLN: no proxy; the children are always drawn instead
+
+    const unsigned int stride = MeshData::FLOATS_PER_VERTEX;
+    MeshData merged;
+    for (const HlodNode* child : { &left, &right })
+    {
+        const unsigned short base = (unsigned short)merged.GetVertexCount();
+        const size_t firstFloat = merged.vertices.size();
+        merged.vertices.insert(merged.vertices.end(), child->proxy.vertices.begin(), child->proxy.vertices.end());
+        for (size_t i = firstFloat; i < merged.vertices.size(); i += stride)
+        {
+            for (int axis = 0; axis < 3; ++axis)
+                merged.vertices[i + axis] += child->center[axis] - node.center[axis];
+        }
+        for (unsigned short index : child->proxy.indices)
+            merged.indices.push_back((unsigned short)(base + index));
+    }
+    SimplifyProxy(node, merged, std::max(left.error, right.error));
+}
+
+
+// CLN: the error of a proxy is its children's plus the larger of what it dropped and what the simplifier moved
+void HlodTree::SimplifyProxy(HlodNode& node, MeshData& merged, float childError)
+{
+    const float extent = MeshSimplifier::GetExtent(merged);
+    float error = RemoveSmallParts(merged, settings.maxError * extent);
+    if (merged.GetTriangleCount() <= settings.proxyTriangles)
+        node.proxy = std::move(merged);
+    else
+        error = std::max(error, MeshSimplifier::Simplify(merged, settings.proxyTriangles, settings.maxError, node.proxy) * extent);
+    node.error = childError + error;
+    node.proxyTriangles = node.proxy.GetTriangleCount();
+}
+
+
+// CLN: texture coordinate rectangle (u0, v0, u1, v1) of a texture's tile in the atlas, inside its gutter
+void HlodTree::GetTileRect(int texture, float* rect) const
+{
+    const int rows = (textureCount + atlasColumns - 1) / atlasColumns;
+    const int column = texture % atlasColumns;
+    const int row = std::min(texture / atlasColumns, rows - 1);
+    const float gutter = 1.0f / TILE_GUTTER_DIVISOR;
+    rect[0] = (column + gutter) / atlasColumns;
+    rect[1] = (row + gutter) / rows;
+    rect[2] = (column + 1 - gutter) / atlasColumns;
+    rect[3] = (row + 1 - gutter) / rows;
+}
+
+
+bool HlodTree::CreateProxies(const std::vector<GLuint>& textures)
+{
+    if (nodes.empty())
+        return false;
+
+    // CLN: each texture is copied stretched over its whole tile first, then over the inside of its gutter, so the
+    //      gutter repeats the texture's edges (from the source mip level nearest the tile size)
+    const int tileSize = settings.atlasTileSize;
+    const int rows = (textureCount + atlasColumns - 1) / atlasColumns;
+    glGenTextures(1, &atlas);
+    glBindTexture(GL_TEXTURE_2D, atlas);
+    glTexStorage2D(GL_TEXTURE_2D, ATLAS_MIP_LEVELS, GL_RGBA8, atlasColumns * tileSize, rows * tileSize);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    GLuint framebuffers[2];
+    glGenFramebuffers(2, framebuffers);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffers[1]);
+    glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, atlas, 0);
+    const GLfloat clear[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+    glClearBufferfv(GL_COLOR, 0, clear);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffers[0]);
+    const int gutter = tileSize / TILE_GUTTER_DIVISOR;
+    for (int texture = 0; texture < textureCount && texture < (int)textures.size(); ++texture)
+    {
+        GLint width = 0, height = 0, level = 0;
+        glBindTexture(GL_TEXTURE_2D, textures[texture]);
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width);
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height);
+        while ((width >> (level + 1)) >= tileSize && (height >> (level + 1)) >= tileSize)
+            ++level;
+        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, textures[texture], level);
+        if (width == 0 || glCheckFramebufferStatus(GL_READ_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            continue;
+
+        const int x = (texture % atlasColumns) * tileSize;
+        const int y = (texture / atlasColumns) * tileSize;
+        const int sourceWidth = std::max(width >> level, 1), sourceHeight = std::max(height >> level, 1);
+        glBlitFramebuffer(0, 0, sourceWidth, sourceHeight, x, y, x + tileSize, y + tileSize, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+        glBlitFramebuffer(0, 0, sourceWidth, sourceHeight, x + gutter, y + gutter, x + tileSize - gutter, y + tileSize - gutter,
+                          GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteFramebuffers(2, framebuffers);
+    glBindTexture(GL_TEXTURE_2D, atlas);
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    // CLN: the proxies in the scene's vertex layout (see GLObject::SetVertexLayout()), their CPU copies freed
+    const GLsizei stride = MeshData::FLOATS_PER_VERTEX * sizeof(float);
+    for (HlodNode& node : nodes)
+    {
+        if (node.error < 0.0f)
+            continue;
+        glGenVertexArrays(1, &node.vao);
+        glBindVertexArray(node.vao);
+        glGenBuffers(2, node.vbos);
+        glBindBuffer(GL_ARRAY_BUFFER, node.vbos[0]);
+        glBufferData(GL_ARRAY_BUFFER, node.proxy.GetVertexBytes(), node.proxy.vertices.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, node.vbos[1]);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, node.proxy.GetIndexBytes(), node.proxy.indices.data(), GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, 0);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(float) * 3));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(float) * 6));
+        glEnableVertexAttribArray(2);
+        glBindVertexArray(0);
+        std::vector<float>().swap(node.proxy.vertices);
+        std::vector<unsigned short>().swap(node.proxy.indices);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    if (glGetError() != GL_NO_ERROR)
+    {
+        std::cout << "Failed to create the HLOD proxies" << std::endl;
+        Destroy();
+        return false;
+    }
+    return true;
+}
+
+
+void HlodTree::Destroy()
+{
+    for (HlodNode& node : nodes)
+    {
+        glDeleteBuffers(2, node.vbos);
+        glDeleteVertexArrays(1, &node.vao);
+    }
+    nodes.clear();
+    levels.clear();
+    glDeleteTextures(1, &atlas);
+    atlas = 0;
+    enabled = false;
+}
+
+
+void HlodTree::Select(const float* cameraPosition, float pixelsPerUnit, float pixelError)
+{
+    selectedProxies.clear();
+    selectedLeaves.clear();
+    selectedObjects = 0;
+    if (nodes.empty())
+        return;
+
+    // CLN: a node is drawn as its proxy once its error, at the nearest point of its bounding sphere, projects under
+    //      pixelError; never while the camera is inside the sphere
+    stack.clear();
+    stack.push_back(0);
+    while (!stack.empty())
+    {
+        const int index = stack.back();
+        stack.pop_back();
+        const HlodNode& node = nodes[index];
+        const float offset[3] = { node.center[0] - cameraPosition[0], node.center[1] - cameraPosition[1], node.center[2] - cameraPosition[2] };
+        const float distance = Length3(offset) - node.radius;
+        if (node.error >= 0.0f && distance > 0.0f && node.error * pixelsPerUnit <= pixelError * distance)
+            selectedProxies.push_back(index);
+        else if (node.children[0] < 0)
+        {
+            selectedLeaves.push_back(index);
+            selectedObjects += node.objectCount;
+        }
+        else
+        {
+            stack.push_back(node.children[1]);
+            stack.push_back(node.children[0]);
+        }
+    }
+}
+
+
+void HlodTree::PrintStats(std::ostream& out) const
+{
+    if (nodes.empty())
+        return;
+
+    size_t proxies = 0, proxyTriangles = 0, selectedTriangles = 0;
+    for (const HlodNode& node : nodes)
+    {
+        proxies += node.error >= 0.0f;
+        proxyTriangles += node.proxyTriangles;
+    }
+    for (int index : selectedProxies)
+        selectedTriangles += nodes[index].proxyTriangles;
+
+    const std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(1)
+        << "INFO: HLOD: " << nodes.size() << " nodes in " << levels.size() << " levels, " << proxies << " proxies of "
+        << proxyTriangles << " triangles (the objects have " << sourceTriangles << "), built in " << buildMs << " ms on "
+        << threads << " thread(s)\n";
+    if (enabled)
+        out << "      last frame: " << selectedProxies.size() << " proxy draw(s) (" << selectedTriangles << " triangles) for "
+            << nodes[0].objectCount - selectedObjects << " object(s), " << selectedObjects << " object(s) drawn individually\n";
+    else
+        out << "      off\n";
+    out.unsetf(std::ios_base::floatfield);
+    out.precision(precision);
+}
+
+
+bool HlodTree::SelfTest(std::ostream& out)
+{
+    bool passed = true;
+    auto check = [&out, &passed](bool condition, const char* what) {
+        if (!condition)
+        {
+            out << "Failed HLOD tree self-test: " << what << std::endl;
+            passed = false;
+        }
+    };
+
+    // CLN: a unit cube of 24 vertices stands in for every primitive
+    MeshData cube;
+    const float faces[6][3] = { { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 } };
+    for (const float* normal : faces)
+    {
+        const int axis = normal[0] != 0.0f ? 0 : normal[1] != 0.0f ? 1 : 2;
+        const int u = (axis + 1) % 3, v = (axis + 2) % 3;
+        const unsigned short base = (unsigned short)cube.GetVertexCount();
+        for (int corner = 0; corner < 4; ++corner)
+        {
+            float vertex[MeshData::FLOATS_PER_VERTEX] = { 0.0f };
+            vertex[axis] = 0.5f * (normal[0] + normal[1] + normal[2]);
+            vertex[u] = (corner == 1 || corner == 2) ? 0.5f : -0.5f;
+            vertex[v] = corner >= 2 ? 0.5f : -0.5f;
+            memcpy(vertex + 3, normal, 3 * sizeof(float));
+            vertex[6] = vertex[u] + 0.5f;
+            vertex[7] = vertex[v] + 0.5f;
+            cube.vertices.insert(cube.vertices.end(), vertex, vertex + MeshData::FLOATS_PER_VERTEX);
+        }
+        const unsigned short quad[6] = { 0, 1, 2, 0, 2, 3 };
+        for (unsigned short index : quad)
+            cube.indices.push_back((unsigned short)(base + index));
+    }
+    const std::vector<MeshData> meshes(STRESS_PRIMITIVE_COUNT, cube);
+
+    // CLN: objects scattered over a 100 unit box with scales of 0.5 to 2, or all on one spot (every split is a tie)
+    auto makeObjects = [](size_t count, bool stacked) {
+        std::vector<StressObject> objects(count);
+        uint32_t state = 12345;
+        auto next = [&state]() { state = state * 1664525u + 1013904223u; return (state >> 8) / 16777216.0f; };
+        for (size_t i = 0; i < count; ++i)
+        {
+            StressObject& object = objects[i];
+            const float scale = 0.5f + 1.5f * next();
+            memset(object.model, 0, sizeof(object.model));
+            object.model[0] = object.model[5] = object.model[10] = scale;
+            object.model[15] = 1.0f;
+            for (int axis = 0; axis < 3; ++axis)
+                object.model[12 + axis] = stacked ? 7.0f : 100.0f * next() - 50.0f;
+            object.primitive = (unsigned char)(i % STRESS_PRIMITIVE_COUNT);
+            object.texture = (unsigned char)(i % 3);
+            object.light = (unsigned short)(i % 4);
+            object.radius = 0.8661f * scale;
+        }
+        return objects;
+    };
+
+    // CLN: the leaves split the object order between them, every inner node's range is its two children's, and each
+    //      node's sphere holds its objects' spheres
+    auto checkTree = [&check](const HlodTree& tree, const std::vector<StressObject>& objects, unsigned int leafObjects) {
+        std::vector<unsigned int> leavesHolding(objects.size(), 0);
+        bool ranges = true, spheres = true, leafSizes = true;
+        for (const HlodNode& node : tree.nodes)
+        {
+            if (node.children[0] < 0)
+            {
+                leafSizes = leafSizes && node.objectCount > 0 && node.objectCount <= leafObjects;
+                for (unsigned int i = node.firstObject; i < node.firstObject + node.objectCount; ++i)
+                    ++leavesHolding[tree.objectOrder[i]];
+            }
+            else
+            {
+                const HlodNode& left = tree.nodes[node.children[0]];
+                const HlodNode& right = tree.nodes[node.children[1]];
+                ranges = ranges && left.firstObject == node.firstObject && right.firstObject == left.firstObject + left.objectCount
+                      && left.objectCount + right.objectCount == node.objectCount;
+            }
+            for (unsigned int i = node.firstObject; i < node.firstObject + node.objectCount; ++i)
+            {
+                const StressObject& object = objects[tree.objectOrder[i]];
+                const float offset[3] = { object.model[12] - node.center[0], object.model[13] - node.center[1], object.model[14] - node.center[2] };
+                spheres = spheres && Length3(offset) + object.radius <= node.radius * 1.0001f + 1e-4f;
+            }
+        }
+        const HlodNode& root = tree.nodes[0];
+        check(root.firstObject == 0 && root.objectCount == objects.size() && ranges, "a node's range isn't its children's");
+        check(std::count(leavesHolding.begin(), leavesHolding.end(), 1u) == (long)objects.size(), "an object isn't in exactly one leaf");
+        check(leafSizes, "a leaf is empty or holds too many objects");
+        check(spheres, "an object sticks out of a node's sphere");
+    };
+
+    WorkerPool pool(2);
+    HlodSettings settings;
+    settings.leafObjects = 16;
+    settings.proxyTriangles = 64;
+    settings.maxError = 0.05f;
+    const std::vector<StressObject> scattered = makeObjects(1000, false);
+    HlodTree tree;
+    check(tree.Build(scattered, meshes, 3, settings, pool), "a tree wasn't built");
+    if (!tree.nodes.empty())
+        checkTree(tree, scattered, settings.leafObjects);
+
+    for (size_t count : { (size_t)1, (size_t)17, (size_t)300 })
+    {
+        HlodTree stacked;
+        const std::vector<StressObject> objects = makeObjects(count, true);
+        check(stacked.Build(objects, meshes, 3, settings, pool), "a tree of stacked objects wasn't built");
+        if (!stacked.nodes.empty())
+            checkTree(stacked, objects, settings.leafObjects);
+    }
+    HlodTree empty;
+    check(!empty.Build(std::vector<StressObject>(), meshes, 3, settings, pool), "a tree of no objects was built");
+    if (tree.nodes.empty())
+        return false;
+
+    // CLN: Select() cuts the tree: walking down from the root, a node passes (its proxy's error, at the near side of
+    //      its sphere, projects under pixelError) and is drawn as its proxy, or fails and is split further, or is a
+    //      leaf that failed and has its objects drawn. Each object is drawn exactly once, one way or the other
+    const float pixelsPerUnit = 1000.0f;
+    auto checkCut = [&](const float* camera, float pixelError, size_t& objectsDrawn) {
+        tree.Select(camera, pixelsPerUnit, pixelError);
+        std::vector<char> selected(tree.nodes.size(), 0);
+        for (int index : tree.selectedProxies)
+            selected[index] = 'p';
+        for (int index : tree.selectedLeaves)
+            selected[index] = 'l';
+
+        bool cut = true;
+        size_t reached = 0;
+        std::vector<int> pending(1, 0);
+        while (!pending.empty())
+        {
+            const HlodNode& node = tree.nodes[pending.back()];
+            const char how = selected[pending.back()];
+            pending.pop_back();
+            const float offset[3] = { node.center[0] - camera[0], node.center[1] - camera[1], node.center[2] - camera[2] };
+            const float distance = Length3(offset) - node.radius;
+            const bool passes = node.error >= 0.0f && distance > 0.0f && node.error * pixelsPerUnit <= pixelError * distance;
+            if (how != 0)
+                ++reached;
+            if (passes)
+                cut = cut && how == 'p';
+            else if (node.children[0] < 0)
+                cut = cut && how == 'l';
+            else
+            {
+                cut = cut && how == 0;
+                pending.push_back(node.children[0]);
+                pending.push_back(node.children[1]);
+            }
+        }
+        objectsDrawn = 0;
+        for (int index : tree.selectedLeaves)
+            objectsDrawn += tree.nodes[index].objectCount;
+        check(cut && reached == tree.selectedProxies.size() + tree.selectedLeaves.size(), "Select() didn't cut the tree where the pixel error says");
+        check(tree.selectedObjects == objectsDrawn, "Select() miscounted the objects drawn one by one");
+    };
+
+    // CLN: from far away the root's proxy stands in for everything; from inside the field a larger pixel error never
+    //      draws more objects one by one, and a camera inside a node's sphere never gets its proxy
+    size_t objectsDrawn = 0;
+    const float far[3] = { 0.0f, 0.0f, 1e6f };
+    checkCut(far, 1.0f, objectsDrawn);
+    check(tree.nodes[0].error >= 0.0f && tree.selectedProxies == std::vector<int>(1, 0) && tree.selectedLeaves.empty(),
+          "a distant camera didn't get the root's proxy");
+
+    const HlodNode& root = tree.nodes[0];
+    const float inside[3] = { root.center[0], root.center[1], root.center[2] };
+    const float edge[3] = { root.center[0] + root.radius - 0.01f, root.center[1], root.center[2] };
+    for (const float* camera : { inside, edge })
+    {
+        size_t previous = scattered.size() + 1;
+        bool fewer = true;
+        for (float pixelError : { 0.0f, 0.1f, 0.5f, 1.0f, 4.0f, 16.0f, 1e6f })
+        {
+            checkCut(camera, pixelError, objectsDrawn);
+            fewer = fewer && objectsDrawn <= previous;
+            previous = objectsDrawn;
+            check(std::find(tree.selectedProxies.begin(), tree.selectedProxies.end(), 0) == tree.selectedProxies.end(),
+                  "a camera inside the root's sphere got the root's proxy");
+        }
+        check(fewer, "a larger pixel error drew more objects one by one");
+    }
+    const float nearby[3] = { 30.0f, 5.0f, -20.0f };
+    for (float pixelError : { 0.0f, 1.0f, 8.0f })
+        checkCut(nearby, pixelError, objectsDrawn);
+
+    // CLN: with nothing simplified away every proxy is exact (error 0) and is taken from anywhere outside its sphere,
+    //      even at a pixel error of 0, but not from just inside it; 3000 cubes don't fit a root proxy of 16-bit
+    //      indices, so the root has none and a distant camera gets its two children's instead
+    settings.proxyTriangles = 1u << 20;
+    settings.maxError = 0.0f;
+    const std::vector<StressObject> many = makeObjects(3000, false);
+    check(tree.Build(many, meshes, 3, settings, pool), "a lossless tree wasn't built");
+    if (tree.nodes.empty())
+        return false;
+    checkTree(tree, many, settings.leafObjects);
+    checkCut(far, 0.0f, objectsDrawn);
+    std::vector<int> rootChildren(tree.nodes[0].children, tree.nodes[0].children + 2);
+    std::sort(tree.selectedProxies.begin(), tree.selectedProxies.end());
+    check(tree.nodes[0].error < 0.0f && tree.selectedProxies == rootChildren && tree.selectedLeaves.empty(),
+          "a distant camera didn't get the children of a root without a proxy");
+    bool exact = true;
+    for (size_t i = 0; i < tree.nodes.size(); ++i)
+    {
+        const HlodNode& node = tree.nodes[i];
+        exact = exact && (i == 0 || node.error == 0.0f);
+        const float edge[3] = { node.center[0] + node.radius - 0.01f, node.center[1], node.center[2] };
+        checkCut(edge, 0.0f, objectsDrawn);
+        check(std::find(tree.selectedProxies.begin(), tree.selectedProxies.end(), (int)i) == tree.selectedProxies.end(),
+              "a camera inside a node's sphere got its proxy");
+    }
+    check(exact, "a proxy of nothing simplified away has an error");
+
+    return passed;
+}
@@ -0,0 +1,125 @@
+//========================================================================================
+// Filename      : HlodTree.h
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Hierarchical LOD for the static objects of the stress scene (--hlod).
+//               : Build() splits the objects into a binary tree by the median of their
+//               : positions along the longest axis, down to leaves of a few dozen
+//               : objects. Every node gets a proxy: one mesh that merges its objects
+//               : (leaves) or its children's proxies (inner nodes), in world space,
+//               : simplified by MeshSimplifier to a triangle budget. The proxies share
+//               : one texture atlas that holds a downsampled copy of every source
+//               : texture, so a proxy is a single draw whatever textures its objects
+//               : use.
+//               :
+//               : A node's error bounds how far its proxy strays from the objects
+//               : (its own simplification plus the worst of its children's). Select()
+//               : walks the tree from the root and draws the proxy of every node
+//               : whose error projects to less than the pixel threshold, so a distant
+//               : region of any size costs one draw; only the leaves that fail it have
+//               : their objects drawn one by one.
+//               :
+//               : Build() runs on the workers (no GL calls); CreateProxies() uploads
+//               : the proxies and bakes the atlas on the main thread afterwards.
+//========================================================================================
+
+#ifndef HLOD_TREE_H
+#define HLOD_TREE_H
+
+#include <GL/glew.h>
+
+#include <ostream>
+#include <vector>
+
+#include "MeshData.h"
+#include "StressScene.h"
+
+class WorkerPool;
+
+struct HlodSettings
+{
+    unsigned int leafObjects = 32;      // --hlod-leaf <n>: objects per leaf at most
+    unsigned int proxyTriangles = 1024; // --hlod-triangles <n>: triangle budget of a proxy
+    float maxError = 0.05f;             // largest simplification error of one proxy, relative to its extent
+    int atlasTileSize = 256;            // texels per side of each source texture in the atlas
+};
+
+struct HlodNode
+{
+    float center[3];                    // bounding sphere of the node's objects (world space)
+    float radius;
+    float error;                        // how far the proxy may be from the objects (world units); -1 if it has none
+    int children[2];                    // -1 for leaves
+    unsigned int firstObject;           // range of the node's objects in GetObjectOrder()
+    unsigned int objectCount;
+    unsigned short light;               // the stress light most of its objects use, which lights the proxy
+    unsigned int proxyTriangles;
+
+    // proxy mesh: positions relative to center, texture coordinates in the atlas
+    MeshData proxy;                     // freed once uploaded
+    GLuint vao;
+    GLuint vbos[2];
+};
+
+class HlodTree
+{
+public:
+    HlodTree();
+
+    // meshes holds the mesh of each StressPrimitive, and an object's texture index picks its tile of the atlas
+    bool Build(const std::vector<StressObject>& objects, const std::vector<MeshData>& meshes, int textureCount,
+               const HlodSettings& settings, WorkerPool& pool);
+    // textures[i] is the texture of texture index i (mipmapped)
+    bool CreateProxies(const std::vector<GLuint>& textures);
+    void Destroy();
+    bool IsCreated() const              { return atlas != 0; }
+
+    void SetEnabled(bool enabled)       { this->enabled = enabled && IsCreated(); }
+    bool IsEnabled() const              { return enabled; }
+
+    // picks the nodes drawn this frame: proxies whose error stays under pixelError pixels, at pixelsPerUnit on-screen
+    // pixels per world unit at a distance of one, and the leaves whose objects are drawn individually
+    void Select(const float* cameraPosition, float pixelsPerUnit, float pixelError);
+    const std::vector<int>& GetSelectedProxies() const      { return selectedProxies; }
+    const std::vector<int>& GetSelectedLeaves() const       { return selectedLeaves; }
+
+    const HlodNode& GetNode(int node) const                 { return nodes[node]; }
+    const std::vector<unsigned int>& GetObjectOrder() const { return objectOrder; }
+    GLuint GetAtlas() const                                 { return atlas; }
+
+    void PrintStats(std::ostream& out) const;
+
+    // builds trees of made-up cube fields (no GL) and checks that every object is in exactly one leaf and inside the
+    // spheres of its nodes, and that Select() cuts the tree where the pixel error says (--self-test)
+    static bool SelfTest(std::ostream& out);
+
+private:
+    int BuildNodes(const std::vector<StressObject>& objects, const std::vector<MeshData>& meshes, unsigned int first,
+                   unsigned int count, int depth);
+    void BuildLeafProxy(HlodNode& node, const std::vector<StressObject>& objects, const std::vector<MeshData>& meshes);
+    void BuildInnerProxy(HlodNode& node);
+    void SimplifyProxy(HlodNode& node, MeshData& merged, float childError);
+    void GetTileRect(int texture, float* rect) const;
+
+    HlodSettings settings;
+    int textureCount;
+    int atlasColumns;
+    bool enabled;
+
+    std::vector<HlodNode> nodes;        // nodes[0] is the root
+    std::vector<unsigned int> objectOrder;
+    std::vector<std::vector<int> > levels;  // node indices by depth
+    GLuint atlas;
+
+    std::vector<int> selectedProxies;
+    std::vector<int> selectedLeaves;
+    std::vector<int> stack;
+    size_t selectedObjects;
+
+    double buildMs;
+    unsigned int threads;
+    size_t sourceTriangles;
+};
+
+#endif
@@ -0,0 +1,46 @@
+//========================================================================================
+// Filename      : MappedFile.h
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Read-only memory mapping of a whole file (mmap on POSIX, a file
+//               : mapping object on Windows). The pages are faulted in by the OS as
+//               : they are touched, so large files can be parsed in place without
+//               : first being copied into a buffer.
+//========================================================================================
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool Open(const std::string& filename);
+    void Close();
+
+    const unsigned char* GetData() const    { return data; }
+    size_t GetSize() const                  { return size; }
+    bool IsOpen() const                     { return data != nullptr || isEmpty; }
+
+private:
+    const unsigned char* data;
+    size_t size;
+    bool isEmpty;           // zero-length files open fine but have nothing to map
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#else
+    int fileDescriptor;
+#endif
+};
+
+#endif
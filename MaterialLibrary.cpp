@@ -0,0 +1,332 @@
+//========================================================================================
+// Filename      : MaterialLibrary.cpp
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Implementation of the MaterialLibrary class (see MaterialLibrary.h)
+//========================================================================================
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "MaterialLibrary.h"
+
+namespace
+{
+    // CLN: contents compare by their bytes; -0 is made +0 first so the two don't count as different materials
+    Material Normalize(Material material)
+    {
+        float* values[] = { &material.color[0], &material.color[1], &material.color[2], &material.ambientStrength,
+                            &material.specularIntensity, &material.highlightSize, &material.reflectivity };
+        for (float* value : values)
+        {
+            if (*value == 0.0f)
+                *value = 0.0f;
+        }
+        return material;
+    }
+
+    unsigned long long HashMaterial(const Material& material)
+    {
+        // CLN: FNV-1a over the 32 bytes
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&material);
+        unsigned long long hash = 14695981039346656037ull;
+        for (size_t i = 0; i < sizeof(Material); ++i)
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        return hash;
+    }
+
+    // CLN: the sort order of the slots: texture first, since that is what a draw has to rebind
+    bool MaterialLess(const Material& a, const Material& b)
+    {
+        if (a.texture != b.texture)
+            return a.texture < b.texture;
+        if (a.highlightSize != b.highlightSize)
+            return a.highlightSize < b.highlightSize;
+        if (a.specularIntensity != b.specularIntensity)
+            return a.specularIntensity < b.specularIntensity;
+        if (a.ambientStrength != b.ambientStrength)
+            return a.ambientStrength < b.ambientStrength;
+        if (a.reflectivity != b.reflectivity)
+            return a.reflectivity < b.reflectivity;
+        return memcmp(a.color, b.color, sizeof(a.color)) < 0;
+    }
+}
+
+
+MaterialLibrary::MaterialLibrary()
+    : addCalls(0), sorted(true), dirty(true), version(0), buffer(0), bufferBytes(0)
+{
+    textureNames.push_back(0);
+    texturesByName[0] = 0;
+    Add(Material());
+    addCalls = 0;
+    sorted = true;
+}
+
+
+GLuint MaterialLibrary::AddTexture(GLuint textureName)
+{
+    const auto found = texturesByName.find(textureName);
+    if (found != texturesByName.end())
+        return found->second;
+    const GLuint texture = (GLuint)textureNames.size();
+    textureNames.push_back(textureName);
+    texturesByName[textureName] = texture;
+    return texture;
+}
+
+
+int MaterialLibrary::Add(const Material& material)
+{
+    ++addCalls;
+    const Material normalized = Normalize(material);
+    const unsigned long long hash = HashMaterial(normalized);
+    std::vector<int>& candidates = idsByHash[hash];
+    for (int id : candidates)
+    {
+        if (memcmp(&materials[id], &normalized, sizeof(Material)) == 0)
+            return id;
+    }
+
+    // CLN: a new material goes to the end of the buffer until the next Sort()
+    const int id = (int)materials.size();
+    materials.push_back(normalized);
+    slots.push_back(id);
+    candidates.push_back(id);
+    sorted = false;
+    dirty = true;
+    return id;
+}
+
+
+void MaterialLibrary::Sort()
+{
+    std::vector<int> order(materials.size());
+    for (size_t id = 0; id < order.size(); ++id)
+        order[id] = (int)id;
+    std::stable_sort(order.begin(), order.end(), [this](int a, int b) { return MaterialLess(materials[a], materials[b]); });
+    for (size_t slot = 0; slot < order.size(); ++slot)
+        slots[order[slot]] = (int)slot;
+    sorted = true;
+    dirty = true;
+}
+
+
+bool MaterialLibrary::Upload()
+{
+    if (dirty)
+    {
+        std::vector<Material> packed(materials.size());
+        for (size_t id = 0; id < materials.size(); ++id)
+            packed[slots[id]] = materials[id];
+
+        const size_t bytes = packed.size() * sizeof(Material);
+        if (!buffer)
+            glGenBuffers(1, &buffer);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+        if (bytes > bufferBytes)
+        {
+            glBufferData(GL_SHADER_STORAGE_BUFFER, bytes, packed.data(), GL_STATIC_DRAW);
+            bufferBytes = bytes;
+        }
+        else
+            glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, bytes, packed.data());
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        dirty = false;
+        ++version;
+    }
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, MATERIAL_BINDING, buffer);
+
+    if (glGetError() != GL_NO_ERROR)
+    {
+        std::cout << "Failed to upload the material buffer" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+
+void MaterialLibrary::Destroy()
+{
+    glDeleteBuffers(1, &buffer);
+    buffer = 0;
+    bufferBytes = 0;
+    dirty = true;
+}
+
+
+void MaterialLibrary::PrintStats(std::ostream& out) const
+{
+    // CLN: (every material but the default was created by one of the Add() calls, the rest found a duplicate)
+    out << "INFO: Materials: " << materials.size() << " from " << addCalls << " assignment(s) (" << addCalls + 1 - materials.size()
+        << " duplicate(s) merged), " << textureNames.size() - 1 << " texture(s), " << materials.size() * sizeof(Material)
+        << " bytes in the material buffer" << (sorted ? ", sorted by texture" : "") << std::endl;
+}
+
+
+bool MaterialLibrary::SelfTest(std::ostream& out)
+{
+    bool passed = true;
+    auto check = [&out, &passed](bool condition, const char* what) {
+        if (!condition)
+        {
+            out << "Failed material library self-test: " << what << std::endl;
+            passed = false;
+        }
+    };
+
+    // CLN: the same contents give the same id (-0 included), any field that differs a new one, and the default
+    //      material is already there as id 0
+    {
+        MaterialLibrary library;
+        check(library.GetCount() == 1 && library.Add(Material()) == DEFAULT_MATERIAL, "the default material isn't id 0");
+
+        Material red;
+        red.color[1] = red.color[2] = 0.0f;
+        Material negativeZero = red;
+        negativeZero.color[1] = -0.0f;
+        const int redId = library.Add(red);
+        check(redId == 1 && library.Add(negativeZero) == redId && library.Add(red) == redId, "equal contents got a new id");
+
+        Material changed[8];
+        for (Material& material : changed)
+            material = red;
+        changed[0].color[0] = 0.5f;
+        changed[1].color[2] = 0.5f;
+        changed[2].ambientStrength = 0.2f;
+        changed[3].specularIntensity = 0.4f;
+        changed[4].highlightSize = 32.0f;
+        changed[5].texture = 1;
+        changed[6].reflectivity = 0.25f;
+        changed[7].color[0] = -1.0f;
+        bool distinct = true;
+        for (int i = 0; i < 8; ++i)
+            distinct = distinct && library.Add(changed[i]) == 2 + i && library.Add(changed[i]) == 2 + i;
+        check(distinct && library.GetCount() == 10, "a material that differs in one field wasn't added");
+
+        // CLN: a few hundred adds drawn from a small set of values (none of them white, so none is an earlier
+        //      material): as many new ids as distinct contents
+        std::vector<Material> seen;
+        std::vector<int> ids;
+        unsigned int state = 7;
+        bool same = true;
+        for (int i = 0; i < 600; ++i)
+        {
+            state = state * 1664525u + 1013904223u;
+            Material material;
+            material.color[0] = (float)(state >> 28 & 3) * 0.25f;
+            material.highlightSize = (float)(8 << (state >> 26 & 3));
+            material.texture = state >> 23 & 3;
+            const int id = library.Add(material);
+            size_t index = 0;
+            while (index < seen.size() && memcmp(&seen[index], &material, sizeof(Material)) != 0)
+                ++index;
+            if (index == seen.size())
+            {
+                seen.push_back(material);
+                ids.push_back(id);
+            }
+            same = same && id == ids[index] && memcmp(&library.Get(id), &material, sizeof(Material)) == 0;
+        }
+        check(same && library.GetCount() == 10 + (int)seen.size(), "an id doesn't match its contents");
+
+        std::ostringstream stats;
+        library.PrintStats(stats);
+        const std::string expected = "INFO: Materials: " + std::to_string(library.GetCount()) + " from 620 assignment(s) (" +
+                                     std::to_string(621 - library.GetCount()) + " duplicate(s) merged)";
+        check(stats.str().compare(0, expected.size(), expected) == 0, "the stats miscount the merged duplicates");
+    }
+
+    // CLN: the texture table gives one index per GL texture, with 0 for "no texture"
+    {
+        MaterialLibrary library;
+        const GLuint first = library.AddTexture(17);
+        check(library.AddTexture(0) == 0 && first == 1 && library.AddTexture(42) == 2 && library.AddTexture(17) == first &&
+              library.GetTextureName(first) == 17, "a texture got a second index");
+    }
+
+    // CLN: Sort() orders the slots by texture, then highlight size, specular, ambient, reflectivity and color, and
+    //      an id still names the same contents; a material added after it takes the next slot at the end until the
+    //      next Sort()
+    {
+        MaterialLibrary library;
+        Material a, b, c, d;
+        a.texture = 2;
+        b.texture = 1;
+        b.highlightSize = 32.0f;
+        c.texture = 1;
+        c.highlightSize = 8.0f;
+        d.texture = 1;
+        d.highlightSize = 8.0f;
+        d.color[0] = 0.5f;
+        const int ids[4] = { library.Add(a), library.Add(b), library.Add(c), library.Add(d) };
+        const int identity[5] = { 0, 1, 2, 3, 4 };
+        bool unsorted = true;
+        for (int id = 0; id < 5; ++id)
+            unsorted = unsorted && library.GetSlot(id) == identity[id];
+        check(unsorted, "an unsorted material isn't in the order it was added");
+
+        library.Sort();
+        // CLN: default (texture 0), then d (texture 1, size 8, red 0.5), c (texture 1, size 8), b (size 32), a (texture 2)
+        const int expected[5] = { 0, 4, 3, 2, 1 };
+        bool order = true;
+        for (int id = 0; id < 5; ++id)
+            order = order && library.GetSlot(id) == expected[id];
+        check(order && library.Get(ids[0]).texture == 2 && library.Get(ids[2]).highlightSize == 8.0f,
+              "Sort() put the slots in the wrong order");
+
+        Material e;
+        e.texture = 1;
+        const int eId = library.Add(e);
+        bool kept = library.GetSlot(eId) == 5;
+        for (int id = 0; id < 5; ++id)
+            kept = kept && library.GetSlot(id) == expected[id];
+        check(kept, "a material added after Sort() moved the others");
+
+        // CLN: e (texture 1, size 16) goes between c and b
+        library.Sort();
+        const int resorted[6] = { 0, 5, 4, 2, 1, 3 };
+        bool remapped = true;
+        for (int id = 0; id < 6; ++id)
+            remapped = remapped && library.GetSlot(id) == resorted[id];
+        check(remapped, "a second Sort() didn't remap the slots");
+    }
+
+    // CLN: with many materials the slots stay a permutation, and reading the buffer by slot (as Upload() packs it)
+    //      gives the materials in order
+    {
+        MaterialLibrary library;
+        unsigned int state = 99;
+        for (int i = 0; i < 300; ++i)
+        {
+            state = state * 1664525u + 1013904223u;
+            Material material;
+            material.texture = state >> 29;
+            material.highlightSize = (float)(state >> 24 & 31);
+            material.specularIntensity = (float)(state >> 21 & 7) * 0.125f;
+            material.color[2] = (float)(state >> 16 & 31) / 31.0f;
+            library.Add(material);
+        }
+        library.Sort();
+        std::vector<int> idBySlot(library.GetCount(), -1);
+        bool permutation = true;
+        for (int id = 0; id < library.GetCount(); ++id)
+        {
+            const int slot = library.GetSlot(id);
+            permutation = permutation && slot >= 0 && slot < library.GetCount() && idBySlot[slot] < 0;
+            if (permutation)
+                idBySlot[slot] = id;
+        }
+        check(permutation, "the slots aren't a permutation");
+        bool ascending = permutation;
+        for (size_t slot = 1; ascending && slot < idBySlot.size(); ++slot)
+            ascending = !MaterialLess(library.Get(idBySlot[slot]), library.Get(idBySlot[slot - 1]));
+        check(ascending, "the buffer read by slot isn't sorted");
+    }
+
+    return passed;
+}
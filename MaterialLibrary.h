@@ -0,0 +1,99 @@
+//========================================================================================
+// Filename      : MaterialLibrary.h
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : The materials of the scene, packed into one shader storage buffer
+//               : that every Phong shader variant reads (binding MATERIAL_BINDING). The
+//               : shaders declare it with MATERIAL_GLSL, defined next to the C++
+//               : Material, so the two layouts are kept in one place.
+//               :
+//               : A draw selects its material with the materialIndex uniform, and an
+//               : instanced draw can give every instance its own (the impostors do),
+//               : so objects with different materials share one program and, where
+//               : the mesh allows, one draw; no lighting constant is baked into a
+//               : shader any more.
+//               :
+//               : Add() returns the existing id for a material whose contents are
+//               : already in the library, so objects that look alike end up with the
+//               : same material. Ids never change; Sort() only reorders the slots they
+//               : occupy in the buffer (by texture, then by parameters), so draws
+//               : sorted by GetSlot() bind each texture once. texture is an index into
+//               : the library's texture table: GLSL 4.40 cannot pick a sampler per
+//               : instance without bindless textures, so the draw still binds it, but
+//               : the material says which one.
+//========================================================================================
+
+#ifndef MATERIAL_LIBRARY_H
+#define MATERIAL_LIBRARY_H
+
+#include <GL/glew.h>
+
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+// std430 layout of the shaders' Material, 32 bytes
+struct Material
+{
+    float color[3] = { 1.0f, 1.0f, 1.0f };  // multiplies the texture
+    float ambientStrength = 0.1f;
+    float specularIntensity = 0.8f;
+    float highlightSize = 16.0f;
+    GLuint texture = 0;                     // index of MaterialLibrary::AddTexture()
+    float reflectivity = 0.0f;              // share of the reflection probe image at normal incidence
+};
+
+// The same struct and the buffer in GLSL, placed after the #version line of every shader that reads the
+// materials (binding 4 is MaterialLibrary::MATERIAL_BINDING)
+#define MATERIAL_GLSL \
+    "struct Material { vec3 color; float ambientStrength; float specularIntensity; float highlightSize; uint texture; float reflectivity; };\n" \
+    "layout(std430, binding = 4) readonly buffer MaterialBuffer { Material materials[]; };\n"
+
+class MaterialLibrary
+{
+public:
+    static const GLuint MATERIAL_BINDING = 4;   // the overdraw view's counters use 3
+    static const int DEFAULT_MATERIAL = 0;      // the defaults of Material, with texture index 0
+
+    MaterialLibrary();
+
+    // index of a GL texture in the texture table (the same index for the same texture); 0 is "no texture"
+    GLuint AddTexture(GLuint textureName);
+    GLuint GetTextureName(GLuint texture) const     { return textureNames[texture]; }
+
+    // id of a material with these contents, new or existing
+    int Add(const Material& material);
+    const Material& Get(int id) const               { return materials[id]; }
+    int GetCount() const                            { return (int)materials.size(); }
+
+    // position of a material in the buffer, what the shaders index with
+    int GetSlot(int id) const                       { return slots[id]; }
+    void Sort();
+
+    // (re)uploads the buffer if anything was added or sorted since, and binds it to MATERIAL_BINDING
+    bool Upload();
+    unsigned int GetVersion() const                 { return version; }   // counts the uploads that changed the buffer
+    void Destroy();
+
+    void PrintStats(std::ostream& out) const;
+
+    // checks the content dedup of Add(), the order Sort() gives the slots and that ids keep their contents through
+    // it, without a GL context (--self-test)
+    static bool SelfTest(std::ostream& out);
+
+private:
+    std::vector<Material> materials;            // by id
+    std::vector<int> slots;                     // by id
+    std::unordered_map<unsigned long long, std::vector<int>> idsByHash;
+    std::vector<GLuint> textureNames;
+    std::unordered_map<GLuint, GLuint> texturesByName;
+    size_t addCalls;
+    bool sorted;
+    bool dirty;
+    unsigned int version;
+    GLuint buffer;
+    size_t bufferBytes;
+};
+
+#endif
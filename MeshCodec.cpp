@@ -0,0 +1,957 @@
+//========================================================================================
+// Filename      : MeshCodec.cpp
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Implementation of the MeshCodec class (see MeshCodec.h)
+//               :
+//               : Index stream, one code byte per triangle:
+//               :    high nibble 0..14 : the triangle shares the edge at that FIFO recency,
+//               :                        low nibble is the code of its third vertex
+//               :    high nibble 15    : no shared edge, two more nibble-pair bytes follow
+//               :                        with the codes of all three vertices
+//               : Vertex codes: 0 = next unseen vertex, 1..13 = vertex FIFO recency,
+//               : 14 = explicit index (zigzag delta varint in the data part).
+//               :
+//               : LZ block format (LZ4 style): token byte with literal length (high
+//               : nibble) and match length - 4 (low nibble), 15 meaning "more length
+//               : bytes follow", then the literals and a 16-bit match offset.
+//========================================================================================
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+
+#include "MeshCodec.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MESH_CODEC_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    const char MESH_MAGIC[4] = { 'C', 'M', 'S', 'H' };
+    const uint32_t MESH_VERSION = 1;
+
+    struct CompressedMeshHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint32_t vertexCount;
+        uint32_t vertexStride;
+        uint32_t indexCount;
+        uint32_t vertexStreamBytes;
+        uint32_t indexStreamBytes;
+    };
+
+    // index codec constants
+    const unsigned int FIFO_SIZE = 16;
+    const unsigned int EDGE_FIFO_CODES = 15;        // recency 0..14
+    const unsigned int VERTEX_FIFO_CODES = 13;      // recency 0..12
+    const unsigned char CODE_NEXT_VERTEX = 0;
+    const unsigned char CODE_EXPLICIT_VERTEX = 14;
+    const unsigned char CODE_NO_EDGE = 15;
+    const size_t MAX_TRIANGLE_BYTES = 3 + 3 * 5;    // a no-edge triangle with three explicit (5-byte varint) vertices
+
+    // LZ constants
+    const size_t LZ_MIN_MATCH = 4;
+    const size_t LZ_LAST_LITERALS = 5;              // the block always ends with at least this many literals
+    const size_t LZ_MAX_OFFSET = 65535;
+    const unsigned int LZ_HASH_BITS = 16;
+    const size_t LZ_MAX_EXPANSION = 255;            // decoded bytes per block byte at most (a match length byte of 255)
+
+    uint32_t Read32(const unsigned char* p)
+    {
+        uint32_t value;
+        memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    void Append32(std::vector<unsigned char>& out, uint32_t value)
+    {
+        unsigned char bytes[4];
+        memcpy(bytes, &value, sizeof(value));
+        out.insert(out.end(), bytes, bytes + 4);
+    }
+
+    void AppendVarint(std::vector<unsigned char>& out, uint32_t value)
+    {
+        while (value >= 0x80)
+        {
+            out.push_back((unsigned char)(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back((unsigned char)value);
+    }
+
+    bool ReadVarint(const unsigned char*& p, const unsigned char* end, uint32_t& value)
+    {
+        value = 0;
+        for (unsigned int shift = 0; shift < 35 && p < end; shift += 7)
+        {
+            unsigned char byte = *p++;
+            value |= (uint32_t)(byte & 0x7f) << shift;
+            if (byte < 0x80)
+                return true;
+        }
+        return false;
+    }
+
+    uint32_t ZigZag(int32_t value)      { return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31); }
+    int32_t UnZigZag(uint32_t value)    { return (int32_t)(value >> 1) ^ -(int32_t)(value & 1); }
+
+    // Edge and vertex FIFOs shared by the index encoder and decoder, which must update them identically
+    struct IndexCoderState
+    {
+        unsigned int edges[FIFO_SIZE][2];
+        unsigned int vertices[FIFO_SIZE];
+        unsigned int edgeHead;
+        unsigned int vertexHead;
+        unsigned int nextVertex;
+        int32_t lastExplicit;
+
+        IndexCoderState() : edgeHead(0), vertexHead(0), nextVertex(0), lastExplicit(0)
+        {
+            for (unsigned int i = 0; i < FIFO_SIZE; ++i)
+            {
+                edges[i][0] = edges[i][1] = ~0u;
+                vertices[i] = ~0u;
+            }
+        }
+
+        void PushEdge(unsigned int a, unsigned int b)
+        {
+            edges[edgeHead][0] = a;
+            edges[edgeHead][1] = b;
+            edgeHead = (edgeHead + 1) % FIFO_SIZE;
+        }
+
+        void PushVertex(unsigned int v)
+        {
+            vertices[vertexHead] = v;
+            vertexHead = (vertexHead + 1) % FIFO_SIZE;
+        }
+
+        const unsigned int* EdgeAt(unsigned int recency) const      { return edges[(edgeHead + FIFO_SIZE - 1 - recency) % FIFO_SIZE]; }
+        unsigned int VertexAt(unsigned int recency) const           { return vertices[(vertexHead + FIFO_SIZE - 1 - recency) % FIFO_SIZE]; }
+
+        int FindEdge(unsigned int a, unsigned int b) const
+        {
+            for (unsigned int i = 0; i < EDGE_FIFO_CODES; ++i)
+            {
+                const unsigned int* edge = EdgeAt(i);
+                if (edge[0] == a && edge[1] == b)
+                    return (int)i;
+            }
+            return -1;
+        }
+
+        int FindVertex(unsigned int v) const
+        {
+            for (unsigned int i = 0; i < VERTEX_FIFO_CODES; ++i)
+            {
+                if (VertexAt(i) == v)
+                    return (int)i;
+            }
+            return -1;
+        }
+
+        unsigned char EncodeVertex(unsigned int v, std::vector<unsigned char>& data)
+        {
+            if (v == nextVertex)
+            {
+                ++nextVertex;
+                PushVertex(v);
+                return CODE_NEXT_VERTEX;
+            }
+
+            int recency = FindVertex(v);
+            if (recency >= 0)
+                return (unsigned char)(1 + recency);
+
+            AppendVarint(data, ZigZag((int32_t)v - lastExplicit));
+            lastExplicit = (int32_t)v;
+            PushVertex(v);
+            return CODE_EXPLICIT_VERTEX;
+        }
+
+        bool DecodeVertex(unsigned char code, const unsigned char*& data, const unsigned char* dataEnd, unsigned int& v)
+        {
+            if (code == CODE_NEXT_VERTEX)
+            {
+                v = nextVertex++;
+                PushVertex(v);
+                return true;
+            }
+            if (code <= VERTEX_FIFO_CODES)
+            {
+                v = VertexAt(code - 1);
+                return v != ~0u;
+            }
+            if (code != CODE_EXPLICIT_VERTEX)
+                return false;
+
+            uint32_t delta;
+            if (!ReadVarint(data, dataEnd, delta))
+                return false;
+            lastExplicit += UnZigZag(delta);
+            v = (unsigned int)lastExplicit;
+            PushVertex(v);
+            return true;
+        }
+    };
+
+    // Decoded size header in front of an LZ block
+    void CompressStream(const std::vector<unsigned char>& raw, std::vector<unsigned char>& encoded)
+    {
+        encoded.clear();
+        Append32(encoded, (uint32_t)raw.size());
+        std::vector<unsigned char> compressed;
+        MeshCodec::Compress(raw.data(), raw.size(), compressed);
+        encoded.insert(encoded.end(), compressed.begin(), compressed.end());
+    }
+
+    // CLN: maxSize is the most the caller's counts can decode to, so a damaged size header fails here instead of
+    //      allocating up to 4 GB
+    bool DecompressStream(const unsigned char* encoded, size_t encodedSize, size_t maxSize, std::vector<unsigned char>& raw)
+    {
+        if (encodedSize < 4 || Read32(encoded) > maxSize)
+            return false;
+        raw.resize(Read32(encoded));
+        return MeshCodec::Decompress(encoded + 4, encodedSize - 4, raw.data(), raw.size());
+    }
+
+    void AppendLength(std::vector<unsigned char>& out, size_t length)
+    {
+        // CLN: lengths of 15 or more continue in bytes of 255 plus a final remainder byte
+        while (length >= 255)
+        {
+            out.push_back(255);
+            length -= 255;
+        }
+        out.push_back((unsigned char)length);
+    }
+
+    void AppendSequence(std::vector<unsigned char>& out, const unsigned char* literals, size_t literalCount, size_t offset, size_t matchLength)
+    {
+        size_t matchCode = matchLength >= LZ_MIN_MATCH ? matchLength - LZ_MIN_MATCH : 0;
+        out.push_back((unsigned char)((std::min<size_t>(literalCount, 15) << 4) | std::min<size_t>(matchCode, 15)));
+        if (literalCount >= 15)
+            AppendLength(out, literalCount - 15);
+        out.insert(out.end(), literals, literals + literalCount);
+
+        if (matchLength == 0)
+            return;     // CLN: final literal-only sequence
+
+        out.push_back((unsigned char)(offset & 0xff));
+        out.push_back((unsigned char)(offset >> 8));
+        if (matchCode >= 15)
+            AppendLength(out, matchCode - 15);
+    }
+
+    bool ReadLength(const unsigned char*& p, const unsigned char* end, size_t& length)
+    {
+        unsigned char byte;
+        do
+        {
+            if (p >= end)
+                return false;
+            byte = *p++;
+            length += byte;
+        } while (byte == 255);
+        return true;
+    }
+
+    // scalar tail of the vertex decoder: prefix-sum the deltas of one vertex range
+    void DecodeVerticesScalar(unsigned char* destination, size_t begin, size_t end, size_t vertexCount, size_t stride,
+                              const unsigned char* planes, uint32_t* previous)
+    {
+        const size_t channels = stride / 4;
+        for (size_t i = begin; i < end; ++i)
+        {
+            for (size_t c = 0; c < channels; ++c)
+            {
+                const unsigned char* plane = planes + c * 4 * vertexCount;
+                uint32_t delta = (uint32_t)plane[i] | (uint32_t)plane[vertexCount + i] << 8 |
+                                 (uint32_t)plane[2 * vertexCount + i] << 16 | (uint32_t)plane[3 * vertexCount + i] << 24;
+                previous[c] += delta;
+                memcpy(destination + i * stride + c * 4, &previous[c], 4);
+            }
+        }
+    }
+
+    double SecondsSince(std::chrono::high_resolution_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+
+    // CLN: the index decoder may rotate a triangle's vertices (same winding), so triangles are compared by rotation
+    bool SameTriangles(const unsigned short* expected, const unsigned short* decoded, size_t indexCount)
+    {
+        for (size_t t = 0; t + 2 < indexCount; t += 3)
+        {
+            const unsigned short* a = &expected[t];
+            const unsigned short* b = &decoded[t];
+            bool same = false;
+            for (int r = 0; r < 3 && !same; ++r)
+                same = a[0] == b[r] && a[1] == b[(r + 1) % 3] && a[2] == b[(r + 2) % 3];
+            if (!same)
+                return false;
+        }
+        return true;
+    }
+
+    // CLN: SplitMix64, for the self-test's data
+    uint32_t NextRandom(uint64_t& state)
+    {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return (uint32_t)((z ^ (z >> 31)) >> 32);
+    }
+}
+
+
+//--------------------------------------------------------------------
+// Index codec
+//--------------------------------------------------------------------
+void MeshCodec::EncodeIndexBuffer(const unsigned short* indices, size_t indexCount, std::vector<unsigned char>& encoded)
+{
+    std::vector<unsigned char> codes;
+    std::vector<unsigned char> data;
+    codes.reserve(indexCount / 3 + 16);
+    IndexCoderState state;
+
+    for (size_t t = 0; t + 2 < indexCount; t += 3)
+    {
+        const unsigned int triangle[3] = { indices[t], indices[t + 1], indices[t + 2] };
+
+        // CLN: a neighbour with the same winding walks the shared edge the other way, so look for (q, p)
+        int bestRecency = -1;
+        int bestRotation = 0;
+        for (int rotation = 0; rotation < 3; ++rotation)
+        {
+            unsigned int p = triangle[rotation];
+            unsigned int q = triangle[(rotation + 1) % 3];
+            int recency = state.FindEdge(q, p);
+            if (recency >= 0 && (bestRecency < 0 || recency < bestRecency))
+            {
+                bestRecency = recency;
+                bestRotation = rotation;
+            }
+        }
+
+        if (bestRecency >= 0)
+        {
+            unsigned int p = triangle[bestRotation];
+            unsigned int q = triangle[(bestRotation + 1) % 3];
+            unsigned int r = triangle[(bestRotation + 2) % 3];
+            unsigned char code = state.EncodeVertex(r, data);
+            codes.push_back((unsigned char)(bestRecency << 4 | code));
+            state.PushEdge(q, r);
+            state.PushEdge(r, p);
+        }
+        else
+        {
+            unsigned char codeA = state.EncodeVertex(triangle[0], data);
+            unsigned char codeB = state.EncodeVertex(triangle[1], data);
+            unsigned char codeC = state.EncodeVertex(triangle[2], data);
+            codes.push_back(CODE_NO_EDGE << 4);
+            codes.push_back((unsigned char)(codeA << 4 | codeB));
+            codes.push_back((unsigned char)(codeC << 4));
+            state.PushEdge(triangle[0], triangle[1]);
+            state.PushEdge(triangle[1], triangle[2]);
+            state.PushEdge(triangle[2], triangle[0]);
+        }
+    }
+
+    std::vector<unsigned char> raw;
+    raw.reserve(4 + codes.size() + data.size());
+    Append32(raw, (uint32_t)codes.size());
+    raw.insert(raw.end(), codes.begin(), codes.end());
+    raw.insert(raw.end(), data.begin(), data.end());
+    CompressStream(raw, encoded);
+}
+
+
+bool MeshCodec::DecodeIndexBuffer(unsigned short* destination, size_t indexCount, const unsigned char* encoded, size_t encodedSize)
+{
+    std::vector<unsigned char> raw;
+    if (!DecompressStream(encoded, encodedSize, 4 + indexCount / 3 * MAX_TRIANGLE_BYTES, raw) || raw.size() < 4)
+        return false;
+
+    const uint32_t codeBytes = Read32(raw.data());
+    if (codeBytes > raw.size() - 4)
+        return false;
+
+    const unsigned char* code = raw.data() + 4;
+    const unsigned char* codeEnd = code + codeBytes;
+    const unsigned char* data = codeEnd;
+    const unsigned char* dataEnd = raw.data() + raw.size();
+    IndexCoderState state;
+
+    for (size_t t = 0; t + 2 < indexCount; t += 3)
+    {
+        if (code >= codeEnd)
+            return false;
+
+        unsigned char first = *code++;
+        unsigned int a, b, c;
+        if ((first >> 4) != CODE_NO_EDGE)
+        {
+            const unsigned int* edge = state.EdgeAt(first >> 4);
+            a = edge[1];
+            b = edge[0];
+            if (a == ~0u || !state.DecodeVertex(first & 15, data, dataEnd, c))
+                return false;
+            state.PushEdge(b, c);
+            state.PushEdge(c, a);
+        }
+        else
+        {
+            if (codeEnd - code < 2)
+                return false;
+            unsigned char codesAB = *code++;
+            unsigned char codesC = *code++;
+            if (!state.DecodeVertex(codesAB >> 4, data, dataEnd, a) ||
+                !state.DecodeVertex(codesAB & 15, data, dataEnd, b) ||
+                !state.DecodeVertex(codesC >> 4, data, dataEnd, c))
+                return false;
+            state.PushEdge(a, b);
+            state.PushEdge(b, c);
+            state.PushEdge(c, a);
+        }
+
+        if (a > 0xffff || b > 0xffff || c > 0xffff)
+            return false;
+        destination[t] = (unsigned short)a;
+        destination[t + 1] = (unsigned short)b;
+        destination[t + 2] = (unsigned short)c;
+    }
+    return true;
+}
+
+
+//--------------------------------------------------------------------
+// Vertex codec
+//--------------------------------------------------------------------
+void MeshCodec::EncodeVertexBuffer(const void* vertices, size_t vertexCount, size_t stride, std::vector<unsigned char>& encoded)
+{
+    const unsigned char* source = (const unsigned char*)vertices;
+    const size_t channels = stride / 4;
+    std::vector<unsigned char> planes(stride * vertexCount);
+
+    // CLN: plane (c * 4 + b) holds byte b of channel c's delta for every vertex
+    for (size_t c = 0; c < channels; ++c)
+    {
+        unsigned char* plane = planes.data() + c * 4 * vertexCount;
+        uint32_t previous = 0;
+        for (size_t i = 0; i < vertexCount; ++i)
+        {
+            uint32_t value = Read32(source + i * stride + c * 4);
+            uint32_t delta = value - previous;
+            previous = value;
+
+            plane[i] = (unsigned char)delta;
+            plane[vertexCount + i] = (unsigned char)(delta >> 8);
+            plane[2 * vertexCount + i] = (unsigned char)(delta >> 16);
+            plane[3 * vertexCount + i] = (unsigned char)(delta >> 24);
+        }
+    }
+
+    CompressStream(planes, encoded);
+}
+
+
+bool MeshCodec::DecodeVertexBuffer(void* destination, size_t vertexCount, size_t stride, const unsigned char* encoded, size_t encodedSize)
+{
+    if (stride == 0 || stride % 4 != 0)
+        return false;
+
+    std::vector<unsigned char> planes;
+    if (!DecompressStream(encoded, encodedSize, stride * vertexCount, planes) || planes.size() != stride * vertexCount)
+        return false;
+
+    unsigned char* output = (unsigned char*)destination;
+    const size_t channels = stride / 4;
+    std::vector<uint32_t> previous(channels, 0);
+    size_t decoded = 0;
+
+#ifdef MESH_CODEC_SSE2
+    // CLN: 4 vertices x 4 channels at a time: rebuild the 32-bit deltas from the byte planes, prefix-sum them
+    //      down the vertices, then transpose so each vertex's 4 channels go out as one 16-byte store
+    if (channels % 4 == 0)
+    {
+        const unsigned char* p = planes.data();
+        for (; decoded + 4 <= vertexCount; decoded += 4)
+        {
+            for (size_t group = 0; group < channels; group += 4)
+            {
+                __m128 lanes[4];
+                for (size_t k = 0; k < 4; ++k)
+                {
+                    const size_t c = group + k;
+                    const unsigned char* plane = p + c * 4 * vertexCount + decoded;
+                    __m128i b0 = _mm_cvtsi32_si128((int)Read32(plane));
+                    __m128i b1 = _mm_cvtsi32_si128((int)Read32(plane + vertexCount));
+                    __m128i b2 = _mm_cvtsi32_si128((int)Read32(plane + 2 * vertexCount));
+                    __m128i b3 = _mm_cvtsi32_si128((int)Read32(plane + 3 * vertexCount));
+                    __m128i low = _mm_unpacklo_epi8(b0, b1);
+                    __m128i high = _mm_unpacklo_epi8(b2, b3);
+                    __m128i delta = _mm_unpacklo_epi16(low, high);
+
+                    // inclusive prefix sum of the 4 lanes plus the running value of the channel
+                    delta = _mm_add_epi32(delta, _mm_slli_si128(delta, 4));
+                    delta = _mm_add_epi32(delta, _mm_slli_si128(delta, 8));
+                    delta = _mm_add_epi32(delta, _mm_set1_epi32((int)previous[c]));
+                    previous[c] = (uint32_t)_mm_cvtsi128_si32(_mm_shuffle_epi32(delta, 0xff));
+                    lanes[k] = _mm_castsi128_ps(delta);
+                }
+
+                _MM_TRANSPOSE4_PS(lanes[0], lanes[1], lanes[2], lanes[3]);
+                for (size_t k = 0; k < 4; ++k)
+                    _mm_storeu_ps((float*)(output + (decoded + k) * stride + group * 4), lanes[k]);
+            }
+        }
+    }
+#endif
+
+    DecodeVerticesScalar(output, decoded, vertexCount, vertexCount, stride, planes.data(), previous.data());
+    return true;
+}
+
+
+//--------------------------------------------------------------------
+// LZ block compressor
+//--------------------------------------------------------------------
+void MeshCodec::Compress(const unsigned char* data, size_t size, std::vector<unsigned char>& compressed)
+{
+    compressed.clear();
+    compressed.reserve(size / 2 + 16);
+
+    size_t anchor = 0;
+    if (size > LZ_MIN_MATCH + LZ_LAST_LITERALS)
+    {
+        std::vector<int64_t> table((size_t)1 << LZ_HASH_BITS, -1);
+        const size_t matchLimit = size - LZ_LAST_LITERALS;      // matches may not reach into the last literals
+        size_t i = 0;
+
+        while (i + LZ_MIN_MATCH <= matchLimit)
+        {
+            const uint32_t sequence = Read32(data + i);
+            const uint32_t hash = (sequence * 2654435761u) >> (32 - LZ_HASH_BITS);
+            const int64_t candidate = table[hash];
+            table[hash] = (int64_t)i;
+
+            if (candidate < 0 || i - (size_t)candidate > LZ_MAX_OFFSET || Read32(data + candidate) != sequence)
+            {
+                // CLN: skip ahead faster through data that doesn't compress
+                i += 1 + ((i - anchor) >> 6);
+                continue;
+            }
+
+            size_t length = LZ_MIN_MATCH;
+            while (i + length < matchLimit && data[(size_t)candidate + length] == data[i + length])
+                ++length;
+
+            AppendSequence(compressed, data + anchor, i - anchor, i - (size_t)candidate, length);
+            i += length;
+            anchor = i;
+        }
+    }
+
+    AppendSequence(compressed, data + anchor, size - anchor, 0, 0);
+}
+
+
+bool MeshCodec::Decompress(const unsigned char* compressed, size_t compressedSize, unsigned char* destination, size_t size)
+{
+    const unsigned char* in = compressed;
+    const unsigned char* inEnd = compressed + compressedSize;
+    unsigned char* out = destination;
+    unsigned char* outEnd = destination + size;
+
+    while (in < inEnd)
+    {
+        const unsigned char token = *in++;
+
+        size_t literalCount = token >> 4;
+        if (literalCount == 15 && !ReadLength(in, inEnd, literalCount))
+            return false;
+        if (literalCount > (size_t)(inEnd - in) || literalCount > (size_t)(outEnd - out))
+            return false;
+        if (literalCount > 0)
+            memcpy(out, in, literalCount);  // CLN: (destination may be null for an empty buffer)
+        in += literalCount;
+        out += literalCount;
+
+        if (in == inEnd)
+            break;      // CLN: the last sequence has no match
+
+        if (inEnd - in < 2)
+            return false;
+        const size_t offset = (size_t)in[0] | (size_t)in[1] << 8;
+        in += 2;
+
+        size_t length = token & 15;
+        if (length == 15 && !ReadLength(in, inEnd, length))
+            return false;
+        length += LZ_MIN_MATCH;
+
+        if (offset == 0 || offset > (size_t)(out - destination) || length > (size_t)(outEnd - out))
+            return false;
+
+        const unsigned char* match = out - offset;
+        if (offset >= 16 && (size_t)(outEnd - out) >= length + 16)
+        {
+            // CLN: non-overlapping (in 16-byte steps) copy, may write up to 15 bytes past the match, which the next sequence overwrites
+            for (size_t copied = 0; copied < length; copied += 16)
+                memcpy(out + copied, match + copied, 16);
+        }
+        else
+        {
+            for (size_t k = 0; k < length; ++k)
+                out[k] = match[k];
+        }
+        out += length;
+    }
+
+    return out == outEnd;
+}
+
+
+//--------------------------------------------------------------------
+// Mesh container
+//--------------------------------------------------------------------
+void MeshCodec::ReorderVerticesForFetch(MeshData& mesh)
+{
+    const unsigned int vertexCount = mesh.GetVertexCount();
+    const unsigned int floats = MeshData::FLOATS_PER_VERTEX;
+    std::vector<unsigned int> remap(vertexCount, ~0u);
+    std::vector<float> reordered;
+    reordered.reserve(mesh.vertices.size());
+
+    // CLN: vertices that no triangle uses are dropped
+    unsigned int nextIndex = 0;
+    for (unsigned short& index : mesh.indices)
+    {
+        if (remap[index] == ~0u)
+        {
+            remap[index] = nextIndex++;
+            reordered.insert(reordered.end(), mesh.vertices.begin() + index * floats, mesh.vertices.begin() + (index + 1) * floats);
+        }
+        index = (unsigned short)remap[index];
+    }
+
+    mesh.vertices.swap(reordered);
+}
+
+
+void MeshCodec::EncodeMesh(const MeshData& mesh, std::vector<unsigned char>& file)
+{
+    std::vector<unsigned char> vertexStream;
+    std::vector<unsigned char> indexStream;
+    const size_t stride = MeshData::FLOATS_PER_VERTEX * sizeof(float);
+    EncodeVertexBuffer(mesh.vertices.data(), mesh.GetVertexCount(), stride, vertexStream);
+    EncodeIndexBuffer(mesh.indices.data(), mesh.indices.size(), indexStream);
+
+    CompressedMeshHeader header;
+    memcpy(header.magic, MESH_MAGIC, sizeof(header.magic));
+    header.version = MESH_VERSION;
+    header.vertexCount = mesh.GetVertexCount();
+    header.vertexStride = (uint32_t)stride;
+    header.indexCount = mesh.GetIndexCount();
+    header.vertexStreamBytes = (uint32_t)vertexStream.size();
+    header.indexStreamBytes = (uint32_t)indexStream.size();
+
+    file.resize(sizeof(header));
+    memcpy(file.data(), &header, sizeof(header));
+    file.insert(file.end(), vertexStream.begin(), vertexStream.end());
+    file.insert(file.end(), indexStream.begin(), indexStream.end());
+}
+
+
+bool MeshCodec::ReadHeader(const unsigned char* file, size_t fileSize, unsigned int& vertexCount, unsigned int& indexCount)
+{
+    CompressedMeshHeader header;
+    if (fileSize < sizeof(header))
+        return false;
+    memcpy(&header, file, sizeof(header));
+
+    if (memcmp(header.magic, MESH_MAGIC, sizeof(header.magic)) != 0 || header.version != MESH_VERSION ||
+        header.vertexStride != MeshData::FLOATS_PER_VERTEX * sizeof(float) ||
+        (uint64_t)header.vertexStreamBytes + header.indexStreamBytes > fileSize - sizeof(header))
+        return false;
+
+    // CLN: the callers size their buffers by these counts: no more vertices than an index reaches, and no more
+    //      triangles than the index stream can hold at one code byte each
+    if (header.vertexCount > MeshData::MAX_VERTICES ||
+        (uint64_t)header.indexCount / 3 > (uint64_t)header.indexStreamBytes * LZ_MAX_EXPANSION)
+        return false;
+
+    vertexCount = header.vertexCount;
+    indexCount = header.indexCount;
+    return true;
+}
+
+
+bool MeshCodec::DecodeMesh(const unsigned char* file, size_t fileSize, float* vertexDestination, unsigned short* indexDestination)
+{
+    unsigned int vertexCount, indexCount;
+    if (!ReadHeader(file, fileSize, vertexCount, indexCount))
+        return false;
+
+    CompressedMeshHeader header;
+    memcpy(&header, file, sizeof(header));
+    const unsigned char* vertexStream = file + sizeof(header);
+    const unsigned char* indexStream = vertexStream + header.vertexStreamBytes;
+
+    return DecodeVertexBuffer(vertexDestination, vertexCount, header.vertexStride, vertexStream, header.vertexStreamBytes) &&
+           DecodeIndexBuffer(indexDestination, indexCount, indexStream, header.indexStreamBytes);
+}
+
+
+bool MeshCodec::DecodeMesh(const unsigned char* file, size_t fileSize, MeshData& mesh)
+{
+    unsigned int vertexCount, indexCount;
+    if (!ReadHeader(file, fileSize, vertexCount, indexCount))
+        return false;
+
+    mesh.vertices.resize((size_t)vertexCount * MeshData::FLOATS_PER_VERTEX);
+    mesh.indices.resize(indexCount);
+    return DecodeMesh(file, fileSize, mesh.vertices.data(), mesh.indices.data());
+}
+
+
+bool MeshCodec::WriteFile(const std::string& filename, const MeshData& mesh)
+{
+    std::vector<unsigned char> file;
+    EncodeMesh(mesh, file);
+
+    std::ofstream out(filename, std::ios::binary);
+    out.write((const char*)file.data(), file.size());
+    return (bool)out;
+}
+
+
+//--------------------------------------------------------------------
+// Benchmark
+//--------------------------------------------------------------------
+bool MeshCodec::Benchmark(const std::vector<MeshData>& meshes, std::ostream& out)
+{
+    size_t totalRaw = 0, totalEncoded = 0;
+    double totalDecodeBytes = 0.0, totalDecodeSeconds = 0.0;
+    bool allValid = true;
+
+    const std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(2);
+    out << "INFO: Mesh codec benchmark\n"
+        << "      vertices  triangles    raw(KB)    enc(KB)   ratio  idx bits/tri  vtx bytes/vtx  decode GB/s\n";
+
+    for (const MeshData& source : meshes)
+    {
+        MeshData mesh = source;
+        ReorderVerticesForFetch(mesh);
+
+        std::vector<unsigned char> vertexStream, indexStream, file;
+        const size_t stride = MeshData::FLOATS_PER_VERTEX * sizeof(float);
+        EncodeVertexBuffer(mesh.vertices.data(), mesh.GetVertexCount(), stride, vertexStream);
+        EncodeIndexBuffer(mesh.indices.data(), mesh.indices.size(), indexStream);
+        EncodeMesh(mesh, file);
+
+        // CLN: decode repeatedly for at least 50 ms to get a stable throughput figure
+        MeshData decoded;
+        decoded.vertices.resize(mesh.vertices.size());
+        decoded.indices.resize(mesh.indices.size());
+        const size_t rawBytes = mesh.GetVertexBytes() + mesh.GetIndexBytes();
+        unsigned int iterations = 0;
+        bool valid = true;
+        std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+        do
+        {
+            valid = DecodeMesh(file.data(), file.size(), decoded.vertices.data(), decoded.indices.data()) && valid;
+            ++iterations;
+        } while (SecondsSince(start) < 0.05);
+        double seconds = SecondsSince(start);
+
+        valid = valid && memcmp(decoded.vertices.data(), mesh.vertices.data(), mesh.GetVertexBytes()) == 0 &&
+                SameTriangles(mesh.indices.data(), decoded.indices.data(), mesh.indices.size());
+        allValid = allValid && valid;
+
+        totalRaw += rawBytes;
+        totalEncoded += file.size();
+        totalDecodeBytes += (double)rawBytes * iterations;
+        totalDecodeSeconds += seconds;
+
+        out << std::setw(14) << mesh.GetVertexCount() << std::setw(11) << mesh.GetTriangleCount()
+            << std::setw(11) << rawBytes / 1024.0 << std::setw(11) << file.size() / 1024.0
+            << std::setw(8) << (double)rawBytes / file.size()
+            << std::setw(14) << (mesh.GetTriangleCount() ? indexStream.size() * 8.0 / mesh.GetTriangleCount() : 0.0)
+            << std::setw(15) << (mesh.GetVertexCount() ? (double)vertexStream.size() / mesh.GetVertexCount() : 0.0)
+            << std::setw(13) << (double)rawBytes * iterations / seconds / 1e9
+            << (valid ? "" : "  ROUND TRIP FAILED") << "\n";
+    }
+
+    out << "      total: " << totalRaw / 1024.0 << " KB -> " << totalEncoded / 1024.0 << " KB (ratio "
+        << (totalEncoded ? (double)totalRaw / totalEncoded : 0.0) << "), decode "
+        << (totalDecodeSeconds > 0.0 ? totalDecodeBytes / totalDecodeSeconds / 1e9 : 0.0) << " GB/s"
+#ifdef MESH_CODEC_SSE2
+        << " (SSE2)"
+#endif
+        << std::endl;
+    out.unsetf(std::ios::floatfield);
+    out.precision(precision);
+    return allValid;
+}
+
+
+//--------------------------------------------------------------------
+// Self-test
+//--------------------------------------------------------------------
+bool MeshCodec::SelfTest(std::ostream& out)
+{
+    bool passed = true;
+    auto check = [&out, &passed](bool condition, const std::string& what) {
+        if (!condition)
+        {
+            out << "Failed mesh codec self-test: " << what << std::endl;
+            passed = false;
+        }
+    };
+    uint64_t random = 1;
+
+    // CLN: LZ blocks: empty, shorter than a match, incompressible, long runs and repeats (overlapping matches)
+    std::vector<std::vector<unsigned char>> blocks(6);
+    blocks[1].assign(3, 7);
+    for (int i = 0; i < 10000; ++i)
+        blocks[2].push_back((unsigned char)NextRandom(random));
+    blocks[3].assign(100000, 0);
+    for (int i = 0; i < 100000; ++i)
+        blocks[4].push_back((unsigned char)("mesh codec "[i % 11]));
+    for (int i = 0; i < 200000; ++i)
+        blocks[5].push_back((unsigned char)(i % 7 == 0 ? NextRandom(random) : i / 4096));
+    for (size_t b = 0; b < blocks.size(); ++b)
+    {
+        const std::vector<unsigned char>& data = blocks[b];
+        std::vector<unsigned char> compressed;
+        Compress(data.data(), data.size(), compressed);
+        std::vector<unsigned char> decoded(data.size() + 1);
+        const bool ok = Decompress(compressed.data(), compressed.size(), decoded.data(), data.size()) &&
+                        std::equal(data.begin(), data.end(), decoded.begin());
+        check(ok, "LZ round trip of block " + std::to_string(b));
+        if (!data.empty())
+        {
+            check(!Decompress(compressed.data(), compressed.size() - 1, decoded.data(), data.size()), "truncated LZ block " + std::to_string(b) + " decoded");
+            check(!Decompress(compressed.data(), compressed.size(), decoded.data(), data.size() + 1), "LZ block " + std::to_string(b) + " decoded to the wrong size");
+        }
+    }
+
+    // CLN: index buffers: empty, one triangle, a grid (shared edges), a random soup (explicit codes), the largest index
+    std::vector<std::vector<unsigned short>> indexBuffers(5);
+    indexBuffers[1] = { 0, 1, 2 };
+    const int side = 40;
+    for (int y = 0; y < side; ++y)
+    {
+        for (int x = 0; x < side; ++x)
+        {
+            const unsigned short v = (unsigned short)(y * (side + 1) + x);
+            const unsigned short quad[6] = { v, (unsigned short)(v + 1), (unsigned short)(v + side + 1),
+                                             (unsigned short)(v + 1), (unsigned short)(v + side + 2), (unsigned short)(v + side + 1) };
+            indexBuffers[2].insert(indexBuffers[2].end(), quad, quad + 6);
+        }
+    }
+    for (int i = 0; i < 9000; ++i)
+        indexBuffers[3].push_back((unsigned short)(NextRandom(random) % 2000));
+    indexBuffers[4] = { 0, 65535, 1, 65535, 65534, 1, 2, 0, 65535 };
+    for (size_t b = 0; b < indexBuffers.size(); ++b)
+    {
+        const std::vector<unsigned short>& indices = indexBuffers[b];
+        std::vector<unsigned char> encoded;
+        EncodeIndexBuffer(indices.data(), indices.size(), encoded);
+        std::vector<unsigned short> decoded(indices.size());
+        check(DecodeIndexBuffer(decoded.data(), indices.size(), encoded.data(), encoded.size()) &&
+              SameTriangles(indices.data(), decoded.data(), indices.size()), "index round trip of buffer " + std::to_string(b));
+        if (!indices.empty())
+            check(!DecodeIndexBuffer(decoded.data(), indices.size(), encoded.data(), encoded.size() / 2), "truncated index buffer " + std::to_string(b) + " decoded");
+    }
+
+    // CLN: vertex buffers of arbitrary bit patterns (NaNs, denormals) at several strides
+    const size_t strides[] = { 4, 12, 32 };
+    const size_t counts[] = { 0, 1, 777 };
+    for (size_t stride : strides)
+    {
+        for (size_t count : counts)
+        {
+            std::vector<uint32_t> words(count * stride / 4);
+            for (size_t i = 0; i < words.size(); ++i)
+                words[i] = i % 3 == 0 ? NextRandom(random) : (uint32_t)(i * 2654435761u) >> (i % 29);
+            std::vector<unsigned char> encoded;
+            EncodeVertexBuffer(words.data(), count, stride, encoded);
+            std::vector<uint32_t> decoded(words.size() + 1);
+            const std::string name = std::to_string(count) + " vertices of stride " + std::to_string(stride);
+            check(DecodeVertexBuffer(decoded.data(), count, stride, encoded.data(), encoded.size()) &&
+                  std::equal(words.begin(), words.end(), decoded.begin()), "vertex round trip of " + name);
+            if (count > 0)
+                check(!DecodeVertexBuffer(decoded.data(), count, stride, encoded.data(), encoded.size() - 1), "truncated " + name + " decoded");
+        }
+    }
+
+    // CLN: the container, after the fetch reorder, which must keep every triangle's vertex data
+    MeshData mesh;
+    for (int i = 0; i < 2000 * (int)MeshData::FLOATS_PER_VERTEX; ++i)
+        mesh.vertices.push_back((float)(NextRandom(random) % 2001) / 1000.0f - 1.0f);
+    mesh.indices = indexBuffers[3];
+    MeshData reordered = mesh;
+    ReorderVerticesForFetch(reordered);
+    bool sameVertices = reordered.indices.size() == mesh.indices.size();
+    for (size_t i = 0; sameVertices && i < mesh.indices.size(); ++i)
+    {
+        sameVertices = memcmp(&mesh.vertices[mesh.indices[i] * MeshData::FLOATS_PER_VERTEX],
+                              &reordered.vertices[reordered.indices[i] * MeshData::FLOATS_PER_VERTEX],
+                              MeshData::FLOATS_PER_VERTEX * sizeof(float)) == 0;
+    }
+    check(sameVertices, "the fetch reorder changed a triangle's vertices");
+
+    std::vector<unsigned char> file;
+    EncodeMesh(reordered, file);
+    MeshData decoded;
+    unsigned int vertexCount = 0, indexCount = 0;
+    check(ReadHeader(file.data(), file.size(), vertexCount, indexCount) && vertexCount == reordered.GetVertexCount() &&
+          indexCount == reordered.GetIndexCount(), "the .cmesh header counts");
+    check(DecodeMesh(file.data(), file.size(), decoded) && decoded.vertices == reordered.vertices &&
+          SameTriangles(reordered.indices.data(), decoded.indices.data(), reordered.indices.size()), ".cmesh round trip");
+    check(!DecodeMesh(file.data(), file.size() - 1, decoded), "truncated .cmesh file decoded");
+
+    // CLN: sizes and counts far beyond what the input holds fail before anything is allocated for them: the size
+    //      headers of both streams, and the .cmesh counts
+    const uint32_t damagedSize = 0xfffffff0u;
+    const size_t vertexStreamBytes = Read32(&file[offsetof(CompressedMeshHeader, vertexStreamBytes)]);
+    std::vector<unsigned char> vertexStream(file.begin() + sizeof(CompressedMeshHeader),
+                                            file.begin() + sizeof(CompressedMeshHeader) + vertexStreamBytes);
+    memcpy(vertexStream.data(), &damagedSize, sizeof(damagedSize));
+    check(!DecodeVertexBuffer(decoded.vertices.data(), reordered.GetVertexCount(), MeshData::FLOATS_PER_VERTEX * sizeof(float),
+                              vertexStream.data(), vertexStream.size()), "a vertex stream with a damaged size decoded");
+    std::vector<unsigned char> indexStream;
+    EncodeIndexBuffer(indexBuffers[2].data(), indexBuffers[2].size(), indexStream);
+    memcpy(indexStream.data(), &damagedSize, sizeof(damagedSize));
+    std::vector<unsigned short> gridIndices(indexBuffers[2].size());
+    check(!DecodeIndexBuffer(gridIndices.data(), gridIndices.size(), indexStream.data(), indexStream.size()),
+          "an index stream with a damaged size decoded");
+    const size_t countOffsets[] = { offsetof(CompressedMeshHeader, vertexCount), offsetof(CompressedMeshHeader, indexCount) };
+    for (size_t offset : countOffsets)
+    {
+        std::vector<unsigned char> damagedFile = file;
+        memcpy(&damagedFile[offset], &damagedSize, sizeof(damagedSize));
+        check(!ReadHeader(damagedFile.data(), damagedFile.size(), vertexCount, indexCount) &&
+              !DecodeMesh(damagedFile.data(), damagedFile.size(), decoded), ".cmesh file with a damaged count decoded");
+    }
+    file[0] ^= 0xff;
+    check(!DecodeMesh(file.data(), file.size(), decoded), ".cmesh file with a bad magic decoded");
+
+    return passed;
+}
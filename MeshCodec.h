@@ -0,0 +1,64 @@
+//========================================================================================
+// Filename      : MeshCodec.h
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Compact on-disk format (".cmesh") for imported and generated meshes.
+//               :
+//               : Index buffers are coded triangle by triangle against a FIFO of recently
+//               : seen edges and a FIFO of recently seen vertices, so a triangle that
+//               : shares an edge with a recent one and introduces the next new vertex
+//               : costs a single byte.
+//               :
+//               : Vertex buffers are split into 32-bit channels, each channel is delta
+//               : coded against the previous vertex, and the deltas are transposed into
+//               : byte planes so the mostly-zero high bytes end up next to each other.
+//               :
+//               : Both streams are then packed with a small LZ77 block compressor. The
+//               : vertex decoder uses SSE2 where available and writes straight into the
+//               : destination, e.g. a buffer mapped with glMapBufferRange().
+//========================================================================================
+
+#ifndef MESH_CODEC_H
+#define MESH_CODEC_H
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "MeshData.h"
+
+class MeshCodec
+{
+public:
+    // index codec (triangle lists)
+    static void EncodeIndexBuffer(const unsigned short* indices, size_t indexCount, std::vector<unsigned char>& encoded);
+    static bool DecodeIndexBuffer(unsigned short* destination, size_t indexCount, const unsigned char* encoded, size_t encodedSize);
+
+    // vertex codec, stride must be a multiple of 4 bytes
+    static void EncodeVertexBuffer(const void* vertices, size_t vertexCount, size_t stride, std::vector<unsigned char>& encoded);
+    static bool DecodeVertexBuffer(void* destination, size_t vertexCount, size_t stride, const unsigned char* encoded, size_t encodedSize);
+
+    // general-purpose LZ77 block compressor used on both streams
+    static void Compress(const unsigned char* data, size_t size, std::vector<unsigned char>& compressed);
+    static bool Decompress(const unsigned char* compressed, size_t compressedSize, unsigned char* destination, size_t size);
+
+    // renumbers vertices in order of first use, which lets most triangles use the cheap "next vertex" code
+    static void ReorderVerticesForFetch(MeshData& mesh);
+
+    // .cmesh container
+    static void EncodeMesh(const MeshData& mesh, std::vector<unsigned char>& file);
+    static bool ReadHeader(const unsigned char* file, size_t fileSize, unsigned int& vertexCount, unsigned int& indexCount);
+    static bool DecodeMesh(const unsigned char* file, size_t fileSize, float* vertexDestination, unsigned short* indexDestination);
+    static bool DecodeMesh(const unsigned char* file, size_t fileSize, MeshData& mesh);
+    static bool WriteFile(const std::string& filename, const MeshData& mesh);
+
+    // encodes and decodes every mesh, verifies the round trip, and reports ratio and decode throughput
+    static bool Benchmark(const std::vector<MeshData>& meshes, std::ostream& out);
+
+    // round trips of edge cases (empty, tiny, incompressible and extreme buffers) through every codec, and checks that
+    // truncated or damaged input, including sizes and counts beyond the input, is rejected (--self-test)
+    static bool SelfTest(std::ostream& out);
+};
+
+#endif
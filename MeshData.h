@@ -0,0 +1,39 @@
+//========================================================================================
+// Filename      : MeshData.h
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : CPU-side copy of a mesh in the layout GLObject::CreateMesh() uploads:
+//               : interleaved vertices of 8 floats (x, y, z, nx, ny, nz, s, t) and
+//               : GLushort triangle indices. Shared by the modules that produce or
+//               : transform geometry before it reaches the GPU.
+//========================================================================================
+
+#ifndef MESH_DATA_H
+#define MESH_DATA_H
+
+#include <vector>
+
+struct MeshData
+{
+    static const unsigned int FLOATS_PER_VERTEX = 8;    // V/N/T
+    static const unsigned int MAX_VERTICES = 65536;     // indices are unsigned short
+
+    std::vector<float> vertices;
+    std::vector<unsigned short> indices;
+
+    unsigned int GetVertexCount() const     { return (unsigned int)vertices.size() / FLOATS_PER_VERTEX; }
+    unsigned int GetIndexCount() const      { return (unsigned int)indices.size(); }
+    unsigned int GetTriangleCount() const   { return (unsigned int)indices.size() / 3; }
+    size_t GetVertexBytes() const           { return vertices.size() * sizeof(float); }
+    size_t GetIndexBytes() const            { return indices.size() * sizeof(unsigned short); }
+
+    // CLN: the Sphere/Cylinder generators already store their "vertices" interleaved as V/N/T
+    void Assign(const float* interleaved, size_t floatCount, const unsigned short* triangleIndices, size_t indexCount)
+    {
+        vertices.assign(interleaved, interleaved + floatCount);
+        indices.assign(triangleIndices, triangleIndices + indexCount);
+    }
+};
+
+#endif
@@ -0,0 +1,1261 @@
+//========================================================================================
+// Filename      : MeshImporter.cpp
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Implementation of the MeshImporter class (see MeshImporter.h)
+//               :
+//               : OBJ import runs in three passes:
+//               :    1. parse  : each chunk collects its own v/vt/vn arrays and face corners
+//               :                (relative indices are kept chunk-local), in parallel
+//               :    2. resolve: corners are turned into file-global indices once the
+//               :                per-chunk counts are known, in parallel
+//               :    3. weld   : unique v/vt/vn corners become interleaved vertices, and
+//               :                a new part is started whenever a part would exceed 65536
+//========================================================================================
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "MeshImporter.h"
+#include "MappedFile.h"
+#include "WorkerPool.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MESH_IMPORTER_SSE2
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+namespace
+{
+    const size_t OBJ_MIN_CHUNK_BYTES = 1024 * 1024;     // smaller files aren't worth splitting further
+    const int32_t NO_INDEX = INT32_MIN;
+
+    double SecondsSince(std::chrono::high_resolution_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+
+    bool IsSpace(char c)    { return c == ' ' || c == '\t' || c == '\r'; }
+    bool IsDigit(char c)    { return c >= '0' && c <= '9'; }
+
+    const char* SkipSpaces(const char* p, const char* end)
+    {
+        while (p < end && IsSpace(*p))
+            ++p;
+        return p;
+    }
+
+    // returns the position of the next '\n', or end
+    const char* FindLineEnd(const char* p, const char* end)
+    {
+#ifdef MESH_IMPORTER_SSE2
+        const __m128i newline = _mm_set1_epi8('\n');
+        while (end - p >= 16)
+        {
+            int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)p), newline));
+            if (mask != 0)
+            {
+#ifdef _MSC_VER
+                unsigned long bit;
+                _BitScanForward(&bit, (unsigned long)mask);
+                return p + bit;
+#else
+                return p + __builtin_ctz((unsigned int)mask);
+#endif
+            }
+            p += 16;
+        }
+#endif
+        const void* found = memchr(p, '\n', (size_t)(end - p));
+        return found ? (const char*)found : end;
+    }
+
+    // CLN: Decimal to double without strtod(): up to 19 significant digits are collected in an integer
+    //      and scaled by an exact power of ten, which is exact for integers and correctly rounded for the
+    //      short decimals found in model files. Longer exponents fall back to pow()
+    const char* ParseDouble(const char* p, const char* end, double& value)
+    {
+        static const double powersOfTen[] = {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+        };
+
+        p = SkipSpaces(p, end);
+        bool negative = false;
+        if (p < end && (*p == '-' || *p == '+'))
+            negative = *p++ == '-';
+
+        uint64_t mantissa = 0;
+        int exponent = 0;
+        int significantDigits = 0;
+        bool anyDigits = false;
+
+        for (; p < end && IsDigit(*p); ++p)
+        {
+            anyDigits = true;
+            if (significantDigits < 19)
+            {
+                mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+                significantDigits += mantissa != 0;
+            }
+            else
+                ++exponent;
+        }
+        if (p < end && *p == '.')
+        {
+            for (++p; p < end && IsDigit(*p); ++p)
+            {
+                anyDigits = true;
+                if (significantDigits < 19)
+                {
+                    mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+                    significantDigits += mantissa != 0;
+                    --exponent;
+                }
+            }
+        }
+        if (!anyDigits)
+            return nullptr;
+
+        if (p < end && (*p == 'e' || *p == 'E'))
+        {
+            const char* q = p + 1;
+            bool negativeExponent = false;
+            if (q < end && (*q == '-' || *q == '+'))
+                negativeExponent = *q++ == '-';
+            if (q < end && IsDigit(*q))
+            {
+                int explicitExponent = 0;
+                for (; q < end && IsDigit(*q); ++q)
+                    explicitExponent = std::min(explicitExponent * 10 + (*q - '0'), 100000);
+                exponent += negativeExponent ? -explicitExponent : explicitExponent;
+                p = q;
+            }
+        }
+
+        double result = (double)mantissa;
+        if (mantissa == 0)
+            result = 0.0;
+        else if (exponent >= 0 && exponent <= 22)
+            result *= powersOfTen[exponent];
+        else if (exponent < 0 && exponent >= -22)
+            result /= powersOfTen[-exponent];
+        else
+            result *= pow(10.0, exponent);
+
+        value = negative ? -result : result;
+        return p;
+    }
+
+    const char* ParseIndex(const char* p, const char* end, int32_t& value)
+    {
+        bool negative = false;
+        if (p < end && (*p == '-' || *p == '+'))
+            negative = *p++ == '-';
+        if (p >= end || !IsDigit(*p))
+            return nullptr;
+
+        int64_t result = 0;
+        for (; p < end && IsDigit(*p); ++p)
+            result = std::min<int64_t>(result * 10 + (*p - '0'), INT32_MAX);
+        value = negative ? -(int32_t)result : (int32_t)result;
+        return p;
+    }
+
+    void AddTriangleNormal(std::vector<float>& normals, const float* positions, const unsigned int* corners)
+    {
+        const float* a = positions + corners[0] * 3;
+        const float* b = positions + corners[1] * 3;
+        const float* c = positions + corners[2] * 3;
+        const float e1[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+        const float e2[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+
+        // CLN: the unnormalized cross product weights each face by its area
+        const float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+        for (int k = 0; k < 3; ++k)
+        {
+            normals[corners[k] * 3] += n[0];
+            normals[corners[k] * 3 + 1] += n[1];
+            normals[corners[k] * 3 + 2] += n[2];
+        }
+    }
+
+    void NormalizeAll(std::vector<float>& normals)
+    {
+        for (size_t i = 0; i + 2 < normals.size(); i += 3)
+        {
+            float length = sqrtf(normals[i] * normals[i] + normals[i + 1] * normals[i + 1] + normals[i + 2] * normals[i + 2]);
+            if (length > 0.0f)
+            {
+                normals[i] /= length;
+                normals[i + 1] /= length;
+                normals[i + 2] /= length;
+            }
+            else
+            {
+                normals[i] = normals[i + 2] = 0.0f;
+                normals[i + 1] = 1.0f;
+            }
+        }
+    }
+
+
+    //--------------------------------------------------------------------
+    // OBJ
+    //--------------------------------------------------------------------
+    struct ObjCorner
+    {
+        int32_t v, t, n;
+    };
+
+    // CLN: Open-addressing table from v/vt/vn corner to part-local vertex index. Sized for twice the
+    //      vertices of a full part, and emptied for the next part by bumping the generation, not clearing
+    class ObjWeldTable
+    {
+    public:
+        ObjWeldTable() : slots(TABLE_SIZE), generation(1) {}
+
+        void Reset()    { ++generation; }
+
+        // returns true if the corner was added with the given index, false if found (index set to the existing one)
+        bool Insert(const ObjCorner& corner, unsigned short& index)
+        {
+            uint64_t hash = (uint64_t)(uint32_t)corner.v * 0x9E3779B97F4A7C15ull ^ (uint64_t)(uint32_t)corner.t * 0xC2B2AE3D27D4EB4Full ^
+                            (uint64_t)(uint32_t)corner.n * 0x165667B19E3779F9ull;
+            for (size_t i = (size_t)(hash >> 40) & (TABLE_SIZE - 1);; i = (i + 1) & (TABLE_SIZE - 1))
+            {
+                Slot& slot = slots[i];
+                if (slot.generation != generation)
+                {
+                    slot.corner = corner;
+                    slot.generation = generation;
+                    slot.index = index;
+                    return true;
+                }
+                if (slot.corner.v == corner.v && slot.corner.t == corner.t && slot.corner.n == corner.n)
+                {
+                    index = slot.index;
+                    return false;
+                }
+            }
+        }
+
+    private:
+        static const size_t TABLE_SIZE = MeshData::MAX_VERTICES * 2;
+
+        struct Slot
+        {
+            ObjCorner corner;
+            uint32_t generation = 0;
+            unsigned short index = 0;
+        };
+
+        std::vector<Slot> slots;
+        uint32_t generation;
+    };
+
+    enum ObjRelativeFlags
+    {
+        RELATIVE_V = 1,
+        RELATIVE_T = 2,
+        RELATIVE_N = 4
+    };
+
+    struct ObjChunk
+    {
+        const char* begin;
+        const char* end;
+        std::vector<float> positions;       // 3 per v
+        std::vector<float> texCoords;       // 2 per vt
+        std::vector<float> normals;         // 3 per vn
+        std::vector<ObjCorner> corners;     // 3 per triangle, negative (relative) indices made chunk-local
+        std::vector<unsigned char> relative;
+        size_t positionBase, texCoordBase, normalBase, cornerBase;
+        bool failed;
+    };
+
+    // Reads one "v/t/n" face corner, converting 1-based / negative indices to 0-based ones
+    const char* ParseCorner(const char* p, const char* end, const ObjChunk& chunk, ObjCorner& corner, unsigned char& relative)
+    {
+        int32_t values[3] = { NO_INDEX, NO_INDEX, NO_INDEX };
+        const size_t counts[3] = { chunk.positions.size() / 3, chunk.texCoords.size() / 2, chunk.normals.size() / 3 };
+
+        p = ParseIndex(p, end, values[0]);
+        if (!p)
+            return nullptr;
+        for (int k = 1; k < 3 && p < end && *p == '/'; ++k)
+        {
+            ++p;
+            if (p < end && *p != '/' && !IsSpace(*p))
+            {
+                p = ParseIndex(p, end, values[k]);
+                if (!p)
+                    return nullptr;
+            }
+        }
+
+        relative = 0;
+        for (int k = 0; k < 3; ++k)
+        {
+            if (values[k] == NO_INDEX)
+                continue;
+            if (values[k] > 0)
+                values[k] -= 1;
+            else if (values[k] < 0)
+            {
+                values[k] += (int32_t)counts[k];    // CLN: -1 is the last one so far; may point into an earlier chunk
+                relative |= (unsigned char)(1 << k);
+            }
+            else
+                return nullptr;     // index 0 is invalid in OBJ
+        }
+
+        corner.v = values[0];
+        corner.t = values[1];
+        corner.n = values[2];
+        return p;
+    }
+
+    const char* ParseFloats(const char* p, const char* end, float* values, int required, int optional)
+    {
+        for (int k = 0; k < required + optional; ++k)
+        {
+            const char* next = MeshImporter::ParseFloat(p, end, values[k]);
+            if (!next)
+                return k < required ? nullptr : p;
+            p = next;
+        }
+        return p;
+    }
+
+    void ParseObjChunk(ObjChunk& chunk)
+    {
+        std::vector<ObjCorner> polygon;
+        std::vector<unsigned char> polygonRelative;
+        const char* p = chunk.begin;
+
+        while (p < chunk.end && !chunk.failed)
+        {
+            const char* lineEnd = FindLineEnd(p, chunk.end);
+            const char* q = SkipSpaces(p, lineEnd);
+            p = lineEnd + 1;
+
+            if (lineEnd - q < 2)
+                continue;
+
+            if (q[0] == 'v')
+            {
+                float values[3] = { 0.0f, 0.0f, 0.0f };
+                if (IsSpace(q[1]))
+                {
+                    chunk.failed = !ParseFloats(q + 2, lineEnd, values, 3, 0);
+                    chunk.positions.insert(chunk.positions.end(), values, values + 3);
+                }
+                else if (q[1] == 't')
+                {
+                    chunk.failed = !ParseFloats(q + 2, lineEnd, values, 1, 1);
+                    chunk.texCoords.insert(chunk.texCoords.end(), values, values + 2);
+                }
+                else if (q[1] == 'n')
+                {
+                    chunk.failed = !ParseFloats(q + 2, lineEnd, values, 3, 0);
+                    chunk.normals.insert(chunk.normals.end(), values, values + 3);
+                }
+            }
+            else if (q[0] == 'f' && IsSpace(q[1]))
+            {
+                polygon.clear();
+                polygonRelative.clear();
+                for (q = SkipSpaces(q + 2, lineEnd); q < lineEnd; q = SkipSpaces(q, lineEnd))
+                {
+                    ObjCorner corner;
+                    unsigned char relative;
+                    q = ParseCorner(q, lineEnd, chunk, corner, relative);
+                    if (!q)
+                    {
+                        chunk.failed = true;
+                        break;
+                    }
+                    polygon.push_back(corner);
+                    polygonRelative.push_back(relative);
+                }
+
+                // CLN: polygons are triangulated as a fan around their first corner
+                for (size_t k = 1; k + 1 < polygon.size(); ++k)
+                {
+                    const size_t fan[3] = { 0, k, k + 1 };
+                    for (size_t c : fan)
+                    {
+                        chunk.corners.push_back(polygon[c]);
+                        chunk.relative.push_back(polygonRelative[c]);
+                    }
+                }
+            }
+            // CLN: everything else (comments, o/g/s, usemtl, mtllib, lines, points) is skipped
+        }
+    }
+
+    bool ResolveObjChunk(ObjChunk& chunk, ObjCorner* resolved, size_t positionCount, size_t texCoordCount, size_t normalCount)
+    {
+        for (size_t i = 0; i < chunk.corners.size(); ++i)
+        {
+            ObjCorner corner = chunk.corners[i];
+            const unsigned char relative = chunk.relative[i];
+            if (relative & RELATIVE_V)
+                corner.v += (int32_t)chunk.positionBase;
+            if (relative & RELATIVE_T)
+                corner.t += (int32_t)chunk.texCoordBase;
+            if (relative & RELATIVE_N)
+                corner.n += (int32_t)chunk.normalBase;
+
+            if (corner.v < 0 || (size_t)corner.v >= positionCount ||
+                (corner.t != NO_INDEX && (corner.t < 0 || (size_t)corner.t >= texCoordCount)) ||
+                (corner.n != NO_INDEX && (corner.n < 0 || (size_t)corner.n >= normalCount)))
+                return false;
+            resolved[i] = corner;
+        }
+        return true;
+    }
+
+    template <typename Container>
+    void Concatenate(const std::vector<ObjChunk>& chunks, Container ObjChunk::* member, Container& all)
+    {
+        size_t total = 0;
+        for (const ObjChunk& chunk : chunks)
+            total += (chunk.*member).size();
+        all.reserve(total);
+        for (const ObjChunk& chunk : chunks)
+            all.insert(all.end(), (chunk.*member).begin(), (chunk.*member).end());
+    }
+
+
+    //--------------------------------------------------------------------
+    // glTF
+    //--------------------------------------------------------------------
+    struct JsonValue
+    {
+        enum Type { JSON_NULL, JSON_BOOL, JSON_NUMBER, JSON_STRING, JSON_ARRAY, JSON_OBJECT };
+
+        Type type = JSON_NULL;
+        double number = 0.0;
+        std::string text;
+        std::vector<JsonValue> items;       // array elements, or object values
+        std::vector<std::string> keys;      // object keys
+
+        const JsonValue* Find(const char* key) const
+        {
+            for (size_t i = 0; i < keys.size(); ++i)
+            {
+                if (keys[i] == key)
+                    return &items[i];
+            }
+            return nullptr;
+        }
+
+        const JsonValue* At(double index) const
+        {
+            if (type != JSON_ARRAY || index < 0.0 || index >= (double)items.size())
+                return nullptr;
+            return &items[(size_t)index];
+        }
+
+        double GetNumber(const char* key, double fallback) const
+        {
+            const JsonValue* value = Find(key);
+            return value && value->type == JSON_NUMBER ? value->number : fallback;
+        }
+
+        std::string GetString(const char* key) const
+        {
+            const JsonValue* value = Find(key);
+            return value && value->type == JSON_STRING ? value->text : std::string();
+        }
+    };
+
+    // Minimal recursive-descent JSON reader, enough for glTF documents
+    class JsonParser
+    {
+    public:
+        JsonParser(const char* begin, const char* end) : p(begin), end(end) {}
+
+        bool Parse(JsonValue& value, int depth = 0)
+        {
+            p = SkipWhitespace(p);
+            if (p >= end || depth > 64)
+                return false;
+
+            switch (*p)
+            {
+            case '{':
+                value.type = JsonValue::JSON_OBJECT;
+                for (++p;;)
+                {
+                    p = SkipWhitespace(p);
+                    if (p < end && *p == '}' && value.keys.empty())
+                        return ++p, true;
+                    std::string key;
+                    if (!ParseString(key))
+                        return false;
+                    p = SkipWhitespace(p);
+                    if (p >= end || *p++ != ':')
+                        return false;
+                    value.keys.push_back(key);
+                    value.items.push_back(JsonValue());
+                    if (!Parse(value.items.back(), depth + 1))
+                        return false;
+                    p = SkipWhitespace(p);
+                    if (p < end && *p == ',')
+                        ++p;
+                    else if (p < end && *p == '}')
+                        return ++p, true;
+                    else
+                        return false;
+                }
+            case '[':
+                value.type = JsonValue::JSON_ARRAY;
+                for (++p;;)
+                {
+                    p = SkipWhitespace(p);
+                    if (p < end && *p == ']' && value.items.empty())
+                        return ++p, true;
+                    value.items.push_back(JsonValue());
+                    if (!Parse(value.items.back(), depth + 1))
+                        return false;
+                    p = SkipWhitespace(p);
+                    if (p < end && *p == ',')
+                        ++p;
+                    else if (p < end && *p == ']')
+                        return ++p, true;
+                    else
+                        return false;
+                }
+            case '"':
+                value.type = JsonValue::JSON_STRING;
+                return ParseString(value.text);
+            case 't':
+                value.type = JsonValue::JSON_BOOL;
+                value.number = 1.0;
+                return ParseLiteral("true");
+            case 'f':
+                value.type = JsonValue::JSON_BOOL;
+                return ParseLiteral("false");
+            case 'n':
+                return ParseLiteral("null");
+            default:
+                value.type = JsonValue::JSON_NUMBER;
+                p = ParseDouble(p, end, value.number);
+                return p != nullptr;
+            }
+        }
+
+    private:
+        const char* SkipWhitespace(const char* q) const
+        {
+            while (q < end && (*q == ' ' || *q == '\t' || *q == '\r' || *q == '\n'))
+                ++q;
+            return q;
+        }
+
+        bool ParseLiteral(const char* literal)
+        {
+            size_t length = strlen(literal);
+            if ((size_t)(end - p) < length || strncmp(p, literal, length) != 0)
+                return false;
+            p += length;
+            return true;
+        }
+
+        // CLN: escapes are decoded except \u, which becomes '?' (glTF keys and URIs we use are plain ASCII)
+        bool ParseString(std::string& text)
+        {
+            if (p >= end || *p != '"')
+                return false;
+            for (++p; p < end; ++p)
+            {
+                if (*p == '"')
+                    return ++p, true;
+                if (*p != '\\')
+                {
+                    text += *p;
+                    continue;
+                }
+                if (++p >= end)
+                    return false;
+                switch (*p)
+                {
+                case 'n': text += '\n'; break;
+                case 't': text += '\t'; break;
+                case 'r': text += '\r'; break;
+                case 'b': text += '\b'; break;
+                case 'f': text += '\f'; break;
+                case 'u':
+                    if (end - p < 5)
+                        return false;
+                    p += 4;
+                    text += '?';
+                    break;
+                default: text += *p; break;
+                }
+            }
+            return false;
+        }
+
+        const char* p;
+        const char* end;
+    };
+
+    struct BufferRange
+    {
+        const unsigned char* data;
+        size_t size;
+    };
+
+    // Typed, strided window into a mapped glTF buffer
+    struct AccessorView
+    {
+        const unsigned char* data = nullptr;
+        size_t count = 0;
+        size_t stride = 0;
+        int componentType = 0;
+        unsigned int components = 0;
+        bool normalized = false;
+
+        float ReadFloat(size_t i, unsigned int c) const
+        {
+            const unsigned char* element = data + i * stride;
+            switch (componentType)
+            {
+            case 5126: { float v; memcpy(&v, element + c * 4, 4); return v; }
+            case 5121: return normalized ? element[c] / 255.0f : element[c];
+            case 5120: { signed char v = (signed char)element[c]; return normalized ? std::max(v / 127.0f, -1.0f) : v; }
+            case 5123: { unsigned short v; memcpy(&v, element + c * 2, 2); return normalized ? v / 65535.0f : v; }
+            case 5122: { short v; memcpy(&v, element + c * 2, 2); return normalized ? std::max(v / 32767.0f, -1.0f) : v; }
+            case 5125: { uint32_t v; memcpy(&v, element + c * 4, 4); return (float)v; }
+            default: return 0.0f;
+            }
+        }
+
+        uint32_t ReadIndex(size_t i) const
+        {
+            const unsigned char* element = data + i * stride;
+            switch (componentType)
+            {
+            case 5121: return element[0];
+            case 5123: { unsigned short v; memcpy(&v, element, 2); return v; }
+            case 5125: { uint32_t v; memcpy(&v, element, 4); return v; }
+            default: return UINT32_MAX;
+            }
+        }
+    };
+
+    size_t ComponentSize(int componentType)
+    {
+        switch (componentType)
+        {
+        case 5120: case 5121: return 1;
+        case 5122: case 5123: return 2;
+        case 5125: case 5126: return 4;
+        default: return 0;
+        }
+    }
+
+    unsigned int ComponentCount(const std::string& type)
+    {
+        if (type == "SCALAR") return 1;
+        if (type == "VEC2") return 2;
+        if (type == "VEC3") return 3;
+        if (type == "VEC4") return 4;
+        return 0;
+    }
+
+    bool GetAccessor(const JsonValue& root, const std::vector<BufferRange>& buffers, double accessorIndex, AccessorView& view)
+    {
+        const JsonValue* accessors = root.Find("accessors");
+        const JsonValue* accessor = accessors ? accessors->At(accessorIndex) : nullptr;
+        const JsonValue* bufferViews = root.Find("bufferViews");
+        if (!accessor || !bufferViews)
+            return false;
+
+        // CLN: sparse accessors and accessors without a bufferView (all zeros) are not supported
+        const JsonValue* bufferView = bufferViews->At(accessor->GetNumber("bufferView", -1.0));
+        if (!bufferView || accessor->Find("sparse"))
+            return false;
+
+        const double bufferIndex = bufferView->GetNumber("buffer", -1.0);
+        if (bufferIndex < 0.0 || bufferIndex >= (double)buffers.size())
+            return false;
+        const BufferRange& buffer = buffers[(size_t)bufferIndex];
+
+        view.componentType = (int)accessor->GetNumber("componentType", 0.0);
+        view.components = ComponentCount(accessor->GetString("type"));
+        view.count = (size_t)accessor->GetNumber("count", 0.0);
+        view.normalized = accessor->Find("normalized") && accessor->Find("normalized")->number != 0.0;
+
+        const size_t elementSize = ComponentSize(view.componentType) * view.components;
+        const size_t viewOffset = (size_t)bufferView->GetNumber("byteOffset", 0.0);
+        const size_t viewLength = (size_t)bufferView->GetNumber("byteLength", 0.0);
+        const size_t accessorOffset = (size_t)accessor->GetNumber("byteOffset", 0.0);
+        view.stride = (size_t)bufferView->GetNumber("byteStride", 0.0);
+        if (view.stride == 0)
+            view.stride = elementSize;
+
+        if (elementSize == 0 || view.stride < elementSize || viewOffset > buffer.size || viewLength > buffer.size - viewOffset)
+            return false;
+        if (view.count > 0 && (accessorOffset > viewLength || viewLength - accessorOffset < elementSize ||
+                               (viewLength - accessorOffset - elementSize) / view.stride < view.count - 1))
+            return false;
+
+        view.data = buffer.data + viewOffset + accessorOffset;
+        return true;
+    }
+
+    // One glTF primitive (triangle list), converted into one or more parts
+    bool ImportPrimitive(const JsonValue& root, const std::vector<BufferRange>& buffers, const JsonValue& primitive, std::vector<MeshData>& parts)
+    {
+        const JsonValue* attributes = primitive.Find("attributes");
+        if (!attributes || primitive.GetNumber("mode", 4.0) != 4.0)
+            return true;    // CLN: points and lines are skipped, not an error
+
+        AccessorView positions, normals, texCoords, indices;
+        if (!GetAccessor(root, buffers, attributes->GetNumber("POSITION", -1.0), positions) ||
+            positions.components != 3 || positions.componentType != 5126)
+            return false;
+
+        const bool hasNormals = attributes->Find("NORMAL") != nullptr;
+        const bool hasTexCoords = attributes->Find("TEXCOORD_0") != nullptr;
+        const bool hasIndices = primitive.Find("indices") != nullptr;
+        if ((hasNormals && (!GetAccessor(root, buffers, attributes->GetNumber("NORMAL", -1.0), normals) || normals.components != 3 || normals.count != positions.count)) ||
+            (hasTexCoords && (!GetAccessor(root, buffers, attributes->GetNumber("TEXCOORD_0", -1.0), texCoords) || texCoords.components != 2 || texCoords.count != positions.count)) ||
+            (hasIndices && (!GetAccessor(root, buffers, primitive.GetNumber("indices", -1.0), indices) || indices.components != 1 || indices.componentType == 5126)))
+            return false;
+
+        const size_t vertexCount = positions.count;
+        const size_t cornerCount = hasIndices ? indices.count : vertexCount;
+        std::vector<unsigned int> triangleCorners(cornerCount - cornerCount % 3);
+        for (size_t i = 0; i < triangleCorners.size(); ++i)
+        {
+            triangleCorners[i] = hasIndices ? indices.ReadIndex(i) : (unsigned int)i;
+            if (triangleCorners[i] >= vertexCount)
+                return false;
+        }
+
+        // CLN: positions are always float VEC3, so they can be read in place for the generated normals
+        std::vector<float> generatedNormals;
+        std::vector<float> packedPositions;
+        if (!hasNormals)
+        {
+            packedPositions.resize(vertexCount * 3);
+            for (size_t i = 0; i < vertexCount; ++i)
+                memcpy(&packedPositions[i * 3], positions.data + i * positions.stride, 3 * sizeof(float));
+            generatedNormals.assign(vertexCount * 3, 0.0f);
+            for (size_t t = 0; t < triangleCorners.size(); t += 3)
+                AddTriangleNormal(generatedNormals, packedPositions.data(), &triangleCorners[t]);
+            NormalizeAll(generatedNormals);
+        }
+
+        auto appendVertex = [&](MeshData& part, size_t i) {
+            float vertex[MeshData::FLOATS_PER_VERTEX];
+            memcpy(vertex, positions.data + i * positions.stride, 3 * sizeof(float));
+            for (unsigned int c = 0; c < 3; ++c)
+                vertex[3 + c] = hasNormals ? normals.ReadFloat(i, c) : generatedNormals[i * 3 + c];
+            // CLN: glTF puts the texture origin at the top left, OpenGL at the bottom left
+            vertex[6] = hasTexCoords ? texCoords.ReadFloat(i, 0) : 0.0f;
+            vertex[7] = hasTexCoords ? 1.0f - texCoords.ReadFloat(i, 1) : 0.0f;
+            part.vertices.insert(part.vertices.end(), vertex, vertex + MeshData::FLOATS_PER_VERTEX);
+        };
+
+        if (vertexCount <= MeshData::MAX_VERTICES)
+        {
+            parts.push_back(MeshData());
+            MeshData& part = parts.back();
+            part.vertices.reserve(vertexCount * MeshData::FLOATS_PER_VERTEX);
+            for (size_t i = 0; i < vertexCount; ++i)
+                appendVertex(part, i);
+            part.indices.assign(triangleCorners.begin(), triangleCorners.end());
+            return true;
+        }
+
+        // CLN: too many vertices for unsigned short indices: split by triangle, copying the vertices each part uses
+        std::vector<int32_t> remap(vertexCount, -1);
+        std::vector<unsigned int> used;
+        MeshData* part = nullptr;
+        for (size_t t = 0; t < triangleCorners.size(); t += 3)
+        {
+            if (!part || part->GetVertexCount() + 3 > MeshData::MAX_VERTICES)
+            {
+                for (unsigned int v : used)
+                    remap[v] = -1;
+                used.clear();
+                parts.push_back(MeshData());
+                part = &parts.back();
+            }
+            for (int k = 0; k < 3; ++k)
+            {
+                const unsigned int v = triangleCorners[t + k];
+                if (remap[v] < 0)
+                {
+                    remap[v] = (int32_t)part->GetVertexCount();
+                    used.push_back(v);
+                    appendVertex(*part, v);
+                }
+                part->indices.push_back((unsigned short)remap[v]);
+            }
+        }
+        return true;
+    }
+
+    std::string DirectoryOf(const std::string& filename)
+    {
+        size_t slash = filename.find_last_of("/\\");
+        return slash == std::string::npos ? std::string() : filename.substr(0, slash + 1);
+    }
+}
+
+
+bool MeshImporter::Import(const std::string& filename, WorkerPool& pool, std::vector<MeshData>& parts, ImportStats& stats)
+{
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+    stats = ImportStats();
+    parts.clear();
+
+    MappedFile file;
+    if (!file.Open(filename))
+    {
+        std::cout << "Failed to open model file " << filename << std::endl;
+        return false;
+    }
+    stats.fileBytes = file.GetSize();
+
+    std::string extension = filename.substr(filename.find_last_of('.') + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return (char)tolower(c); });
+
+    bool imported;
+    if (extension == "obj")
+        imported = ImportObj(file, pool, parts, stats);
+    else if (extension == "glb" || extension == "gltf")
+        imported = ImportGltf(filename, file, pool, parts, stats);
+    else
+    {
+        std::cout << "Failed to import " << filename << ": unknown model format" << std::endl;
+        return false;
+    }
+
+    if (!imported)
+    {
+        std::cout << "Failed to import " << filename << std::endl;
+        parts.clear();
+        return false;
+    }
+
+    for (const MeshData& part : parts)
+    {
+        stats.vertices += part.GetVertexCount();
+        stats.triangles += part.GetTriangleCount();
+    }
+    stats.parts = parts.size();
+    stats.seconds = SecondsSince(start);
+    return true;
+}
+
+
+bool MeshImporter::ImportObj(const MappedFile& file, WorkerPool& pool, std::vector<MeshData>& parts, ImportStats& stats)
+{
+    return ImportObjText((const char*)file.GetData(), file.GetSize(), OBJ_MIN_CHUNK_BYTES, pool, parts, stats);
+}
+
+
+bool MeshImporter::ImportObjText(const char* text, size_t size, size_t minChunkBytes, WorkerPool& pool, std::vector<MeshData>& parts,
+                                 ImportStats& stats)
+{
+    const char* textEnd = text + size;
+
+    // CLN: split into line-aligned chunks, a few per thread so uneven chunks still balance out
+    size_t chunkCount = std::max<size_t>(1, std::min<size_t>(size / minChunkBytes, (pool.GetWorkerCount() + 1) * 4));
+    std::vector<ObjChunk> chunks(chunkCount);
+    const char* chunkBegin = text;
+    for (size_t c = 0; c < chunkCount; ++c)
+    {
+        const char* chunkEnd = c + 1 == chunkCount ? textEnd : text + size / chunkCount * (c + 1);
+        if (chunkEnd < chunkBegin)
+            chunkEnd = chunkBegin;
+        if (chunkEnd < textEnd)
+            chunkEnd = std::min(FindLineEnd(chunkEnd, textEnd) + 1, textEnd);
+
+        chunks[c].begin = chunkBegin;
+        chunks[c].end = chunkEnd;
+        chunks[c].failed = false;
+        chunkBegin = chunkEnd;
+    }
+
+    stats.chunks = (unsigned int)chunkCount;
+    stats.threads = pool.ParallelFor(chunkCount, [&chunks](size_t c) { ParseObjChunk(chunks[c]); });
+
+    size_t positionCount = 0, texCoordCount = 0, normalCount = 0, cornerCount = 0;
+    for (ObjChunk& chunk : chunks)
+    {
+        if (chunk.failed)
+        {
+            std::cout << "Failed to parse OBJ data at byte " << chunk.begin - text << std::endl;
+            return false;
+        }
+        chunk.positionBase = positionCount;
+        chunk.texCoordBase = texCoordCount;
+        chunk.normalBase = normalCount;
+        chunk.cornerBase = cornerCount;
+        positionCount += chunk.positions.size() / 3;
+        texCoordCount += chunk.texCoords.size() / 2;
+        normalCount += chunk.normals.size() / 3;
+        cornerCount += chunk.corners.size();
+    }
+
+    std::vector<ObjCorner> corners(cornerCount);
+    std::atomic<bool> indicesValid(true);
+    pool.ParallelFor(chunkCount, [&](size_t c) {
+        if (!ResolveObjChunk(chunks[c], corners.data() + chunks[c].cornerBase, positionCount, texCoordCount, normalCount))
+            indicesValid = false;
+        std::vector<ObjCorner>().swap(chunks[c].corners);
+        std::vector<unsigned char>().swap(chunks[c].relative);
+    });
+    if (!indicesValid)
+    {
+        std::cout << "Failed to import OBJ: face index out of range" << std::endl;
+        return false;
+    }
+
+    std::vector<float> positions, texCoords, normals;
+    Concatenate(chunks, &ObjChunk::positions, positions);
+    Concatenate(chunks, &ObjChunk::texCoords, texCoords);
+    Concatenate(chunks, &ObjChunk::normals, normals);
+    chunks.clear();
+
+    // CLN: corners without a normal get a smooth normal of their position, appended after the file's normals
+    bool needsNormals = false;
+    for (const ObjCorner& corner : corners)
+        needsNormals = needsNormals || corner.n == NO_INDEX;
+    if (needsNormals)
+    {
+        std::vector<float> generated(positionCount * 3, 0.0f);
+        for (size_t t = 0; t + 2 < corners.size(); t += 3)
+        {
+            if (corners[t].n == NO_INDEX || corners[t + 1].n == NO_INDEX || corners[t + 2].n == NO_INDEX)
+            {
+                const unsigned int triangle[3] = { (unsigned int)corners[t].v, (unsigned int)corners[t + 1].v, (unsigned int)corners[t + 2].v };
+                AddTriangleNormal(generated, positions.data(), triangle);
+            }
+        }
+        NormalizeAll(generated);
+        normals.insert(normals.end(), generated.begin(), generated.end());
+        for (ObjCorner& corner : corners)
+        {
+            if (corner.n == NO_INDEX)
+                corner.n = (int32_t)(normalCount + corner.v);
+        }
+    }
+
+    // CLN: weld identical v/vt/vn corners into one vertex; start a new part before a triangle could overflow the indices
+    ObjWeldTable welded;
+    MeshData* part = nullptr;
+    for (size_t t = 0; t + 2 < corners.size(); t += 3)
+    {
+        if (!part || part->GetVertexCount() + 3 > MeshData::MAX_VERTICES)
+        {
+            parts.push_back(MeshData());
+            part = &parts.back();
+            welded.Reset();
+        }
+        for (size_t k = t; k < t + 3; ++k)
+        {
+            const ObjCorner& corner = corners[k];
+            unsigned short index = (unsigned short)part->GetVertexCount();
+            if (welded.Insert(corner, index))
+            {
+                const float* position = &positions[corner.v * 3];
+                const float* normal = &normals[corner.n * 3];
+                const float vertex[MeshData::FLOATS_PER_VERTEX] = {
+                    position[0], position[1], position[2], normal[0], normal[1], normal[2],
+                    corner.t != NO_INDEX ? texCoords[corner.t * 2] : 0.0f,
+                    corner.t != NO_INDEX ? texCoords[corner.t * 2 + 1] : 0.0f
+                };
+                part->vertices.insert(part->vertices.end(), vertex, vertex + MeshData::FLOATS_PER_VERTEX);
+            }
+            part->indices.push_back(index);
+        }
+    }
+    return true;
+}
+
+
+bool MeshImporter::ImportGltf(const std::string& filename, const MappedFile& file, WorkerPool& pool, std::vector<MeshData>& parts, ImportStats& stats)
+{
+    const unsigned char* data = file.GetData();
+    const size_t size = file.GetSize();
+    const char* json = (const char*)data;
+    size_t jsonSize = size;
+    BufferRange binaryChunk = { nullptr, 0 };
+
+    // CLN: .glb container: 12-byte header, then a JSON chunk and an optional BIN chunk (little endian)
+    if (size >= 12 && memcmp(data, "glTF", 4) == 0)
+    {
+        uint32_t header[3];
+        memcpy(header, data, sizeof(header));
+        if (header[1] != 2 || header[2] > size)
+        {
+            std::cout << "Failed to import glTF: unsupported .glb version or truncated file" << std::endl;
+            return false;
+        }
+
+        json = nullptr;
+        for (size_t offset = 12; offset + 8 <= header[2];)
+        {
+            uint32_t chunk[2];
+            memcpy(chunk, data + offset, sizeof(chunk));
+            offset += 8;
+            if (chunk[0] > header[2] - offset)
+                return false;
+            if (chunk[1] == 0x4E4F534A && !json)            // "JSON"
+            {
+                json = (const char*)data + offset;
+                jsonSize = chunk[0];
+            }
+            else if (chunk[1] == 0x004E4942 && !binaryChunk.data)   // "BIN\0"
+            {
+                binaryChunk.data = data + offset;
+                binaryChunk.size = chunk[0];
+            }
+            offset += (chunk[0] + 3) & ~3u;
+        }
+        if (!json)
+            return false;
+    }
+
+    JsonValue root;
+    JsonParser parser(json, json + jsonSize);
+    if (!parser.Parse(root) || root.type != JsonValue::JSON_OBJECT)
+    {
+        std::cout << "Failed to parse glTF JSON" << std::endl;
+        return false;
+    }
+
+    // CLN: the buffers stay mapped for the whole import; accessors read them in place
+    std::vector<BufferRange> buffers;
+    std::vector<std::unique_ptr<MappedFile> > externalBuffers;
+    const JsonValue* bufferList = root.Find("buffers");
+    for (size_t i = 0; bufferList && i < bufferList->items.size(); ++i)
+    {
+        const JsonValue& buffer = bufferList->items[i];
+        const std::string uri = buffer.GetString("uri");
+        BufferRange range = binaryChunk;
+        if (!uri.empty())
+        {
+            if (uri.compare(0, 5, "data:") == 0)
+            {
+                std::cout << "Failed to import glTF: embedded data URIs are not supported" << std::endl;
+                return false;
+            }
+            externalBuffers.push_back(std::unique_ptr<MappedFile>(new MappedFile()));
+            if (!externalBuffers.back()->Open(DirectoryOf(filename) + uri))
+            {
+                std::cout << "Failed to open glTF buffer " << uri << std::endl;
+                return false;
+            }
+            range.data = externalBuffers.back()->GetData();
+            range.size = externalBuffers.back()->GetSize();
+            stats.fileBytes += range.size;
+        }
+        else if (i != 0 || !range.data)
+            return false;
+
+        range.size = std::min(range.size, (size_t)buffer.GetNumber("byteLength", 0.0));
+        buffers.push_back(range);
+    }
+
+    std::vector<const JsonValue*> primitives;
+    const JsonValue* meshes = root.Find("meshes");
+    for (size_t m = 0; meshes && m < meshes->items.size(); ++m)
+    {
+        const JsonValue* meshPrimitives = meshes->items[m].Find("primitives");
+        for (size_t p = 0; meshPrimitives && p < meshPrimitives->items.size(); ++p)
+            primitives.push_back(&meshPrimitives->items[p]);
+    }
+
+    // CLN: primitives are converted in parallel, each into its own list of parts, and joined in file order
+    std::vector<std::vector<MeshData> > primitiveParts(primitives.size());
+    std::atomic<bool> valid(true);
+    stats.chunks = (unsigned int)primitives.size();
+    stats.threads = pool.ParallelFor(primitives.size(), [&](size_t p) {
+        if (!ImportPrimitive(root, buffers, *primitives[p], primitiveParts[p]))
+            valid = false;
+    });
+    if (!valid)
+    {
+        std::cout << "Failed to import glTF: invalid or unsupported accessor" << std::endl;
+        return false;
+    }
+
+    for (std::vector<MeshData>& list : primitiveParts)
+    {
+        for (MeshData& part : list)
+        {
+            parts.push_back(MeshData());
+            parts.back().vertices.swap(part.vertices);
+            parts.back().indices.swap(part.indices);
+        }
+    }
+    return true;
+}
+
+
+void MeshImporter::PrintStats(const std::string& filename, const ImportStats& stats, std::ostream& out)
+{
+    const std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(1)
+        << "INFO: Imported " << filename << ": " << stats.fileBytes / (1024.0 * 1024.0) << " MB in "
+        << stats.seconds * 1000.0 << " ms (" << stats.GetMBPerSecond() << " MB/s), "
+        << stats.parts << " part(s), " << stats.vertices << " vertices, " << stats.triangles << " triangles, "
+        << stats.chunks << " chunk(s) on " << stats.threads << " thread(s)" << std::endl;
+    out.unsetf(std::ios::floatfield);
+    out.precision(precision);
+}
+
+
+const char* MeshImporter::ParseFloat(const char* p, const char* end, float& value)
+{
+    double result;
+    p = ParseDouble(p, end, result);
+    if (p)
+        value = (float)result;
+    return p;
+}
+
+
+bool MeshImporter::SelfTest(std::ostream& out)
+{
+    bool passed = true;
+    auto check = [&out, &passed](bool condition, const std::string& what) {
+        if (!condition)
+        {
+            out << "Failed mesh importer self-test: " << what << std::endl;
+            passed = false;
+        }
+    };
+
+    // CLN: three workers, so a file is split into up to 16 chunks
+    WorkerPool pool(3);
+    auto import = [&pool](const std::string& text, size_t minChunkBytes, std::vector<MeshData>& parts) {
+        ImportStats stats;
+        parts.clear();
+        return ImportObjText(text.data(), text.size(), minChunkBytes, pool, parts, stats);
+    };
+    auto same = [](const std::vector<MeshData>& a, const std::vector<MeshData>& b) {
+        bool equal = a.size() == b.size();
+        for (size_t i = 0; equal && i < a.size(); ++i)
+            equal = a[i].vertices == b[i].vertices && a[i].indices == b[i].indices;
+        return equal;
+    };
+
+    // CLN: a grid of quads, a row of v/vt lines at a time followed by the faces that reach it, written with absolute
+    //      and with relative indices (which point back into the rows of earlier chunks once the file is split)
+    const int side = 12;
+    std::ostringstream absolute, relative;
+    absolute << "# grid\nvn 0 1 0\n";
+    relative << "# grid\nvn 0 1 0\n";
+    for (int y = 0; y < side; ++y)
+    {
+        for (int x = 0; x < side; ++x)
+        {
+            std::ostringstream lines;
+            lines << "v " << x * 0.5f << " 0 " << y * 0.25f << "\nvt " << x / (float)side << " " << y / (float)side << "\n";
+            absolute << lines.str();
+            relative << lines.str();
+        }
+        for (int x = 0; y > 0 && x + 1 < side; ++x)
+        {
+            const int seen = (y + 1) * side;
+            const int quad[4] = { (y - 1) * side + x + 1, (y - 1) * side + x + 2, y * side + x + 2, y * side + x + 1 };
+            absolute << "f";
+            relative << "f";
+            for (int corner : quad)
+            {
+                absolute << " " << corner << "/" << corner << "/1";
+                relative << " " << corner - seen - 1 << "/" << corner - seen - 1 << "/-1";
+            }
+            absolute << "\n";
+            relative << "\n";
+        }
+    }
+
+    std::vector<MeshData> expected, parts;
+    check(import(absolute.str(), absolute.str().size(), expected) && expected.size() == 1 &&
+          expected[0].GetVertexCount() == side * side && expected[0].GetTriangleCount() == 2 * (side - 1) * (side - 1),
+          "the grid didn't import as one welded part");
+
+    // CLN: every chunk count, with a leading comment of every length up to 31 so the chunk borders move through the
+    //      lines; LF, CRLF, and no line end after the last face
+    bool relativeSame = true, crlfSame = true, unterminatedSame = true;
+    for (size_t padding = 0; padding < 32; ++padding)
+    {
+        const std::string relativeText = "#" + std::string(padding, '-') + "\n" + relative.str();
+        std::string crlfText;
+        for (char c : relativeText)
+            crlfText += c == '\n' ? std::string("\r\n") : std::string(1, c);
+        const std::string unterminatedText = crlfText.substr(0, crlfText.size() - 2);
+        for (size_t chunks = 1; chunks <= 16; ++chunks)
+        {
+            relativeSame = relativeSame && import(relativeText, relativeText.size() / chunks, parts) && same(parts, expected);
+            crlfSame = crlfSame && import(crlfText, crlfText.size() / chunks, parts) && same(parts, expected);
+            unterminatedSame = unterminatedSame && import(unterminatedText, unterminatedText.size() / chunks, parts) && same(parts, expected);
+        }
+    }
+    check(relativeSame, "relative indices across chunk borders didn't match the absolute ones");
+    check(crlfSame, "CRLF line ends split across chunks changed the mesh");
+    check(unterminatedSame, "a last line without a line end changed the mesh");
+
+    // CLN: 22000 triangles of three new vertices each: the first part stops at the last whole triangle under 65536
+    //      vertices, and the vertices keep the file's order across the split
+    const unsigned int triangles = 22000;
+    std::ostringstream large;
+    for (unsigned int v = 0; v < triangles * 3; ++v)
+        large << "v " << v << " 1 2\n";
+    for (unsigned int t = 0; t < triangles; ++t)
+        large << "f " << t * 3 + 1 << " " << t * 3 + 2 << " " << t * 3 + 3 << "\n";
+    const std::string largeText = large.str();
+    bool split = import(largeText, largeText.size() / 16, parts) && parts.size() == 2 &&
+                 parts[0].GetVertexCount() == MeshData::MAX_VERTICES - MeshData::MAX_VERTICES % 3 &&
+                 parts[0].GetTriangleCount() + parts[1].GetTriangleCount() == triangles;
+    unsigned int next = 0;
+    for (size_t p = 0; split && p < parts.size(); ++p)
+    {
+        for (size_t i = 0; split && i < parts[p].indices.size(); ++i)
+        {
+            const unsigned short index = parts[p].indices[i];
+            split = index < parts[p].GetVertexCount() && parts[p].vertices[index * MeshData::FLOATS_PER_VERTEX] == (float)next++;
+        }
+    }
+    check(split, "a model over 65536 vertices wasn't split into whole parts");
+
+    // CLN: malformed faces: a non-number, index 0, past the last vertex, a relative index before the first vertex, and
+    //      a texture coordinate that doesn't exist
+    const char* const malformed[] = { "f 1 2 x\n", "f 0 1 2\n", "f 1 2 4\n", "f -4 -2 -1\n", "f 1/1 2/1 3/1\n" };
+    for (const char* face : malformed)
+    {
+        const std::string text = std::string("v 0 0 0\nv 1 0 0\nv 0 1 0\n") + face;
+        check(!import(text, text.size(), parts), std::string("a malformed face loaded: ") + face);
+    }
+
+    return passed;
+}
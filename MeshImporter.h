@@ -0,0 +1,70 @@
+//========================================================================================
+// Filename      : MeshImporter.h
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Imports Wavefront OBJ and glTF 2.0 (.glb, .gltf with external .bin
+//               : buffers) models into the interleaved V/N/T layout that
+//               : GLObject::CreateMesh() expects.
+//               :
+//               : Files are memory-mapped (MappedFile) and parsed in place. OBJ files
+//               : are split into line-aligned chunks that are parsed in parallel on
+//               : the WorkerPool with a fast float parser; glTF accessors are read
+//               : straight out of the mapped binary buffer without copying it first.
+//               :
+//               : Models with more than 65536 unique vertices are split into several
+//               : parts, since the scene draws with unsigned short indices. Missing
+//               : normals are generated (area-weighted smooth normals); node
+//               : transforms and materials are not applied.
+//========================================================================================
+
+#ifndef MESH_IMPORTER_H
+#define MESH_IMPORTER_H
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "MeshData.h"
+
+class WorkerPool;
+class MappedFile;
+
+struct ImportStats
+{
+    size_t fileBytes = 0;           // including external glTF buffers
+    double seconds = 0.0;
+    unsigned int chunks = 0;        // parallel parse chunks (OBJ)
+    unsigned int threads = 0;
+    size_t vertices = 0;
+    size_t triangles = 0;
+    size_t parts = 0;
+
+    double GetMBPerSecond() const   { return seconds > 0.0 ? fileBytes / (1024.0 * 1024.0) / seconds : 0.0; }
+};
+
+class MeshImporter
+{
+public:
+    // picks the format from the file extension (.obj, .glb, .gltf)
+    static bool Import(const std::string& filename, WorkerPool& pool, std::vector<MeshData>& parts, ImportStats& stats);
+
+    static bool ImportObj(const MappedFile& file, WorkerPool& pool, std::vector<MeshData>& parts, ImportStats& stats);
+    static bool ImportGltf(const std::string& filename, const MappedFile& file, WorkerPool& pool, std::vector<MeshData>& parts, ImportStats& stats);
+
+    static void PrintStats(const std::string& filename, const ImportStats& stats, std::ostream& out);
+
+    // parses a decimal float ("-1.5e-3"), returns the position after it or nullptr if there is no number
+    static const char* ParseFloat(const char* p, const char* end, float& value);
+
+    // parses OBJ text split at many chunk sizes (CRLF and LF line ends, relative indices across chunks), checks the
+    // split into parts at 65536 vertices and that malformed faces are rejected (--self-test)
+    static bool SelfTest(std::ostream& out);
+
+private:
+    // OBJ text split into chunks of at least minChunkBytes (ImportObj() uses 1 MB)
+    static bool ImportObjText(const char* text, size_t size, size_t minChunkBytes, WorkerPool& pool, std::vector<MeshData>& parts,
+                              ImportStats& stats);
+};
+
+#endif
@@ -0,0 +1,755 @@
+//========================================================================================
+// Filename      : MeshSimplifier.cpp
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Implementation of the MeshSimplifier class (see MeshSimplifier.h)
+//               :
+//               : Vertices with the same position form a "wedge ring"; the ring's first
+//               : vertex is the position's id. Every pass:
+//               :    1. builds the position-to-triangle adjacency (CSR arrays)
+//               :    2. classifies positions: border (an edge used by one triangle) or
+//               :       locked (an edge used by three or more, i.e. non-manifold)
+//               :    3. queues every valid collapse by cost and performs them cheapest
+//               :       first; the neighbourhood of a collapse is locked for the rest of
+//               :       the pass, so the queued costs of the others stay exact
+//               :    4. remaps the indices and drops the collapsed triangles
+//========================================================================================
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <queue>
+#include <string>
+#include <unordered_map>
+
+#include "MeshSimplifier.h"
+#include "Sphere.h"
+#include "WorkerPool.h"
+
+namespace
+{
+    // CLN: squared normal/UV change is weighted against the squared relative distance of the quadric
+    const double ATTRIBUTE_WEIGHT = 0.01;
+    const unsigned int NO_VERTEX = ~0u;
+    const unsigned int AMBIGUOUS_VERTEX = ~0u - 1;
+
+    double SecondsSince(std::chrono::high_resolution_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+
+    // Sum of squared distances to a set of planes, weighted by triangle area
+    struct Quadric
+    {
+        double a00, a01, a02, a11, a12, a22, b0, b1, b2, c;
+
+        Quadric() : a00(0), a01(0), a02(0), a11(0), a12(0), a22(0), b0(0), b1(0), b2(0), c(0) {}
+
+        void AddPlane(const double n[3], double d, double weight)
+        {
+            a00 += weight * n[0] * n[0]; a01 += weight * n[0] * n[1]; a02 += weight * n[0] * n[2];
+            a11 += weight * n[1] * n[1]; a12 += weight * n[1] * n[2]; a22 += weight * n[2] * n[2];
+            b0 += weight * n[0] * d; b1 += weight * n[1] * d; b2 += weight * n[2] * d;
+            c += weight * d * d;
+        }
+
+        void Add(const Quadric& q)
+        {
+            a00 += q.a00; a01 += q.a01; a02 += q.a02; a11 += q.a11; a12 += q.a12; a22 += q.a22;
+            b0 += q.b0; b1 += q.b1; b2 += q.b2; c += q.c;
+        }
+
+        double Evaluate(const float* p) const
+        {
+            const double x = p[0], y = p[1], z = p[2];
+            double error = a00 * x * x + 2 * a01 * x * y + 2 * a02 * x * z + a11 * y * y + 2 * a12 * y * z + a22 * z * z +
+                           2 * (b0 * x + b1 * y + b2 * z) + c;
+            return error > 0.0 ? error : 0.0;
+        }
+    };
+
+    struct Collapse
+    {
+        double cost;
+        unsigned int from;      // position ids
+        unsigned int to;
+
+        bool operator<(const Collapse& other) const     { return cost > other.cost; }  // CLN: makes priority_queue a min-heap
+    };
+
+    void Cross(const float* a, const float* b, const float* c, double n[3])
+    {
+        const double e1[3] = { (double)b[0] - a[0], (double)b[1] - a[1], (double)b[2] - a[2] };
+        const double e2[3] = { (double)c[0] - a[0], (double)c[1] - a[1], (double)c[2] - a[2] };
+        n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+        n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+        n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+    }
+
+    struct PositionKey
+    {
+        uint32_t bits[3];
+        bool operator==(const PositionKey& other) const     { return memcmp(bits, other.bits, sizeof(bits)) == 0; }
+    };
+
+    struct PositionKeyHash
+    {
+        size_t operator()(const PositionKey& key) const
+        {
+            return (size_t)(key.bits[0] * 73856093u ^ key.bits[1] * 19349663u ^ key.bits[2] * 83492791u);
+        }
+    };
+
+    class Simplifier
+    {
+    public:
+        explicit Simplifier(const MeshData& source);
+
+        float Run(size_t targetTriangleCount, float maxError);
+        void Extract(MeshData& result) const;
+
+    private:
+        void BuildAdjacency();
+        void ClassifyPositions();
+        unsigned int CountEdgeTriangles(unsigned int from, unsigned int to) const;
+        unsigned int FindWedgeTarget(unsigned int vertex, unsigned int from, unsigned int to) const;
+        bool IsHardEdge(unsigned int from, unsigned int to) const;
+        bool Evaluate(unsigned int from, unsigned int to, double& cost) const;
+        void Perform(const Collapse& collapse);
+        void ApplyRemap();
+
+        const float* PositionOf(unsigned int vertex) const  { return &positions[vertex * 3]; }
+
+        const MeshData& source;
+        unsigned int vertexCount;
+        std::vector<float> positions;           // normalized to the unit box, so errors are relative to the extent
+        std::vector<unsigned int> positionId;   // vertex -> first vertex with the same position
+        std::vector<unsigned int> wedgeNext;    // circular list of the live vertices of a position
+        std::vector<unsigned int> ringStart;    // position id -> a live vertex of its ring (the id vertex itself may be gone)
+        std::vector<unsigned int> indices;
+        std::vector<unsigned int> remap;
+        std::vector<Quadric> quadrics;          // per position id
+        std::vector<double> vertexArea;
+
+        // per pass
+        std::vector<unsigned int> adjacencyOffsets;     // position id -> range in adjacencyTriangles
+        std::vector<unsigned int> adjacencyTriangles;
+        std::vector<unsigned char> border;
+        std::vector<unsigned char> locked;
+        std::vector<unsigned char> passLocked;
+        size_t triangleCount;
+    };
+
+
+    Simplifier::Simplifier(const MeshData& source)
+        : source(source), vertexCount(source.GetVertexCount()), triangleCount(0)
+    {
+        const unsigned int stride = MeshData::FLOATS_PER_VERTEX;
+
+        float low[3] = { 0.0f, 0.0f, 0.0f }, high[3] = { 0.0f, 0.0f, 0.0f };
+        for (unsigned int v = 0; v < vertexCount; ++v)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                float value = source.vertices[v * stride + k];
+                low[k] = v == 0 ? value : std::min(low[k], value);
+                high[k] = v == 0 ? value : std::max(high[k], value);
+            }
+        }
+        float extent = std::max(high[0] - low[0], std::max(high[1] - low[1], high[2] - low[2]));
+        float scale = extent > 0.0f ? 1.0f / extent : 1.0f;
+
+        // CLN: vertices with bitwise identical positions share one position id (seams, hard edges)
+        positions.resize(vertexCount * 3);
+        positionId.resize(vertexCount);
+        std::unordered_map<PositionKey, unsigned int, PositionKeyHash> firstVertex;
+        firstVertex.reserve(vertexCount);
+        for (unsigned int v = 0; v < vertexCount; ++v)
+        {
+            PositionKey key;
+            memcpy(key.bits, &source.vertices[v * stride], sizeof(key.bits));
+            positionId[v] = firstVertex.insert(std::make_pair(key, v)).first->second;
+            for (int k = 0; k < 3; ++k)
+                positions[v * 3 + k] = (source.vertices[v * stride + k] - low[k]) * scale;
+        }
+
+        remap.resize(vertexCount);
+        for (unsigned int v = 0; v < vertexCount; ++v)
+            remap[v] = v;
+
+        indices.reserve(source.indices.size());
+        quadrics.resize(vertexCount);
+        vertexArea.assign(vertexCount, 0.0);
+        for (size_t t = 0; t + 2 < source.indices.size(); t += 3)
+        {
+            const unsigned int a = source.indices[t], b = source.indices[t + 1], c = source.indices[t + 2];
+            if (a >= vertexCount || b >= vertexCount || c >= vertexCount ||
+                positionId[a] == positionId[b] || positionId[b] == positionId[c] || positionId[c] == positionId[a])
+                continue;   // CLN: degenerate triangles are dropped up front
+
+            indices.push_back(a);
+            indices.push_back(b);
+            indices.push_back(c);
+
+            double n[3];
+            Cross(PositionOf(a), PositionOf(b), PositionOf(c), n);
+            double length = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            double area = length * 0.5;
+            if (length > 0.0)
+            {
+                n[0] /= length; n[1] /= length; n[2] /= length;
+                const float* p = PositionOf(a);
+                double d = -(n[0] * p[0] + n[1] * p[1] + n[2] * p[2]);
+                quadrics[positionId[a]].AddPlane(n, d, area);
+                quadrics[positionId[b]].AddPlane(n, d, area);
+                quadrics[positionId[c]].AddPlane(n, d, area);
+            }
+            vertexArea[a] += area / 3.0;
+            vertexArea[b] += area / 3.0;
+            vertexArea[c] += area / 3.0;
+        }
+        triangleCount = indices.size() / 3;
+    }
+
+
+    void Simplifier::BuildAdjacency()
+    {
+        adjacencyOffsets.assign(vertexCount + 1, 0);
+        for (unsigned int index : indices)
+            ++adjacencyOffsets[positionId[index] + 1];
+        for (unsigned int p = 0; p < vertexCount; ++p)
+            adjacencyOffsets[p + 1] += adjacencyOffsets[p];
+
+        std::vector<unsigned int> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        adjacencyTriangles.resize(indices.size());
+        for (size_t i = 0; i < indices.size(); ++i)
+            adjacencyTriangles[fill[positionId[indices[i]]]++] = (unsigned int)(i / 3);
+
+        // CLN: wedge rings only hold vertices that are still referenced
+        std::vector<unsigned char> referenced(vertexCount, 0);
+        for (unsigned int index : indices)
+            referenced[index] = 1;
+        wedgeNext.assign(vertexCount, NO_VERTEX);
+        ringStart.assign(vertexCount, NO_VERTEX);
+        for (unsigned int v = 0; v < vertexCount; ++v)
+        {
+            if (!referenced[v])
+                continue;
+            unsigned int& head = ringStart[positionId[v]];
+            if (head == NO_VERTEX)
+            {
+                head = v;
+                wedgeNext[v] = v;
+            }
+            else
+            {
+                wedgeNext[v] = wedgeNext[head];
+                wedgeNext[head] = v;
+            }
+        }
+    }
+
+
+    unsigned int Simplifier::CountEdgeTriangles(unsigned int from, unsigned int to) const
+    {
+        unsigned int count = 0;
+        for (unsigned int a = adjacencyOffsets[from]; a < adjacencyOffsets[from + 1]; ++a)
+        {
+            const unsigned int* triangle = &indices[adjacencyTriangles[a] * 3];
+            count += positionId[triangle[0]] == to || positionId[triangle[1]] == to || positionId[triangle[2]] == to;
+        }
+        return count;
+    }
+
+
+    void Simplifier::ClassifyPositions()
+    {
+        border.assign(vertexCount, 0);
+        locked.assign(vertexCount, 0);
+
+        for (unsigned int p = 0; p < vertexCount; ++p)
+        {
+            for (unsigned int a = adjacencyOffsets[p]; a < adjacencyOffsets[p + 1] && !locked[p]; ++a)
+            {
+                const unsigned int* triangle = &indices[adjacencyTriangles[a] * 3];
+                for (int k = 0; k < 3; ++k)
+                {
+                    unsigned int neighbour = positionId[triangle[k]];
+                    if (neighbour == p)
+                        continue;
+                    unsigned int count = CountEdgeTriangles(p, neighbour);
+                    if (count == 1)
+                        border[p] = 1;
+                    else if (count > 2)
+                        locked[p] = 1;
+                }
+            }
+        }
+    }
+
+
+    // The vertex of position 'to' that 'vertex' (of position 'from') shares an edge with: NO_VERTEX if there is
+    // none, AMBIGUOUS_VERTEX if there are several
+    unsigned int Simplifier::FindWedgeTarget(unsigned int vertex, unsigned int from, unsigned int to) const
+    {
+        unsigned int target = NO_VERTEX;
+        for (unsigned int a = adjacencyOffsets[from]; a < adjacencyOffsets[from + 1]; ++a)
+        {
+            const unsigned int* triangle = &indices[adjacencyTriangles[a] * 3];
+            if (triangle[0] != vertex && triangle[1] != vertex && triangle[2] != vertex)
+                continue;
+            for (int k = 0; k < 3; ++k)
+            {
+                if (positionId[triangle[k]] != to)
+                    continue;
+                if (target != NO_VERTEX && target != triangle[k])
+                    return AMBIGUOUS_VERTEX;    // CLN: the attributes would have to be merged
+                target = triangle[k];
+            }
+        }
+        return target;
+    }
+
+
+    // True if the two triangles on the edge use different vertices for it (a hard edge or UV seam)
+    bool Simplifier::IsHardEdge(unsigned int from, unsigned int to) const
+    {
+        unsigned int edgeVertices[2] = { NO_VERTEX, NO_VERTEX };
+        for (unsigned int a = adjacencyOffsets[from]; a < adjacencyOffsets[from + 1]; ++a)
+        {
+            const unsigned int* triangle = &indices[adjacencyTriangles[a] * 3];
+            unsigned int fromVertex = NO_VERTEX, toVertex = NO_VERTEX;
+            for (int k = 0; k < 3; ++k)
+            {
+                if (positionId[triangle[k]] == from)
+                    fromVertex = triangle[k];
+                else if (positionId[triangle[k]] == to)
+                    toVertex = triangle[k];
+            }
+            if (toVertex == NO_VERTEX)
+                continue;
+            if (edgeVertices[0] != NO_VERTEX && (edgeVertices[0] != fromVertex || edgeVertices[1] != toVertex))
+                return true;
+            edgeVertices[0] = fromVertex;
+            edgeVertices[1] = toVertex;
+        }
+        return false;
+    }
+
+
+    bool Simplifier::Evaluate(unsigned int from, unsigned int to, double& cost) const
+    {
+        if (locked[from] || (border[from] && CountEdgeTriangles(from, to) != 1))
+            return false;
+
+        // CLN: every wedge of 'from' must slide onto its own wedge of 'to', which keeps UV seams intact. Along a
+        //      hard edge (e.g. flat shading) a wedge that doesn't touch 'to' may instead move there with its attributes
+        const unsigned int stride = MeshData::FLOATS_PER_VERTEX;
+        const bool hardEdge = IsHardEdge(from, to);
+        double attributeCost = 0.0;
+        double area = 0.0;
+        const unsigned int first = ringStart[from];
+        unsigned int vertex = first;
+        do
+        {
+            unsigned int target = FindWedgeTarget(vertex, from, to);
+            if (target == AMBIGUOUS_VERTEX || (target == NO_VERTEX && !hardEdge))
+                return false;
+            if (target == NO_VERTEX)
+            {
+                area += vertexArea[vertex];
+                vertex = wedgeNext[vertex];
+                continue;
+            }
+
+            double difference = 0.0;
+            for (unsigned int k = 3; k < stride; ++k)
+            {
+                double delta = (double)source.vertices[vertex * stride + k] - source.vertices[target * stride + k];
+                difference += delta * delta;
+            }
+            attributeCost += vertexArea[vertex] * difference;
+            area += vertexArea[vertex];
+            vertex = wedgeNext[vertex];
+        } while (vertex != first);
+
+        // CLN: reject collapses that would flip or flatten a remaining triangle
+        const float* target = PositionOf(to);
+        for (unsigned int a = adjacencyOffsets[from]; a < adjacencyOffsets[from + 1]; ++a)
+        {
+            const unsigned int* triangle = &indices[adjacencyTriangles[a] * 3];
+            const float* corners[3];
+            bool hasTarget = false;
+            for (int k = 0; k < 3; ++k)
+            {
+                corners[k] = PositionOf(triangle[k]);
+                hasTarget = hasTarget || positionId[triangle[k]] == to;
+            }
+            if (hasTarget)
+                continue;   // collapses away
+
+            double before[3], after[3];
+            Cross(corners[0], corners[1], corners[2], before);
+            for (int k = 0; k < 3; ++k)
+            {
+                if (positionId[triangle[k]] == from)
+                    corners[k] = target;
+            }
+            Cross(corners[0], corners[1], corners[2], after);
+
+            double dot = before[0] * after[0] + before[1] * after[1] + before[2] * after[2];
+            double lengths = sqrt(before[0] * before[0] + before[1] * before[1] + before[2] * before[2]) *
+                             sqrt(after[0] * after[0] + after[1] * after[1] + after[2] * after[2]);
+            if (dot <= 0.25 * lengths || lengths == 0.0)
+                return false;
+        }
+
+        cost = (quadrics[from].Evaluate(target) + ATTRIBUTE_WEIGHT * attributeCost) / std::max(area, 1e-20);
+        return true;
+    }
+
+
+    void Simplifier::Perform(const Collapse& collapse)
+    {
+        triangleCount -= CountEdgeTriangles(collapse.from, collapse.to);
+
+        // CLN: lock both one-rings for the rest of the pass
+        const unsigned int ends[2] = { collapse.from, collapse.to };
+        for (unsigned int p : ends)
+        {
+            for (unsigned int a = adjacencyOffsets[p]; a < adjacencyOffsets[p + 1]; ++a)
+            {
+                const unsigned int* triangle = &indices[adjacencyTriangles[a] * 3];
+                for (int k = 0; k < 3; ++k)
+                    passLocked[positionId[triangle[k]]] = 1;
+            }
+        }
+
+        const unsigned int first = ringStart[collapse.from];
+        unsigned int vertex = first;
+        do
+        {
+            const unsigned int next = wedgeNext[vertex];
+            unsigned int target = FindWedgeTarget(vertex, collapse.from, collapse.to);
+            if (target != NO_VERTEX)
+            {
+                remap[vertex] = target;
+                vertexArea[target] += vertexArea[vertex];
+            }
+            else
+            {
+                // CLN: moved wedge (hard edge), the vertex keeps its attributes at the new position
+                positionId[vertex] = collapse.to;
+                memcpy(&positions[vertex * 3], PositionOf(collapse.to), 3 * sizeof(float));
+            }
+            vertex = next;
+        } while (vertex != first);
+
+        quadrics[collapse.to].Add(quadrics[collapse.from]);
+    }
+
+
+    void Simplifier::ApplyRemap()
+    {
+        size_t kept = 0;
+        for (size_t t = 0; t < indices.size(); t += 3)
+        {
+            const unsigned int a = remap[indices[t]], b = remap[indices[t + 1]], c = remap[indices[t + 2]];
+            if (positionId[a] == positionId[b] || positionId[b] == positionId[c] || positionId[c] == positionId[a])
+                continue;
+            indices[kept++] = a;
+            indices[kept++] = b;
+            indices[kept++] = c;
+        }
+        indices.resize(kept);
+        triangleCount = kept / 3;
+    }
+
+
+    float Simplifier::Run(size_t targetTriangleCount, float maxError)
+    {
+        const double maxCost = (double)maxError * maxError;
+        double largestCost = 0.0;
+
+        while (triangleCount > targetTriangleCount)
+        {
+            BuildAdjacency();
+            ClassifyPositions();
+
+            // CLN: each half-edge is evaluated once from its own triangle (border edges have no twin, so both
+            //      directions there); only the cheapest collapse of each position is queued
+            std::vector<Collapse> best(vertexCount);
+            for (Collapse& collapse : best)
+                collapse.cost = -1.0;
+            for (size_t t = 0; t < indices.size(); t += 3)
+            {
+                for (int k = 0; k < 3; ++k)
+                {
+                    const unsigned int a = positionId[indices[t + k]];
+                    const unsigned int b = positionId[indices[t + (k + 1) % 3]];
+                    const unsigned int directions = border[a] && border[b] && CountEdgeTriangles(a, b) == 1 ? 2 : 1;
+                    for (unsigned int d = 0; d < directions; ++d)
+                    {
+                        const unsigned int from = d == 0 ? a : b;
+                        const unsigned int to = d == 0 ? b : a;
+                        double cost;
+                        if (Evaluate(from, to, cost) && cost <= maxCost && (best[from].cost < 0.0 || cost < best[from].cost))
+                        {
+                            best[from].cost = cost;
+                            best[from].from = from;
+                            best[from].to = to;
+                        }
+                    }
+                }
+            }
+
+            std::vector<Collapse> candidates;
+            for (const Collapse& collapse : best)
+            {
+                if (collapse.cost >= 0.0)
+                    candidates.push_back(collapse);
+            }
+            if (candidates.empty())
+                break;
+
+            std::priority_queue<Collapse> queue(std::less<Collapse>(), std::move(candidates));
+            passLocked.assign(vertexCount, 0);
+            size_t collapses = 0;
+            while (!queue.empty() && triangleCount > targetTriangleCount)
+            {
+                Collapse collapse = queue.top();
+                queue.pop();
+                if (passLocked[collapse.from] || passLocked[collapse.to])
+                    continue;
+
+                Perform(collapse);
+                largestCost = std::max(largestCost, collapse.cost);
+                ++collapses;
+            }
+
+            ApplyRemap();
+            if (collapses == 0)
+                break;
+        }
+
+        return (float)sqrt(largestCost);
+    }
+
+
+    void Simplifier::Extract(MeshData& result) const
+    {
+        const unsigned int stride = MeshData::FLOATS_PER_VERTEX;
+        std::vector<unsigned int> newIndex(vertexCount, NO_VERTEX);
+        result.vertices.clear();
+        result.indices.clear();
+        result.indices.reserve(indices.size());
+
+        for (unsigned int index : indices)
+        {
+            if (newIndex[index] == NO_VERTEX)
+            {
+                newIndex[index] = result.GetVertexCount();
+                result.vertices.insert(result.vertices.end(), source.vertices.begin() + index * stride, source.vertices.begin() + (index + 1) * stride);
+                // CLN: moved wedges take the position of the vertex that identifies their new position
+                std::copy(source.vertices.begin() + positionId[index] * stride, source.vertices.begin() + positionId[index] * stride + 3,
+                          result.vertices.end() - stride);
+            }
+            result.indices.push_back((unsigned short)newIndex[index]);
+        }
+    }
+}
+
+
+float MeshSimplifier::Simplify(const MeshData& source, size_t targetTriangleCount, float maxError, MeshData& result)
+{
+    Simplifier simplifier(source);
+    float error = simplifier.Run(targetTriangleCount, maxError);
+    simplifier.Extract(result);
+    return error;
+}
+
+
+void MeshSimplifier::BuildLodChain(const MeshData& mesh, float targetRatio, float maxError, std::vector<MeshLod>& chain)
+{
+    chain.clear();
+    chain.push_back(MeshLod());
+    chain[0].mesh = mesh;
+    chain[0].error = 0.0f;
+
+    const size_t targetTriangles = (size_t)(mesh.GetTriangleCount() * targetRatio);
+    while (chain.back().mesh.GetTriangleCount() > targetTriangles)
+    {
+        // CLN: each level is simplified from the previous one, so the error bound is the sum along the chain
+        const MeshLod& previous = chain.back();
+        MeshLod level;
+        float error = Simplify(previous.mesh, std::max<size_t>(previous.mesh.GetTriangleCount() / 2, targetTriangles), maxError, level.mesh);
+        level.error = previous.error + error;
+
+        // CLN: stop once the error budget blocks meaningful progress
+        if (level.mesh.GetTriangleCount() > previous.mesh.GetTriangleCount() * 9 / 10)
+            break;
+        chain.push_back(std::move(level));
+    }
+}
+
+
+void MeshSimplifier::BuildLodChains(WorkerPool& pool, const std::vector<const MeshData*>& meshes, float targetRatio, float maxError,
+                                    std::vector<std::vector<MeshLod> >& chains, std::ostream& out)
+{
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+    chains.resize(meshes.size());
+    unsigned int threads = pool.ParallelFor(meshes.size(), [&](size_t m) {
+        BuildLodChain(*meshes[m], targetRatio, maxError, chains[m]);
+    });
+    double seconds = SecondsSince(start);
+
+    size_t inputTriangles = 0, levels = 0;
+    for (size_t m = 0; m < meshes.size(); ++m)
+    {
+        inputTriangles += meshes[m]->GetTriangleCount();
+        levels += chains[m].size() - 1;
+    }
+
+    const std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(2)
+        << "INFO: Simplified " << meshes.size() << " mesh(es), " << inputTriangles << " triangles, into " << levels << " LOD level(s) in "
+        << seconds * 1000.0 << " ms (" << (seconds > 0.0 ? inputTriangles / seconds / 1e6 : 0.0) << " M triangles/s) on " << threads << " thread(s)\n";
+    for (size_t m = 0; m < chains.size(); ++m)
+    {
+        out << "      mesh " << m << ":";
+        for (const MeshLod& level : chains[m])
+            out << " " << level.mesh.GetTriangleCount() << " (" << level.error * 100.0f << "%)";
+        out << "\n";
+    }
+    out.unsetf(std::ios::floatfield);
+    out.precision(precision);
+    out.flush();
+}
+
+
+float MeshSimplifier::GetExtent(const MeshData& mesh)
+{
+    float low[3] = { 0.0f, 0.0f, 0.0f }, high[3] = { 0.0f, 0.0f, 0.0f };
+    for (size_t i = 0; i < mesh.vertices.size(); i += MeshData::FLOATS_PER_VERTEX)
+    {
+        for (int k = 0; k < 3; ++k)
+        {
+            low[k] = i == 0 ? mesh.vertices[i + k] : std::min(low[k], mesh.vertices[i + k]);
+            high[k] = i == 0 ? mesh.vertices[i + k] : std::max(high[k], mesh.vertices[i + k]);
+        }
+    }
+    return std::max(high[0] - low[0], std::max(high[1] - low[1], high[2] - low[2]));
+}
+
+
+bool MeshSimplifier::SelfTest(std::ostream& out)
+{
+    bool passed = true;
+    auto check = [&out, &passed](bool condition, const char* what) {
+        if (!condition)
+        {
+            out << "Failed mesh simplifier self-test: " << what << std::endl;
+            passed = false;
+        }
+    };
+    const unsigned int floats = MeshData::FLOATS_PER_VERTEX;
+
+    // CLN: every result vertex must be a source vertex, bit for bit (half-edge collapses move no vertex), and every
+    //      triangle must use three different ones
+    auto keepsVertices = [floats](const MeshData& source, const MeshData& result) {
+        std::unordered_map<std::string, int> sourceVertices;
+        for (size_t v = 0; v < source.GetVertexCount(); ++v)
+            sourceVertices[std::string((const char*)&source.vertices[v * floats], floats * sizeof(float))] = 1;
+        for (size_t v = 0; v < result.GetVertexCount(); ++v)
+        {
+            if (!sourceVertices.count(std::string((const char*)&result.vertices[v * floats], floats * sizeof(float))))
+                return false;
+        }
+        for (size_t t = 0; t + 2 < result.indices.size(); t += 3)
+        {
+            const unsigned short* triangle = &result.indices[t];
+            if (triangle[0] >= result.GetVertexCount() || triangle[1] >= result.GetVertexCount() || triangle[2] >= result.GetVertexCount() ||
+                triangle[0] == triangle[1] || triangle[1] == triangle[2] || triangle[2] == triangle[0])
+                return false;
+        }
+        return true;
+    };
+
+    // CLN: a flat 16 x 16 grid on the unit square (y up). With its UVs the grid holds at almost no error allowed
+    MeshData grid;
+    const int side = 16;
+    for (int z = 0; z <= side; ++z)
+    {
+        for (int x = 0; x <= side; ++x)
+        {
+            const float vertex[8] = { (float)x / side, 0.0f, (float)z / side, 0.0f, 1.0f, 0.0f, (float)x / side, (float)z / side };
+            grid.vertices.insert(grid.vertices.end(), vertex, vertex + 8);
+        }
+    }
+    for (int z = 0; z < side; ++z)
+    {
+        for (int x = 0; x < side; ++x)
+        {
+            const unsigned short v = (unsigned short)(z * (side + 1) + x);
+            const unsigned short quad[6] = { v, (unsigned short)(v + side + 1), (unsigned short)(v + 1),
+                                             (unsigned short)(v + 1), (unsigned short)(v + side + 1), (unsigned short)(v + side + 2) };
+            grid.indices.insert(grid.indices.end(), quad, quad + 6);
+        }
+    }
+    MeshData none;
+    check(Simplify(grid, 2, 1e-4f, none) <= 1e-4f && none.GetTriangleCount() == grid.GetTriangleCount(),
+          "a flat grid collapsed across its UVs with almost no error allowed");
+
+    // CLN: without them every collapse is free, so only the flip test keeps a triangle from folding over another
+    MeshData plain = grid;
+    for (size_t v = 0; v < plain.GetVertexCount(); ++v)
+        plain.vertices[v * floats + 6] = plain.vertices[v * floats + 7] = 0.0f;
+    MeshData flat;
+    Simplify(plain, 2, 1.0f, flat);
+    double area = 0.0;
+    bool flipped = false;
+    for (size_t t = 0; t + 2 < flat.indices.size(); t += 3)
+    {
+        const float* a = &flat.vertices[flat.indices[t] * floats];
+        const float* b = &flat.vertices[flat.indices[t + 1] * floats];
+        const float* c = &flat.vertices[flat.indices[t + 2] * floats];
+        // CLN: y of (b - a) x (c - a), twice the area; the grid's triangles wind so that it is positive
+        const double normalY = (double)(b[2] - a[2]) * (c[0] - a[0]) - (double)(b[0] - a[0]) * (c[2] - a[2]);
+        flipped = flipped || normalY <= 0.0;
+        area += normalY / 2.0;
+    }
+    check(keepsVertices(plain, flat), "a flat grid result has a new or degenerate vertex");
+    check(flat.GetTriangleCount() > 0 && flat.GetTriangleCount() < plain.GetTriangleCount() / 8, "a flat grid was hardly simplified");
+    check(!flipped && area > 0.0 && area <= 1.0 + 1e-6, "a flat grid result flipped a triangle");
+
+    // CLN: a sphere to half its triangles, within the error asked for
+    Sphere sphere(0.4f, 36, 18);
+    MeshData round;
+    round.Assign(sphere.getVertices(), sphere.getVertexSize() / sizeof(float), sphere.getIndices(), sphere.getIndexCount());
+    MeshData half;
+    const float error = Simplify(round, round.GetTriangleCount() / 2, 0.05f, half);
+    check(keepsVertices(round, half), "a sphere result has a new or degenerate vertex");
+    check(half.GetTriangleCount() <= round.GetTriangleCount() / 2 && error >= 0.0f && error <= 0.05f,
+          "a sphere result missed its target or error bound");
+    MeshData exact;
+    check(Simplify(round, 0, 0.0f, exact) == 0.0f && exact.GetTriangleCount() == round.GetTriangleCount(),
+          "a sphere was simplified with no error allowed");
+
+    // CLN: the chain: level 0 is the mesh, then fewer triangles and no smaller error per level
+    std::vector<MeshLod> chain;
+    BuildLodChain(round, 0.1f, 0.05f, chain);
+    bool ordered = chain.size() > 1 && chain[0].mesh.vertices == round.vertices && chain[0].mesh.indices == round.indices &&
+                   chain[0].error == 0.0f;
+    for (size_t level = 1; ordered && level < chain.size(); ++level)
+    {
+        ordered = chain[level].mesh.GetTriangleCount() < chain[level - 1].mesh.GetTriangleCount() &&
+                  chain[level].error >= chain[level - 1].error;
+    }
+    check(ordered, "a LOD chain isn't ordered");
+
+    return passed;
+}
@@ -0,0 +1,60 @@
+//========================================================================================
+// Filename      : MeshSimplifier.h
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Quadric error edge-collapse simplification for meshes that have no
+//               : parametric detail control (imported models, the hand-built tri-case).
+//               :
+//               : Each collapse moves one vertex position onto a neighbouring one
+//               : (half-edge collapse), so the surviving vertices keep their exact
+//               : normals and texture coordinates. Vertices that share a position but
+//               : differ in normal or UV (seams) collapse together along the seam, open
+//               : borders only collapse along the border, and the collapse cost adds an
+//               : attribute term (normal and UV change) to the Garland-Heckbert
+//               : position quadric. Collapses are taken cheapest first from a priority
+//               : queue, in passes over a compact vertex-to-triangle adjacency.
+//               :
+//               : Errors are relative to the mesh extent (the largest side of its
+//               : bounding box), so 0.01 means 1% of the mesh size.
+//========================================================================================
+
+#ifndef MESH_SIMPLIFIER_H
+#define MESH_SIMPLIFIER_H
+
+#include <ostream>
+#include <vector>
+
+#include "MeshData.h"
+
+class WorkerPool;
+
+// One level of a LOD chain; level 0 is the original mesh
+struct MeshLod
+{
+    MeshData mesh;
+    float error;        // bound on the deviation from the original, relative to the mesh extent
+};
+
+class MeshSimplifier
+{
+public:
+    // collapses edges until at most targetTriangleCount triangles remain or the next collapse would exceed
+    // maxError; returns the largest collapse error made
+    static float Simplify(const MeshData& source, size_t targetTriangleCount, float maxError, MeshData& result);
+
+    // halves the triangle count per level until targetRatio of the original is reached or maxError stops it
+    static void BuildLodChain(const MeshData& mesh, float targetRatio, float maxError, std::vector<MeshLod>& chain);
+
+    // builds the chains of several meshes in parallel and reports the simplification throughput
+    static void BuildLodChains(WorkerPool& pool, const std::vector<const MeshData*>& meshes, float targetRatio, float maxError,
+                               std::vector<std::vector<MeshLod> >& chains, std::ostream& out);
+
+    static float GetExtent(const MeshData& mesh);      // largest side of the bounding box
+
+    // simplifies a flat grid and a sphere and checks the result: only source vertices, no flipped or degenerate
+    // triangles, the target and error bounds, and the LOD chain's order (--self-test)
+    static bool SelfTest(std::ostream& out);
+};
+
+#endif
@@ -0,0 +1,260 @@
+//========================================================================================
+// Filename      : MeshWelder.cpp
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Implementation of the MeshWelder class (see MeshWelder.h)
+//========================================================================================
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <vector>
+
+#include "MeshWelder.h"
+
+namespace
+{
+    const uint32_t EMPTY_SLOT = ~0u;
+
+    // Position cell of a vertex: the bits of the coordinates when welding exactly, the epsilon grid cell otherwise
+    struct Cell
+    {
+        int64_t xyz[3];
+
+        bool operator==(const Cell& other) const
+        {
+            return xyz[0] == other.xyz[0] && xyz[1] == other.xyz[1] && xyz[2] == other.xyz[2];
+        }
+    };
+
+    uint32_t FloatBits(float value)
+    {
+        value += 0.0f;      // CLN: -0.0 becomes +0.0, so the two weld together
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    uint64_t Mix(uint64_t hash, uint64_t value)
+    {
+        hash ^= value + 0x9E3779B97F4A7C15ull + (hash << 6) + (hash >> 2);
+        return hash;
+    }
+
+    class WeldTable
+    {
+    public:
+        WeldTable(const MeshData& mesh, float epsilon)
+            : mesh(mesh), epsilon(epsilon)
+        {
+            size_t size = 16;
+            while (size < mesh.GetVertexCount() * 2)
+                size *= 2;
+            slots.assign(size, EMPTY_SLOT);
+            cells.resize(mesh.GetVertexCount());
+            attributeHashes.resize(mesh.GetVertexCount());
+        }
+
+        // Returns the vertex that 'vertex' welds onto, or 'vertex' itself after adding it to the table
+        uint32_t Insert(uint32_t vertex)
+        {
+            const float* v = Vertex(vertex);
+            uint64_t attributeHash = 0;
+            for (unsigned int k = 3; k < MeshData::FLOATS_PER_VERTEX; ++k)
+                attributeHash = Mix(attributeHash, FloatBits(v[k]));
+            attributeHashes[vertex] = attributeHash;
+
+            Cell& cell = cells[vertex];
+            if (epsilon > 0.0f)
+            {
+                for (int k = 0; k < 3; ++k)
+                    cell.xyz[k] = (int64_t)std::floor(v[k] / epsilon);
+
+                // CLN: a vertex within epsilon can sit in any of the 27 cells around this one
+                for (int dz = -1; dz <= 1; ++dz)
+                    for (int dy = -1; dy <= 1; ++dy)
+                        for (int dx = -1; dx <= 1; ++dx)
+                        {
+                            Cell neighbour = {{ cell.xyz[0] + dx, cell.xyz[1] + dy, cell.xyz[2] + dz }};
+                            uint32_t match = Find(vertex, neighbour);
+                            if (match != EMPTY_SLOT)
+                                return match;
+                        }
+            }
+            else
+            {
+                for (int k = 0; k < 3; ++k)
+                    cell.xyz[k] = FloatBits(v[k]);
+                uint32_t match = Find(vertex, cell);
+                if (match != EMPTY_SLOT)
+                    return match;
+            }
+
+            size_t i = Hash(cell, attributeHash) & (slots.size() - 1);
+            while (slots[i] != EMPTY_SLOT)
+                i = (i + 1) & (slots.size() - 1);
+            slots[i] = vertex;
+            return vertex;
+        }
+
+    private:
+        const float* Vertex(uint32_t vertex) const  { return &mesh.vertices[(size_t)vertex * MeshData::FLOATS_PER_VERTEX]; }
+
+        static size_t Hash(const Cell& cell, uint64_t attributeHash)
+        {
+            uint64_t hash = Mix(Mix(Mix(attributeHash, (uint64_t)cell.xyz[0]), (uint64_t)cell.xyz[1]), (uint64_t)cell.xyz[2]);
+            return (size_t)(hash ^ (hash >> 29));
+        }
+
+        // an earlier vertex in the given cell with the same normal and UV (and, with epsilon, a position within it)
+        uint32_t Find(uint32_t vertex, const Cell& cell) const
+        {
+            const float* v = Vertex(vertex);
+            for (size_t i = Hash(cell, attributeHashes[vertex]) & (slots.size() - 1); slots[i] != EMPTY_SLOT; i = (i + 1) & (slots.size() - 1))
+            {
+                const uint32_t other = slots[i];
+                if (attributeHashes[other] != attributeHashes[vertex] || !(cells[other] == cell))
+                    continue;
+
+                const float* o = Vertex(other);
+                bool equal = true;
+                for (unsigned int k = 3; k < MeshData::FLOATS_PER_VERTEX && equal; ++k)
+                    equal = FloatBits(v[k]) == FloatBits(o[k]);
+                for (int k = 0; k < 3 && equal && epsilon > 0.0f; ++k)
+                    equal = std::fabs(v[k] - o[k]) <= epsilon;
+                if (equal)
+                    return other;
+            }
+            return EMPTY_SLOT;
+        }
+
+        const MeshData& mesh;
+        const float epsilon;
+        std::vector<uint32_t> slots;            // vertex ids, EMPTY_SLOT if free
+        std::vector<Cell> cells;
+        std::vector<uint64_t> attributeHashes;  // of the normal and UV
+    };
+}
+
+
+WeldStats MeshWelder::Weld(MeshData& mesh, float positionEpsilon)
+{
+    const unsigned int stride = MeshData::FLOATS_PER_VERTEX;
+    WeldStats stats;
+    stats.verticesBefore = mesh.GetVertexCount();
+
+    WeldTable table(mesh, positionEpsilon);
+    std::vector<uint32_t> newIndex(mesh.GetVertexCount());
+    std::vector<float> welded;
+    welded.reserve(mesh.vertices.size());
+    for (uint32_t v = 0; v < mesh.GetVertexCount(); ++v)
+    {
+        const uint32_t match = table.Insert(v);
+        if (match != v)
+        {
+            newIndex[v] = newIndex[match];
+            continue;
+        }
+        newIndex[v] = (uint32_t)(welded.size() / stride);
+        welded.insert(welded.end(), mesh.vertices.begin() + (size_t)v * stride, mesh.vertices.begin() + (size_t)(v + 1) * stride);
+    }
+
+    for (unsigned short& index : mesh.indices)
+    {
+        if (index < newIndex.size())
+            index = (unsigned short)newIndex[index];
+    }
+    mesh.vertices.swap(welded);
+
+    stats.verticesAfter = mesh.GetVertexCount();
+    return stats;
+}
+
+
+void MeshWelder::PrintStats(const std::string& name, const WeldStats& stats, std::ostream& out)
+{
+    const double reduction = stats.verticesBefore > 0 ? 100.0 * (stats.verticesBefore - stats.verticesAfter) / stats.verticesBefore : 0.0;
+
+    const std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(1)
+        << "INFO: Welded " << name << ": " << stats.verticesBefore << " -> " << stats.verticesAfter << " vertices ("
+        << reduction << "% fewer)\n";
+    out.unsetf(std::ios::floatfield);
+    out.precision(precision);
+    out.flush();
+}
+
+
+bool MeshWelder::SelfTest(std::ostream& out)
+{
+    bool passed = true;
+    auto check = [&out, &passed](bool condition, const char* what) {
+        if (!condition)
+        {
+            out << "Failed mesh welder self-test: " << what << std::endl;
+            passed = false;
+        }
+    };
+    const unsigned int stride = MeshData::FLOATS_PER_VERTEX;
+
+    // CLN: the vertex each index reads, so a weld can be checked to leave every triangle as it was
+    auto expand = [stride](const MeshData& mesh) {
+        std::vector<float> corners;
+        for (unsigned short index : mesh.indices)
+            corners.insert(corners.end(), mesh.vertices.begin() + (size_t)index * stride, mesh.vertices.begin() + (size_t)(index + 1) * stride);
+        return corners;
+    };
+
+    // CLN: a cube stored like CubeVertices, two triangles of three vertices per face: 36 vertices, 24 distinct
+    MeshData cube;
+    for (int face = 0; face < 6; ++face)
+    {
+        const int axis = face / 2;
+        const float side = face % 2 == 0 ? -0.5f : 0.5f;
+        const float square[6][2] = { { -0.5f, -0.5f }, { 0.5f, -0.5f }, { 0.5f, 0.5f }, { 0.5f, 0.5f }, { -0.5f, 0.5f }, { -0.5f, -0.5f } };
+        for (int corner = 0; corner < 6; ++corner)
+        {
+            float vertex[8] = {};
+            vertex[axis] = side;
+            vertex[(axis + 1) % 3] = square[corner][0];
+            vertex[(axis + 2) % 3] = square[corner][1];
+            vertex[3 + axis] = side * 2.0f;
+            vertex[6] = square[corner][0] + 0.5f;
+            vertex[7] = square[corner][1] + 0.5f;
+            cube.vertices.insert(cube.vertices.end(), vertex, vertex + 8);
+            cube.indices.push_back((unsigned short)cube.indices.size());
+        }
+    }
+    const std::vector<float> cubeCorners = expand(cube);
+    const std::vector<float> firstVertex(cube.vertices.begin(), cube.vertices.begin() + stride);
+    WeldStats stats = Weld(cube);
+    check(stats.verticesBefore == 36 && stats.verticesAfter == 24 && cube.GetVertexCount() == 24, "a cube didn't weld to 24 vertices");
+    check(expand(cube) == cubeCorners, "a welded cube reads different corners");
+    check(std::equal(firstVertex.begin(), firstVertex.end(), cube.vertices.begin()), "a weld didn't keep the first-use order");
+    check(Weld(cube).verticesAfter == 24, "a second weld changed a welded cube");
+
+    // CLN: copies of one vertex: -0 for +0, a position moved across an epsilon cell border, and another normal
+    const float base[8] = { 0.0f, 0.24999f, 1.0f, 0.0f, 1.0f, 0.0f, 0.5f, 0.5f };
+    MeshData near;
+    for (int copy = 0; copy < 4; ++copy)
+        near.vertices.insert(near.vertices.end(), base, base + 8);
+    near.vertices[1 * stride + 0] = -0.0f;
+    near.vertices[2 * stride + 1] = 0.25001f;     // CLN: across the 0.25 cell border of the 1e-4 grid
+    near.vertices[3 * stride + 3] = 1.0f;
+    near.vertices[3 * stride + 4] = 0.0f;
+    const unsigned short nearIndices[6] = { 0, 1, 2, 2, 3, 0 };
+    near.indices.assign(nearIndices, nearIndices + 6);
+    MeshData exact = near;
+    check(Weld(exact).verticesAfter == 3 && exact.indices[1] == 0 && exact.indices[2] == 1,
+          "an exact weld didn't merge -0 with +0 alone");
+    MeshData snapped = near;
+    check(Weld(snapped, 1e-4f).verticesAfter == 2 && snapped.indices[2] == 0 && snapped.indices[4] == 1,
+          "an epsilon weld didn't merge across a cell border or merged another normal");
+    near.vertices[2 * stride + 1] = 0.250095f;    // CLN: the next cell, but 1.05 epsilon away
+    check(Weld(near, 1e-4f).verticesAfter == 3, "an epsilon weld merged vertices farther apart than epsilon");
+
+    return passed;
+}
@@ -0,0 +1,48 @@
+//========================================================================================
+// Filename      : MeshWelder.h
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Vertex welding and re-indexing for the meshes that reach
+//               : GLObject::CreateMesh() with duplicated vertices: the hand-authored
+//               : arrays (CubeVertices stores 36 vertices for 24 distinct corners) and
+//               : imported models.
+//               :
+//               : Vertices are hashed by their full V/N/T tuple into an open addressing
+//               : table in one pass, so the cost is linear in the vertex count. With a
+//               : position epsilon, positions are snapped to an epsilon grid and the
+//               : neighbouring cells are searched too, so vertices whose positions are
+//               : within epsilon (and whose normals and UVs are identical) also merge.
+//               : The surviving vertices keep their first-use order.
+//========================================================================================
+
+#ifndef MESH_WELDER_H
+#define MESH_WELDER_H
+
+#include <ostream>
+#include <string>
+
+#include "MeshData.h"
+
+struct WeldStats
+{
+    size_t verticesBefore = 0;
+    size_t verticesAfter = 0;
+
+    void Add(const WeldStats& other)    { verticesBefore += other.verticesBefore; verticesAfter += other.verticesAfter; }
+};
+
+class MeshWelder
+{
+public:
+    // merges duplicate vertices of the mesh in place and rewrites its indices
+    static WeldStats Weld(MeshData& mesh, float positionEpsilon = 0.0f);
+
+    static void PrintStats(const std::string& name, const WeldStats& stats, std::ostream& out);
+
+    // welds an unrolled cube and near-duplicate vertices and checks the counts, the order and that every triangle
+    // still reads the same corners (--self-test)
+    static bool SelfTest(std::ostream& out);
+};
+
+#endif
@@ -58,6 +58,22 @@
 //               : WASD keys    : Control the forward, backward, left, and right motion
 //               : QE keys      : Control the upwardand downward movement
 //               : P key        : Toggles between perspective and orthographic views
+//               : R key        : Rebuilds the foam ball at the next tessellation level through
+//               :                the time-sliced frame scheduler
+//               : T key        : Prints the frame stats (scheduler budget, deferred work)
+//               : L key        : Toggles the simplified LOD meshes of the tri-case and imported model
+//               : O key        : Toggles order-independent transparency (the logo's PNG alpha)
+//               : V key        : Toggles the shading LOD (cheaper shaders for objects small on screen)
+//               : C key        : Toggles the reprojection cache (reuses last frame's lighting)
+//               : F key        : Cycles the fragment debug views (overdraw, quad efficiency, off)
+//               : B key        : Toggles the debug drawing (object bounds, light labels, camera path
+//               :                and the frustum the camera had when it was turned on)
+//               : J key        : Toggles the accumulation anti-aliasing (converges while nothing moves)
+//               : K key        : Stops or restarts the lamp's orbit
+//               : N key        : Toggles checkerboard rendering (half the pixels shaded per frame)
+//               : I key        : Toggles the impostors of distant stress objects
+//               : H key        : Toggles the HLOD proxies of distant stress object clusters
+//               : M key        : Toggles the reflection probes of the marble plane and the can
 //               : Mouse cursor : Changes the orientation of the camera so it can look up 
 //               :                and down or right and left
 //               : Mouse scroll : Adjusts the speed of the movement, or the speed the camera
@@ -81,8 +97,48 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include <vector>           // CLN: Added to handle cylinder and sphere vertices and indices
+#include <memory>           // CLN: [Startup] unique_ptr for the geometry built on worker threads
+#include <chrono>           // CLN: [Startup] steady_clock for the time-to-first-frame measurement
+#include <algorithm>        // CLN: [Scheduler] std::min for the upload chunk size
+#include <cstring>          // CLN: strcmp for the command line options
+#include <cfloat>           // CLN: [Import] FLT_MAX for the model bounds
+#include <string>           // CLN: [Streaming] directory names from the command line
+#include <fstream>          // CLN: [ShaderLab] shader variants read from files
+#include <sstream>
+#ifdef _WIN32
+#include <direct.h>         // CLN: [Streaming] _mkdir for the streaming world directory
+#else
+#include <sys/stat.h>       // CLN: [Streaming] mkdir for the streaming world directory
+#endif
 #include "Cylinder.h"       // CLN: Header file from open source author Song Ho Ahn
 #include "Sphere.h"         // CLN: Header file from open source author Song ho Ahn
+#include "WorkerPool.h"     // CLN: [Startup] Worker threads for image decodes and geometry generation
+#include "TaskGraph.h"      // CLN: [Startup] Dependency graph that schedules the startup work
+#include "FrameScheduler.h" // CLN: [Scheduler] Time-sliced per-frame background work
+#include "MeshData.h"       // CLN: [Streaming] CPU-side V/N/T mesh
+#include "SceneStreamer.h"  // CLN: [Streaming] Out-of-core cell streaming for large scenes
+#include "MeshCodec.h"      // CLN: [MeshCodec] Compressed .cmesh vertex/index format
+#include "MeshImporter.h"   // CLN: [Import] Memory-mapped OBJ/glTF model importer
+#include "MeshSimplifier.h" // CLN: [LOD] Quadric edge-collapse LOD chains
+#include "GeometryCache.h"  // CLN: [GeometryCache] Memory-mapped cache of the generated sphere/cylinder meshes
+#include "MeshWelder.h"     // CLN: [Weld] Merges duplicate vertices before upload
+#include "TransparencyPass.h" // CLN: [OIT] Weighted blended order-independent transparency
+#include "GpuTimer.h"       // CLN: [ShadingLOD] GPU timer queries for the pass costs
+#include "ReprojectionCache.h" // CLN: [Reprojection] Reuses last frame's shading where the surface is unchanged
+#include "OverdrawView.h"   // CLN: [Overdraw] Overdraw and quad efficiency debug views
+#include "DebugDraw.h"      // CLN: [DebugDraw] Batched debug lines, shapes and labels from any thread
+#include "HardwareProbe.h"  // CLN: [Probe] Startup GPU benchmark that picks the quality profile
+#include "ShaderLab.h"      // CLN: [ShaderLab] A/B timing of shader variants on synthetic workloads
+#include "StressScene.h"    // CLN: [Stress] Procedural scenes of 1k to 1M objects for scaling tests
+#include "FrameArena.h"     // CLN: [Arena] Per-frame bump allocator for transient data
+#include "FlightRecorder.h" // CLN: [Flight] Always-on ring buffer of recent zones/counters, dumped on frame spikes
+#include "ProgressiveAA.h"  // CLN: [AccumAA] Jittered frames averaged into a history while the scene is still
+#include "CheckerboardRenderer.h" // CLN: [Checkerboard] Half the pixels shaded per frame, the rest reconstructed
+#include "OctahedralImpostors.h" // CLN: [Impostor] Baked multi-view quads for distant props
+#include "HlodTree.h"           // CLN: [HLOD] Merged, simplified proxies of stress object clusters
+#include "NumaTopology.h"       // CLN: [NUMA] CPUs of each memory node, thread pinning, node-local memory
+#include "MaterialLibrary.h"    // CLN: [Material] Deduplicated materials packed into one shader storage buffer
+#include "ReflectionProbes.h"   // CLN: [Reflection] Cube map probes re-rendered round-robin within the frame budget
 
 // CLN: Include LearnOpenGL's Camera class in the working directory
 #include "camera.h"
@@ -107,6 +163,8 @@ using namespace std; // Standard namespace
 #ifndef GLSL
 #define GLSL(Version, Source) "#version " #Version " core \n" #Source
 #endif
+// CLN: [Material] (with shared declarations, e.g. MATERIAL_GLSL, between the #version line and the source)
+#define GLSL_WITH(Version, Declarations, Source) "#version " #Version " core \n" Declarations #Source
 
 // Unnamed namespace
 namespace
@@ -125,6 +183,28 @@ namespace
         GLuint nIndices;    // Number of indices of the mesh
     };
 
+    // CLN: [Scheduler] CPU copy of a rebuilt mesh that is streamed to the GPU over several frames
+    struct MeshUpload
+    {
+        std::vector<GLfloat> vertices;      // interleaved V/N/T
+        std::vector<GLushort> indices;
+        std::shared_ptr<CachedGeometry> geometry;   // CLN: [GeometryCache] when set, uploaded from here instead of the vectors
+        GLMesh mesh = {};                   // new GL objects, swapped into the GLObject once complete
+        size_t vertexBytesDone = 0;
+        size_t indexBytesDone = 0;
+        bool created = false;
+    };
+
+    // CLN: [Startup] Decoded image waiting to be uploaded to the GPU
+    struct TextureImage
+    {
+        const char* filename = nullptr;
+        int width = 0;
+        int height = 0;
+        int channels = 0;
+        unsigned char* pixels = nullptr;    // owned by stb_image until UploadTexture() frees it
+    };
+
     // Main GLFW window
     GLFWwindow* gWindow = nullptr;
     // GLMesh gMesh;
@@ -146,10 +226,173 @@ namespace
     // timing
     float gDeltaTime = 0.0f; // time between current frame and last frame
     float gLastFrame = 0.0f;
+
+    // CLN: [Scheduler] Runs deferred upload/rebuild work within a fixed time budget each frame
+    //      (set with --frame-budget-ms on the command line, 2 ms by default)
+    FrameScheduler gFrameScheduler(2.0);
+
+    // CLN: [Scheduler] Set by the 'R' key, cycles the foam ball through higher tessellations
+    bool gRebuildFoamBall = false;
+    // CLN: Set by the 'T' key, prints the frame stats to the console
+    bool gPrintStats = false;
+    // CLN: [LOD] Toggled by the 'L' key, draws the simplified LOD meshes where their error is small enough
+    bool gLodEnabled = true;
+
+    // CLN: [ShadingLOD] Shader variants from full per-fragment Phong down to per-vertex lighting. Objects whose
+    //      projected radius falls under --shading-lod-pixels use the cheaper ones; the 'V' key toggles this
+    enum ShadingLevel
+    {
+        SHADING_FULL,       // per-fragment ambient + diffuse + specular (gProgramId)
+        SHADING_DIFFUSE,    // per-fragment ambient + diffuse, no specular pow()
+        SHADING_VERTEX,     // Phong evaluated per vertex and interpolated
+        SHADING_LEVEL_COUNT
+    };
+    GLuint gShadingProgramIds[SHADING_LEVEL_COUNT];
+    bool gShadingLodEnabled = true;
+    unsigned int gShadingLevelCounts[SHADING_LEVEL_COUNT];  // objects drawn at each level in the last frame
+
+    // CLN: [ShadingLOD] GPU time of the opaque and transparent passes, so the saved fragment cost shows in the 'T' stats
+    GpuTimer gOpaquePassTimer("opaque pass");
+    GpuTimer gTransparentPassTimer("transparent pass");
+
+    // CLN: [Reprojection] Toggled by the 'C' key (or --reprojection-cache). gOpaquePassMsWithoutCache is the opaque
+    //      pass average measured just before it was turned on, to report the fragment time it saves.
+    //      gLightingVersion counts the lamp's moves, so the cache knows when last frame's lighting went stale
+    ReprojectionCache gReprojectionCache;
+    bool gReprojectionEnabled = false;
+    double gOpaquePassMsWithoutCache = 0.0;
+    unsigned int gLightingVersion = 0;
+
+    // CLN: [Overdraw] Fragment debug views, cycled by the 'F' key (or written out headless by --overdraw-report)
+    OverdrawView gOverdrawView;
+    GLuint gOverdrawCountProgramId;
+    GLuint gOverdrawResolveProgramId;
+
+    // CLN: [DebugDraw] Toggled by the 'B' key. The camera path and the frustum frozen when it was turned on show
+    //      where the camera has been and what it saw from there
+    DebugDraw gDebugDraw;
+    GLuint gDebugDrawProgramId;
+    bool gDebugDrawEnabled = false;
+    GpuTimer gDebugDrawTimer("debug draw");
+    std::vector<glm::vec3> gDebugCameraPath;
+    glm::mat4 gDebugFrozenViewProjection;
+
+    // CLN: Settings read from the command line by UParseCommandLine()
+    struct Options
+    {
+        std::string streamDirectory;        // --stream <dir>: stream the cells of this world around the camera
+        int buildStreamCells = 0;           // --build-stream-world <n>: first write an n x n cell world into that directory
+        float streamDrawRadius = 30.0f;     // --stream-radius <units>
+        size_t streamBudgetMB = 512;        // --stream-budget-mb <MB>
+        bool meshCodecBenchmark = false;    // --mesh-codec-bench: report mesh codec ratio/throughput and exit
+        bool selfTest = false;              // --self-test: run the modules' self-tests and exit
+        std::string importFilename;         // --import <file>: add an OBJ/glTF model to the scene
+        float lodPixelError = 1.0f;         // --lod-pixel-error <px>: largest on-screen error of a LOD mesh
+        std::string geometryCacheDirectory = "geometry_cache";  // --geometry-cache <dir>, --no-geometry-cache
+        float weldEpsilon = 0.0f;           // --weld-epsilon <units>: also weld positions this close (exact matches only by default)
+        float shadingLodPixels = 32.0f;     // --shading-lod-pixels <px>: projected radius below which objects drop the specular term
+        int reprojectionRefresh = 8;        // --reprojection-refresh <frames>: longest a cached pixel is reused before it is relit
+        std::string overdrawReportFile;     // --overdraw-report <file>: write the overdraw counts of the first frame and exit
+        std::string quality;                // --quality <low|medium|high|ultra>: use this profile instead of probing
+        float targetFrameMs = 16.7f;        // --target-frame-ms <ms>: frame time the probed profile has to fit
+        bool reprobe = false;               // --reprobe: measure again even if this GPU is in the probe cache
+        bool shaderLab = false;             // --shader-lab: time the shader variants on synthetic workloads and exit
+        int shaderLabIterations = ShaderLab::DEFAULT_ITERATIONS;   // --shader-lab-iterations <n>
+        std::vector<std::string> shaderLabFragmentFiles;           // --shader-lab-fs <file>: (repeatable) more variants
+        bool shaderLabWallClock = false;    // --shader-lab-wall-clock: glFinish() timing even on a GPU
+        size_t stressObjects = 0;           // --stress <count>: add a procedural stress scene of this many objects
+        unsigned int stressSeed = 1;        // --stress-seed <n>
+        StressDistribution stressDistribution = STRESS_UNIFORM;    // --stress-distribution <uniform|clustered|occluders>
+        int stressLights = 1;               // --stress-lights <n>: each object is lit by the nearest of these
+        float stressExtent = 0.0f;          // --stress-extent <units>: side of the ground square (0: from the count)
+        size_t frameArenaKB = FrameArena::DEFAULT_BYTES_PER_THREAD / 1024;     // --frame-arena-kb <KB>: per thread and frame
+        bool flightRecorder = true;         // --no-flight-recorder
+        double flightRecorderSpikeMs = 50.0;    // --flight-recorder-spike-ms <ms>: frames longer than this are dumped
+        double flightRecorderSeconds = 5.0;     // --flight-recorder-seconds <s>: window written to each dump
+        std::string flightRecorderDirectory;    // --flight-recorder-dir <dir>: where the dumps go (current directory)
+        bool accumulationAA = false;        // --accumulation-aa: start with the accumulation anti-aliasing on
+        int accumulationSamples = ProgressiveAA::DEFAULT_SAMPLES;  // --accumulation-samples <n>: jittered frames averaged
+        double accumulationIdleFps = 10.0;  // --accumulation-idle-fps <fps>: frame rate once the image has converged
+        bool checkerboard = false;          // --checkerboard: start with checkerboard rendering on
+        std::string checkerboardReportFile; // --checkerboard-report <file>: compare against native rendering and exit
+        bool impostors = true;              // --no-impostors: draw every stress object as its mesh
+        float impostorPixels = 24.0f;       // --impostor-pixels <px>: stress objects smaller than this on screen are impostors
+        int impostorGridSize = OctahedralImpostors::DEFAULT_GRID_SIZE;     // --impostor-grid <n>: baked views per side
+        int impostorFrameSize = OctahedralImpostors::DEFAULT_FRAME_SIZE;   // --impostor-frame-size <px>: texels per view
+        bool hlod = false;                  // --hlod: build the HLOD tree of the stress scene
+        float hlodPixelError = 1.0f;        // --hlod-pixel-error <px>: largest projected error of a drawn HLOD proxy
+        HlodSettings hlodSettings;          // --hlod-leaf <n>, --hlod-triangles <n>
+        bool threadPinning = true;          // --no-thread-pinning: let the OS place the worker and GL threads
+        bool reflectionProbes = true;       // --no-reflection-probes
+        int reflectionProbeSize = ReflectionProbes::DEFAULT_SIZE;  // --reflection-probe-size <px>: texels per cube face side
+        int reflectionProbeFaces = ReflectionProbes::DEFAULT_FACES_PER_FRAME;  // --reflection-probe-faces <n>: faces per frame at most
+    };
+    Options gOptions;
+
+    // CLN: [Probe] Tessellation, LOD bias and resolution scale, from the hardware probe or --quality. The probe
+    //      results are kept per GL_RENDERER in HARDWARE_PROBE_CACHE, so it only runs once per GPU
+    QualityProfile gQuality = HardwareProbe::PROFILES[HardwareProbe::DEFAULT_PROFILE];
+    const char* const HARDWARE_PROBE_CACHE = "hardware_probe.cache";
+
+    // CLN: [Streaming] Only created when --stream is given
+    SceneStreamer* gStreamer = nullptr;
+
+    // CLN: [Stress] Generated at startup when --stress is given, and the CPU time its draw loop took last frame
+    StressScene gStressScene;
+    double gStressSubmitMs = 0.0;
+
+    // CLN: [Arena] Transient per-frame allocations (draw lists, sort keys) of every thread; created in main() with
+    //      the --frame-arena-kb size
+    FrameArena* gFrameArena = nullptr;
+
+    // CLN: [NUMA] main()'s worker pool, for the 'T' stats (its job counts and hardware counters)
+    WorkerPool* gWorkerPool = nullptr;
+
+    // CLN: [Flight] Records the frame's zones, GPU pass times, counters and input all the time; a frame over
+    //      --flight-recorder-spike-ms (or SIGUSR1) writes the last seconds of it to a trace file
+    FlightRecorder gFlightRecorder;
+
+    // CLN: [AccumAA] Toggled by the 'J' key (or --accumulation-aa). 'K' stops the lamp's orbit, so the lights can
+    //      hold still long enough for the image to converge
+    ProgressiveAA gProgressiveAA;
+    GLuint gAccumulateProgramId;
+    bool gLightOrbitPaused = false;
+    // CLN: [AccumAA] Bumped whenever an object's mesh is replaced; it goes into the per-frame state hash, so no
+    //      draw has to be hashed to find out that the scene changed
+    unsigned long long gSceneVersion = 0;
+
+    // CLN: [Checkerboard] Toggled by the 'N' key (or --checkerboard). --checkerboard-report turns the camera for
+    //      CHECKERBOARD_REPORT_FRAMES checkerboard frames, draws the last view natively to compare, then times as
+    //      many native frames
+    CheckerboardRenderer gCheckerboard;
+    GLuint gCheckerboardStampProgramId;
+    GLuint gCheckerboardReconstructProgramId;
+    const int CHECKERBOARD_REPORT_FRAMES = 60;
+
+    // CLN: [Impostor] Baked for the stress scene's primitive and texture pairs after loading; the 'I' key toggles them
+    OctahedralImpostors gImpostors;
+    GLuint gImpostorBakeProgramId;
+    GLuint gImpostorProgramId;
+
+    // CLN: [HLOD] Built at startup with --hlod; the 'H' key toggles it
+    HlodTree gHlod;
+
+    // CLN: [OIT] Scene framebuffer and transparency targets, resized with the window. The 'O' key toggles
+    //      the transparent pass; when off, transparent objects draw opaque as before
+    TransparencyPass gTransparencyPass;
+    GLuint gOitCompositeProgramId;
+    bool gOitEnabled = true;
+
+    // CLN: [Material] Every object's lighting parameters and texture index; filled after loading, then sorted by
+    //      texture and uploaded once
+    MaterialLibrary gMaterials;
+
+    // CLN: [Reflection] Probes at the marble plane and the can, created after loading; the 'M' key toggles them
+    ReflectionProbes gReflectionProbes;
 }
 
 // CLN: [Lighting] Added colors for the light and object
-glm::vec3 gObjectColor(1.0f, 1.0f, 1.0f); // CLN: Color for the object (r=255, g=255, b=255)
+// CLN: [Material] (the object color is now the material's)
 glm::vec3 gLightColor(1.0f, 1.0f, 1.0f);  // CLN: Color for the lamp (r=255, g=255, b=255)
 
 // CLN: [Lighting] Added position and scale for the light object (used for light orbiting)
@@ -163,13 +406,25 @@ glm::vec3 gLightScale(0.3f);
  * and render graphics on the screen
  */
 bool UInitialize(int, char* [], GLFWwindow** window);
+void UParseCommandLine(int argc, char* argv[]);
+bool UKeyPressedOnce(GLFWwindow* window, int key);
+void UPrintStats();
+bool UBuildStreamingWorld(const std::string& directory, int cellsPerSide);
+bool URunMeshCodecBenchmark();
+bool URunSelfTests();
+MeshData UWeldArrays(const char* name, const GLfloat* vertices, size_t vertexBytes, const GLushort* indices, size_t indexBytes);
 void UResizeWindow(GLFWwindow* window, int width, int height);
 void UProcessInput(GLFWwindow* window);
 void UMousePositionCallback(GLFWwindow* window, double xpos, double ypos);
 void UMouseScrollCallback(GLFWwindow* window, double xoffset, double yoffset);
 void UMouseButtonCallback(GLFWwindow* window, int button, int action, int mods);
+void UKeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
 bool UCreateShaderProgram(const char* vtxShaderSource, const char* fragShaderSource, GLuint& programId);
 void UDestroyShaderProgram(GLuint programId);
+QualityProfile USelectQualityProfile();
+bool URunShaderLab();
+void UGetSceneSize(int windowWidth, int windowHeight, int& width, int& height);
+unsigned long long UHashViewState();
 
 
 // ------------------------------------------------
@@ -206,7 +461,7 @@ void main()
 
 
 /* Fragment Shader Source Code*/
-const GLchar* fragmentShaderSource = GLSL(440,
+const GLchar* fragmentShaderSource = GLSL_WITH(440, MATERIAL_GLSL,
     
     // CLN: [Lighting] Added two vec3's for vertextNormal and vertexFragmentPos
     in vec3 vertexNormal; // For incoming normals
@@ -214,39 +469,144 @@ const GLchar* fragmentShaderSource = GLSL(440,
 
     in vec2 vertexTextureCoordinate; // CLN: [Texture] Added to handle texture coord. input from vertex shader above
 
-    out vec4 fragmentColor;
+    layout(location = 0) out vec4 fragmentColor;
+    layout(location = 1) out vec4 revealage;    // CLN: [OIT] only written in the transparent pass
+    layout(location = 2) out vec4 cachedSurface;    // CLN: [Reprojection] world normal and camera distance, when caching
 
-    // CLN: [Lighting] Added uniforms for objectColor, lightColor, lightPos, viewPosition, and uvScale
-    // Uniform / Global variables for object color, light color, light position, and camera/view position
-    uniform vec3 objectColor;
+    // CLN: [Lighting] Added uniforms for lightColor, lightPos, viewPosition, and uvScale
+    // Uniform / Global variables for light color, light position, and camera/view position
+    // CLN: [Material] objectColor, which nothing read, became the material's color
     uniform vec3 lightColor;
     uniform vec3 lightPos;
     uniform vec3 viewPosition;
     //uniform vec2 uvScale;
     // CLN: [Texture] added uniform of sampler2D tyupe to handle the texture image
     uniform sampler2D uTextureBase;
+    // CLN: [Material] The scene's materials (MATERIAL_GLSL), and the one this draw uses
+    uniform int materialIndex;
+    // CLN: [Reflection] The cube map probes (see ReflectionProbes.h): center and radius of each sphere (radius 0 until
+    //      captured; 8 is ReflectionProbes::MAX_PROBES), and the camera the reflections are seen from
+    uniform samplerCubeArray probeTexture;
+    uniform int probeCount;
+    uniform vec4 probeSpheres[8];
+    uniform vec3 probeEyePosition;
+    // CLN: [OIT] Set for the objects drawn into the weighted blended transparency targets
+    uniform bool transparentPass;
+    uniform float opacity;
+    // CLN: [Reprojection] Last frame's lit color and surfaces, and the counters of the reuse ratio (see ReprojectionCache.h)
+    uniform bool reprojectionEnabled;
+    uniform mat4 previousViewProjection;
+    uniform vec3 currentCameraPosition;
+    uniform vec3 previousCameraPosition;
+    uniform sampler2D cachedShadingTexture;
+    uniform sampler2D cachedSurfaceTexture;
+    uniform int cacheFrame;
+    uniform int refreshPeriod;
+    layout(binding = 0, offset = 0) uniform atomic_uint reusedFragments;
+    layout(binding = 0, offset = 4) uniform atomic_uint shadedFragments;
+
+
+// CLN: [Reprojection] Finds this surface point in last frame's cache. Returns true, with the stored color, if it was
+//      lit there at the same distance from the camera and with the same normal, and this 8 x 8 tile isn't due a refresh
+bool ReuseCachedShading(vec3 norm, out vec4 color)
+{
+    ivec2 tile = ivec2(gl_FragCoord.xy) / 8;
+    if ((tile.x * 7 + tile.y * 13 + cacheFrame) % refreshPeriod == 0)
+        return false;
+
+    vec4 previousClip = previousViewProjection * vec4(vertexFragmentPos, 1.0);
+    if (previousClip.w <= 0.0)
+        return false;   // behind last frame's camera
+    vec2 uv = previousClip.xy / previousClip.w * 0.5 + 0.5;
+    if (any(lessThan(uv, vec2(0.0))) || any(greaterThanEqual(uv, vec2(1.0))))
+        return false;   // off last frame's screen
+
+    ivec2 texel = ivec2(uv * vec2(textureSize(cachedSurfaceTexture, 0)));
+    vec4 surface = texelFetch(cachedSurfaceTexture, texel, 0);
+    float expectedDistance = length(previousCameraPosition - vertexFragmentPos);
+    if (surface.w < 0.0 || abs(surface.w - expectedDistance) > 0.01 * expectedDistance || dot(surface.xyz, norm) < 0.95)
+        return false;   // disoccluded, or another surface was cached there
+
+    color = texelFetch(cachedShadingTexture, texel, 0);
+    return true;
+}
+
+
+// CLN: [Reflection] The probe image reflected at this point (rgb) and how much of it to show (a: Schlick's Fresnel term
+//      for the reflectivity, 0 outside every probe). The probe whose sphere holds the point, the nearest center if
+//      several do, is read where the reflected view ray leaves its sphere, so reflections of nearby objects line up
+//      with them; the mip level grows as the Phong lobe of the highlight size widens (about 1 / sqrt(size) radians)
+vec4 ProbeReflection(vec3 norm, float reflectivity, float highlightSize)
+{
+    int probe = -1;
+    float nearest = 0.0;
+    for (int i = 0; i < probeCount; ++i)
+    {
+        vec3 offset = vertexFragmentPos - probeSpheres[i].xyz;
+        float distanceSquared = dot(offset, offset);
+        if (distanceSquared < probeSpheres[i].w * probeSpheres[i].w && (probe < 0 || distanceSquared < nearest))
+        {
+            probe = i;
+            nearest = distanceSquared;
+        }
+    }
+    if (probe < 0)
+        return vec4(0.0);
+
+    vec3 eyeDirection = normalize(vertexFragmentPos - probeEyePosition);
+    vec3 ray = reflect(eyeDirection, norm);
+    vec3 origin = vertexFragmentPos - probeSpheres[probe].xyz;
+    float b = dot(origin, ray);
+    float c = dot(origin, origin) - probeSpheres[probe].w * probeSpheres[probe].w;
+    vec3 direction = origin + (sqrt(max(b * b - c, 0.0)) - b) * ray;
+
+    float faceSize = float(textureSize(probeTexture, 0).x);
+    float lod = clamp(log2(faceSize / 1.5708) - 0.5 * log2(max(highlightSize, 1.0)), 0.0, float(textureQueryLevels(probeTexture) - 1));
+    vec3 reflection = textureLod(probeTexture, vec4(direction, float(probe)), lod).rgb;
+    float fresnel = reflectivity + (1.0 - reflectivity) * pow(1.0 - max(dot(norm, -eyeDirection), 0.0), 5.0);
+    return vec4(reflection, fresnel);
+}
 
 
 void main()
 {
+    vec3 norm = normalize(vertexNormal); // Normalize vectors to 1 unit
+
+    // CLN: [Reprojection] Reuse last frame's lighting of this point where possible, and record the surface for the next frame
+    if (reprojectionEnabled && !transparentPass)
+    {
+        cachedSurface = vec4(norm, length(currentCameraPosition - vertexFragmentPos));
+        vec4 cachedColor;
+        if (ReuseCachedShading(norm, cachedColor))
+        {
+            atomicCounterIncrement(reusedFragments);
+            fragmentColor = cachedColor;
+            return;
+        }
+        atomicCounterIncrement(shadedFragments);
+    }
+    else
+        cachedSurface = vec4(0.0, 0.0, 0.0, -1.0);
+
     // CLN: [Lighting] Added the following code for Phong lighting model calcs
     //      Changed uTexture to uTextureBase to match previous code variable
 
     /*Phong lighting model calculations to generate ambient, diffuse, and specular components*/
+    // CLN: [Material] The strengths come from the draw's material instead of constants
+    Material material = materials[materialIndex];
 
     //Calculate Ambient lighting*/
-    float ambientStrength = 0.1f; // Set ambient or global lighting strength
+    float ambientStrength = material.ambientStrength; // Set ambient or global lighting strength
     vec3 ambient = ambientStrength * lightColor; // Generate ambient light color
 
     //Calculate Diffuse lighting*/
-    vec3 norm = normalize(vertexNormal); // Normalize vectors to 1 unit
     vec3 lightDirection = normalize(lightPos - vertexFragmentPos); // Calculate distance (light direction) between light source and fragments/pixels on cube
     float impact = max(dot(norm, lightDirection), 0.0);// Calculate diffuse impact by generating dot product of normal and light
     vec3 diffuse = impact * lightColor; // Generate diffuse light color
 
     //Calculate Specular lighting*/
-    float specularIntensity = 0.8f; // Set specular light strength
-    float highlightSize = 16.0f; // Set specular highlight size
+    float specularIntensity = material.specularIntensity; // Set specular light strength
+    float highlightSize = material.highlightSize; // Set specular highlight size
     vec3 viewDir = normalize(viewPosition - vertexFragmentPos); // Calculate view direction
     vec3 reflectDir = reflect(-lightDirection, norm);// Calculate reflection vector
     //Calculate specular component
@@ -260,9 +620,27 @@ void main()
     vec4 textureColor = texture(uTextureBase, vertexTextureCoordinate);
     
     // Calculate phong result
-    vec3 phong = (ambient + diffuse + specular) * textureColor.xyz;
+    vec3 phong = (ambient + diffuse + specular) * textureColor.xyz * material.color;
+
+    // CLN: [Reflection] Reflective materials show their surroundings over the lit color
+    if (material.reflectivity > 0.0)
+    {
+        vec4 reflection = ProbeReflection(norm, material.reflectivity, highlightSize);
+        phong = mix(phong, reflection.rgb, reflection.a);
+    }
     
-    fragmentColor = vec4(phong, 1.0); // Send lighting results to GPU
+    // CLN: [OIT] Transparent objects add their premultiplied color and coverage with a weight that falls off
+    //      with the distance to the camera (McGuire and Bavoil, equation 7), so nearer layers dominate without any sorting
+    if (transparentPass)
+    {
+        float alpha = textureColor.a * opacity;
+        float distance = length(viewPosition - vertexFragmentPos);
+        float weight = alpha * clamp(10.0 / (1e-5 + pow(distance / 5.0, 2.0) + pow(distance / 200.0, 6.0)), 1e-2, 3e3);
+        fragmentColor = vec4(phong * alpha, alpha) * weight;
+        revealage = vec4(alpha);
+    }
+    else
+        fragmentColor = vec4(phong, 1.0); // Send lighting results to GPU
     
     //fragmentColor = vec4(vertexColor);
     //fragmentColor = texture(uTextureBase, vertexTextureCoordinate); // CLN: Notice, not passing vertexColor because now using a texture
@@ -270,6 +648,106 @@ void main()
 );
 
 
+// CLN: [ShadingLOD] Cheaper variants of the Phong shader for objects that cover few pixels. Both keep the
+//      uniform names of the full shader, so RenderModel() sets them the same way whichever variant draws
+/* Diffuse-only Fragment Shader Source Code (used with vertexShaderSource)*/
+const GLchar* diffuseFragmentShaderSource = GLSL_WITH(440, MATERIAL_GLSL,
+
+    in vec3 vertexNormal;
+    in vec3 vertexFragmentPos;
+    in vec2 vertexTextureCoordinate;
+
+    layout(location = 0) out vec4 fragmentColor;
+    layout(location = 2) out vec4 cachedSurface;    // CLN: [Reprojection] never reused
+
+    uniform vec3 lightColor;
+    uniform vec3 lightPos;
+    uniform sampler2D uTextureBase;
+    // CLN: [Material] The scene's materials (MATERIAL_GLSL), and the one this draw uses
+    uniform int materialIndex;
+
+void main()
+{
+    cachedSurface = vec4(0.0, 0.0, 0.0, -1.0);
+
+    // CLN: ambient and diffuse as in fragmentShaderSource; the specular highlight (and its pow()) is
+    //      dropped, it is only a few pixels wide at this size anyway
+    Material material = materials[materialIndex];
+    vec3 ambient = material.ambientStrength * lightColor;
+
+    vec3 norm = normalize(vertexNormal);
+    vec3 lightDirection = normalize(lightPos - vertexFragmentPos);
+    float impact = max(dot(norm, lightDirection), 0.0);
+    vec3 diffuse = impact * lightColor;
+
+    vec4 textureColor = texture(uTextureBase, vertexTextureCoordinate);
+    fragmentColor = vec4((ambient + diffuse) * textureColor.xyz * material.color, 1.0);
+}
+);
+
+
+/* Per-vertex Lighting Shader Source Code*/
+const GLchar* vertexLitVertexShaderSource = GLSL_WITH(440, MATERIAL_GLSL,
+    layout(location = 0) in vec3 position;
+    layout(location = 1) in vec3 normal;
+    layout(location = 2) in vec2 textureCoordinate;
+
+    out vec3 vertexLighting;            // CLN: ambient + diffuse + specular (times the material color), interpolated across the triangle
+    out vec2 vertexTextureCoordinate;
+
+    uniform mat4 model;
+    uniform mat4 view;
+    uniform mat4 projection;
+    uniform vec3 lightColor;
+    uniform vec3 lightPos;
+    uniform vec3 viewPosition;
+    // CLN: [Material] The scene's materials (MATERIAL_GLSL), and the one this draw uses
+    uniform int materialIndex;
+
+void main()
+{
+    gl_Position = projection * view * model * vec4(position, 1.0f);
+    vec3 worldPosition = vec3(model * vec4(position, 1.0f));
+    vec3 norm = normalize(mat3(transpose(inverse(model))) * normal);
+
+    // CLN: the same Phong terms as fragmentShaderSource, once per vertex instead of once per fragment
+    Material material = materials[materialIndex];
+    vec3 ambient = material.ambientStrength * lightColor;
+
+    vec3 lightDirection = normalize(lightPos - worldPosition);
+    float impact = max(dot(norm, lightDirection), 0.0);
+    vec3 diffuse = impact * lightColor;
+
+    vec3 viewDir = normalize(viewPosition - worldPosition);
+    vec3 reflectDir = reflect(-lightDirection, norm);
+    float specularComponent = pow(max(dot(viewDir, reflectDir), 0.0), material.highlightSize);
+    vec3 specular = material.specularIntensity * specularComponent * lightColor;
+
+    vertexLighting = (ambient + diffuse + specular) * material.color;
+    vertexTextureCoordinate = textureCoordinate;
+}
+);
+
+
+const GLchar* vertexLitFragmentShaderSource = GLSL(440,
+
+    in vec3 vertexLighting;
+    in vec2 vertexTextureCoordinate;
+
+    layout(location = 0) out vec4 fragmentColor;
+    layout(location = 2) out vec4 cachedSurface;    // CLN: [Reprojection] never reused
+
+    uniform sampler2D uTextureBase;
+
+void main()
+{
+    cachedSurface = vec4(0.0, 0.0, 0.0, -1.0);
+    vec4 textureColor = texture(uTextureBase, vertexTextureCoordinate);
+    fragmentColor = vec4(vertexLighting * textureColor.xyz, 1.0);
+}
+);
+
+
 // CLN: [Lighting] Added shader sources for lampVertexShaderSource and lampFragmentShaderSource shaders
 /* Lamp Shader Source Code*/
 const GLchar* lampVertexShaderSource = GLSL(440,
@@ -291,13 +769,15 @@ void main()
 /* Fragment Shader Source Code*/
 const GLchar* lampFragmentShaderSource = GLSL(440,
 
-    out vec4 fragmentColor; // For outgoing lamp color (smaller cube) to the GPU
+    layout(location = 0) out vec4 fragmentColor; // For outgoing lamp color (smaller cube) to the GPU
+    layout(location = 2) out vec4 cachedSurface; // CLN: [Reprojection] lamps are never reused
 
     // CLN: Added lightColor uniform to pass light color to lamp object
     uniform vec3 lightColor;
 
 void main()
 {
+    cachedSurface = vec4(0.0, 0.0, 0.0, -1.0);
     //fragmentColor = vec4(1.0f); // Set color to white (1.0f,1.0f,1.0f) with alpha 1.0
     //CLN: passed lightColor to fragment with alpha 1.0
     fragmentColor = vec4(lightColor, 1.0); // Set color to white (1.0f,1.0f,1.0f) with alpha 1.0
@@ -305,6 +785,540 @@ void main()
 );
 
 
+// CLN: [OIT] Composite pass: resolves the accumulation and revealage targets over the opaque scene
+/* OIT Composite Shader Source Code*/
+const GLchar* oitCompositeVertexShaderSource = GLSL(440,
+
+void main()
+{
+    // CLN: one triangle that covers the screen, generated from the vertex id (no vertex buffer)
+    vec2 corner = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);
+}
+);
+
+
+const GLchar* oitCompositeFragmentShaderSource = GLSL(440,
+
+    out vec4 fragmentColor;
+
+    uniform sampler2D accumulationTexture;
+    uniform sampler2D revealageTexture;
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    float revealage = texelFetch(revealageTexture, pixel, 0).r;
+    if (revealage >= 1.0)
+        discard;    // no transparent surface here
+
+    vec4 accumulation = texelFetch(accumulationTexture, pixel, 0);
+    // CLN: keep the average color finite if the half floats overflowed
+    if (isinf(max(max(abs(accumulation.r), abs(accumulation.g)), abs(accumulation.b))))
+        accumulation.rgb = vec3(accumulation.a);
+    vec3 averageColor = accumulation.rgb / max(accumulation.a, 1e-5);
+
+    fragmentColor = vec4(averageColor, 1.0 - revealage);   // blended over the opaque color with SRC_ALPHA
+}
+);
+
+
+// CLN: [Overdraw] Counting shader of the overdraw and quad efficiency views (used with vertexShaderSource).
+//      GLSL 4.50 for gl_HelperInvocation; the views are unavailable where it doesn't compile
+/* Overdraw Count Shader Source Code*/
+const GLchar* overdrawCountFragmentShaderSource = GLSL(450,
+
+    // CLN: count only the fragments that pass the depth test, as the scene shaders (free of side effects) would
+    layout(early_fragment_tests) in;
+
+    layout(binding = 0, r32ui) uniform coherent uimage2D overdrawImage;
+    layout(binding = 1, r32ui) uniform coherent uimage2D quadShareImage;
+    layout(std430, binding = 3) buffer ObjectCounters
+    {
+        uvec2 objectCounters[];     // fragments, quad share
+    };
+    uniform int objectId;
+
+void main()
+{
+    // CLN: live lanes of this 2x2 quad: helper lanes only run for the derivatives and add 0. The pair sum of the
+    //      row comes from the horizontal difference, the quad sum from the vertical difference of the pair sums
+    float live = gl_HelperInvocation ? 0.0 : 1.0;
+    float dx = dFdxFine(live);
+    float pairSum = 2.0 * live + ((int(gl_FragCoord.x) & 1) == 0 ? dx : -dx);
+    float dy = dFdyFine(pairSum);
+    float quadSum = 2.0 * pairSum + ((int(gl_FragCoord.y) & 1) == 0 ? dy : -dy);
+
+    if (gl_HelperInvocation)
+        return;
+    uint share = uint(12.0 / max(quadSum, 1.0) + 0.5);     // 12, 6, 4 or 3
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    imageAtomicAdd(overdrawImage, pixel, 1u);
+    imageAtomicAdd(quadShareImage, pixel, share);
+    atomicAdd(objectCounters[objectId].x, 1u);
+    atomicAdd(objectCounters[objectId].y, share);
+}
+);
+
+
+// CLN: [Overdraw] Heat map of the counts (used with oitCompositeVertexShaderSource)
+const GLchar* overdrawResolveFragmentShaderSource = GLSL(450,
+
+    out vec4 fragmentColor;
+
+    layout(binding = 0, r32ui) uniform readonly uimage2D overdrawImage;
+    layout(binding = 1, r32ui) uniform readonly uimage2D quadShareImage;
+    uniform int mode;   // OverdrawViewMode
+
+// 0 blue, 0.33 green, 0.67 yellow, 1 red
+vec3 Heat(float t)
+{
+    t = clamp(t, 0.0, 1.0);
+    return clamp(vec3(3.0 * t - 1.0, t < 0.67 ? 3.0 * t : 3.0 - 3.0 * t, 1.0 - 3.0 * t), 0.0, 1.0);
+}
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    uint fragments = imageLoad(overdrawImage, pixel).r;
+    if (fragments == 0u)
+    {
+        fragmentColor = vec4(0.0, 0.0, 0.0, 1.0);
+        return;
+    }
+
+    if (mode == 1)
+        fragmentColor = vec4(Heat(float(fragments - 1u) / 7.0), 1.0);  // 1 .. 8 or more fragments
+    else
+    {
+        // lanes run per useful fragment: 12 shares per quad of 4 lanes
+        float lanesPerFragment = float(imageLoad(quadShareImage, pixel).r) / (3.0 * float(fragments));
+        fragmentColor = vec4(Heat((lanesPerFragment - 1.0) / 3.0), 1.0);
+    }
+}
+);
+
+
+// CLN: [DebugDraw] Unlit colored lines of the debug drawing (see DebugDraw.h)
+/* Debug Draw Shader Source Code*/
+const GLchar* debugDrawVertexShaderSource = GLSL(440,
+
+    layout(location = 0) in vec3 position;
+    layout(location = 1) in vec4 color;     // RGBA8, normalized
+
+    out vec4 vertexColor;
+
+    uniform mat4 viewProjection;
+
+void main()
+{
+    gl_Position = viewProjection * vec4(position, 1.0f);
+    vertexColor = color;
+}
+);
+
+
+const GLchar* debugDrawFragmentShaderSource = GLSL(440,
+
+    in vec4 vertexColor;
+
+    out vec4 fragmentColor;
+
+void main()
+{
+    fragmentColor = vertexColor;
+}
+);
+
+
+// CLN: [Probe] Micro-scenes of the startup hardware probe (see HardwareProbe.h)
+/* Hardware Probe Shader Source Code*/
+const GLchar* probeVertexShaderSource = GLSL(440,
+
+    layout(location = 0) in vec2 position;
+
+    uniform vec2 offset;
+
+void main()
+{
+    gl_Position = vec4(position + offset, 0.0, 1.0);
+}
+);
+
+
+const GLchar* probeSolidFragmentShaderSource = GLSL(440,
+
+    out vec4 fragmentColor;
+
+    uniform vec4 color;
+
+void main()
+{
+    fragmentColor = color;
+}
+);
+
+
+// CLN: [Probe] (used with oitCompositeVertexShaderSource) four taps per pixel, one in each quadrant of the texture
+const GLchar* probeTextureFragmentShaderSource = GLSL(440,
+
+    out vec4 fragmentColor;
+
+    uniform sampler2D probeTexture;
+
+void main()
+{
+    vec2 uv = gl_FragCoord.xy / vec2(textureSize(probeTexture, 0));
+    fragmentColor = texture(probeTexture, uv) + texture(probeTexture, uv + vec2(0.5, 0.0))
+                  + texture(probeTexture, uv + vec2(0.0, 0.5)) + texture(probeTexture, uv + vec2(0.5, 0.5));
+}
+);
+
+
+// CLN: [AccumAA] (used with oitCompositeVertexShaderSource) copies the scene color into the history, where the
+//      constant blend alpha turns it into a running average
+const GLchar* accumulateFragmentShaderSource = GLSL(440,
+
+    out vec4 fragmentColor;
+
+    uniform sampler2D sceneTexture;
+
+void main()
+{
+    fragmentColor = texelFetch(sceneTexture, ivec2(gl_FragCoord.xy), 0);
+}
+);
+
+
+// CLN: [Checkerboard] (used with oitCompositeVertexShaderSource) keeps the pixels of the 2x2 blocks where
+//      x / 2 + y / 2 is odd, whose stencil is set to 1
+const GLchar* checkerboardStampFragmentShaderSource = GLSL(440,
+
+    out vec4 fragmentColor;
+
+void main()
+{
+    ivec2 block = ivec2(gl_FragCoord.xy) >> 1;
+    if (((block.x + block.y) & 1) == 0)
+        discard;
+    fragmentColor = vec4(0.0);
+}
+);
+
+
+// CLN: [Checkerboard] (used with oitCompositeVertexShaderSource) fills in the 2x2 blocks this frame didn't shade.
+//      The depths of the nearest shaded pixels left, right, below and above are reprojected into the last frame;
+//      if the last frame has one of those surfaces there, its color is reused, otherwise the pixel is interpolated
+//      from the neighbours along the edge
+const GLchar* checkerboardReconstructFragmentShaderSource = GLSL(440,
+
+    layout(location = 0) out vec4 fragmentColor;
+    layout(location = 1) out float fragmentDepth;
+
+    uniform sampler2D sceneColorTexture;
+    uniform sampler2D sceneDepthTexture;
+    uniform sampler2D historyColorTexture;      // last frame, reconstructed
+    uniform sampler2D historyDepthTexture;
+    uniform mat4 currentToPrevious;
+    uniform int parity;                         // blocks where (x / 2 + y / 2) & 1 == parity were shaded
+    uniform bool historyValid;
+    uniform bool clampHistory;                  // the camera moved: clamp the history to the neighbours
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    ivec2 size = textureSize(sceneColorTexture, 0);
+    ivec2 block = pixel >> 1;
+    if (((block.x + block.y) & 1) == parity)
+    {
+        fragmentColor = texelFetch(sceneColorTexture, pixel, 0);
+        fragmentDepth = texelFetch(sceneDepthTexture, pixel, 0).r;
+        return;
+    }
+
+    // CLN: left, right, below, above: the edge pixels of the shaded blocks around this one, 1 or 2 pixels away.
+    //      Off screen ones take the opposite neighbour
+    ivec2 neighbourPixels[4] = ivec2[4](ivec2(block.x * 2 - 1, pixel.y), ivec2(block.x * 2 + 2, pixel.y),
+                                        ivec2(pixel.x, block.y * 2 - 1), ivec2(pixel.x, block.y * 2 + 2));
+    vec4 neighbours[4];
+    float depths[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        ivec2 neighbour = neighbourPixels[i];
+        if (any(lessThan(neighbour, ivec2(0))) || any(greaterThanEqual(neighbour, size)))
+            neighbour = neighbourPixels[i ^ 1];
+        neighbours[i] = texelFetch(sceneColorTexture, neighbour, 0);
+        depths[i] = texelFetch(sceneDepthTexture, neighbour, 0).r;
+    }
+    vec4 minColor = min(min(neighbours[0], neighbours[1]), min(neighbours[2], neighbours[3]));
+    vec4 maxColor = max(max(neighbours[0], neighbours[1]), max(neighbours[2], neighbours[3]));
+    fragmentDepth = min(min(depths[0], depths[1]), min(depths[2], depths[3]));
+
+    // CLN: the pixel is (almost always) on the surface of one of its neighbours; where the last frame saw that
+    //      surface at the reprojected position, it shaded this point
+    vec2 ndc = (vec2(pixel) + 0.5) / vec2(size) * 2.0 - 1.0;
+    for (int i = 0; i < 4 && historyValid; ++i)
+    {
+        vec4 previous = currentToPrevious * vec4(ndc, depths[i] * 2.0 - 1.0, 1.0);
+        previous.xyz /= previous.w;
+        vec2 uv = previous.xy * 0.5 + 0.5;
+        float expectedDepth = previous.z * 0.5 + 0.5;
+        if (previous.w <= 0.0 || any(lessThan(uv, vec2(0.0))) || any(greaterThanEqual(uv, vec2(1.0))))
+            continue;
+
+        // CLN: only pixels the last frame shaded are reused (reconstructed ones would compound their error), and
+        //      unfiltered, since filtering blurs a little more every frame
+        ivec2 previousPixel = ivec2(uv * vec2(size));
+        ivec2 previousBlock = previousPixel >> 1;
+        if (((previousBlock.x + previousBlock.y) & 1) == parity)
+            continue;
+
+        // CLN: window depth is hyperbolic, so the tolerance shrinks towards the far plane
+        float storedDepth = texelFetch(historyDepthTexture, previousPixel, 0).r;
+        if (abs(storedDepth - expectedDepth) < 0.02 * (1.0 - expectedDepth) + 1e-6)
+        {
+            vec4 history = texelFetch(historyColorTexture, previousPixel, 0);
+            fragmentColor = clampHistory ? clamp(history, minColor, maxColor) : history;
+            fragmentDepth = depths[i];
+            return;
+        }
+    }
+
+    // CLN: disoccluded: interpolate between the pair that differs least, so edges aren't blurred across
+    const vec3 luma = vec3(0.299, 0.587, 0.114);
+    float horizontal = abs(dot(neighbours[0].rgb - neighbours[1].rgb, luma));
+    float vertical = abs(dot(neighbours[2].rgb - neighbours[3].rgb, luma));
+    vec2 weight = (vec2(pixel & 1) + 1.0) / 3.0;
+    fragmentColor = horizontal <= vertical ? mix(neighbours[0], neighbours[1], weight.x) : mix(neighbours[2], neighbours[3], weight.y);
+}
+);
+
+
+// CLN: [Impostor] Renders a mesh into one frame of the impostor atlases: an orthographic view of the bounding sphere
+//      from bakeDirection, with the depth measured from the sphere's front
+const GLchar* impostorBakeVertexShaderSource = GLSL(440,
+    layout(location = 0) in vec3 position;
+    layout(location = 1) in vec3 normal;
+    layout(location = 2) in vec2 textureCoordinate;
+
+    out vec3 bakeNormal;
+    out vec2 bakeTextureCoordinate;
+    out float bakeDepth;
+
+    uniform vec3 bakeDirection;     // from the object towards the viewer
+    uniform vec3 bakeRight;
+    uniform vec3 bakeUp;
+    uniform float radius;
+
+void main()
+{
+    bakeDepth = (radius - dot(position, bakeDirection)) / (2.0 * radius);
+    gl_Position = vec4(dot(position, bakeRight) / radius, dot(position, bakeUp) / radius, bakeDepth * 2.0 - 1.0, 1.0);
+    bakeNormal = normal;
+    bakeTextureCoordinate = textureCoordinate;
+}
+);
+
+
+const GLchar* impostorBakeFragmentShaderSource = GLSL(440,
+
+    in vec3 bakeNormal;
+    in vec2 bakeTextureCoordinate;
+    in float bakeDepth;
+
+    layout(location = 0) out vec4 albedo;
+    layout(location = 1) out vec4 normalColor;
+    layout(location = 2) out vec4 depth;
+
+    uniform sampler2D uTextureBase;
+
+void main()
+{
+    albedo = vec4(texture(uTextureBase, bakeTextureCoordinate).rgb, 1.0);
+    normalColor = vec4(normalize(bakeNormal) * 0.5 + 0.5, 1.0);
+    depth = vec4(bakeDepth);
+}
+);
+
+
+// CLN: [Impostor] One camera-facing quad per instance, in front of its bounding sphere. The direction it is seen
+//      from (in object space) picks the three nearest baked views
+const GLchar* impostorVertexShaderSource = GLSL(440,
+    layout(location = 0) in vec4 modelRow0;     // per instance: the rows of the affine model matrix
+    layout(location = 1) in vec4 modelRow1;
+    layout(location = 2) in vec4 modelRow2;
+    layout(location = 3) in vec4 instanceLightPosition;
+    layout(location = 4) in vec4 instanceLightColor;  // CLN: [Material] w: the instance's material slot
+
+    out vec3 objectPosition;                    // on the quad
+    out vec3 objectRay;                         // from the camera, in object space
+    flat out vec3 frameDirections[3];
+    flat out vec3 frameRights[3];
+    flat out vec3 frameUps[3];
+    flat out vec2 frameOrigins[3];              // atlas coordinates of the frames
+    flat out vec3 frameWeights;
+    flat out vec4 modelRows[3];
+    flat out vec3 lightPosition;
+    flat out vec3 lightColor;
+    flat out int materialSlot;
+
+    uniform mat4 viewProjection;
+    uniform vec3 cameraPosition;
+    uniform float radius;
+    uniform int gridSize;
+
+// CLN: the upper hemisphere onto [-1, 1]^2 and back (see HemiOctDecode() in OctahedralImpostors.cpp)
+vec2 HemiOctEncode(vec3 direction)
+{
+    direction /= abs(direction.x) + abs(direction.y) + abs(direction.z);
+    return vec2(direction.x + direction.z, direction.x - direction.z);
+}
+
+vec3 HemiOctDecode(vec2 coordinates)
+{
+    vec2 xz = vec2(coordinates.x + coordinates.y, coordinates.x - coordinates.y) * 0.5;
+    return normalize(vec3(xz.x, 1.0 - abs(xz.x) - abs(xz.y), xz.y));
+}
+
+void FrameBasis(vec3 direction, out vec3 right, out vec3 up)
+{
+    vec3 reference = abs(direction.y) > 0.999 ? vec3(0.0, 0.0, 1.0) : vec3(0.0, 1.0, 0.0);
+    right = normalize(cross(reference, direction));
+    up = cross(direction, right);
+}
+
+void main()
+{
+    mat4 model = transpose(mat4(modelRow0, modelRow1, modelRow2, vec4(0.0, 0.0, 0.0, 1.0)));
+    mat4 inverseModel = inverse(model);
+    vec3 localCamera = vec3(inverseModel * vec4(cameraPosition, 1.0));
+    vec3 viewDirection = normalize(localCamera);
+
+    // CLN: views from below the horizon use the horizon's frames
+    vec3 frameView = normalize(vec3(viewDirection.x, max(viewDirection.y, 1e-3), viewDirection.z));
+    vec2 grid = (HemiOctEncode(frameView) * 0.5 + 0.5) * float(gridSize - 1);
+    vec2 base = min(floor(grid), vec2(float(gridSize - 2)));
+    vec2 fraction = grid - base;
+    vec2 cells[3];
+    cells[0] = base;
+    cells[1] = base + vec2(1.0);
+    if (fraction.x > fraction.y)
+    {
+        cells[2] = base + vec2(1.0, 0.0);
+        frameWeights = vec3(1.0 - fraction.x, fraction.y, fraction.x - fraction.y);
+    }
+    else
+    {
+        cells[2] = base + vec2(0.0, 1.0);
+        frameWeights = vec3(1.0 - fraction.y, fraction.x, fraction.y - fraction.x);
+    }
+    for (int i = 0; i < 3; ++i)
+    {
+        frameDirections[i] = HemiOctDecode(cells[i] / float(gridSize - 1) * 2.0 - 1.0);
+        FrameBasis(frameDirections[i], frameRights[i], frameUps[i]);
+        frameOrigins[i] = cells[i] / float(gridSize);
+    }
+
+    // CLN: (the quad covers the sphere's silhouette from any distance further than 1.5 radii)
+    vec3 right;
+    vec3 up;
+    FrameBasis(viewDirection, right, up);
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 2.0 - 1.0;
+    objectPosition = (right * corner.x + up * corner.y + viewDirection) * radius;
+    objectRay = objectPosition - localCamera;
+
+    modelRows[0] = modelRow0;
+    modelRows[1] = modelRow1;
+    modelRows[2] = modelRow2;
+    lightPosition = instanceLightPosition.xyz;
+    lightColor = instanceLightColor.rgb;
+    materialSlot = int(instanceLightColor.w);
+    gl_Position = viewProjection * model * vec4(objectPosition, 1.0);
+}
+);
+
+
+// CLN: [Impostor] Follows the pixel's ray into each of the three views (where it crosses the plane through the
+//      object's center facing that view), blends them, moves the fragment back to the baked surface (never forward,
+//      so early depth testing still rejects hidden quads) and lights it as fragmentShaderSource does
+const GLchar* impostorFragmentShaderSource = GLSL_WITH(440, MATERIAL_GLSL,
+
+    in vec3 objectPosition;
+    in vec3 objectRay;
+    flat in vec3 frameDirections[3];
+    flat in vec3 frameRights[3];
+    flat in vec3 frameUps[3];
+    flat in vec2 frameOrigins[3];
+    flat in vec3 frameWeights;
+    flat in vec4 modelRows[3];
+    flat in vec3 lightPosition;
+    flat in vec3 lightColor;
+    flat in int materialSlot;   // CLN: [Material] this instance's material in the buffer (MATERIAL_GLSL)
+
+    layout(location = 0) out vec4 fragmentColor;
+    layout(location = 2) out vec4 cachedSurface;    // CLN: [Reprojection] never reused
+    layout(depth_greater) out float gl_FragDepth;
+
+    uniform sampler2D albedoAtlas;
+    uniform sampler2D normalAtlas;
+    uniform sampler2D depthAtlas;
+    uniform mat4 viewProjection;
+    uniform vec3 viewPosition;
+    uniform float radius;
+    uniform int gridSize;
+
+void main()
+{
+    // CLN: (sampled everywhere and masked, so the mipmap derivatives stay defined)
+    vec4 albedo = vec4(0.0);
+    vec4 normal = vec4(0.0);
+    float rayDistance = 0.0;
+    for (int i = 0; i < 3; ++i)
+    {
+        float rayDot = min(dot(objectRay, frameDirections[i]), -1e-4 * radius);
+        vec3 onPlane = objectPosition - objectRay * (dot(objectPosition, frameDirections[i]) / rayDot);
+        vec2 coordinates = vec2(dot(onPlane, frameRights[i]), dot(onPlane, frameUps[i])) / radius * 0.5 + 0.5;
+        float inside = all(greaterThanEqual(coordinates, vec2(0.0))) && all(lessThanEqual(coordinates, vec2(1.0))) ? frameWeights[i] : 0.0;
+        vec2 uv = frameOrigins[i] + clamp(coordinates, 0.0, 1.0) / float(gridSize);
+        vec4 viewAlbedo = texture(albedoAtlas, uv);
+        albedo += inside * viewAlbedo;
+        normal += inside * texture(normalAtlas, uv);
+
+        // CLN: the baked depth places the surface on a plane facing this view; how far along the ray it lies
+        float depth = texture(depthAtlas, uv).r / max(viewAlbedo.a, 1e-3);
+        float planeOffset = radius * (1.0 - 2.0 * depth) - dot(objectPosition, frameDirections[i]);
+        rayDistance += inside * viewAlbedo.a * planeOffset / rayDot;
+    }
+    if (albedo.a < 0.5)
+        discard;
+
+    // CLN: the atlases are premultiplied by coverage
+    vec3 color = albedo.rgb / albedo.a;
+    vec3 objectNormal = normalize(normal.rgb / normal.a * 2.0 - 1.0);
+    vec3 surface = objectPosition + objectRay * max(rayDistance / albedo.a, 0.0);
+
+    mat4 model = transpose(mat4(modelRows[0], modelRows[1], modelRows[2], vec4(0.0, 0.0, 0.0, 1.0)));
+    mat3 axes = mat3(model);
+    vec3 vertexFragmentPos = vec3(model * vec4(surface, 1.0));
+    vec3 norm = normalize(transpose(inverse(axes)) * objectNormal);
+    vec4 clipPosition = viewProjection * vec4(vertexFragmentPos, 1.0);
+    gl_FragDepth = max(clipPosition.z / clipPosition.w * 0.5 + 0.5, gl_FragCoord.z);
+
+    // CLN: the Phong terms of fragmentShaderSource, with the instance's material
+    Material material = materials[materialSlot];
+    vec3 ambient = material.ambientStrength * lightColor;
+    vec3 lightDirection = normalize(lightPosition - vertexFragmentPos);
+    vec3 diffuse = max(dot(norm, lightDirection), 0.0) * lightColor;
+    vec3 viewDir = normalize(viewPosition - vertexFragmentPos);
+    vec3 reflectDir = reflect(-lightDirection, norm);
+    vec3 specular = material.specularIntensity * pow(max(dot(viewDir, reflectDir), 0.0), material.highlightSize) * lightColor;
+
+    fragmentColor = vec4((ambient + diffuse + specular) * color * material.color, 1.0);
+    cachedSurface = vec4(0.0, 0.0, 0.0, -1.0);
+}
+);
+
+
 //-------------------------------------------------------
 // CLN: Added variables code to control projection matrix
 //-------------------------------------------------------
@@ -322,13 +1336,35 @@ public:
     GLMesh mesh;
     // CLN: [Texture] Added texture id for the object instance
     GLuint gTextureId;
+    // CLN: [OIT] Transparent objects are drawn by the transparency pass, with their texture alpha scaled by opacity
+    bool transparent = false;
+    float opacity = 1.0f;
+    // CLN: [LOD] Simplified versions of mesh, finest first, and their error relative to lodExtent (model units)
+    std::vector<GLMesh> lodMeshes;
+    std::vector<float> lodErrors;
+    float lodExtent = 0.0f;
+    // CLN: [ShadingLOD] Distance of the farthest vertex from the model origin (0 if unknown: always full shading),
+    //      and the shading level the object was last drawn with. A shared draw proxy points shadingLevelSlot at
+    //      the level of the logical object it is drawing, so one object's level doesn't carry over to the next
+    float boundingRadius = 0.0f;
+    int shadingLevel = SHADING_FULL;
+    unsigned char* shadingLevelSlot = nullptr;
+    // CLN: [Material] Id in gMaterials; the draw passes its slot in the material buffer
+    int materialId = MaterialLibrary::DEFAULT_MATERIAL;
+    // CLN: [Reflection] Reported to the probes when drawn (the static scene objects; the stress, HLOD and streamed
+    //      proxies are left out of the reflections)
+    bool reflectionCaster = false;
    
     // CLN: [Lighting] Added angularVelocity and cameraPosition const
     const float angularVelocity = glm::radians(45.0f);
     const glm::vec3 cameraPosition = gCamera.Position;
 
+    // CLN: [Overdraw] Name of the object in the per-object fragment counts
+    std::string name;
+
     // CLN: Default constructor
-    GLObject() {
+    // CLN: [Overdraw] (with the name for the fragment counts)
+    explicit GLObject(const std::string& name = "object") : name(name) {
         mesh.nIndices = 0;
         mesh.vao = 0;
         mesh.vbos[0] = { 0 }; // CLN: initialize array with zeros
@@ -339,6 +1375,13 @@ public:
     // Functioned called to render a frame
     // CLN: Updated Render to include lamp bool and r, g, b values for lamp color
     void Render(glm::mat4 scale, glm::mat4 rotation, glm::mat4 translation, bool lamp, bool orbit)
+    {
+        // CLN: Model matrix: transformations are applied right-to-left order due to matrix multiplication non-commutative
+        RenderModel(translation * rotation * scale, lamp, orbit);
+    }
+
+    // CLN: [Streaming] Renders with a ready-made model matrix (used for objects that come with their own transform)
+    void RenderModel(glm::mat4 model, bool lamp, bool orbit)
     {
         // Enable z-depth. This is used with the fragement shader whenever the fragment shader wants to output its color
         // If the current fragment is behind the other fragment, the color is discarded, otherwise it is written.
@@ -347,52 +1390,72 @@ public:
         // CLN: camera (view) transformation matrix
         glm::mat4 view = gCamera.GetViewMatrix();
 
-        // CLN: Model matrix: transformations are applied right-to-left order due to matrix multiplication non-commutative
-        glm::mat4 model = translation * rotation * scale;
-
         if (!lamp)
         {
             // CLN: NOTE, the projection matrix is set as a global variable above, which is "toggled" perspective/orthographic through UProcessInput() by pressing 'P'
 
             // Set the shader to be used
-            glUseProgram(gProgramId);
+            // CLN: [ShadingLOD] (the full Phong shader, or a cheaper variant if the object is small on screen)
+            // CLN: [Overdraw] (or the counting shader while a fragment debug view is on)
+            const GLuint programId = gOverdrawView.IsActive() ? gOverdrawView.UseForObject(name)
+                                                              : gShadingProgramIds[transparent ? SHADING_FULL : SelectShadingLevel(model)];
+            glUseProgram(programId);
 
             // Retrieves and passes transform matrices to the Shader program
-            GLint modelLoc = glGetUniformLocation(gProgramId, "model");
-            GLint viewLoc = glGetUniformLocation(gProgramId, "view");
-            GLint projLoc = glGetUniformLocation(gProgramId, "projection");
+            GLint modelLoc = glGetUniformLocation(programId, "model");
+            GLint viewLoc = glGetUniformLocation(programId, "view");
+            GLint projLoc = glGetUniformLocation(programId, "projection");
 
             glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
             glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
             glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection));
 
-            // CLN: [Lighting] Added objectColorLoc, lightColorLoc, LightPositionLoc, and vewPositionLoc
-            // Reference matrix uniforms from the Cube Shader program for the cub color, light color, light position, and camera position
-            GLint objectColorLoc = glGetUniformLocation(gProgramId, "objectColor");
-            GLint lightColorLoc = glGetUniformLocation(gProgramId, "lightColor");
-            GLint lightPositionLoc = glGetUniformLocation(gProgramId, "lightPos");
-            GLint viewPositionLoc = glGetUniformLocation(gProgramId, "viewPosition");
+            // CLN: [Lighting] Added lightColorLoc, LightPositionLoc, and vewPositionLoc
+            // Reference matrix uniforms from the Cube Shader program for the light color, light position, and camera position
+            GLint lightColorLoc = glGetUniformLocation(programId, "lightColor");
+            GLint lightPositionLoc = glGetUniformLocation(programId, "lightPos");
+            GLint viewPositionLoc = glGetUniformLocation(programId, "viewPosition");
 
-            // Pass color, light, and camera data to the Cube Shader program's corresponding uniforms
-            glUniform3f(objectColorLoc, gObjectColor.r, gObjectColor.g, gObjectColor.b);
+            // Pass light and camera data to the Cube Shader program's corresponding uniforms
             glUniform3f(lightColorLoc, gLightColor.r, gLightColor.g, gLightColor.b);
             glUniform3f(lightPositionLoc, gLightPosition.x, gLightPosition.y, gLightPosition.z);
 
             glUniform3f(viewPositionLoc, cameraPosition.x, cameraPosition.y, cameraPosition.z);
 
+            // CLN: [Material] the object's color and Phong parameters, from the material buffer
+            glUniform1i(glGetUniformLocation(programId, "materialIndex"), gMaterials.GetSlot(materialId));
+
+            // CLN: [OIT]
+            glUniform1i(glGetUniformLocation(programId, "transparentPass"), transparent && gOitEnabled);
+            glUniform1f(glGetUniformLocation(programId, "opacity"), opacity);
+
             // CLN: [Lighting] UVScaleLoc (removed because scales texture, which isn't needed for the 3D scene)
             // GLint UVScaleLoc = glGetUniformLocation(gProgramId, "uvScale");
             // glUniform2fv(UVScaleLoc, 1, glm::value_ptr(gUVScale));
 
             // CLN: Activate the VBOs contained within the mesh's VAO
-            glBindVertexArray(mesh.vao);
+            // CLN: [LOD] (or those of the coarsest LOD mesh that still looks the same from here)
+            const GLMesh& drawn = SelectLod(model);
+            glBindVertexArray(drawn.vao);
 
             // CLN: [Texture] bind textures on corresponding texture units
             glActiveTexture(GL_TEXTURE0);
             glBindTexture(GL_TEXTURE_2D, gTextureId);
 
             // CLN:Draws the 3D object
-            glDrawElements(GL_TRIANGLES, mesh.nIndices, GL_UNSIGNED_SHORT, NULL);
+            glDrawElements(GL_TRIANGLES, drawn.nIndices, GL_UNSIGNED_SHORT, NULL);
+
+            // CLN: [Reflection] what the probes see (the opaque objects, with the light they were lit by)
+            if (reflectionCaster && gReflectionProbes.IsEnabled() && !transparent)
+            {
+                const float scale = std::max(glm::length(glm::vec3(model[0])), std::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+                gReflectionProbes.AddCaster(this, drawn.vao, drawn.nIndices, gTextureId, gMaterials.GetSlot(materialId), glm::value_ptr(model),
+                                            boundingRadius * scale, glm::value_ptr(gLightPosition), glm::value_ptr(gLightColor));
+            }
+
+            // CLN: [DebugDraw]
+            if (gDebugDrawEnabled)
+                DrawDebugBounds(model, false);
 
             // CLN: Deactivate the Vertex Array Object
             glBindVertexArray(0);
@@ -402,23 +1465,29 @@ public:
             // CLN: [Lighting] Added Lamp draw code
             // LAMP: draw lamp
             //-------------------------------------
-            glUseProgram(gLampProgramId);
+            // CLN: [Overdraw] (lamps are counted too while a fragment debug view is on)
+            const GLuint lampProgramId = gOverdrawView.IsActive() ? gOverdrawView.UseForObject(name) : gLampProgramId;
+            glUseProgram(lampProgramId);
             
             // CLN: [Lighting] Lamp orbits around the origin if orbit is true
             if (orbit) {    
-                glm::vec4 newPosition = glm::rotate(angularVelocity * gDeltaTime * 2, glm::vec3(0.0f, 2.0f, 0.0f)) * glm::vec4(gLightPosition, 1.0f);
+                // CLN: [AccumAA] (a zero angle while the orbit is paused, so the lamp stays exactly where it is)
+                const float orbitAngle = gLightOrbitPaused ? 0.0f : angularVelocity * gDeltaTime * 2;
+                glm::vec4 newPosition = glm::rotate(orbitAngle, glm::vec3(0.0f, 2.0f, 0.0f)) * glm::vec4(gLightPosition, 1.0f);
                   gLightPosition.x = newPosition.x;
                   gLightPosition.y = newPosition.y;
                   gLightPosition.z = newPosition.z;
+                if (orbitAngle != 0.0f)
+                    ++gLightingVersion;     // CLN: [Reprojection]
 
                 //Transform the smaller cube used as a visual que for the light source
                 model = glm::translate(gLightPosition) * glm::scale(gLightScale);
             }
 
             // Reference matrix uniforms from the Lamp Shader program
-            GLint modelLoc = glGetUniformLocation(gLampProgramId, "model");
-            GLint viewLoc = glGetUniformLocation(gLampProgramId, "view");
-            GLint projLoc = glGetUniformLocation(gLampProgramId, "projection");
+            GLint modelLoc = glGetUniformLocation(lampProgramId, "model");
+            GLint viewLoc = glGetUniformLocation(lampProgramId, "view");
+            GLint projLoc = glGetUniformLocation(lampProgramId, "projection");
 
             // Pass matrix data to the Lamp Shader program's matrix uniforms
             glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
@@ -426,7 +1495,7 @@ public:
             glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection));
 
             // CLN: Added lightColor uniform to fragment shader to pass along the r, g, b colors that the lamp is emitting
-            GLint lightColorLoc = glGetUniformLocation(gLampProgramId, "lightColor");
+            GLint lightColorLoc = glGetUniformLocation(lampProgramId, "lightColor");
             glUniform3f(lightColorLoc, gLightColor.r, gLightColor.g, gLightColor.b);
 
             // CLN: Activate the VBOs contained within the mesh's VAO
@@ -439,6 +1508,10 @@ public:
             // CLN: [Lighting] Changed to glDrawElements
             glDrawElements(GL_TRIANGLES, mesh.nIndices, GL_UNSIGNED_SHORT, NULL);
 
+            // CLN: [DebugDraw]
+            if (gDebugDrawEnabled)
+                DrawDebugBounds(model, true);
+
             // CLN: [Lighting] Deactivate shader program
             glUseProgram(0);
         }
@@ -447,14 +1520,8 @@ public:
     }
 
     // Implements the UCreateMesh function
-    void CreateMesh(GLfloat &objVertices, size_t verts, GLushort &objIndices, size_t indices)
+    void CreateMesh(const GLfloat &objVertices, size_t verts, const GLushort &objIndices, size_t indices)
     {
-        const GLuint floatsPerVertex = 3; // CLN: this is x, y, and z coordinates
-        // CLN: [Lighting] Added floatsPerNormal for three additional vertices in stride for the x, y, z normals
-        const GLuint floatsPerNormal = 3;
-        // CLN: [Texture] Added two vertices for texture
-        const GLuint floatsPerUV = 2;
-
         glGenVertexArrays(1, &mesh.vao); // we can also generate multiple VAOs or buffers at the same time
         glBindVertexArray(mesh.vao);
 
@@ -467,9 +1534,183 @@ public:
          std::cout << "Number of Vertices: " << verts << std::endl;
 
         mesh.nIndices = indices / sizeof(GLushort);   // CLN: Calculates the total number of indicies
+        boundingRadius = GetBoundingRadius(&objVertices, verts / sizeof(GLfloat));
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.vbos[1]);    // CLN: Activates the buffer for the indicies
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices, &objIndices, GL_STATIC_DRAW); // CLN: Sends vertex or coordinate data to the GPU
 
+        SetVertexLayout();
+    }
+
+    // CLN: [MeshCodec] Creates the mesh from a .cmesh file image. The streams are decoded straight into
+    //      the mapped GL buffers, so the raw vertices and indices never exist in a separate CPU copy
+    bool CreateCompressedMesh(const unsigned char* file, size_t fileSize)
+    {
+        unsigned int vertexCount, indexCount;
+        if (!MeshCodec::ReadHeader(file, fileSize, vertexCount, indexCount))
+        {
+            std::cout << "Failed to read compressed mesh header" << std::endl;
+            return false;
+        }
+
+        const size_t vertexBytes = (size_t)vertexCount * MeshData::FLOATS_PER_VERTEX * sizeof(GLfloat);
+        const size_t indexBytes = (size_t)indexCount * sizeof(GLushort);
+
+        glGenVertexArrays(1, &mesh.vao);
+        glBindVertexArray(mesh.vao);
+        glGenBuffers(2, mesh.vbos);
+        glBindBuffer(GL_ARRAY_BUFFER, mesh.vbos[0]);
+        glBufferData(GL_ARRAY_BUFFER, vertexBytes, NULL, GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.vbos[1]);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBytes, NULL, GL_STATIC_DRAW);
+        SetVertexLayout();
+
+        const GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT;
+        void* vertices = glMapBufferRange(GL_ARRAY_BUFFER, 0, vertexBytes, access);
+        void* indices = glMapBufferRange(GL_ELEMENT_ARRAY_BUFFER, 0, indexBytes, access);
+        bool decoded = vertices && indices && MeshCodec::DecodeMesh(file, fileSize, (float*)vertices, (unsigned short*)indices);
+
+        // CLN: glUnmapBuffer() returns GL_FALSE if the buffer contents were lost while mapped
+        if (indices && glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER) == GL_FALSE)
+            decoded = false;
+        if (vertices && glUnmapBuffer(GL_ARRAY_BUFFER) == GL_FALSE)
+            decoded = false;
+        glBindVertexArray(0);
+
+        if (!decoded)
+        {
+            std::cout << "Failed to decode compressed mesh" << std::endl;
+            DestroyMesh(mesh);
+            mesh = {};
+            return false;
+        }
+
+        mesh.nIndices = indexCount;
+        std::cout << "Number of Vertices: " << vertexCount << " (decoded from " << fileSize << " bytes)" << std::endl;
+        return true;
+    }
+
+    // CLN: [LOD] Uploads levels 1.. of a chain from MeshSimplifier::BuildLodChains() (level 0 is the mesh itself)
+    void CreateLodMeshes(const std::vector<MeshLod>& chain)
+    {
+        lodExtent = chain.empty() ? 0.0f : MeshSimplifier::GetExtent(chain[0].mesh);
+        for (size_t level = 1; level < chain.size(); ++level)
+        {
+            const MeshData& data = chain[level].mesh;
+            GLMesh lod;
+            glGenVertexArrays(1, &lod.vao);
+            glBindVertexArray(lod.vao);
+            glGenBuffers(2, lod.vbos);
+            glBindBuffer(GL_ARRAY_BUFFER, lod.vbos[0]);
+            glBufferData(GL_ARRAY_BUFFER, data.GetVertexBytes(), data.vertices.data(), GL_STATIC_DRAW);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, lod.vbos[1]);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, data.GetIndexBytes(), data.indices.data(), GL_STATIC_DRAW);
+            SetVertexLayout();
+            glBindVertexArray(0);
+            lod.nIndices = (GLuint)data.indices.size();
+
+            lodMeshes.push_back(lod);
+            lodErrors.push_back(chain[level].error);
+        }
+    }
+
+    // CLN: [LOD] Picks the coarsest LOD mesh whose error, projected at the object's distance from the camera,
+    //      stays under --lod-pixel-error pixels
+    const GLMesh& SelectLod(const glm::mat4& model) const
+    {
+        if (!gLodEnabled || lodMeshes.empty())
+            return mesh;
+
+        const float pixelsPerUnit = GetPixelsPerModelUnit(model);
+        for (size_t level = lodMeshes.size(); level > 0; --level)
+        {
+            if (lodErrors[level - 1] * lodExtent * pixelsPerUnit <= gOptions.lodPixelError * gQuality.lodBias)
+                return lodMeshes[level - 1];
+        }
+        return mesh;
+    }
+
+    // CLN: [ShadingLOD] Picks the shader variant from the projected radius of the object: full Phong down to
+    //      --shading-lod-pixels, diffuse-only down to a quarter of that, per-vertex below. A level is only left
+    //      once the radius is 20% past its threshold, so objects near one don't flicker between shaders
+    int SelectShadingLevel(const glm::mat4& model)
+    {
+        int level = shadingLevelSlot ? *shadingLevelSlot : shadingLevel;
+        if (!gShadingLodEnabled || boundingRadius <= 0.0f)
+            level = SHADING_FULL;
+        else
+        {
+            const float hysteresis = 0.2f;
+            // smallest projected radius (pixels) of SHADING_FULL and SHADING_DIFFUSE
+            const float thresholds[SHADING_LEVEL_COUNT - 1] = { gOptions.shadingLodPixels, gOptions.shadingLodPixels * 0.25f };
+            const float radius = boundingRadius * GetPixelsPerModelUnit(model);
+
+            while (level > SHADING_FULL && radius > thresholds[level - 1] * (1.0f + hysteresis))
+                --level;
+            while (level < SHADING_LEVEL_COUNT - 1 && radius < thresholds[level] * (1.0f - hysteresis))
+                ++level;
+        }
+        if (shadingLevelSlot)
+            *shadingLevelSlot = (unsigned char)level;
+        else
+            shadingLevel = level;
+        ++gShadingLevelCounts[level];
+        return level;
+    }
+
+    // CLN: [LOD] On-screen pixels covered by one model unit at the object's distance from the camera
+    //      (uses the largest axis scale of the model matrix)
+    static float GetPixelsPerModelUnit(const glm::mat4& model)
+    {
+        const float distance = std::max(glm::length(glm::vec3(model[3]) - gCamera.Position), 0.01f);
+        return GetModelScale(model) * WINDOW_HEIGHT / (2.0f * tanf(glm::radians(gCamera.Zoom) * 0.5f) * distance);
+    }
+
+    // CLN: [DebugDraw] Largest axis scale of the model matrix
+    static float GetModelScale(const glm::mat4& model)
+    {
+        return std::max(glm::length(glm::vec3(model[0])), std::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+    }
+
+    // CLN: [DebugDraw] Bounding sphere of the object (cyan, magenta if transparent); lamps get a yellow one
+    //      with a marker and their name on top of the scene
+    void DrawDebugBounds(const glm::mat4& model, bool lamp) const
+    {
+        if (boundingRadius <= 0.0f)
+            return;
+
+        const glm::vec3 center(model[3]);
+        const float radius = boundingRadius * GetModelScale(model);
+        if (!lamp)
+        {
+            gDebugDraw.Sphere(glm::value_ptr(center), radius, transparent ? DebugDraw::Color(1.0f, 0.0f, 1.0f) : DebugDraw::Color(0.0f, 1.0f, 1.0f));
+            return;
+        }
+
+        const GLuint yellow = DebugDraw::Color(1.0f, 1.0f, 0.0f);
+        const glm::vec3 labelPosition = center + glm::vec3(0.0f, radius + 0.1f, 0.0f);
+        gDebugDraw.Sphere(glm::value_ptr(center), radius, yellow);
+        gDebugDraw.Marker(glm::value_ptr(center), radius * 4.0f, yellow);
+        gDebugDraw.Text(glm::value_ptr(labelPosition), name, 0.15f, yellow);
+    }
+
+    // CLN: [ShadingLOD] Distance of the farthest V/N/T vertex position from the model origin
+    static float GetBoundingRadius(const GLfloat* vertices, size_t floatCount)
+    {
+        float radiusSquared = 0.0f;
+        for (size_t i = 0; i + 2 < floatCount; i += MeshData::FLOATS_PER_VERTEX)
+            radiusSquared = std::max(radiusSquared, vertices[i] * vertices[i] + vertices[i + 1] * vertices[i + 1] + vertices[i + 2] * vertices[i + 2]);
+        return sqrtf(radiusSquared);
+    }
+
+    // CLN: [Scheduler] Sets the V/N/T vertex attribute pointers for the VAO and GL_ARRAY_BUFFER that are currently bound
+    static void SetVertexLayout()
+    {
+        const GLuint floatsPerVertex = 3; // CLN: this is x, y, and z coordinates
+        // CLN: [Lighting] Added floatsPerNormal for three additional vertices in stride for the x, y, z normals
+        const GLuint floatsPerNormal = 3;
+        // CLN: [Texture] Added two vertices for texture
+        const GLuint floatsPerUV = 2;
+
         // CLN: [Texture] Updated stride to accomodate two vertices for texture. Strides between vertex coordinates is 6 (x, y, z, r, g, b, a, s, t). A tightly packed stride is 0.
         // CLN: [Lighting] Updated stride to include offset for floatsPerNormal. Strides between vertex coordinates is 5 (x, y, z, nx, ny, nz, s, t).
         GLint stride = sizeof(float) * (floatsPerVertex + floatsPerNormal + floatsPerUV);
@@ -486,51 +1727,126 @@ public:
         // CLN: [Lighting] Changed buffer 1 to buffer 2 and added (floatsPerVertex + floatsPerNormal)
         glVertexAttribPointer(2, floatsPerUV, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(float) * (floatsPerVertex + floatsPerNormal)));
         glEnableVertexAttribArray(2);
+    }
+
+    // CLN: [Scheduler] Replaces the mesh through the frame scheduler. The new buffers are filled in chunks, as
+    //      many per frame as fit in the budget, and swapped in once complete so the old mesh draws until then
+    void QueueMeshUpload(FrameScheduler& scheduler, const std::string& name, std::shared_ptr<MeshUpload> upload)
+    {
+        const size_t chunkBytes = 64 * 1024;
+
+        scheduler.Enqueue(name, WORK_PRIORITY_NORMAL, [this, upload, chunkBytes](const FrameDeadline& deadline) {
+            MeshUpload& job = *upload;
+            const GLfloat* vertexData = job.geometry ? job.geometry->GetVertices() : job.vertices.data();
+            const GLushort* indexData = job.geometry ? job.geometry->GetIndices() : job.indices.data();
+            const size_t vertexBytes = job.geometry ? job.geometry->GetVertexBytes() : job.vertices.size() * sizeof(GLfloat);
+            const size_t indexBytes = job.geometry ? job.geometry->GetIndexBytes() : job.indices.size() * sizeof(GLushort);
+
+            if (!job.created)
+            {
+                // CLN: allocate the storage up front, the data follows in glBufferSubData() chunks
+                glGenVertexArrays(1, &job.mesh.vao);
+                glBindVertexArray(job.mesh.vao);
+                glGenBuffers(2, job.mesh.vbos);
+                glBindBuffer(GL_ARRAY_BUFFER, job.mesh.vbos[0]);
+                glBufferData(GL_ARRAY_BUFFER, vertexBytes, NULL, GL_STATIC_DRAW);
+                glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, job.mesh.vbos[1]);
+                glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBytes, NULL, GL_STATIC_DRAW);
+                SetVertexLayout();
+                glBindVertexArray(0);
+                job.mesh.nIndices = (GLuint)(indexBytes / sizeof(GLushort));
+                job.created = true;
+            }
 
+            glBindBuffer(GL_ARRAY_BUFFER, job.mesh.vbos[0]);
+            while (job.vertexBytesDone < vertexBytes && !deadline.Expired())
+            {
+                size_t bytes = std::min(chunkBytes, vertexBytes - job.vertexBytesDone);
+                glBufferSubData(GL_ARRAY_BUFFER, job.vertexBytesDone, bytes, (const char*)vertexData + job.vertexBytesDone);
+                job.vertexBytesDone += bytes;
+            }
+
+            // CLN: the element buffer binding is VAO state, so bind the VAO (not just the buffer) before updating it
+            glBindVertexArray(job.mesh.vao);
+            while (job.vertexBytesDone == vertexBytes && job.indexBytesDone < indexBytes && !deadline.Expired())
+            {
+                size_t bytes = std::min(chunkBytes, indexBytes - job.indexBytesDone);
+                glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, job.indexBytesDone, bytes, (const char*)indexData + job.indexBytesDone);
+                job.indexBytesDone += bytes;
+            }
+            glBindVertexArray(0);
+
+            if (job.vertexBytesDone < vertexBytes || job.indexBytesDone < indexBytes)
+                return false;   // CLN: out of budget, continue next frame
+
+            DestroyMesh(mesh);
+            mesh = job.mesh;
+            ++gSceneVersion;    // CLN: [AccumAA]
+            std::cout << "Mesh upload complete: " << vertexBytes + indexBytes << " bytes" << std::endl;
+            return true;
+        }, [this, upload] {
+            // CLN: dropped before it finished, the half-filled buffers are deleted and the old mesh stays
+            if (upload->created)
+                DestroyMesh(upload->mesh);
+        });
     }
 
         // CLN: [Texture] Load and create the texture
         // ------------------------------------------
         bool CreateTexture(const char* filename, GLuint & textureId)
         {
-        int width, height, channels;
-        stbi_set_flip_vertically_on_load(true);     // CLN: Used the stbi library function to flip about the y-axis instead of the flipImageVertically custom function
-        unsigned char* image = stbi_load(filename, &width, &height, &channels, 0);
-        if (image)
-        {
-            //flipImageVertically(image, width, height, channels);
-
-            glGenTextures(1, &textureId);
-            glBindTexture(GL_TEXTURE_2D, textureId);    // CLN: Binds the texture
-
-            // set the texture wrapping parameters
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-            // set texture filtering parameters
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-            if (channels == 3)
-                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, image);
-            else if (channels == 4) // CLN: The fourth channel is alpha for image formats that support transparency (i.e., .png files)
-                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
-            else
-            {
-                cout << "Not implemented to handle image with " << channels << " channels" << endl;
-                return false;
-            }
+        TextureImage image;
+        if (!DecodeTexture(filename, image))
+            return false;   // Error loading the image
+
+        return UploadTexture(image, textureId);
+    }
 
-            glGenerateMipmap(GL_TEXTURE_2D);
+    // CLN: [Startup] Decodes the image file into CPU memory. Makes no GL calls, so it is safe to run on a worker thread
+    static bool DecodeTexture(const char* filename, TextureImage& image)
+    {
+        stbi_set_flip_vertically_on_load_thread(true);     // CLN: Used the stbi library function to flip about the y-axis instead of the flipImageVertically custom function (per-thread so workers don't race on the flag)
+        image.filename = filename;
+        image.pixels = stbi_load(filename, &image.width, &image.height, &image.channels, 0);
+        return image.pixels != nullptr;
+    }
 
-            stbi_image_free(image);
-            glBindTexture(GL_TEXTURE_2D, 0); // Unbind the texture
-            
-            cout << filename << " loaded successfully!" << endl;
-            return true;
+    // CLN: [Startup] Uploads a decoded image to the GPU and frees the CPU copy. Must run on the GL context thread
+    static bool UploadTexture(TextureImage& image, GLuint& textureId)
+    {
+        if (image.channels != 3 && image.channels != 4)
+        {
+            cout << "Not implemented to handle image with " << image.channels << " channels" << endl;
+            stbi_image_free(image.pixels);
+            image.pixels = nullptr;
+            return false;
         }
 
-        // Error loading the image
-        return false;
+        //flipImageVertically(image, width, height, channels);
+
+        glGenTextures(1, &textureId);
+        glBindTexture(GL_TEXTURE_2D, textureId);    // CLN: Binds the texture
+
+        // set the texture wrapping parameters
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        // set texture filtering parameters
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+        if (image.channels == 3)
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, image.width, image.height, 0, GL_RGB, GL_UNSIGNED_BYTE, image.pixels);
+        else // CLN: The fourth channel is alpha for image formats that support transparency (i.e., .png files)
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, image.width, image.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image.pixels);
+
+        glGenerateMipmap(GL_TEXTURE_2D);
+
+        stbi_image_free(image.pixels);
+        image.pixels = nullptr;
+        glBindTexture(GL_TEXTURE_2D, 0); // Unbind the texture
+
+        cout << image.filename << " loaded successfully!" << endl;
+        return true;
     }
 
 
@@ -545,6 +1861,15 @@ public:
         glDeleteBuffers(2, mesh.vbos);
     }
 
+    // CLN: [LOD] Releases the simplified meshes
+    void DestroyLodMeshes()
+    {
+        for (GLMesh& lod : lodMeshes)
+            DestroyMesh(lod);
+        lodMeshes.clear();
+        lodErrors.clear();
+    }
+
 };
 
 
@@ -694,108 +2019,557 @@ GLushort CubeIndices[] = {
 //------------------
 int main(int argc, char* argv[])
 {
+    // CLN: [Startup] time-to-first-frame is measured from here to the first glfwSwapBuffers()
+    const std::chrono::steady_clock::time_point startupBegin = std::chrono::steady_clock::now();
+
+    UParseCommandLine(argc, argv);
+
+    // CLN: [MeshCodec] CPU-only benchmark, runs without opening a window
+    if (gOptions.meshCodecBenchmark)
+        return URunMeshCodecBenchmark() ? EXIT_SUCCESS : EXIT_FAILURE;
+
+    // CLN: [SelfTest] CPU-only as well
+    if (gOptions.selfTest)
+        return URunSelfTests() ? EXIT_SUCCESS : EXIT_FAILURE;
+
     if (!UInitialize(argc, argv, &gWindow))
         return EXIT_FAILURE;
+
+    // CLN: [ShaderLab] Headless shader timing, in place of the scene
+    if (gOptions.shaderLab)
+    {
+        const bool ran = URunShaderLab();
+        glfwTerminate();
+        return ran ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // CLN: [Flight] Measured here, on the main thread, so the main thread is the first one in the traces
+    gFlightRecorder.Configure(gOptions.flightRecorder, gOptions.flightRecorderSpikeMs, gOptions.flightRecorderSeconds,
+                              gOptions.flightRecorderDirectory);
+    gFlightRecorder.MeasureEventCost();
+    FlightRecorder::InstallSignalHandler();
+
+    // CLN: [Probe] Pick the tessellation, LOD bias and resolution for this GPU before anything is built with them
+    gQuality = USelectQualityProfile();
     
-    // CLN: Instantiates Cynlinder object and builds its vertices, texture coordinates, and indices
-    //      creates a cylinder with base radius=0.27f, top radius=0.27f, height=0.9f, sectors=36, stacks=1, smooth=true
-    //-----------------------------------------------------------------------------------------------------------------
-    Cylinder cylinder(0.27, 0.27, 0.9, 36, 1, true);
-
-    // CLN: Instantiates Sphere object and builds its vertices, texture coordinates, and indices
-    //      creates a sphere with radius=0.4, sectors=36, stacks=18, smooth=true (default)
-    //------------------------------------------------------------------------------------------
-    Sphere sphere(0.4f, 36, 18);
+    // CLN: The cylinder and sphere are built by worker threads in the startup graph below
+    //      cylinder: base radius=0.27f, top radius=0.27f, height=0.9f, sectors=36, stacks=1, smooth=true
+    //      sphere  : radius=0.4, sectors=36, stacks=18, smooth=true (default)
+    // CLN: [GeometryCache] or, after the first run, mapped from the geometry cache
+    //-----------------------------------------------------------------------------------------------------
+    GeometryCache geometryCache(gOptions.geometryCacheDirectory);
+    std::shared_ptr<CachedGeometry> cylinder;
+    std::shared_ptr<CachedGeometry> sphere;
 
 
     // CLN: For debugging
    /*
-    const float* cylNormals = cylinder.getNormals();
+    const float* cylNormals = cylinder->getNormals();
 
     std::cout << "DEBUG: The cylinder normals are : ";
-    for (int i = 0; i < cylinder.getNormalSize(); i++)
+    for (int i = 0; i < cylinder->getNormalSize(); i++)
         std::cout << cylNormals[i] << ", ";
 
-    const float* sphereNormals = sphere.getNormals();
+    const float* sphereNormals = sphere->getNormals();
 
     std::cout << "\n\nDEBUG: The sphere normals are : ";
-    for (int i = 0; i < cylinder.getNormalSize(); i++)
+    for (int i = 0; i < cylinder->getNormalSize(); i++)
         std::cout << sphereNormals[i] << ", ";
     */
 
 
     // CLN: Instantiate the various objects for the 3D Scene
     // -----------------------------------------------------
-    GLObject Plane;
-    GLObject TriCase;
-    GLObject TriCaseLogo;
-    GLObject LaCroixCan;
-    GLObject FoamBall;
-    GLObject StickyNotes;
-    GLObject MainLight;
-    GLObject FillLight;
-
-    // CLN: Load in the textures for the objects
-    // -----------------------------------------
-    if (!Plane.CreateTexture(texFilename1, Plane.gTextureId))
-    {
-        cout << "Failed to load texture " << texFilename1 << endl;
-        return EXIT_FAILURE;
-    }
-    else if (!TriCase.CreateTexture(texFilename2, TriCase.gTextureId))
+    GLObject Plane("plane");
+    GLObject TriCase("tri-case");
+    GLObject TriCaseLogo("tri-case logo");
+    GLObject LaCroixCan("LaCroix can");
+    GLObject FoamBall("foam ball");
+    GLObject StickyNotes("sticky notes");
+    GLObject MainLight("main light");
+    GLObject FillLight("fill light");
+
+    // CLN: [Startup] Build the startup as a task graph. Image decodes and sphere/cylinder generation
+    //      run on the worker pool while the main thread compiles the shaders; each GL upload runs on
+    //      the main thread as soon as its input is ready.
+    // -----------------------------------------------------------------------------------------------
+    // CLN: [NUMA] Workers pinned to the CPUs of their NUMA nodes, with a queue per node; the main (GL) thread is
+    //      pinned to the CPU they leave free on the first node
+    WorkerPool workerPool(0, gOptions.threadPinning);
+    workerPool.AttachCallingThread();
+    gWorkerPool = &workerPool;
+    TaskGraph startup(workerPool);
+
+    // CLN: [Arena] Three frames in flight: the GPU may still read a frame's data two frames later
+    FrameArena frameArena(gOptions.frameArenaKB * 1024, 3);
+    gFrameArena = &frameArena;
+
+    // CLN: Create the shader programs (main thread, no inputs, so they start right away)
+    startup.AddTask("scene shader", "shaders", TASK_MAIN_THREAD, [] {
+        return UCreateShaderProgram(vertexShaderSource, fragmentShaderSource, gProgramId);
+    });
+    // CLN: [Lighting] Added to create shader for lamp object
+    startup.AddTask("lamp shader", "shaders", TASK_MAIN_THREAD, [] {
+        return UCreateShaderProgram(lampVertexShaderSource, lampFragmentShaderSource, gLampProgramId);
+    });
+    // CLN: [ShadingLOD] Cheaper shader variants for objects that are small on screen
+    startup.AddTask("shading LOD shaders", "shaders", TASK_MAIN_THREAD, [] {
+        return UCreateShaderProgram(vertexShaderSource, diffuseFragmentShaderSource, gShadingProgramIds[SHADING_DIFFUSE])
+            && UCreateShaderProgram(vertexLitVertexShaderSource, vertexLitFragmentShaderSource, gShadingProgramIds[SHADING_VERTEX]);
+    });
+    // CLN: [OIT] Composite shader and targets of the transparency pass
+    startup.AddTask("transparency pass", "shaders", TASK_MAIN_THREAD, [] {
+        if (!UCreateShaderProgram(oitCompositeVertexShaderSource, oitCompositeFragmentShaderSource, gOitCompositeProgramId))
+            return false;
+        int windowWidth, windowHeight, width, height;
+        glfwGetFramebufferSize(gWindow, &windowWidth, &windowHeight);
+        UGetSceneSize(windowWidth, windowHeight, width, height);   // CLN: [Probe] (scaled by the quality profile)
+        return gTransparencyPass.Create(width, height, gOitCompositeProgramId);
+    });
+    // CLN: [Reprojection] Cached shading targets, the same size as the scene framebuffer
+    startup.AddTask("reprojection cache", "shaders", TASK_MAIN_THREAD, [] {
+        int windowWidth, windowHeight, width, height;
+        glfwGetFramebufferSize(gWindow, &windowWidth, &windowHeight);
+        UGetSceneSize(windowWidth, windowHeight, width, height);   // CLN: [Probe] (scaled by the quality profile)
+        gReprojectionCache.SetRefreshPeriod(gOptions.reprojectionRefresh);
+        return gReprojectionCache.Create(width, height);
+    });
+    // CLN: [Overdraw] Counting and heat map shaders of the fragment debug views. They need GLSL 4.50, so a driver
+    //      without it only loses the views (unless --overdraw-report asks for them)
+    startup.AddTask("overdraw view", "shaders", TASK_MAIN_THREAD, [] {
+        if (!UCreateShaderProgram(vertexShaderSource, overdrawCountFragmentShaderSource, gOverdrawCountProgramId) ||
+            !UCreateShaderProgram(oitCompositeVertexShaderSource, overdrawResolveFragmentShaderSource, gOverdrawResolveProgramId))
+        {
+            cout << "INFO: Overdraw views unavailable" << endl;
+            return gOptions.overdrawReportFile.empty();
+        }
+        int windowWidth, windowHeight, width, height;
+        glfwGetFramebufferSize(gWindow, &windowWidth, &windowHeight);
+        UGetSceneSize(windowWidth, windowHeight, width, height);   // CLN: [Probe] (scaled by the quality profile)
+        return gOverdrawView.Create(width, height, gOverdrawCountProgramId, gOverdrawResolveProgramId);
+    });
+    // CLN: [AccumAA] History target of the accumulation anti-aliasing (the scene runs without it)
+    startup.AddTask("accumulation AA", "shaders", TASK_MAIN_THREAD, [] {
+        int windowWidth, windowHeight, width, height;
+        glfwGetFramebufferSize(gWindow, &windowWidth, &windowHeight);
+        UGetSceneSize(windowWidth, windowHeight, width, height);   // CLN: [Probe] (scaled by the quality profile)
+        if (!UCreateShaderProgram(oitCompositeVertexShaderSource, accumulateFragmentShaderSource, gAccumulateProgramId) ||
+            !gProgressiveAA.Create(width, height, gAccumulateProgramId))
+        {
+            cout << "INFO: Accumulation anti-aliasing unavailable" << endl;
+            return true;
+        }
+        gProgressiveAA.SetSampleCount(gOptions.accumulationSamples);
+        gProgressiveAA.SetEnabled(gOptions.accumulationAA);
+        return true;
+    });
+    // CLN: [Checkerboard] Stamp and reconstruction shaders and the full-frame history (the scene runs without them)
+    startup.AddTask("checkerboard", "shaders", TASK_MAIN_THREAD, [] {
+        int windowWidth, windowHeight, width, height;
+        glfwGetFramebufferSize(gWindow, &windowWidth, &windowHeight);
+        UGetSceneSize(windowWidth, windowHeight, width, height);   // CLN: [Probe] (scaled by the quality profile)
+        if (!UCreateShaderProgram(oitCompositeVertexShaderSource, checkerboardStampFragmentShaderSource, gCheckerboardStampProgramId) ||
+            !UCreateShaderProgram(oitCompositeVertexShaderSource, checkerboardReconstructFragmentShaderSource, gCheckerboardReconstructProgramId) ||
+            !gCheckerboard.Create(width, height, gCheckerboardStampProgramId, gCheckerboardReconstructProgramId))
+        {
+            cout << "INFO: Checkerboard rendering unavailable" << endl;
+            return gOptions.checkerboardReportFile.empty();
+        }
+        gCheckerboard.SetEnabled(gOptions.checkerboard || !gOptions.checkerboardReportFile.empty());
+        return true;
+    });
+    // CLN: [Impostor] Bake and draw shaders (the atlases are baked once the meshes and textures are loaded)
+    startup.AddTask("impostors", "shaders", TASK_MAIN_THREAD, [] {
+        if (!UCreateShaderProgram(impostorBakeVertexShaderSource, impostorBakeFragmentShaderSource, gImpostorBakeProgramId) ||
+            !UCreateShaderProgram(impostorVertexShaderSource, impostorFragmentShaderSource, gImpostorProgramId) ||
+            !gImpostors.Create(gImpostorBakeProgramId, gImpostorProgramId, gOptions.impostorGridSize, gOptions.impostorFrameSize,
+                               gOptions.geometryCacheDirectory))
+        {
+            cout << "INFO: Impostors unavailable" << endl;
+            return true;
+        }
+        gImpostors.SetEnabled(gOptions.impostors);
+        return true;
+    });
+    // CLN: [DebugDraw] Line shader and streaming buffer of the debug drawing (the scene runs without them)
+    startup.AddTask("debug draw", "shaders", TASK_MAIN_THREAD, [] {
+        if (!UCreateShaderProgram(debugDrawVertexShaderSource, debugDrawFragmentShaderSource, gDebugDrawProgramId) ||
+            !gDebugDraw.Create(gDebugDrawProgramId))
+        {
+            cout << "INFO: Debug drawing unavailable" << endl;
+        }
+        return true;
+    });
+
+    // CLN: Load in the textures for the objects: decode on a worker, then upload on the main thread
+    // ----------------------------------------------------------------------------------------------
+    struct TextureJob
     {
-        cout << "Failed to load texture " << texFilename2 << endl;
-        return EXIT_FAILURE;
+        const char* filename;
+        GLObject* object;
+        TextureImage image;
+    };
+    TextureJob textureJobs[] = {
+        { texFilename1, &Plane, TextureImage() },
+        { texFilename2, &TriCase, TextureImage() },
+        { texFilename3, &TriCaseLogo, TextureImage() },
+        { texFilename4, &LaCroixCan, TextureImage() },
+        { texFilename5, &FoamBall, TextureImage() },
+        { texFilename6, &StickyNotes, TextureImage() }
+    };
+    for (TextureJob& job : textureJobs)
+    {
+        TaskGraph::TaskId decoded = startup.AddTask(string("decode ") + job.filename, "decode", TASK_WORKER, [&job] {
+            if (GLObject::DecodeTexture(job.filename, job.image))
+                return true;
+            cout << "Failed to load texture " << job.filename << endl;
+            return false;
+        });
+        startup.AddTask(string("upload ") + job.filename, "upload", TASK_MAIN_THREAD, [&job] {
+            if (GLObject::UploadTexture(job.image, job.object->gTextureId))
+                return true;
+            cout << "Failed to load texture " << job.filename << endl;
+            return false;
+        }, { decoded });
     }
-    else if (!TriCaseLogo.CreateTexture(texFilename3, TriCaseLogo.gTextureId))
+
+    // CLN: Generate the cylinder and sphere vertices, texture coordinates, and indices on the workers
+    TaskGraph::TaskId cylinderBuilt = startup.AddTask("build cylinder", "geometry", TASK_WORKER, [&] {
+        cylinder = geometryCache.GetCylinder(0.27f, 0.27f, 0.9f, gQuality.cylinderSectors, 1, true);   // CLN: [Probe] 36 sectors in "high"
+        return true;
+    });
+    TaskGraph::TaskId sphereBuilt = startup.AddTask("build sphere", "geometry", TASK_WORKER, [&] {
+        sphere = geometryCache.GetSphere(0.4f, gQuality.sphereSectors, gQuality.sphereStacks);   // CLN: [Probe] 36 x 18 in "high"
+        return true;
+    });
+
+    // CLN: Create meshes for the various 3D objects by transferring vertices and indices into each
+    //      respective object's VBO, then bind over to the GPU
+    // ---------------------------------------------------------------------------------------------
+    // CLN: [Weld] The hand-authored arrays repeat vertices (e.g. 36 cube vertices for 24 distinct corners), so
+    //      they are welded first and the cube is welded once for its three objects
+    // CLN: [HLOD] The stress primitives' meshes, kept on the CPU for the HLOD builder
+    const bool buildHlod = gOptions.hlod && gOptions.stressObjects > 0;
+    std::vector<MeshData> hlodMeshes(STRESS_PRIMITIVE_COUNT);
+    MeshData triCaseData;   // CLN: [LOD] the welded tri-case, simplified below so its LODs match level 0
+    TaskGraph::TaskId staticMeshed = startup.AddTask("mesh static arrays", "mesh", TASK_MAIN_THREAD, [&] {
+        MeshData plane = UWeldArrays("plane", PlaneVertices, sizeof(PlaneVertices), PlaneIndices, sizeof(PlaneIndices));
+        MeshData triCase = UWeldArrays("tri-case", TriCaseVertices, sizeof(TriCaseVertices), TriCaseIndices, sizeof(TriCaseIndices));
+        MeshData triCaseLogo = UWeldArrays("tri-case logo", TriCaseLogoVertices, sizeof(TriCaseLogoVertices), TriCaseLogoIndices, sizeof(TriCaseLogoIndices));
+        MeshData cube = UWeldArrays("cube", CubeVertices, sizeof(CubeVertices), CubeIndices, sizeof(CubeIndices));
+
+        Plane.CreateMesh(*plane.vertices.data(), plane.GetVertexBytes(), *plane.indices.data(), plane.GetIndexBytes());
+        TriCase.CreateMesh(*triCase.vertices.data(), triCase.GetVertexBytes(), *triCase.indices.data(), triCase.GetIndexBytes());
+        TriCaseLogo.CreateMesh(*triCaseLogo.vertices.data(), triCaseLogo.GetVertexBytes(), *triCaseLogo.indices.data(), triCaseLogo.GetIndexBytes());
+        StickyNotes.CreateMesh(*cube.vertices.data(), cube.GetVertexBytes(), *cube.indices.data(), cube.GetIndexBytes());
+        MainLight.CreateMesh(*cube.vertices.data(), cube.GetVertexBytes(), *cube.indices.data(), cube.GetIndexBytes());
+        FillLight.CreateMesh(*cube.vertices.data(), cube.GetVertexBytes(), *cube.indices.data(), cube.GetIndexBytes());
+        triCaseData = triCase;
+        if (buildHlod)
+        {
+            hlodMeshes[STRESS_CUBE] = std::move(cube);
+            hlodMeshes[STRESS_TRI_CASE] = std::move(triCase);
+            hlodMeshes[STRESS_PLANE] = std::move(plane);
+        }
+        return true;
+    });
+    TaskGraph::TaskId cylinderMeshed = startup.AddTask("mesh cylinder", "mesh", TASK_MAIN_THREAD, [&] {
+        // CLN: [GeometryCache] uploaded straight from the mapped cache file, which is unmapped right after
+        LaCroixCan.CreateMesh(*cylinder->GetVertices(), cylinder->GetVertexBytes(), *cylinder->GetIndices(), cylinder->GetIndexBytes());
+        if (buildHlod)
+            hlodMeshes[STRESS_CYLINDER].Assign(cylinder->GetVertices(), cylinder->GetVertexBytes() / sizeof(GLfloat),
+                                               cylinder->GetIndices(), cylinder->GetIndexBytes() / sizeof(GLushort));
+        cylinder.reset();
+        return true;
+    }, { cylinderBuilt });
+    TaskGraph::TaskId sphereMeshed = startup.AddTask("mesh sphere", "mesh", TASK_MAIN_THREAD, [&] {
+        FoamBall.CreateMesh(*sphere->GetVertices(), sphere->GetVertexBytes(), *sphere->GetIndices(), sphere->GetIndexBytes());
+        if (buildHlod)
+            hlodMeshes[STRESS_SPHERE].Assign(sphere->GetVertices(), sphere->GetVertexBytes() / sizeof(GLfloat),
+                                             sphere->GetIndices(), sphere->GetIndexBytes() / sizeof(GLushort));
+        sphere.reset();
+        return true;
+    }, { sphereBuilt });
+
+    // CLN: [Import] Optional model from the command line, parsed on the workers and uploaded part by part
+    //      (models with more than 64K vertices arrive split into several parts)
+    std::vector<MeshData> importedParts;
+    std::vector<GLObject> ImportedModel;
+    glm::mat4 importedModelFit(1.0f);
+    std::vector<TaskGraph::TaskId> simplifyInputs(1, staticMeshed);
+    std::vector<TaskGraph::TaskId> lodMeshInputs(1, staticMeshed);
+    if (!gOptions.importFilename.empty())
     {
-        cout << "Failed to load texture " << texFilename3 << endl;
-        return EXIT_FAILURE;
+        TaskGraph::TaskId imported = startup.AddTask("import " + gOptions.importFilename, "geometry", TASK_WORKER, [&] {
+            ImportStats stats;
+            if (!MeshImporter::Import(gOptions.importFilename, workerPool, importedParts, stats))
+                return false;
+            MeshImporter::PrintStats(gOptions.importFilename, stats, cout);
+
+            // CLN: [Weld] the importer only merges corners that share their OBJ/glTF indices, so weld the attribute values too
+            std::vector<WeldStats> partWelds(importedParts.size());
+            workerPool.ParallelFor(importedParts.size(), [&](size_t i) {
+                partWelds[i] = MeshWelder::Weld(importedParts[i], gOptions.weldEpsilon);
+            });
+            WeldStats welded;
+            for (const WeldStats& part : partWelds)
+                welded.Add(part);
+            MeshWelder::PrintStats(gOptions.importFilename, welded, cout);
+            return true;
+        });
+        TaskGraph::TaskId importMeshed = startup.AddTask("mesh imported model", "mesh", TASK_MAIN_THREAD, [&] {
+            // CLN: scale the model to fit a 1.5 unit box resting at its base
+            glm::vec3 low(FLT_MAX), high(-FLT_MAX);
+            for (const MeshData& part : importedParts)
+            {
+                for (size_t i = 0; i < part.vertices.size(); i += MeshData::FLOATS_PER_VERTEX)
+                {
+                    glm::vec3 position(part.vertices[i], part.vertices[i + 1], part.vertices[i + 2]);
+                    low = glm::min(low, position);
+                    high = glm::max(high, position);
+                }
+            }
+            glm::vec3 extent = high - low;
+            float largest = std::max(extent.x, std::max(extent.y, extent.z));
+            float scale = largest > 0.0f ? 1.5f / largest : 1.0f;
+            importedModelFit = glm::scale(glm::vec3(scale)) * glm::translate(glm::vec3(-(low.x + high.x) * 0.5f, -low.y, -(low.z + high.z) * 0.5f));
+
+            ImportedModel.resize(importedParts.size());
+            for (size_t i = 0; i < importedParts.size(); ++i)
+            {
+                MeshData& part = importedParts[i];
+                ImportedModel[i].name = "imported part " + to_string(i);
+                ImportedModel[i].CreateMesh(*part.vertices.data(), part.GetVertexBytes(), *part.indices.data(), part.GetIndexBytes());
+            }
+            return true;
+        }, { imported });
+        simplifyInputs.push_back(imported);
+        lodMeshInputs.push_back(importMeshed);
     }
-    else if (!LaCroixCan.CreateTexture(texFilename4, LaCroixCan.gTextureId))
+
+    // CLN: [LOD] The tri-case and the imported model have no tessellation parameters to lower, so their
+    //      LOD chains come from the quadric simplifier, one mesh per worker. Both start from the welded meshes
+    //      level 0 renders (the import task welds its parts in place), so every level shares its vertex layout
+    std::vector<std::vector<MeshLod> > lodChains;
+    TaskGraph::TaskId simplified = startup.AddTask("simplify LOD chains", "geometry", TASK_WORKER, [&] {
+        std::vector<const MeshData*> meshes(1, &triCaseData);
+        for (const MeshData& part : importedParts)
+            meshes.push_back(&part);
+        MeshSimplifier::BuildLodChains(workerPool, meshes, 0.05f, 0.05f, lodChains, cout);
+        return true;
+    }, simplifyInputs);
+    lodMeshInputs.push_back(simplified);
+    startup.AddTask("mesh LOD chains", "mesh", TASK_MAIN_THREAD, [&] {
+        TriCase.CreateLodMeshes(lodChains[0]);
+        for (size_t i = 0; i < ImportedModel.size(); ++i)
+            ImportedModel[i].CreateLodMeshes(lodChains[i + 1]);
+        std::vector<std::vector<MeshLod> >().swap(lodChains);
+        std::vector<MeshData>().swap(importedParts);
+        return true;
+    }, lodMeshInputs);
+
+    // CLN: [Stress] The stress scene is generated on the workers along with everything else
+    if (gOptions.stressObjects > 0)
     {
-        cout << "Failed to load texture " << texFilename4 << endl;
+        TaskGraph::TaskId stressGenerated = startup.AddTask("generate stress scene", "geometry", TASK_WORKER, [&workerPool] {
+            StressSceneSettings settings;
+            settings.objectCount = gOptions.stressObjects;
+            settings.seed = gOptions.stressSeed;
+            settings.distribution = gOptions.stressDistribution;
+            settings.lightCount = gOptions.stressLights;
+            settings.extent = gOptions.stressExtent;
+            settings.textureCount = STRESS_PRIMITIVE_COUNT;    // CLN: the textures of the objects each primitive comes from
+            if (!gStressScene.Generate(settings, &workerPool))
+                return false;
+            gStressScene.PrintStats(cout);
+            return true;
+        });
+
+        // CLN: [HLOD] The tree and its proxy meshes are built on the workers; they are uploaded after startup, once
+        //      the textures their atlas is made of have loaded
+        if (buildHlod)
+        {
+            startup.AddTask("build HLOD tree", "geometry", TASK_WORKER, [&workerPool, &hlodMeshes] {
+                if (!gHlod.Build(gStressScene.GetObjects(), hlodMeshes, STRESS_PRIMITIVE_COUNT, gOptions.hlodSettings, workerPool))
+                    cout << "INFO: HLOD tree unavailable" << endl;
+                std::vector<MeshData>().swap(hlodMeshes);
+                return true;
+            }, { stressGenerated, staticMeshed, cylinderMeshed, sphereMeshed });
+        }
+    }
+
+    bool startupSucceeded = startup.Run();
+    startup.PrintTimeline(cout);
+
+    // CLN: [NUMA] Startup is where the workers do most of their work, so its cross-node traffic is shown here;
+    //      compare with a --no-thread-pinning run
+    NumaTopology::Get().PrintStats(cout);
+    workerPool.PrintStats(cout);
+    if (!startupSucceeded)
         return EXIT_FAILURE;
+
+    if (!gOptions.geometryCacheDirectory.empty())
+        cout << "INFO: Geometry cache " << gOptions.geometryCacheDirectory << ": " << geometryCache.GetHitCount() << " hit(s), "
+             << geometryCache.GetMissCount() << " miss(es)" << endl;
+
+    cout << "All textures loaded successfully!" << endl;
+
+    // CLN: [Import] imported models carry no textures of their own, so they use the marble of the plane
+    for (GLObject& part : ImportedModel)
+        part.gTextureId = Plane.gTextureId;
+
+    // CLN: [OIT] The Optic Chicago logo is a PNG with alpha
+    TriCaseLogo.transparent = true;
+
+    // CLN: [Reflection] The objects the probes of the plane and the can see
+    GLObject* const reflectionCasters[] = { &Plane, &TriCase, &TriCaseLogo, &LaCroixCan, &FoamBall, &StickyNotes };
+    for (GLObject* caster : reflectionCasters)
+        caster->reflectionCaster = true;
+    for (GLObject& part : ImportedModel)
+        part.reflectionCaster = true;
+
+    // CLN: [Overdraw] --overdraw-report counts the first frame
+    if (!gOptions.overdrawReportFile.empty())
+        gOverdrawView.SetMode(OVERDRAW_VIEW_OVERDRAW);
+    bool overdrawReportFailed = false;
+
+    // CLN: [Checkerboard] --checkerboard-report state: the frame, the last reconstructed image and the frame times
+    int checkerboardReportFrame = 0;
+    std::vector<unsigned char> checkerboardImage;
+    ImageComparison checkerboardComparison;
+    double checkerboardFrameMs = 0.0, nativeFrameMs = 0.0;
+    bool checkerboardReportFailed = false;
+    if (!gOptions.checkerboardReportFile.empty())
+        gLightOrbitPaused = true;
+
+    // CLN: [Streaming] Optional out-of-core world, loaded and evicted cell by cell around the camera
+    // ----------------------------------------------------------------------------------------------
+    SceneStreamer streamer(workerPool, gFrameScheduler);
+    GLObject StreamedObject("streamed cells");  // CLN: draws the streamed objects through the regular render path
+
+    // CLN: [Stress] Stress objects borrow the mesh and texture of the scene object their primitive comes from
+    GLObject StressInstance("stress scene");
+    const GLObject* stressSources[STRESS_PRIMITIVE_COUNT] = { &StickyNotes, &TriCase, &FoamBall, &LaCroixCan, &Plane };
+    std::vector<unsigned char> stressShadingLevels;    // CLN: [ShadingLOD] per stress object
+
+    // CLN: [HLOD] Proxies share one atlas of the stress sources' textures, and draw through the regular render path
+    GLObject HlodInstance("HLOD proxies");
+    std::vector<unsigned char> hlodShadingLevels;      // CLN: [ShadingLOD] per HLOD node
+    if (buildHlod)
+    {
+        std::vector<GLuint> hlodTextures;
+        for (const GLObject* source : stressSources)
+            hlodTextures.push_back(source->gTextureId);
+        if (gHlod.CreateProxies(hlodTextures))
+        {
+            gHlod.SetEnabled(true);
+            gHlod.PrintStats(cout);
+        }
     }
-    else if (!FoamBall.CreateTexture(texFilename5, FoamBall.gTextureId))
+
+    // CLN: [Impostor] One impostor per primitive and texture pair the stress scene uses (-1: none, drawn as meshes).
+    //      They are baked from the startup meshes; the foam ball keeps its first tessellation's impostor after 'R'
+    int stressImpostors[STRESS_PRIMITIVE_COUNT][STRESS_PRIMITIVE_COUNT];
+    std::fill(&stressImpostors[0][0], &stressImpostors[0][0] + STRESS_PRIMITIVE_COUNT * STRESS_PRIMITIVE_COUNT, -1);
+    if (gImpostors.IsCreated())
     {
-        cout << "Failed to load texture " << texFilename5 << endl;
-        return EXIT_FAILURE;
+        bool used[STRESS_PRIMITIVE_COUNT][STRESS_PRIMITIVE_COUNT] = {};
+        for (const StressObject& object : gStressScene.GetObjects())
+            used[object.primitive][object.texture] = true;
+        for (int primitive = 0; primitive < STRESS_PRIMITIVE_COUNT; ++primitive)
+        {
+            for (int texture = 0; texture < STRESS_PRIMITIVE_COUNT; ++texture)
+            {
+                if (!used[primitive][texture])
+                    continue;
+                const GLObject& source = *stressSources[primitive];
+                const std::string key = string(StressScene::GetPrimitiveName((StressPrimitive)primitive)) + "_"
+                                      + StressScene::GetPrimitiveName((StressPrimitive)texture);
+                stressImpostors[primitive][texture] = gImpostors.Bake(key, source.mesh.vao, source.mesh.nIndices,
+                                                                      stressSources[texture]->gTextureId, source.boundingRadius);
+            }
+        }
+        if (gImpostors.GetCount() > 0)
+            gImpostors.PrintStats(cout);
     }
-    else if (!StickyNotes.CreateTexture(texFilename6, StickyNotes.gTextureId))
+
+    // CLN: [Material] The scene's objects keep the Phong constants they had, each with its own texture; the stress
+    //      objects get one material per texture. Alike materials are merged, then the buffer is sorted by texture
+    //      (HLOD proxies and streamed cells keep the default, their draws bind the atlas or cell texture)
+    std::vector<GLObject*> materialObjects = { &Plane, &TriCase, &TriCaseLogo, &LaCroixCan, &FoamBall, &StickyNotes };
+    for (GLObject& part : ImportedModel)
+        materialObjects.push_back(&part);
+    for (GLObject* object : materialObjects)
     {
-        cout << "Failed to load texture " << texFilename6 << endl;
-        return EXIT_FAILURE;
+        Material material;
+        material.texture = gMaterials.AddTexture(object->gTextureId);
+        // CLN: [Reflection] The polished marble and the can mirror their surroundings, the can the sharper of the two
+        if (object == &Plane)
+        {
+            material.reflectivity = 0.15f;
+            material.highlightSize = 64.0f;
+        }
+        else if (object == &LaCroixCan)
+        {
+            material.reflectivity = 0.3f;
+            material.highlightSize = 128.0f;
+        }
+        object->materialId = gMaterials.Add(material);
     }
-    else
+    int stressMaterials[STRESS_PRIMITIVE_COUNT];
+    int stressMaterialSlots[STRESS_PRIMITIVE_COUNT];
+    for (int texture = 0; texture < STRESS_PRIMITIVE_COUNT; ++texture)
     {
-        cout << "All textures loaded successfully!" << endl;
+        Material material;
+        material.texture = gMaterials.AddTexture(stressSources[texture]->gTextureId);
+        stressMaterials[texture] = gMaterials.Add(material);
     }
-
-    // CLN: Create meshes for the various 3D objects by transferring vertices and indices into each
-    //      respective object's VBO, then bind over to the GPU
-    // ---------------------------------------------------------------------------------------------
-    Plane.CreateMesh(*PlaneVertices, sizeof(PlaneVertices), *PlaneIndices, sizeof(PlaneIndices));
-    TriCase.CreateMesh(*TriCaseVertices, sizeof(TriCaseVertices), *TriCaseIndices, sizeof(TriCaseIndices));
-    TriCaseLogo.CreateMesh(*TriCaseLogoVertices, sizeof(TriCaseLogoVertices), *TriCaseLogoIndices, sizeof(TriCaseLogoIndices));
-    LaCroixCan.CreateMesh(*cylinder.getVertices(), cylinder.getVertexSize(), *cylinder.getIndices(), cylinder.getIndexSize());
-    FoamBall.CreateMesh(*sphere.getVertices(), sphere.getVertexSize(), *sphere.getIndices(), sphere.getIndexSize());
-    StickyNotes.CreateMesh(*CubeVertices, sizeof(CubeVertices), *CubeIndices, sizeof(CubeIndices));
-    MainLight.CreateMesh(*CubeVertices, sizeof(CubeVertices), *CubeIndices, sizeof(CubeIndices));
-    FillLight.CreateMesh(*CubeVertices, sizeof(CubeVertices), *CubeIndices, sizeof(CubeIndices));
-     
-    // Create the shader program
-    if (!UCreateShaderProgram(vertexShaderSource, fragmentShaderSource, gProgramId))
+    gMaterials.Sort();
+    if (!gMaterials.Upload())
         return EXIT_FAILURE;
+    for (int texture = 0; texture < STRESS_PRIMITIVE_COUNT; ++texture)
+        stressMaterialSlots[texture] = gMaterials.GetSlot(stressMaterials[texture]);
+    gMaterials.PrintStats(cout);
 
-    // CLN: [Lighting] Added to create shader for lamp object
-    if (!UCreateShaderProgram(lampVertexShaderSource, lampFragmentShaderSource, gLampProgramId))
-        return EXIT_FAILURE;
+    // CLN: [Reflection] One probe above the middle of the plane, one in the can (where both spheres hold a point, the
+    //      nearer center wins, so the can reflects from its own). Their faces are drawn with the diffuse-only shader
+    if (gOptions.reflectionProbes)
+    {
+        if (gReflectionProbes.Create(gShadingProgramIds[SHADING_DIFFUSE], gOptions.reflectionProbeSize, gOptions.reflectionProbeFaces))
+        {
+            const float planeProbe[3] = { 0.0f, 1.0f, 0.0f };
+            const float canProbe[3] = { 1.0f, 0.75f, 1.0f };
+            gReflectionProbes.AddProbe(planeProbe, 4.0f, &Plane);
+            gReflectionProbes.AddProbe(canProbe, 1.0f, &LaCroixCan);
+        }
+        else
+            cout << "INFO: Reflection probes unavailable" << endl;
+    }
+    if (!gOptions.streamDirectory.empty())
+    {
+        if (gOptions.buildStreamCells > 0 && !UBuildStreamingWorld(gOptions.streamDirectory, gOptions.buildStreamCells))
+            return EXIT_FAILURE;
+        if (!streamer.Open(gOptions.streamDirectory))
+            return EXIT_FAILURE;
+
+        streamer.SetDrawRadius(gOptions.streamDrawRadius);
+        streamer.SetMemoryBudget(gOptions.streamBudgetMB * 1024 * 1024);
+        gStreamer = &streamer;
+    }
 
     // CLN: [Texture] tell opengl for each sampler to which texture unit it belongs (only has to be done once)
-    glUseProgram(gProgramId);
-    // We set the texture as texture unit 0
-    glUniform1i(glGetUniformLocation(gProgramId, "uTextureBase"), 0);
+    // CLN: [ShadingLOD] (in every shading variant; gProgramId is the full one)
+    gShadingProgramIds[SHADING_FULL] = gProgramId;
+    for (GLuint programId : gShadingProgramIds)
+    {
+        glUseProgram(programId);
+        // We set the texture as texture unit 0
+        glUniform1i(glGetUniformLocation(programId, "uTextureBase"), 0);
+        // CLN: [Reprojection] [Reflection] (their uniforms are set once per frame, in every variant)
+        if (gReprojectionCache.IsCreated())
+            gReprojectionCache.AddProgram(programId);
+        gReflectionProbes.AddProgram(programId);
+    }
 
     // Sets the background color of the window to black (it will be implicitely used by glClear)
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
@@ -805,30 +2579,140 @@ int main(int argc, char* argv[])
     // ---------------------------------------------------------------------------
     while (!glfwWindowShouldClose(gWindow))
     {
+        // CLN: [AccumAA] Once the image has converged it can't get any better until something moves: wait for input
+        //      (or the idle frame interval) instead of drawing the same frame at full rate
+        if (gProgressiveAA.IsConverged() && gFrameScheduler.GetPendingCount() == 0)
+            glfwWaitEventsTimeout(1.0 / gOptions.accumulationIdleFps);
+
         // per-frame timing
         // --------------------
         float currentFrame = glfwGetTime();
         gDeltaTime = currentFrame - gLastFrame;
         gLastFrame = currentFrame;
+        const unsigned long long frameStartNs = FlightRecorder::Now();   // CLN: [Flight]
 
         // UProcessInput function processes all user input into the window object using glfwGetKey() 
         // function.
         // CLN: If the 'ESC' key is pressed, will close the OpenGL window, otherwise ASDWQEP keys
         //      are processed accordingly
         // -----------------------------------------------------------------------------------------
-        UProcessInput(gWindow);
+        {
+            FlightZone zone(gFlightRecorder, "input");
+            UProcessInput(gWindow);
+        }
+
+        // CLN: [Checkerboard] The report turns the camera every frame, so the reconstruction has to reproject, except
+        //      on the native frame it is compared with, which draws the view of the last checkerboard frame
+        const bool checkerboardReport = !gOptions.checkerboardReportFile.empty();
+        if (checkerboardReport)
+        {
+            if (checkerboardReportFrame != CHECKERBOARD_REPORT_FRAMES)
+                gCamera.ProcessMouseMovement(2.0f, 0.0f);
+            if (checkerboardReportFrame == CHECKERBOARD_REPORT_FRAMES)
+                gCheckerboard.SetEnabled(false);
+        }
+
+        // CLN: [Scheduler] 'R' rebuilds the foam ball at the next tessellation level. The sphere is generated
+        //      on a worker thread and its upload is handed to the frame scheduler, so neither step hitches a frame
+        // CLN: [GeometryCache] once a level has been generated, later runs map it from the cache instead
+        if (gRebuildFoamBall)
+        {
+            gRebuildFoamBall = false;
+
+            static int foamBallLevel = 0;
+            foamBallLevel = (foamBallLevel + 1) % 3;
+            const int sectors = 36 << foamBallLevel;    // 36x18, 72x36, 144x72
+            const int stacks = 18 << foamBallLevel;
+
+            workerPool.Submit([&FoamBall, &geometryCache, sectors, stacks] {
+                FlightZone zone(gFlightRecorder, "generate foam ball");
+                std::shared_ptr<MeshUpload> upload = std::make_shared<MeshUpload>();
+                upload->geometry = geometryCache.GetSphere(0.4f, sectors, stacks);
+                FoamBall.QueueMeshUpload(gFrameScheduler, "foam ball " + to_string(sectors) + "x" + to_string(stacks), upload);
+            });
+        }
+
+        // CLN: [Streaming] Request/evict cells around the camera before the scheduler runs their uploads
+        if (gStreamer)
+        {
+            FlightZone zone(gFlightRecorder, "streaming update");
+            gStreamer->Update(gCamera.Position, gCamera.Front, gDeltaTime);
+        }
+
+        // CLN: [Scheduler] Run queued background work, but never more than the per-frame budget
+        {
+            FlightZone zone(gFlightRecorder, "frame scheduler");
+            gFrameScheduler.RunFrame();
+        }
+
+        if (gPrintStats)
+        {
+            gPrintStats = false;
+            UPrintStats();
+        }
+
+        // CLN: [AccumAA] If the camera, lights and settings are as they were last frame, this frame is drawn with the
+        //      next subpixel offset; otherwise the accumulation starts over with it, unjittered
+        const glm::mat4 unjitteredProjection = projection;
+        if (gProgressiveAA.IsEnabled())
+        {
+            gProgressiveAA.BeginFrame(UHashViewState());
+            gProgressiveAA.JitterProjection(glm::value_ptr(unjitteredProjection), glm::value_ptr(projection));
+        }
+
+        // CLN: [Checkerboard] (the report times the frame from here to the reconstruction, GPU work included)
+        std::chrono::steady_clock::time_point checkerboardReportStart;
+        if (checkerboardReport)
+        {
+            glFinish();
+            checkerboardReportStart = std::chrono::steady_clock::now();
+        }
 
         // CLN: This renders the window's background color. Set glClearColor RGB values to 0 for a black background
         // and clears the frame and z buffers
+        // CLN: [OIT] (of the scene framebuffer, which is copied to the window once the transparent layer is added)
         // --------------------------------------------------------------------------------------------------------
-        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        gTransparencyPass.BeginOpaque();
+
+        // CLN: [Checkerboard] Mask the opaque and transparent passes to this frame's half of the pixels (not under
+        //      the overdraw views, which count every fragment)
+        const bool checkerboarding = gCheckerboard.IsEnabled() && !gOverdrawView.IsActive();
+        if (checkerboarding)
+        {
+            const glm::mat4 viewProjection = projection * gCamera.GetViewMatrix();
+            gCheckerboard.BeginFrame(gTransparencyPass.GetSceneFramebuffer(), glm::value_ptr(viewProjection),
+                                     glm::value_ptr(glm::inverse(viewProjection)));
+        }
+
+        // CLN: [ShadingLOD] Time the opaque objects on the GPU, and count them per shading level from here
+        const unsigned long long opaqueStartNs = FlightRecorder::Now();   // CLN: [Flight]
+        gOpaquePassTimer.Begin();
+        std::fill(gShadingLevelCounts, gShadingLevelCounts + SHADING_LEVEL_COUNT, 0u);
+
+        // CLN: [Overdraw] Start the fragment counts of a debug view
+        if (gOverdrawView.IsActive())
+            gOverdrawView.BeginFrame();
+
+        // CLN: [Reprojection] Let the opaque objects reuse last frame's lighting (not while the counting shader draws)
+        //      [Checkerboard] nor under the checkerboard, whose half-shaded frames would go into the cache
+        const bool reprojecting = gReprojectionEnabled && !gOverdrawView.IsActive() && !checkerboarding;
+        if (reprojecting)
+        {
+            const glm::mat4 viewProjection = projection * gCamera.GetViewMatrix();
+            gReprojectionCache.BeginFrame(glm::value_ptr(viewProjection), glm::value_ptr(gCamera.Position),
+                                          (unsigned long long)gLightingVersion << 32 | gMaterials.GetVersion());
+        }
+
+        // CLN: [Reflection] The probes see what the opaque pass draws from here on, and the shaders see the probes
+        gReflectionProbes.BeginFrame(glm::value_ptr(gCamera.Position));
+
+        // CLN: [DebugDraw] Labels drawn this frame face the camera
+        gDebugDraw.SetCamera(glm::value_ptr(gCamera.GetViewMatrix()));
 
         // CLN: Renders the 3D Scene by passing the scale, rotate, and translate matrices, and lamp & orbit bools to the object's Render method
         // ------------------------------------------------------------------------------------------------------------------------------------
         Plane.Render(glm::scale(glm::vec3(2.5f, 2.5f, 2.5f)), glm::rotate(glm::radians(30.0f), glm::vec3(0.3f, 1.0f, 0.0f)), glm::translate(glm::vec3(0.0f, 0.0f, 0.0f)), false, false);
         TriCase.Render(glm::scale(glm::vec3(2.0f, 2.0f, 2.0f)), glm::rotate(glm::radians(30.0f), glm::vec3(0.3f, 1.0f, 0.0f)), glm::translate(glm::vec3(-1.0f, -0.54f, 4.0f)), false, false);
-        TriCaseLogo.Render(glm::scale(glm::vec3(2.0f, 2.0f, 2.0f)), glm::rotate(glm::radians(30.0f), glm::vec3(0.3f, 1.0f, 0.0f)), glm::translate(glm::vec3(-1.0f, -0.54f, 4.0f)), false, false);
         LaCroixCan.Render(glm::scale(glm::vec3(2.0f, 2.0f, 2.0f)), glm::rotate(glm::radians(99.0f), glm::vec3(1.0f, 0.0f, 0.0f)), glm::translate(glm::vec3(1.0f, 0.75f, 1.0f)), false, false);
         FoamBall.Render(glm::scale(glm::vec3(1.0f, 1.0f, 1.0f)), glm::rotate(glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f)), glm::translate(glm::vec3(1.0f, -0.24f, 4.2f)), false, false);
         StickyNotes.Render(glm::scale(glm::vec3(1.0f, 0.1f, 1.0f)), glm::rotate(glm::radians(30.0f), glm::vec3(0.3f, 1.0f, 0.0f)), glm::translate(glm::vec3(2.5f, -0.31f, 2.0f)), false, false);
@@ -839,14 +2723,300 @@ int main(int argc, char* argv[])
         MainLight.Render(glm::scale(glm::vec3(0.5f, 0.5f, 0.5f)), glm::rotate(glm::radians(30.0f), glm::vec3(0.3f, 1.0f, 0.0f)), glm::translate(glm::vec3(2.5f, 2.0f, 7.0)), true, true);
         //gLightColor.r, gLightColor.g, gLightColor.b = 0.1f; // sets color white 10% intensity for fill light (FillLight)
         FillLight.Render(glm::scale(glm::vec3(0.5f, 0.5f, 0.5f)), glm::rotate(glm::radians(30.0f), glm::vec3(0.3f, 1.0f, 0.0f)), glm::translate(glm::vec3(5.0f, 1.0f, -1.0)), true, false);
+
+        // CLN: [Import] Imported model, standing on the left side of the plane
+        for (GLObject& part : ImportedModel)
+            part.Render(importedModelFit, glm::rotate(glm::radians(30.0f), glm::vec3(0.3f, 1.0f, 0.0f)), glm::translate(glm::vec3(-2.0f, 0.0f, 1.5f)), false, false);
+
+        // CLN: [Streaming] Draw the resident cells
+        if (gStreamer)
+        {
+            gStreamer->Draw(gCamera.Position, [&StreamedObject](GLuint vao, GLuint indexCount, GLuint texture, const float* model) {
+                StreamedObject.mesh.vao = vao;
+                StreamedObject.mesh.nIndices = indexCount;
+                StreamedObject.gTextureId = texture;
+                StreamedObject.RenderModel(glm::make_mat4(model), false, false);
+            });
+        }
+
+        // CLN: [Stress] Every stress object through the regular render path, lit by its nearest stress light
+        if (!gStressScene.GetObjects().empty())
+        {
+            const std::chrono::steady_clock::time_point submitStart = std::chrono::steady_clock::now();
+            const glm::vec3 sceneLightPosition = gLightPosition;
+            const glm::vec3 sceneLightColor = gLightColor;
+            const std::vector<StressLight>& stressLights = gStressScene.GetLights();
+            const std::vector<StressObject>& stressObjects = gStressScene.GetObjects();
+
+            // CLN: [Arena] Draw list sorted by mesh, then texture, then light, so consecutive draws share their state.
+            //      The keys live in the frame arena, no heap allocation per frame
+            // CLN: [Material] (by material slot instead of texture: the slots are sorted by texture, so materials that
+            //      share one stay adjacent)
+            FrameVector<unsigned long long> drawList{ FrameAllocator<unsigned long long>(*gFrameArena) };
+            drawList.reserve(stressObjects.size());
+
+            // CLN: [Impostor] Objects whose bounding sphere is smaller than --impostor-pixels on screen go to the
+            //      impostors instead (not under the overdraw views, which count the meshes' fragments)
+            const bool impostoring = gImpostors.IsEnabled() && !gOverdrawView.IsActive();
+            const float pixelsPerUnitAtOne = WINDOW_HEIGHT / (2.0f * tanf(glm::radians(gCamera.Zoom) * 0.5f));
+            auto queueObject = [&](size_t i) {
+                const StressObject& object = stressObjects[i];
+                const int impostor = stressImpostors[object.primitive][object.texture];
+                if (impostoring && impostor >= 0)
+                {
+                    const float distance = std::max(glm::length(glm::make_vec3(object.model + 12) - gCamera.Position), 0.01f);
+                    if (2.0f * object.radius * pixelsPerUnitAtOne < gOptions.impostorPixels * distance)
+                    {
+                        const StressLight& light = stressLights[object.light];
+                        gImpostors.Add(impostor, object.model, light.position, light.color, stressMaterialSlots[object.texture]);
+                        return;
+                    }
+                }
+                drawList.push_back((unsigned long long)object.primitive << 56
+                                 | (unsigned long long)stressMaterialSlots[object.texture] << 40
+                                 | (unsigned long long)object.light << 32 | i);
+            };
+
+            // CLN: [HLOD] Only the objects of the leaves no proxy stands in for are drawn one by one (the overdraw
+            //      views count every object's fragments)
+            const bool hlodActive = gHlod.IsEnabled() && !gOverdrawView.IsActive();
+            if (hlodActive)
+            {
+                gHlod.Select(glm::value_ptr(gCamera.Position), pixelsPerUnitAtOne, gOptions.hlodPixelError * gQuality.lodBias);
+                const std::vector<unsigned int>& order = gHlod.GetObjectOrder();
+                for (int leaf : gHlod.GetSelectedLeaves())
+                {
+                    const HlodNode& node = gHlod.GetNode(leaf);
+                    for (unsigned int k = node.firstObject; k < node.firstObject + node.objectCount; ++k)
+                        queueObject(order[k]);
+                }
+            }
+            else
+            {
+                for (size_t i = 0; i < stressObjects.size(); ++i)
+                    queueObject(i);
+            }
+            std::sort(drawList.begin(), drawList.end());
+
+            if (stressShadingLevels.size() != stressObjects.size())
+                stressShadingLevels.assign(stressObjects.size(), SHADING_FULL);
+            for (unsigned long long key : drawList)
+            {
+                const StressObject& object = stressObjects[key & 0xFFFFFFFFull];
+                const GLObject& source = *stressSources[object.primitive];
+                StressInstance.mesh = source.mesh;
+                StressInstance.boundingRadius = source.boundingRadius;
+                StressInstance.shadingLevelSlot = &stressShadingLevels[key & 0xFFFFFFFFull];
+                StressInstance.materialId = stressMaterials[object.texture];
+                StressInstance.gTextureId = gMaterials.GetTextureName(gMaterials.Get(StressInstance.materialId).texture);
+                gLightPosition = glm::make_vec3(stressLights[object.light].position);
+                gLightColor = glm::make_vec3(stressLights[object.light].color);
+                StressInstance.RenderModel(glm::make_mat4(object.model), false, false);
+            }
+
+            // CLN: [HLOD] One draw per selected proxy, lit by the light most of its objects use
+            if (hlodActive)
+            {
+                HlodInstance.gTextureId = gHlod.GetAtlas();
+                for (int index : gHlod.GetSelectedProxies())
+                {
+                    const HlodNode& node = gHlod.GetNode(index);
+                    if (node.proxyTriangles == 0)
+                        continue;   // CLN: [HLOD] everything in it was too small to keep at that distance
+                    HlodInstance.mesh.vao = node.vao;
+                    HlodInstance.mesh.vbos[0] = node.vbos[0];
+                    HlodInstance.mesh.vbos[1] = node.vbos[1];
+                    HlodInstance.mesh.nIndices = node.proxyTriangles * 3;
+                    HlodInstance.boundingRadius = node.radius;
+                    if ((size_t)index >= hlodShadingLevels.size())
+                        hlodShadingLevels.resize(index + 1, SHADING_FULL);
+                    HlodInstance.shadingLevelSlot = &hlodShadingLevels[index];
+                    gLightPosition = glm::make_vec3(stressLights[node.light].position);
+                    gLightColor = glm::make_vec3(stressLights[node.light].color);
+                    HlodInstance.RenderModel(glm::translate(glm::make_vec3(node.center)), false, false);
+                }
+            }
+            gLightPosition = sceneLightPosition;
+            gLightColor = sceneLightColor;
+
+            // CLN: [Impostor] (one instanced draw per baked impostor; lit as StressInstance would light them)
+            if (impostoring)
+            {
+                const glm::mat4 viewProjection = projection * gCamera.GetViewMatrix();
+                gImpostors.Draw(glm::value_ptr(viewProjection), glm::value_ptr(gCamera.Position), glm::value_ptr(StressInstance.cameraPosition));
+            }
+            gStressSubmitMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - submitStart).count();
+            gFlightRecorder.Counter("stress submit ms", gStressSubmitMs);
+        }
+
+        if (reprojecting)
+            gReprojectionCache.EndFrame(gTransparencyPass.GetSceneColorTexture());
+        gOpaquePassTimer.End();
+        gFlightRecorder.Zone("opaque pass", opaqueStartNs, FlightRecorder::Now());
+
+        // CLN: [Reflection] Queue the updates of the probes whose view changed; the frame scheduler re-renders their
+        //      faces from these draws at the start of the next frames, within its budget
+        gReflectionProbes.EndFrame(gFrameScheduler);
+
+        // CLN: [OIT] Transparent objects last, in any order: their cost doesn't depend on sorting or object count
+        const unsigned long long transparentStartNs = FlightRecorder::Now();    // CLN: [Flight]
+        gTransparentPassTimer.Begin();
+        if (gOitEnabled)
+            gTransparencyPass.BeginTransparent();
+        TriCaseLogo.Render(glm::scale(glm::vec3(2.0f, 2.0f, 2.0f)), glm::rotate(glm::radians(30.0f), glm::vec3(0.3f, 1.0f, 0.0f)), glm::translate(glm::vec3(-1.0f, -0.54f, 4.0f)), false, false);
+        if (gOitEnabled)
+            gTransparencyPass.EndTransparent();
+        gTransparentPassTimer.End();
+        gFlightRecorder.Zone("transparent pass", transparentStartNs, FlightRecorder::Now());
+
+        // CLN: [Checkerboard] Fill in the pixels this frame skipped
+        if (checkerboarding)
+        {
+            FlightZone zone(gFlightRecorder, "checkerboard reconstruct");
+            gCheckerboard.Reconstruct(gTransparencyPass.GetSceneFramebuffer(), gTransparencyPass.GetSceneColorTexture(),
+                                      gTransparencyPass.GetSceneDepthTexture());
+        }
+
+        // CLN: [Checkerboard] Report: average frame times (the first checkerboard frame stamps the pattern, and the
+        //      compared native frame reads back, so neither counts), and the last checkerboard frame against the
+        //      same view drawn natively
+        if (checkerboardReport)
+        {
+            glFinish();
+            const double frameMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - checkerboardReportStart).count();
+            const int width = gCheckerboard.GetWidth(), height = gCheckerboard.GetHeight();
+            if (checkerboardReportFrame > 0 && checkerboardReportFrame < CHECKERBOARD_REPORT_FRAMES)
+                checkerboardFrameMs += frameMs / (CHECKERBOARD_REPORT_FRAMES - 1);
+            else if (checkerboardReportFrame > CHECKERBOARD_REPORT_FRAMES)
+                nativeFrameMs += frameMs / CHECKERBOARD_REPORT_FRAMES;
+
+            if (checkerboardReportFrame == CHECKERBOARD_REPORT_FRAMES - 1)
+                CheckerboardRenderer::ReadColor(gTransparencyPass.GetSceneFramebuffer(), width, height, checkerboardImage);
+            else if (checkerboardReportFrame == CHECKERBOARD_REPORT_FRAMES)
+            {
+                std::vector<unsigned char> nativeImage;
+                CheckerboardRenderer::ReadColor(gTransparencyPass.GetSceneFramebuffer(), width, height, nativeImage);
+                checkerboardComparison = CheckerboardRenderer::CompareImages(nativeImage, checkerboardImage, width, height);
+            }
+            else if (checkerboardReportFrame == 2 * CHECKERBOARD_REPORT_FRAMES)
+            {
+                CheckerboardRenderer::PrintComparison(checkerboardComparison, cout);
+                cout << "INFO: Checkerboard frames took " << checkerboardFrameMs << " ms, native frames " << nativeFrameMs << " ms" << endl;
+                checkerboardReportFailed = !CheckerboardRenderer::WriteReport(gOptions.checkerboardReportFile, checkerboardComparison,
+                                                                              checkerboardFrameMs, nativeFrameMs);
+                glfwSetWindowShouldClose(gWindow, true);
+            }
+            ++checkerboardReportFrame;
+        }
+
+        // CLN: [Overdraw] The heat map replaces the scene color
+        if (gOverdrawView.IsActive())
+            gOverdrawView.Resolve();
+
+        // CLN: [DebugDraw] Everything recorded this frame (from any thread) goes out in at most two draws, over the
+        //      finished scene but depth tested against it
+        if (gDebugDrawEnabled)
+        {
+            FlightZone zone(gFlightRecorder, "debug draw");
+            if (gDebugCameraPath.empty() || glm::length(gDebugCameraPath.back() - gCamera.Position) > 0.05f)
+            {
+                if (gDebugCameraPath.size() == 512)
+                    gDebugCameraPath.erase(gDebugCameraPath.begin());
+                gDebugCameraPath.push_back(gCamera.Position);
+            }
+            gDebugDraw.LineStrip(glm::value_ptr(gDebugCameraPath[0]), gDebugCameraPath.size(), DebugDraw::Color(1.0f, 0.5f, 0.0f));
+            gDebugDraw.Frustum(glm::value_ptr(glm::inverse(gDebugFrozenViewProjection)), DebugDraw::Color(1.0f, 1.0f, 1.0f));
+
+            const glm::mat4 viewProjection = projection * gCamera.GetViewMatrix();
+            gDebugDrawTimer.Begin();
+            gDebugDraw.Flush(glm::value_ptr(viewProjection));
+            gDebugDrawTimer.End();
+        }
+
+        // CLN: [AccumAA] Put the unjittered projection back and average the frame into the history (the scene color
+        //      becomes the average so far), unless the state changed while drawing (the lamp's orbit moves the light)
+        if (gProgressiveAA.IsEnabled())
+        {
+            FlightZone zone(gFlightRecorder, "accumulation AA");
+            projection = unjitteredProjection;
+            gProgressiveAA.Accumulate(gTransparencyPass.GetSceneFramebuffer(), gTransparencyPass.GetSceneColorTexture(), UHashViewState());
+        }
+
+        // CLN: [Probe] (scaled up to the window if the quality profile renders at a lower resolution)
+        int windowWidth, windowHeight;
+        glfwGetFramebufferSize(gWindow, &windowWidth, &windowHeight);
+        {
+            FlightZone zone(gFlightRecorder, "present");
+            gTransparencyPass.Present(windowWidth, windowHeight);
+        }
+
+        // CLN: [Overdraw] Headless overdraw report (--overdraw-report): one frame is enough
+        if (!gOptions.overdrawReportFile.empty())
+        {
+            const OverdrawStats stats = gOverdrawView.ReadStats();
+            OverdrawView::PrintStats(stats, cout);
+            overdrawReportFailed = !OverdrawView::WriteReport(gOptions.overdrawReportFile, stats);
+            glfwSetWindowShouldClose(gWindow, true);
+        }
         
         // CLN: Moved the swap buffers here, instead of in the object's Rendedr() method, to prevent flickering
-        glfwSwapBuffers(gWindow);    // Flips the the back buffer with the front buffer every frame.
-        glfwPollEvents();
+        {
+            FlightZone zone(gFlightRecorder, "swap buffers");
+            glfwSwapBuffers(gWindow);    // Flips the the back buffer with the front buffer every frame.
+        }
+        {
+            FlightZone zone(gFlightRecorder, "poll events");
+            glfwPollEvents();
+        }
+
+        // CLN: [Arena] This frame's transient data stays valid while the next two frames are built
+        gFrameArena->NextFrame();
+
+        // CLN: [Flight] The GPU pass times arrive a few frames late (GpuTimer), so they are the latest results, not
+        //      this frame's. On a spike, the window is copied here and written out by a worker
+        gFlightRecorder.Counter("opaque pass GPU ms", gOpaquePassTimer.GetLastMs());
+        gFlightRecorder.Counter("transparent pass GPU ms", gTransparentPassTimer.GetLastMs());
+        gFlightRecorder.Counter("frame arena KB", gFrameArena->GetLastFrameBytes() / 1024.0);
+        std::string flightDumpReason;
+        if (gFlightRecorder.EndFrame(frameStartNs, flightDumpReason))
+        {
+            std::shared_ptr<std::vector<FlightEvent>> events = std::make_shared<std::vector<FlightEvent>>();
+            gFlightRecorder.Snapshot(*events);
+            const std::string filename = gFlightRecorder.NextDumpFilename();
+            cout << "INFO: Flight recorder: " << flightDumpReason << ", writing the last " << gOptions.flightRecorderSeconds
+                 << " s (" << events->size() << " events) to " << filename << endl;
+            workerPool.Submit([events, filename, flightDumpReason] {
+                FlightRecorder::WriteTrace(filename, *events, flightDumpReason);
+            });
+        }
+
+        // CLN: [Startup] Report how long it took from launch until the first frame was presented
+        static bool firstFrameShown = false;
+        if (!firstFrameShown)
+        {
+            firstFrameShown = true;
+            cout << "INFO: Time to first frame: "
+                 << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startupBegin).count()
+                 << " ms" << endl;
+        }
     }
 
     // CLN: Teardown
     // -----------------------------------------------------
+    // CLN: [Scheduler] Let any in-flight rebuild finish before its target objects go away
+    workerPool.WaitIdle();
+
+    // CLN: [Scheduler] then drop the uploads it (or the streamer) queued, with the buffers they already created
+    const size_t cancelledItems = gFrameScheduler.CancelAll();
+    if (cancelledItems > 0)
+        cout << "INFO: Cancelled " << cancelledItems << " unfinished frame scheduler item(s) at exit" << endl;
+
+    // CLN: [Streaming] Release the streamed cells while the GL context is still alive
+    streamer.ReleaseAll();
+    gStreamer = nullptr;
+    gFrameArena = nullptr;      // CLN: [Arena] (main's arena goes away with main)
+    gWorkerPool = nullptr;
+
     // CLN: Release the mesh data for each respective object
     Plane.DestroyMesh(Plane.mesh);
     TriCase.DestroyMesh(TriCase.mesh);
@@ -856,6 +3026,12 @@ int main(int argc, char* argv[])
     StickyNotes.DestroyMesh(StickyNotes.mesh);
     MainLight.DestroyMesh(MainLight.mesh);
     FillLight.DestroyMesh(FillLight.mesh);
+    for (GLObject& part : ImportedModel)
+    {
+        part.DestroyMesh(part.mesh);
+        part.DestroyLodMeshes();
+    }
+    TriCase.DestroyLodMeshes();
 
     // CLN: [Texture] Release texture
     Plane.DestroyTexture(Plane.gTextureId);
@@ -873,7 +3049,53 @@ int main(int argc, char* argv[])
     // CLN: [Lighting] release lamp shader program
     UDestroyShaderProgram(gLampProgramId);
 
-    exit(EXIT_SUCCESS); // Terminates the program successfully
+    // CLN: [OIT] release the transparency targets and composite shader
+    gTransparencyPass.Destroy();
+    UDestroyShaderProgram(gOitCompositeProgramId);
+
+    // CLN: [ShadingLOD] release the cheaper shader variants and the GPU timer queries
+    UDestroyShaderProgram(gShadingProgramIds[SHADING_DIFFUSE]);
+    UDestroyShaderProgram(gShadingProgramIds[SHADING_VERTEX]);
+    gOpaquePassTimer.Destroy();
+    gTransparentPassTimer.Destroy();
+
+    // CLN: [Reprojection] release the cached shading targets
+    gReprojectionCache.Destroy();
+
+    // CLN: [Overdraw] release the debug view counters and shaders
+    gOverdrawView.Destroy();
+    UDestroyShaderProgram(gOverdrawCountProgramId);
+    UDestroyShaderProgram(gOverdrawResolveProgramId);
+
+    // CLN: [DebugDraw] release the line buffer, shader and timer queries
+    gDebugDraw.Destroy();
+    UDestroyShaderProgram(gDebugDrawProgramId);
+    gDebugDrawTimer.Destroy();
+
+    // CLN: [AccumAA] release the history target and its shader
+    gProgressiveAA.Destroy();
+    UDestroyShaderProgram(gAccumulateProgramId);
+
+    // CLN: [Checkerboard] release the reconstruction targets and shaders
+    gCheckerboard.Destroy();
+    UDestroyShaderProgram(gCheckerboardStampProgramId);
+    UDestroyShaderProgram(gCheckerboardReconstructProgramId);
+
+    // CLN: [HLOD] release the proxies and their atlas
+    gHlod.Destroy();
+
+    // CLN: [Impostor] release the atlases, instance buffer and shaders
+    gImpostors.Destroy();
+    UDestroyShaderProgram(gImpostorBakeProgramId);
+    UDestroyShaderProgram(gImpostorProgramId);
+
+    // CLN: [Material] release the material buffer
+    gMaterials.Destroy();
+
+    // CLN: [Reflection] release the probes' cube map array and targets
+    gReflectionProbes.Destroy();
+
+    exit(overdrawReportFailed || checkerboardReportFailed ? EXIT_FAILURE : EXIT_SUCCESS); // Terminates the program successfully
 }
 //----------------
 // CLN: main (end)
@@ -899,6 +3121,12 @@ bool UInitialize(int argc, char* argv[], GLFWwindow** window)
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 #endif
 
+    // CLN: [Overdraw] the headless overdraw report draws offscreen, the window needn't show
+    //      [ShaderLab] and neither does the shader lab
+    //      [Checkerboard] and neither does the checkerboard report
+    if (!gOptions.overdrawReportFile.empty() || gOptions.shaderLab || !gOptions.checkerboardReportFile.empty())
+        glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+
 
     // glfw window creation:
     // This creates a pointer to a GLFWwindow object, which holds all the windowing data for all GLFW functions
@@ -914,12 +3142,14 @@ bool UInitialize(int argc, char* argv[], GLFWwindow** window)
 
     // glfw: whenever the window size changed (by OS or user resize) this callback function executes
     // Callback functions set for cursor position, mouse scroll, and mouse button
+    // CLN: [Flight] and keys, which are only recorded (the keys are handled by polling in UProcessInput())
     // ---------------------------------------------------------------------------------------------
     glfwMakeContextCurrent(*window);
     glfwSetFramebufferSizeCallback(*window, UResizeWindow);
     glfwSetCursorPosCallback(*window, UMousePositionCallback);
     glfwSetScrollCallback(*window, UMouseScrollCallback);
     glfwSetMouseButtonCallback(*window, UMouseButtonCallback);
+    glfwSetKeyCallback(*window, UKeyCallback);
 
     // tell GLFW to capture our mouse
     glfwSetInputMode(*window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
@@ -943,6 +3173,457 @@ bool UInitialize(int argc, char* argv[], GLFWwindow** window)
 }
 
 
+// CLN: Reads the optional command line settings
+//      --frame-budget-ms <ms>        : time the frame scheduler may spend on background work per frame
+//      --stream <dir>                : stream the cells of a world directory around the camera
+//      --build-stream-world <n>      : write an n x n cell test world into the --stream directory first
+//      --stream-radius <units>       : distance up to which streamed cells are drawn (30 by default)
+//      --stream-budget-mb <MB>       : memory budget for streamed cells (512 by default)
+//      --mesh-codec-bench            : encode/decode large generated meshes, print ratio and throughput, then exit
+//      --self-test                   : run the self-tests of the task graph, scheduler, worker pool, mesh and scene
+//                                      modules, print the failures and exit (non-zero if any failed)
+//      --import <file>               : import an OBJ, GLB or glTF model into the scene (prints the import MB/s)
+//      --lod-pixel-error <px>        : largest projected error of a simplified LOD mesh (1 pixel by default)
+//      --geometry-cache <dir>        : directory of the generated sphere/cylinder cache ("geometry_cache" by default)
+//      --no-geometry-cache           : always run the sphere/cylinder generators
+//      --weld-epsilon <units>        : weld vertices whose positions are this close (and normals/UVs equal) before upload
+//      --shading-lod-pixels <px>     : projected radius below which objects use the diffuse-only shader (32 by default),
+//                                      and a quarter of which they switch to per-vertex lighting
+//      --reprojection-cache          : start with the reprojection cache on ('C' key)
+//      --reprojection-refresh <n>    : relight every cached pixel at least every n frames (8 by default)
+//      --overdraw-report <file>      : draw one frame (in a hidden window) with the overdraw counters, print them,
+//                                      write them to <file> as JSON and exit
+//      --quality <profile>           : low, medium, high or ultra tessellation/LOD/resolution instead of the probed one
+//      --target-frame-ms <ms>        : frame time the hardware probe picks the profile for (16.7 by default)
+//      --reprobe                     : run the hardware probe again instead of using its cached results
+//      --shader-lab                  : time the scene shader variants on synthetic workloads (in a hidden window),
+//                                      print the A/B report and exit
+//      --shader-lab-iterations <n>   : timed iterations per variant and workload (50 by default)
+//      --shader-lab-fs <file>        : add a variant: this fragment shader (with its #version line) after
+//                                      vertexShaderSource, e.g. an edited copy of fragmentShaderSource; repeatable
+//      --shader-lab-wall-clock       : time with glFinish() and the CPU clock even where timer queries work
+//      --stress <count>              : add a procedural stress scene of 1 to 1048576 random primitives
+//      --stress-seed <n>             : seed of the stress scene (1 by default); the same seed gives the same scene
+//      --stress-distribution <name>  : uniform (default), clustered or occluders (walls around city blocks)
+//      --stress-lights <n>           : lights of the stress scene, each object is lit by the nearest (1 by default)
+//      --stress-extent <units>       : side of the stress scene's ground square (about 1.5 units per object by default)
+//      --frame-arena-kb <KB>         : per-frame transient memory of each thread (4096 by default); more is taken from
+//                                      the heap with a warning
+//      --flight-recorder-spike-ms <ms>: write the flight record when a frame takes longer than this (50 by default);
+//                                      on POSIX systems, kill -USR1 <pid> writes one at any time
+//      --flight-recorder-seconds <s> : seconds of recent events in each flight record (5 by default)
+//      --flight-recorder-dir <dir>   : directory of the flight_record_<frame>.json files (the current one by default)
+//      --no-flight-recorder          : record nothing
+//      --accumulation-aa             : start with accumulation anti-aliasing on (toggled by 'J'); while nothing moves
+//                                      ('K' stops the lamp), jittered frames are averaged
+//      --accumulation-samples <n>    : jittered frames averaged before the image counts as converged (32 by default)
+//      --accumulation-idle-fps <fps> : frame rate once it has converged, until something moves (10 by default)
+//      --checkerboard                : start with checkerboard rendering on (toggled by 'N'): half the pixels shaded
+//                                      each frame, the other half reconstructed
+//      --checkerboard-report <file>  : turn the camera for a second of frames, compare the checkerboard image against
+//                                      native rendering (PSNR, SSIM), time both, write them as JSON and exit
+//      --no-impostors                : draw every stress object as its mesh (toggled by 'I')
+//      --impostor-pixels <px>        : stress objects whose bounding sphere is smaller than this on screen are drawn as
+//                                      octahedral impostors (24 by default)
+//      --impostor-grid <n>           : baked views per side of the hemi-octahedral grid (8 by default)
+//      --impostor-frame-size <px>    : texels per side of each baked view (32 by default); the atlases are cached in
+//                                      the geometry cache directory
+//      --hlod                        : build a hierarchical LOD tree over the stress scene and draw distant clusters as
+//                                      single merged proxies (toggled by 'H')
+//      --hlod-pixel-error <px>       : largest projected error of a drawn HLOD proxy (1 pixel by default)
+//      --hlod-leaf <n>               : objects per HLOD leaf at most (32 by default)
+//      --hlod-triangles <n>          : triangle budget of each HLOD proxy (1024 by default)
+//      --no-thread-pinning           : don't pin the worker and GL threads to the CPUs of their NUMA nodes, and use one
+//                                      job queue for all the workers
+//      --no-reflection-probes        : no reflections on the marble plane and the can (toggled by 'M')
+//      --reflection-probe-size <px>  : texels per side of a reflection probe's cube faces (128 by default)
+//      --reflection-probe-faces <n>  : cube faces re-rendered per frame at most (1 by default, 6 for a whole probe); the
+//                                      frame scheduler's budget (--frame-budget-ms) may stop them sooner
+void UParseCommandLine(int argc, char* argv[])
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--frame-budget-ms") == 0 && i + 1 < argc)
+        {
+            gFrameScheduler.SetBudgetMs(atof(argv[++i]));
+            cout << "INFO: Frame scheduler budget: " << gFrameScheduler.GetBudgetMs() << " ms" << endl;
+        }
+        else if (strcmp(argv[i], "--stream") == 0 && i + 1 < argc)
+            gOptions.streamDirectory = argv[++i];
+        else if (strcmp(argv[i], "--build-stream-world") == 0 && i + 1 < argc)
+            gOptions.buildStreamCells = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--stream-radius") == 0 && i + 1 < argc)
+            gOptions.streamDrawRadius = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--stream-budget-mb") == 0 && i + 1 < argc)
+            gOptions.streamBudgetMB = (size_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--mesh-codec-bench") == 0)
+            gOptions.meshCodecBenchmark = true;
+        else if (strcmp(argv[i], "--self-test") == 0)
+            gOptions.selfTest = true;
+        else if (strcmp(argv[i], "--import") == 0 && i + 1 < argc)
+            gOptions.importFilename = argv[++i];
+        else if (strcmp(argv[i], "--lod-pixel-error") == 0 && i + 1 < argc)
+            gOptions.lodPixelError = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--geometry-cache") == 0 && i + 1 < argc)
+            gOptions.geometryCacheDirectory = argv[++i];
+        else if (strcmp(argv[i], "--no-geometry-cache") == 0)
+            gOptions.geometryCacheDirectory.clear();
+        else if (strcmp(argv[i], "--weld-epsilon") == 0 && i + 1 < argc)
+            gOptions.weldEpsilon = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--shading-lod-pixels") == 0 && i + 1 < argc)
+            gOptions.shadingLodPixels = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--reprojection-cache") == 0)
+            gReprojectionEnabled = true;
+        else if (strcmp(argv[i], "--reprojection-refresh") == 0 && i + 1 < argc)
+            gOptions.reprojectionRefresh = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--overdraw-report") == 0 && i + 1 < argc)
+            gOptions.overdrawReportFile = argv[++i];
+        else if (strcmp(argv[i], "--quality") == 0 && i + 1 < argc)
+            gOptions.quality = argv[++i];
+        else if (strcmp(argv[i], "--target-frame-ms") == 0 && i + 1 < argc)
+            gOptions.targetFrameMs = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--reprobe") == 0)
+            gOptions.reprobe = true;
+        else if (strcmp(argv[i], "--shader-lab") == 0)
+            gOptions.shaderLab = true;
+        else if (strcmp(argv[i], "--shader-lab-iterations") == 0 && i + 1 < argc)
+            gOptions.shaderLabIterations = std::max(2, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--shader-lab-fs") == 0 && i + 1 < argc)
+            gOptions.shaderLabFragmentFiles.push_back(argv[++i]);
+        else if (strcmp(argv[i], "--shader-lab-wall-clock") == 0)
+            gOptions.shaderLabWallClock = true;
+        else if (strcmp(argv[i], "--stress") == 0 && i + 1 < argc)
+            gOptions.stressObjects = (size_t)std::max(0, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--stress-seed") == 0 && i + 1 < argc)
+            gOptions.stressSeed = (unsigned int)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--stress-distribution") == 0 && i + 1 < argc)
+        {
+            if (!StressScene::ParseDistribution(argv[++i], gOptions.stressDistribution))
+                cout << "Unknown stress distribution " << argv[i] << ", using " << StressScene::GetDistributionName(gOptions.stressDistribution) << endl;
+        }
+        else if (strcmp(argv[i], "--stress-lights") == 0 && i + 1 < argc)
+            gOptions.stressLights = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--stress-extent") == 0 && i + 1 < argc)
+            gOptions.stressExtent = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--frame-arena-kb") == 0 && i + 1 < argc)
+            gOptions.frameArenaKB = (size_t)std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--flight-recorder-spike-ms") == 0 && i + 1 < argc)
+            gOptions.flightRecorderSpikeMs = atof(argv[++i]);
+        else if (strcmp(argv[i], "--flight-recorder-seconds") == 0 && i + 1 < argc)
+            gOptions.flightRecorderSeconds = std::max(0.1, atof(argv[++i]));
+        else if (strcmp(argv[i], "--flight-recorder-dir") == 0 && i + 1 < argc)
+            gOptions.flightRecorderDirectory = argv[++i];
+        else if (strcmp(argv[i], "--no-flight-recorder") == 0)
+            gOptions.flightRecorder = false;
+        else if (strcmp(argv[i], "--accumulation-aa") == 0)
+            gOptions.accumulationAA = true;
+        else if (strcmp(argv[i], "--accumulation-samples") == 0 && i + 1 < argc)
+            gOptions.accumulationSamples = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--accumulation-idle-fps") == 0 && i + 1 < argc)
+            gOptions.accumulationIdleFps = std::max(1.0, atof(argv[++i]));
+        else if (strcmp(argv[i], "--checkerboard") == 0)
+            gOptions.checkerboard = true;
+        else if (strcmp(argv[i], "--checkerboard-report") == 0 && i + 1 < argc)
+            gOptions.checkerboardReportFile = argv[++i];
+        else if (strcmp(argv[i], "--no-impostors") == 0)
+            gOptions.impostors = false;
+        else if (strcmp(argv[i], "--impostor-pixels") == 0 && i + 1 < argc)
+            gOptions.impostorPixels = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--impostor-grid") == 0 && i + 1 < argc)
+            gOptions.impostorGridSize = std::max(2, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--impostor-frame-size") == 0 && i + 1 < argc)
+            gOptions.impostorFrameSize = std::max(4, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--hlod") == 0)
+            gOptions.hlod = true;
+        else if (strcmp(argv[i], "--hlod-pixel-error") == 0 && i + 1 < argc)
+            gOptions.hlodPixelError = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--hlod-leaf") == 0 && i + 1 < argc)
+            gOptions.hlodSettings.leafObjects = (unsigned int)std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--hlod-triangles") == 0 && i + 1 < argc)
+            gOptions.hlodSettings.proxyTriangles = (unsigned int)std::max(16, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--no-thread-pinning") == 0)
+            gOptions.threadPinning = false;
+        else if (strcmp(argv[i], "--no-reflection-probes") == 0)
+            gOptions.reflectionProbes = false;
+        else if (strcmp(argv[i], "--reflection-probe-size") == 0 && i + 1 < argc)
+            gOptions.reflectionProbeSize = std::max(8, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--reflection-probe-faces") == 0 && i + 1 < argc)
+            gOptions.reflectionProbeFaces = std::max(1, atoi(argv[++i]));
+        else
+        {
+            cout << "Unknown command line option " << argv[i] << endl;
+        }
+    }
+}
+
+
+// CLN: Returns true only on the frame a key goes down, so toggles don't repeat while the key is held
+bool UKeyPressedOnce(GLFWwindow* window, int key)
+{
+    static bool wasDown[GLFW_KEY_LAST + 1] = { false };
+
+    bool isDown = glfwGetKey(window, key) == GLFW_PRESS;
+    bool pressed = isDown && !wasDown[key];
+    wasDown[key] = isDown;
+    return pressed;
+}
+
+
+// CLN: Prints the performance stats of the running subsystems ('T' key)
+void UPrintStats()
+{
+    gFrameScheduler.PrintStats(cout);
+    // CLN: [Reflection] The probe updates' share of the scheduler's budget, and their GPU time
+    gReflectionProbes.PrintStats(cout, gFrameScheduler.GetBudgetMs());
+    if (gStreamer)
+        gStreamer->PrintStats(cout);
+
+    // CLN: [Arena] Use and high-water mark of the per-frame allocator (warnings are printed when it overflows)
+    if (gFrameArena)
+        gFrameArena->PrintStats(cout);
+
+    // CLN: [NUMA] Jobs taken across nodes, and the workers' and GL thread's remote memory loads so far
+    if (gWorkerPool)
+        gWorkerPool->PrintStats(cout);
+
+    // CLN: [Flight] What the recorder keeps and its measured share of the frame time
+    gFlightRecorder.PrintStats(cout);
+
+    // CLN: [AccumAA] How far the image has converged
+    gProgressiveAA.PrintStats(cout);
+
+    // CLN: [Checkerboard] Compare the opaque and transparent pass times with 'N' toggled to see what it saves
+    gCheckerboard.PrintStats(cout);
+
+    // CLN: [Impostor] Compare the stress scene's draw time and the opaque pass with 'I' toggled
+    if (!gStressScene.GetObjects().empty())
+        gImpostors.PrintStats(cout);
+
+    // CLN: [HLOD] The draws the proxies stood in for last frame ('H' toggles them)
+    gHlod.PrintStats(cout);
+
+    // CLN: [Material] How many distinct materials the objects came down to
+    gMaterials.PrintStats(cout);
+
+    // CLN: [Stress] The scene that was drawn (the checksum identifies it between runs) and the CPU cost of drawing it
+    if (!gStressScene.GetObjects().empty())
+    {
+        gStressScene.PrintStats(cout);
+        cout << "INFO: Stress scene draw calls took " << gStressSubmitMs << " ms of CPU time in the last frame" << endl;
+    }
+
+    // CLN: [ShadingLOD] Compare these with the 'V' key toggled to see the fragment cost the cheaper shaders save
+    cout << "INFO: Shading LOD " << (gShadingLodEnabled ? "on" : "off") << ": "
+         << gShadingLevelCounts[SHADING_FULL] << " full, " << gShadingLevelCounts[SHADING_DIFFUSE] << " diffuse-only, "
+         << gShadingLevelCounts[SHADING_VERTEX] << " per-vertex objects in the last frame" << endl;
+    gOpaquePassTimer.PrintStats(cout);
+    gTransparentPassTimer.PrintStats(cout);
+
+    // CLN: [Overdraw] Fragment counts of the last frame, while a debug view is on
+    if (gOverdrawView.IsActive())
+        OverdrawView::PrintStats(gOverdrawView.ReadStats(), cout);
+
+    // CLN: [DebugDraw] Lines of the last frame and what they cost
+    if (gDebugDrawEnabled)
+    {
+        gDebugDraw.PrintStats(cout);
+        gDebugDrawTimer.PrintStats(cout);
+    }
+
+    // CLN: [Reprojection] Reuse ratio, and the opaque pass time saved against the average before 'C' turned it on
+    if (gReprojectionEnabled)
+    {
+        gReprojectionCache.PrintStats(cout);
+        if (gOpaquePassMsWithoutCache > 0.0 && gOpaquePassTimer.GetSampleCount() > 0)
+        {
+            cout << "INFO: Reprojection cache saves " << gOpaquePassMsWithoutCache - gOpaquePassTimer.GetAverageMs()
+                 << " ms of the opaque pass (" << gOpaquePassMsWithoutCache << " ms without it)" << endl;
+        }
+    }
+}
+
+
+// CLN: [Weld] Copies a hand-authored vertex/index array pair into a MeshData and welds its duplicate vertices
+MeshData UWeldArrays(const char* name, const GLfloat* vertices, size_t vertexBytes, const GLushort* indices, size_t indexBytes)
+{
+    MeshData mesh;
+    mesh.Assign(vertices, vertexBytes / sizeof(GLfloat), indices, indexBytes / sizeof(GLushort));
+    MeshWelder::PrintStats(name, MeshWelder::Weld(mesh, gOptions.weldEpsilon), cout);
+    return mesh;
+}
+
+
+// CLN: [MeshCodec] Round-trips the scene's generators at high tessellation (up to the 64K vertex limit of
+//      the unsigned short indices) through the .cmesh codec and reports compression ratio and decode speed
+bool URunMeshCodecBenchmark()
+{
+    std::vector<MeshData> meshes(5);
+    Sphere sphere(0.4f, 36, 18);
+    Sphere largeSphere(0.4f, 255, 127);
+    Sphere flatSphere(0.4f, 128, 64, false);
+    Cylinder cylinder(0.27f, 0.27f, 0.9f, 1024, 16, true);
+    Cylinder flatCylinder(0.27f, 0.27f, 0.9f, 256, 32, false);
+
+    meshes[0].Assign(sphere.getVertices(), sphere.getVertexSize() / sizeof(float), sphere.getIndices(), sphere.getIndexCount());
+    meshes[1].Assign(largeSphere.getVertices(), largeSphere.getVertexSize() / sizeof(float), largeSphere.getIndices(), largeSphere.getIndexCount());
+    meshes[2].Assign(flatSphere.getVertices(), flatSphere.getVertexSize() / sizeof(float), flatSphere.getIndices(), flatSphere.getIndexCount());
+    meshes[3].Assign(cylinder.getVertices(), cylinder.getVertexSize() / sizeof(float), cylinder.getIndices(), cylinder.getIndexCount());
+    meshes[4].Assign(flatCylinder.getVertices(), flatCylinder.getVertexSize() / sizeof(float), flatCylinder.getIndices(), flatCylinder.getIndexCount());
+
+    for (const MeshData& mesh : meshes)
+    {
+        if (mesh.GetVertexCount() > MeshData::MAX_VERTICES)
+        {
+            cout << "Failed to build benchmark mesh: " << mesh.GetVertexCount() << " vertices exceed the index range" << endl;
+            return false;
+        }
+    }
+
+    if (!MeshCodec::Benchmark(meshes, cout))
+    {
+        cout << "Failed mesh codec round trip" << endl;
+        return false;
+    }
+    return true;
+}
+
+
+// CLN: [SelfTest] Runs the modules' self-tests (each prints what failed) and reports how many passed
+bool URunSelfTests()
+{
+    struct SelfTest
+    {
+        const char* name;
+        bool (*run)(std::ostream& out);
+    };
+    const SelfTest tests[] = {
+        { "task graph", TaskGraph::SelfTest },
+        { "frame scheduler", FrameScheduler::SelfTest },
+        { "hardware probe", HardwareProbe::SelfTest },
+        { "scene streamer", SceneStreamer::SelfTest },
+        { "mesh codec", MeshCodec::SelfTest },
+        { "mesh importer", MeshImporter::SelfTest },
+        { "mesh simplifier", MeshSimplifier::SelfTest },
+        { "geometry cache", GeometryCache::SelfTest },
+        { "mesh welder", MeshWelder::SelfTest },
+        { "material library", MaterialLibrary::SelfTest },
+        { "stress scene", StressScene::SelfTest },
+        { "hlod tree", HlodTree::SelfTest },
+        { "worker pool", WorkerPool::SelfTest },
+        { "frame arena", FrameArena::SelfTest },
+        { "flight recorder", FlightRecorder::SelfTest },
+    };
+
+    int passed = 0;
+    const int count = (int)(sizeof(tests) / sizeof(tests[0]));
+    for (const SelfTest& test : tests)
+    {
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        const bool ok = test.run(cout);
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        cout << "INFO: Self-test " << test.name << ": " << (ok ? "passed" : "FAILED") << " (" << ms << " ms)" << endl;
+        if (ok)
+            ++passed;
+    }
+
+    cout << "INFO: Self-tests: " << passed << " of " << count << " passed" << endl;
+    return passed == count;
+}
+
+
+// CLN: [Streaming] Writes a test world of cellsPerSide x cellsPerSide cells around the origin. Every cell gets a
+//      marble floor and a few of the scene's props at positions derived from the cell coordinates, and carries
+//      its own copy of the meshes and the encoded texture files, so each cell file can be streamed on its own
+bool UBuildStreamingWorld(const std::string& directory, int cellsPerSide)
+{
+    const float cellSize = 10.0f;
+#ifdef _WIN32
+    _mkdir(directory.c_str());
+#else
+    mkdir(directory.c_str(), 0755);
+#endif
+
+    Cylinder cylinder(0.27f, 0.27f, 0.9f, 36, 1, true);
+    Sphere sphere(0.4f, 36, 18);
+
+    // CLN: mesh and texture slots shared by every cell
+    enum { MESH_PLANE, MESH_TRICASE, MESH_CAN, MESH_BALL, MESH_CUBE, MESH_COUNT };
+    StreamCellContents shared;
+    shared.meshes.resize(MESH_COUNT);
+    shared.meshes[MESH_PLANE].Assign(PlaneVertices, sizeof(PlaneVertices) / sizeof(GLfloat), PlaneIndices, sizeof(PlaneIndices) / sizeof(GLushort));
+    shared.meshes[MESH_TRICASE].Assign(TriCaseVertices, sizeof(TriCaseVertices) / sizeof(GLfloat), TriCaseIndices, sizeof(TriCaseIndices) / sizeof(GLushort));
+    shared.meshes[MESH_CAN].Assign(cylinder.getVertices(), cylinder.getVertexSize() / sizeof(float), cylinder.getIndices(), cylinder.getIndexCount());
+    shared.meshes[MESH_BALL].Assign(sphere.getVertices(), sphere.getVertexSize() / sizeof(float), sphere.getIndices(), sphere.getIndexCount());
+    shared.meshes[MESH_CUBE].Assign(CubeVertices, sizeof(CubeVertices) / sizeof(GLfloat), CubeIndices, sizeof(CubeIndices) / sizeof(GLushort));
+
+    // CLN: the smaller La Croix label keeps the per-cell texture memory reasonable
+    const char* textureFiles[MESH_COUNT] = { texFilename1, texFilename2, "images/LaCroix-texture-cropped-mirrored.jpg", texFilename5, texFilename6 };
+    shared.textures.resize(MESH_COUNT);
+    for (int i = 0; i < MESH_COUNT; ++i)
+    {
+        if (!StreamWorldWriter::ReadFileBytes(textureFiles[i], shared.textures[i]))
+        {
+            cout << "Failed to load texture " << textureFiles[i] << endl;
+            return false;
+        }
+    }
+
+    StreamWorldWriter writer(directory, cellSize);
+    for (int cellZ = -cellsPerSide / 2; cellZ < cellsPerSide - cellsPerSide / 2; ++cellZ)
+    {
+        for (int cellX = -cellsPerSide / 2; cellX < cellsPerSide - cellsPerSide / 2; ++cellX)
+        {
+            StreamCellContents contents;
+            contents.meshes = shared.meshes;
+            contents.textures = shared.textures;
+
+            const glm::vec3 cellOrigin(cellX * cellSize, -1.0f, cellZ * cellSize);
+            StreamObject object;
+
+            // CLN: the plane is 4x4 units, scale it to cover the cell
+            glm::mat4 model = glm::translate(cellOrigin + glm::vec3(cellSize * 0.5f, 0.0f, cellSize * 0.5f)) * glm::scale(glm::vec3(cellSize / 4.0f));
+            object.mesh = object.texture = MESH_PLANE;
+            memcpy(object.model, glm::value_ptr(model), sizeof(object.model));
+            contents.objects.push_back(object);
+
+            // CLN: simple integer hash of the cell coordinates, so a rebuilt world is identical
+            unsigned int seed = (unsigned int)(cellX * 73856093) ^ (unsigned int)(cellZ * 19349663);
+            for (int prop = 0; prop < 6; ++prop)
+            {
+                seed = seed * 1664525u + 1013904223u;
+                float u = (seed >> 8 & 0xffff) / 65535.0f;
+                seed = seed * 1664525u + 1013904223u;
+                float v = (seed >> 8 & 0xffff) / 65535.0f;
+                seed = seed * 1664525u + 1013904223u;
+
+                const unsigned int kind = MESH_TRICASE + seed % (MESH_COUNT - MESH_TRICASE);
+                const glm::vec3 position = cellOrigin + glm::vec3(1.0f + u * (cellSize - 2.0f), 0.0f, 1.0f + v * (cellSize - 2.0f));
+                const glm::mat4 spin = glm::rotate(glm::radians(u * 360.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+                if (kind == MESH_CAN)       // CLN: cylinder axis is z, stand it up
+                    model = glm::translate(position + glm::vec3(0.0f, 0.9f, 0.0f)) * spin * glm::rotate(glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f)) * glm::scale(glm::vec3(2.0f));
+                else if (kind == MESH_BALL)
+                    model = glm::translate(position + glm::vec3(0.0f, 0.4f, 0.0f)) * spin;
+                else if (kind == MESH_CUBE) // CLN: sticky note pad
+                    model = glm::translate(position + glm::vec3(0.0f, 0.05f, 0.0f)) * spin * glm::scale(glm::vec3(1.0f, 0.1f, 1.0f));
+                else
+                    model = glm::translate(position) * spin * glm::scale(glm::vec3(2.0f));
+
+                object.mesh = object.texture = kind;
+                memcpy(object.model, glm::value_ptr(model), sizeof(object.model));
+                contents.objects.push_back(object);
+            }
+
+            if (!writer.AddCell(cellX, cellZ, contents))
+                return false;
+        }
+    }
+
+    cout << "INFO: Wrote streaming world " << directory << " (" << cellsPerSide * cellsPerSide << " cells)" << endl;
+    return writer.Finish();
+}
+
+
 // process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
 void UProcessInput(GLFWwindow* window)
 {
@@ -1007,6 +3688,109 @@ void UProcessInput(GLFWwindow* window)
         ++PCount; // CLN: Increment 'P' counter
         //cout << "'P' key pressed!" << endl;
     }
+
+    // CLN: [Scheduler] when 'R' key pressed, rebuild the foam ball at the next tessellation level
+    if (UKeyPressedOnce(window, GLFW_KEY_R)) {
+        gRebuildFoamBall = true;
+        cout << "'R' key pressed!" << endl;
+    }
+
+    // CLN: when 'T' key pressed, print the frame stats
+    if (UKeyPressedOnce(window, GLFW_KEY_T)) {
+        gPrintStats = true;
+    }
+
+    // CLN: [OIT] when 'O' key pressed, toggle order-independent transparency
+    if (UKeyPressedOnce(window, GLFW_KEY_O)) {
+        gOitEnabled = !gOitEnabled;
+        cout << "Order-independent transparency " << (gOitEnabled ? "on" : "off") << endl;
+    }
+
+    // CLN: [LOD] when 'L' key pressed, toggle the simplified LOD meshes
+    if (UKeyPressedOnce(window, GLFW_KEY_L)) {
+        gLodEnabled = !gLodEnabled;
+        cout << "LOD meshes " << (gLodEnabled ? "on" : "off") << endl;
+    }
+
+    // CLN: [ShadingLOD] when 'V' key pressed, toggle the cheaper shading variants. The GPU pass averages restart,
+    //      so the next 'T' stats show the cost of the new setting only
+    if (UKeyPressedOnce(window, GLFW_KEY_V)) {
+        gShadingLodEnabled = !gShadingLodEnabled;
+        gOpaquePassTimer.ResetAverage();
+        gTransparentPassTimer.ResetAverage();
+        cout << "Shading LOD " << (gShadingLodEnabled ? "on" : "off") << endl;
+    }
+
+    // CLN: [Reprojection] when 'C' key pressed, toggle the reprojection cache. Its old contents are stale by now,
+    //      so it starts empty, and the opaque pass average so far becomes the baseline of the saved time
+    if (UKeyPressedOnce(window, GLFW_KEY_C)) {
+        gReprojectionEnabled = !gReprojectionEnabled;
+        gOpaquePassMsWithoutCache = gReprojectionEnabled ? gOpaquePassTimer.GetAverageMs() : 0.0;
+        gReprojectionCache.Invalidate();
+        gOpaquePassTimer.ResetAverage();
+        gTransparentPassTimer.ResetAverage();
+        cout << "Reprojection cache " << (gReprojectionEnabled ? "on" : "off") << endl;
+    }
+
+    // CLN: [Overdraw] when 'F' key pressed, cycle the fragment debug views. The reprojection cache is paused
+    //      while they draw, so it starts over afterwards
+    if (UKeyPressedOnce(window, GLFW_KEY_F)) {
+        gOverdrawView.SetMode((OverdrawViewMode)((gOverdrawView.GetMode() + 1) % OVERDRAW_VIEW_MODE_COUNT));
+        gReprojectionCache.Invalidate();
+        cout << "Fragment debug view: " << OverdrawView::GetModeName(gOverdrawView.GetMode()) << endl;
+    }
+
+    // CLN: [DebugDraw] when 'B' key pressed, toggle the debug drawing. The camera path starts over and the
+    //      frustum of the camera is frozen where it is now
+    if (UKeyPressedOnce(window, GLFW_KEY_B) && gDebugDraw.IsCreated()) {
+        gDebugDrawEnabled = !gDebugDrawEnabled;
+        gDebugCameraPath.clear();
+        gDebugFrozenViewProjection = projection * gCamera.GetViewMatrix();
+        gDebugDraw.Clear();
+        gDebugDrawTimer.ResetAverage();
+        cout << "Debug drawing " << (gDebugDrawEnabled ? "on" : "off") << endl;
+    }
+
+    // CLN: [AccumAA] when 'J' key pressed, toggle the accumulation anti-aliasing
+    if (UKeyPressedOnce(window, GLFW_KEY_J) && gProgressiveAA.IsCreated()) {
+        gProgressiveAA.SetEnabled(!gProgressiveAA.IsEnabled());
+        cout << "Accumulation anti-aliasing " << (gProgressiveAA.IsEnabled() ? "on" : "off") << endl;
+    }
+
+    // CLN: [AccumAA] when 'K' key pressed, stop or restart the lamp's orbit
+    if (UKeyPressedOnce(window, GLFW_KEY_K)) {
+        gLightOrbitPaused = !gLightOrbitPaused;
+        cout << "Lamp orbit " << (gLightOrbitPaused ? "paused" : "running") << endl;
+    }
+
+    // CLN: [Checkerboard] when 'N' key pressed, toggle checkerboard rendering
+    if (UKeyPressedOnce(window, GLFW_KEY_N) && gCheckerboard.IsCreated()) {
+        gCheckerboard.SetEnabled(!gCheckerboard.IsEnabled());
+        gOpaquePassTimer.ResetAverage();
+        gTransparentPassTimer.ResetAverage();
+        cout << "Checkerboard rendering " << (gCheckerboard.IsEnabled() ? "on" : "off") << endl;
+    }
+
+    // CLN: [Impostor] when 'I' key pressed, toggle the impostors of distant stress objects
+    if (UKeyPressedOnce(window, GLFW_KEY_I) && gImpostors.IsCreated()) {
+        gImpostors.SetEnabled(!gImpostors.IsEnabled());
+        gOpaquePassTimer.ResetAverage();
+        cout << "Impostors " << (gImpostors.IsEnabled() ? "on" : "off") << endl;
+    }
+
+    // CLN: [HLOD] when 'H' key pressed, toggle the HLOD proxies of distant stress object clusters
+    if (UKeyPressedOnce(window, GLFW_KEY_H) && gHlod.IsCreated()) {
+        gHlod.SetEnabled(!gHlod.IsEnabled());
+        gOpaquePassTimer.ResetAverage();
+        cout << "HLOD proxies " << (gHlod.IsEnabled() ? "on" : "off") << endl;
+    }
+
+    // CLN: [Reflection] when 'M' key pressed, toggle the reflection probes of the marble plane and the can
+    if (UKeyPressedOnce(window, GLFW_KEY_M) && gReflectionProbes.IsCreated()) {
+        gReflectionProbes.SetEnabled(!gReflectionProbes.IsEnabled());
+        gOpaquePassTimer.ResetAverage();
+        cout << "Reflection probes " << (gReflectionProbes.IsEnabled() ? "on" : "off") << endl;
+    }
 }
 
 
@@ -1014,6 +3798,42 @@ void UProcessInput(GLFWwindow* window)
 void UResizeWindow(GLFWwindow* window, int width, int height)
 {
     glViewport(0, 0, width, height);
+
+    // CLN: [Probe] the scene renders at the window size times the resolution scale of the quality profile
+    int sceneWidth, sceneHeight;
+    UGetSceneSize(width, height, sceneWidth, sceneHeight);
+    gTransparencyPass.Resize(sceneWidth, sceneHeight);   // CLN: [OIT] the scene framebuffer follows the window size
+    gReprojectionCache.Resize(sceneWidth, sceneHeight);   // CLN: [Reprojection] and so do the cached shading targets
+    gOverdrawView.Resize(sceneWidth, sceneHeight);        // CLN: [Overdraw] and the fragment count images
+    gProgressiveAA.Resize(sceneWidth, sceneHeight);       // CLN: [AccumAA] and the accumulation history
+    gCheckerboard.Resize(sceneWidth, sceneHeight);        // CLN: [Checkerboard] and the reconstruction history
+}
+
+
+// CLN: [AccumAA] Hash of everything that changes the image: camera, projection, light, the toggles and the scene
+//      version (meshes swapped in, streamed cells loaded or evicted, new reflections). The accumulation restarts
+//      when it differs from the last frame's
+unsigned long long UHashViewState()
+{
+    const glm::mat4 view = gCamera.GetViewMatrix();
+    const int settings[] = { gOitEnabled, gLodEnabled, gShadingLodEnabled, gReprojectionEnabled, gOverdrawView.GetMode(), gDebugDrawEnabled,
+                             gCheckerboard.IsEnabled(), gImpostors.IsEnabled(), gHlod.IsEnabled(), gReflectionProbes.IsEnabled() };
+    const unsigned long long versions[] = { gSceneVersion, gStreamer ? gStreamer->GetResidencyVersion() : 0,
+                                            gReflectionProbes.GetUpdateCount() };
+    unsigned long long hash = ProgressiveAA::Hash(glm::value_ptr(view), sizeof(view));
+    hash = ProgressiveAA::Hash(glm::value_ptr(projection), sizeof(projection), hash);
+    hash = ProgressiveAA::Hash(glm::value_ptr(gLightPosition), sizeof(gLightPosition), hash);
+    hash = ProgressiveAA::Hash(glm::value_ptr(gLightColor), sizeof(gLightColor), hash);
+    hash = ProgressiveAA::Hash(versions, sizeof(versions), hash);
+    return ProgressiveAA::Hash(settings, sizeof(settings), hash);
+}
+
+
+// CLN: [Probe] Size of the scene framebuffer for a window size (0 x 0 stays 0 x 0, see TransparencyPass::Resize())
+void UGetSceneSize(int windowWidth, int windowHeight, int& width, int& height)
+{
+    width = windowWidth > 0 ? std::max(1, (int)(windowWidth * gQuality.resolutionScale + 0.5f)) : 0;
+    height = windowHeight > 0 ? std::max(1, (int)(windowHeight * gQuality.resolutionScale + 0.5f)) : 0;
 }
 
 //--------------------------------------------------------
@@ -1045,6 +3865,7 @@ void UMousePositionCallback(GLFWwindow* window, double xpos, double ypos)
 // ----------------------------------------------------------------------
 void UMouseScrollCallback(GLFWwindow* window, double xoffset, double yoffset)
 {
+    gFlightRecorder.Instant("mouse scroll", yoffset);   // CLN: [Flight]
     gCamera.ProcessMouseScroll(yoffset);
     cout << "Mouse scroll wheel moved!" << endl;
 }
@@ -1053,6 +3874,8 @@ void UMouseScrollCallback(GLFWwindow* window, double xoffset, double yoffset)
 // --------------------------------
 void UMouseButtonCallback(GLFWwindow* window, int button, int action, int mods)
 {
+    gFlightRecorder.Instant(action == GLFW_PRESS ? "mouse button press" : "mouse button release", button);    // CLN: [Flight]
+
     switch (button)
     {
     case GLFW_MOUSE_BUTTON_LEFT:
@@ -1088,6 +3911,121 @@ void UMouseButtonCallback(GLFWwindow* window, int button, int action, int mods)
     }
 }
 
+// CLN: [Flight] glfw: key presses and releases go to the flight recorder as input events (value: the GLFW key code)
+// ------------------------------------------------------------------------------------------------------------------
+void UKeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+    if (action == GLFW_PRESS)
+        gFlightRecorder.Instant("key press", key);
+    else if (action == GLFW_RELEASE)
+        gFlightRecorder.Instant("key release", key);
+}
+
+
+// CLN: [Probe] Picks the quality profile: the one --quality names, or else the best one whose estimated frame time
+//      at the window size fits --target-frame-ms, from this GPU's probe results (measured once per GL_RENDERER)
+QualityProfile USelectQualityProfile()
+{
+    if (!gOptions.quality.empty())
+    {
+        const int profile = HardwareProbe::FindProfile(gOptions.quality);
+        if (profile >= 0)
+        {
+            cout << "INFO: Quality profile: " << HardwareProbe::PROFILES[profile].name << " (--quality)" << endl;
+            return HardwareProbe::PROFILES[profile];
+        }
+        cout << "Unknown quality profile " << gOptions.quality << ", probing the hardware instead" << endl;
+    }
+
+    const GLubyte* rendererString = glGetString(GL_RENDERER);
+    const std::string renderer = rendererString ? (const char*)rendererString : "unknown renderer";
+    HardwareProbeResult result;
+    const bool cached = !gOptions.reprobe && HardwareProbe::LoadCached(HARDWARE_PROBE_CACHE, renderer, result);
+    if (!cached)
+    {
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        GLuint solidProgramId = 0, textureProgramId = 0;
+        const bool measured = UCreateShaderProgram(probeVertexShaderSource, probeSolidFragmentShaderSource, solidProgramId)
+                           && UCreateShaderProgram(oitCompositeVertexShaderSource, probeTextureFragmentShaderSource, textureProgramId)
+                           && HardwareProbe::Measure(solidProgramId, textureProgramId, result);
+        UDestroyShaderProgram(solidProgramId);
+        UDestroyShaderProgram(textureProgramId);
+        if (!measured)
+        {
+            const QualityProfile& fallback = HardwareProbe::PROFILES[HardwareProbe::DEFAULT_PROFILE];
+            cout << "INFO: Quality profile: " << fallback.name << " (the hardware probe failed)" << endl;
+            return fallback;
+        }
+        HardwareProbe::SaveCached(HARDWARE_PROBE_CACHE, renderer, result);
+        cout << "INFO: Hardware probe of " << renderer << " took "
+             << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() << " ms" << endl;
+    }
+    HardwareProbe::PrintResult(result, cout);
+
+    int windowWidth, windowHeight;
+    glfwGetFramebufferSize(gWindow, &windowWidth, &windowHeight);
+    double frameMs = 0.0;
+    const int profile = HardwareProbe::SelectProfile(result, windowWidth, windowHeight, gOptions.targetFrameMs, frameMs);
+    cout << "INFO: Quality profile: " << HardwareProbe::PROFILES[profile].name << " (estimated " << frameMs << " ms per frame, target "
+         << gOptions.targetFrameMs << " ms" << (cached ? ", cached probe of " : ", probe of ") << renderer << ")" << endl;
+    return HardwareProbe::PROFILES[profile];
+}
+
+
+// CLN: [ShaderLab] Times the built-in shading variants, and any --shader-lab-fs files, against fragmentShaderSource.
+//      Software rasterizers are timed by the wall clock, since their timer queries don't include the rendering
+bool URunShaderLab()
+{
+    struct LabVariant
+    {
+        std::string name;
+        const char* vertexSource;
+        std::string fragmentSource;
+        GLuint programId;
+    };
+    std::vector<LabVariant> variants = {
+        { "phong", vertexShaderSource, fragmentShaderSource, 0 },
+        { "diffuse", vertexShaderSource, diffuseFragmentShaderSource, 0 },
+        { "vertex-lit", vertexLitVertexShaderSource, vertexLitFragmentShaderSource, 0 },
+    };
+    for (const std::string& filename : gOptions.shaderLabFragmentFiles)
+    {
+        std::ifstream file(filename.c_str());
+        if (!file)
+        {
+            cout << "Failed to read the shader " << filename << endl;
+            return false;
+        }
+        std::ostringstream source;
+        source << file.rdbuf();
+        variants.push_back({ filename, vertexShaderSource, source.str(), 0 });
+    }
+
+    const GLubyte* rendererString = glGetString(GL_RENDERER);
+    const std::string renderer = rendererString ? (const char*)rendererString : "unknown renderer";
+    const bool wallClock = gOptions.shaderLabWallClock || ShaderLab::IsSoftwareRenderer(renderer);
+    cout << "INFO: Shader lab on " << renderer << endl;
+
+    // CLN: [Material] The Phong variants read the default material, slot 0 of the buffer
+    ShaderLab lab;
+    bool ran = gMaterials.Upload() && lab.Create();
+    for (LabVariant& variant : variants)
+    {
+        ran = ran && UCreateShaderProgram(variant.vertexSource, variant.fragmentSource.c_str(), variant.programId);
+        if (ran)
+            lab.AddVariant(variant.name, variant.programId);
+    }
+    ran = ran && lab.Run(gOptions.shaderLabIterations, wallClock);
+    if (ran)
+        lab.PrintReport(cout);
+
+    for (const LabVariant& variant : variants)
+        UDestroyShaderProgram(variant.programId);
+    lab.Destroy();
+    gMaterials.Destroy();
+    return ran;
+}
+
 
 // --------------------------------------
 // build and compile shader program
@@ -0,0 +1,282 @@
+//========================================================================================
+// Filename      : NumaTopology.cpp
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Implementation of the NumaTopology class (see NumaTopology.h)
+//========================================================================================
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#include "NumaTopology.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/mman.h>
+#endif
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    // CLN: node the calling thread was pinned to, -1 until it is
+    thread_local int tPinnedNode = -1;
+
+#ifdef __linux__
+    const char* const SYSFS_NODE_DIRECTORY = "/sys/devices/system/node";
+    const int MPOL_PREFERRED_MODE = 1;          // CLN: MPOL_PREFERRED of <linux/mempolicy.h>
+    const int NODE_MASK_WORDS = 16;             // CLN: 1024 nodes, the kernel's largest MAX_NUMNODES
+
+    // CLN: a sysfs CPU list such as "0-15,32-47"
+    std::vector<int> ParseCpuList(const std::string& text)
+    {
+        std::vector<int> cpus;
+        std::stringstream list(text);
+        std::string range;
+        while (std::getline(list, range, ','))
+        {
+            if (range.find_first_of("0123456789") == std::string::npos)
+                continue;
+            const size_t dash = range.find('-');
+            const int first = atoi(range.c_str());
+            const int last = dash == std::string::npos ? first : atoi(range.c_str() + dash + 1);
+            for (int cpu = first; cpu <= last; ++cpu)
+                cpus.push_back(cpu);
+        }
+        return cpus;
+    }
+#endif
+
+    // CLN: the reverse of ParseCpuList(), for the log
+    std::string FormatCpuList(const std::vector<int>& cpus)
+    {
+        std::ostringstream text;
+        for (size_t i = 0; i < cpus.size(); )
+        {
+            size_t last = i;
+            while (last + 1 < cpus.size() && cpus[last + 1] == cpus[last] + 1)
+                ++last;
+            text << (i > 0 ? "," : "") << cpus[i];
+            if (last > i)
+                text << '-' << cpus[last];
+            i = last + 1;
+        }
+        return text.str();
+    }
+}
+
+
+const NumaTopology& NumaTopology::Get()
+{
+    static const NumaTopology topology;
+    return topology;
+}
+
+
+NumaTopology::NumaTopology()
+{
+    if (!Discover())
+    {
+        nodeCpus.clear();
+        nodeIds.clear();
+        const int hardwareThreads = std::max(1, (int)std::thread::hardware_concurrency());
+        nodeCpus.resize(1);
+        for (int cpu = 0; cpu < hardwareThreads; ++cpu)
+            nodeCpus[0].push_back(cpu);
+        nodeIds.push_back(0);
+        source = "no NUMA information, one node";
+    }
+
+    for (int node = 0; node < GetNodeCount(); ++node)
+    {
+        for (int cpu : nodeCpus[node])
+        {
+            if ((int)cpuNodes.size() <= cpu)
+                cpuNodes.resize(cpu + 1, 0);
+            cpuNodes[cpu] = node;
+        }
+    }
+}
+
+
+bool NumaTopology::Discover()
+{
+#if defined(_WIN32)
+    ULONG highestNode = 0;
+    if (!GetNumaHighestNodeNumber(&highestNode))
+        return false;
+    for (ULONG node = 0; node <= highestNode; ++node)
+    {
+        GROUP_AFFINITY affinity = {};
+        if (!GetNumaNodeProcessorMaskEx((USHORT)node, &affinity) || affinity.Mask == 0)
+            continue;   // CLN: a node with memory and no CPUs
+        std::vector<int> cpus;
+        for (int bit = 0; bit < 64; ++bit)
+        {
+            if (affinity.Mask & ((KAFFINITY)1 << bit))
+                cpus.push_back(affinity.Group * 64 + bit);
+        }
+        nodeCpus.push_back(cpus);
+        nodeIds.push_back((int)node);
+    }
+    source = "Windows NUMA API";
+#elif defined(__linux__)
+    DIR* directory = opendir(SYSFS_NODE_DIRECTORY);
+    if (!directory)
+        return false;
+    std::vector<int> ids;
+    while (dirent* entry = readdir(directory))
+    {
+        int id = 0;
+        char rest = 0;
+        if (sscanf(entry->d_name, "node%d%c", &id, &rest) == 1)
+            ids.push_back(id);
+    }
+    closedir(directory);
+    std::sort(ids.begin(), ids.end());
+
+    for (int id : ids)
+    {
+        std::ifstream file(std::string(SYSFS_NODE_DIRECTORY) + "/node" + std::to_string(id) + "/cpulist");
+        std::string text;
+        if (!std::getline(file, text))
+            continue;
+        const std::vector<int> cpus = ParseCpuList(text);
+        if (cpus.empty())
+            continue;   // CLN: a node with memory and no CPUs
+        nodeCpus.push_back(cpus);
+        nodeIds.push_back(id);
+    }
+    source = "sysfs";
+#endif
+    return !nodeCpus.empty();
+}
+
+
+int NumaTopology::GetCpuCount() const
+{
+    int count = 0;
+    for (const std::vector<int>& cpus : nodeCpus)
+        count += (int)cpus.size();
+    return count;
+}
+
+
+int NumaTopology::GetNodeOfCpu(int cpu) const
+{
+    return cpu >= 0 && cpu < (int)cpuNodes.size() ? cpuNodes[cpu] : 0;
+}
+
+
+int NumaTopology::GetCurrentNode() const
+{
+    if (tPinnedNode >= 0 || GetNodeCount() == 1)
+        return std::max(tPinnedNode, 0);
+#if defined(_WIN32)
+    PROCESSOR_NUMBER processor;
+    GetCurrentProcessorNumberEx(&processor);
+    return GetNodeOfCpu(processor.Group * 64 + processor.Number);
+#elif defined(__linux__)
+    return GetNodeOfCpu(sched_getcpu());
+#else
+    return 0;
+#endif
+}
+
+
+bool NumaTopology::PinCurrentThread(const std::vector<int>& cpus, int node) const
+{
+    if (cpus.empty())
+        return false;
+#if defined(_WIN32)
+    // CLN: a thread runs in one processor group; the CPUs of a node never span two
+    GROUP_AFFINITY affinity = {};
+    affinity.Group = (WORD)(cpus[0] / 64);
+    for (int cpu : cpus)
+    {
+        if (cpu / 64 == affinity.Group)
+            affinity.Mask |= (KAFFINITY)1 << (cpu % 64);
+    }
+    if (!SetThreadGroupAffinity(GetCurrentThread(), &affinity, nullptr))
+        return false;
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus)
+    {
+        if (cpu >= 0 && cpu < CPU_SETSIZE)
+            CPU_SET(cpu, &set);
+    }
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+        return false;
+#else
+    return false;
+#endif
+    tPinnedNode = std::min(std::max(node, 0), GetNodeCount() - 1);
+    return true;
+}
+
+
+void* NumaTopology::AllocateOnNode(size_t bytes, int node)
+{
+    if (bytes == 0)
+        return nullptr;
+    const NumaTopology& topology = Get();
+    node = std::min(std::max(node, 0), topology.GetNodeCount() - 1);
+#if defined(_WIN32)
+    return VirtualAllocExNuma(GetCurrentProcess(), nullptr, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE, (DWORD)topology.nodeIds[node]);
+#else
+    void* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED)
+        return nullptr;
+#ifdef __linux__
+    // CLN: preferred, not bound: when the node is full the pages come from another one instead of failing. The
+    //      pages aren't touched yet, so the policy decides where every one of them goes (a failure leaves them to
+    //      first touch)
+    const int id = topology.nodeIds[node];
+    if (topology.GetNodeCount() > 1 && id < NODE_MASK_WORDS * 64)
+    {
+        unsigned long mask[NODE_MASK_WORDS] = {};
+        mask[id / 64] = 1ul << (id % 64);
+        syscall(SYS_mbind, memory, bytes, MPOL_PREFERRED_MODE, mask, (unsigned long)NODE_MASK_WORDS * 64, 0);
+    }
+#endif
+    return memory;
+#endif
+}
+
+
+void NumaTopology::Free(void* memory, size_t bytes)
+{
+    if (!memory)
+        return;
+#ifdef _WIN32
+    (void)bytes;
+    VirtualFree(memory, 0, MEM_RELEASE);
+#else
+    munmap(memory, bytes);
+#endif
+}
+
+
+void NumaTopology::PrintStats(std::ostream& out) const
+{
+    out << "INFO: NUMA topology (" << source << "): " << GetNodeCount() << " node(s), " << GetCpuCount() << " CPU(s)";
+    for (int node = 0; node < GetNodeCount(); ++node)
+        out << (node == 0 ? "; " : ", ") << "node " << nodeIds[node] << ": CPUs " << FormatCpuList(nodeCpus[node]);
+    out << std::endl;
+}
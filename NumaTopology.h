@@ -0,0 +1,63 @@
+//========================================================================================
+// Filename      : NumaTopology.h
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : NUMA topology of the machine: which logical CPUs belong to which
+//               : memory node, read once from /sys/devices/system/node on Linux and
+//               : from the NUMA API on Windows (no libnuma needed). A machine that
+//               : reports nothing is one node of every hardware thread, so callers
+//               : never need a special case.
+//               :
+//               : On a multi-socket machine a thread that wanders between sockets, or
+//               : that works on memory another socket allocated, pays for every cache
+//               : line twice. PinCurrentThread() keeps a thread on a set of CPUs, and
+//               : AllocateOnNode() places pages on a node (MPOL_PREFERRED through the
+//               : mbind system call, VirtualAllocExNuma() on Windows; where neither
+//               : works the pages land wherever the first thread to touch them runs).
+//               :
+//               : PerfCounters.h measures what the placement saves.
+//========================================================================================
+
+#ifndef NUMA_TOPOLOGY_H
+#define NUMA_TOPOLOGY_H
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+class NumaTopology
+{
+public:
+    // discovered on first use
+    static const NumaTopology& Get();
+
+    int GetNodeCount() const                            { return (int)nodeCpus.size(); }
+    const std::vector<int>& GetCpus(int node) const     { return nodeCpus[node]; }
+    int GetCpuCount() const;
+    int GetNodeOfCpu(int cpu) const;                    // 0 for CPUs it doesn't know
+
+    // node of the calling thread: the one it was pinned to, otherwise the one of the CPU it is running on now
+    int GetCurrentNode() const;
+
+    // restricts the calling thread to cpus (logical CPU numbers); node is what GetCurrentNode() reports from then on
+    bool PinCurrentThread(const std::vector<int>& cpus, int node) const;
+
+    // page-aligned memory whose pages are placed on node; Free() it with the same size
+    static void* AllocateOnNode(size_t bytes, int node);
+    static void Free(void* memory, size_t bytes);
+
+    void PrintStats(std::ostream& out) const;
+
+private:
+    NumaTopology();
+    bool Discover();
+
+    std::vector<std::vector<int>> nodeCpus;
+    std::vector<int> nodeIds;                           // the system's number of each node (they can have gaps)
+    std::vector<int> cpuNodes;                          // node of each CPU number
+    std::string source;                                 // where the topology came from
+};
+
+#endif
@@ -0,0 +1,468 @@
+//========================================================================================
+// Filename      : OctahedralImpostors.cpp
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Implementation of the OctahedralImpostors class (see OctahedralImpostors.h)
+//               :
+//               : Cache file layout (native byte order):
+//               :    header ("IMP1", format version, grid and frame size, index count,
+//               :           radius, checksum)
+//               :    albedo (RGBA8), normal (RGBA8) and depth (R16F) of the top mip
+//               :    level; the other levels are generated after loading
+//========================================================================================
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include "OctahedralImpostors.h"
+
+namespace
+{
+    const char CACHE_MAGIC[4] = { 'I', 'M', 'P', '1' };
+    const uint32_t CACHE_FORMAT_VERSION = 1;
+
+    const uint64_t FNV_OFFSET = 14695981039346656037ull;
+    const uint64_t FNV_PRIME = 1099511628211ull;
+
+    struct CacheFileHeader
+    {
+        char magic[4];
+        uint32_t formatVersion;
+        uint32_t gridSize;
+        uint32_t frameSize;
+        uint32_t indexCount;
+        float radius;
+        uint64_t checksum;      // of the three atlases
+    };
+
+    uint64_t Checksum(const std::vector<unsigned char>& data)
+    {
+        uint64_t hash = FNV_OFFSET;
+        for (unsigned char byte : data)
+            hash = (hash ^ byte) * FNV_PRIME;
+        return hash;
+    }
+
+    // CLN: hemi-octahedral mapping of the upper hemisphere (y >= 0) onto [-1, 1]^2; the same as HemiOctDecode() in
+    //      impostorVertexShaderSource
+    void HemiOctDecode(float u, float v, float* direction)
+    {
+        const float x = (u + v) * 0.5f;
+        const float z = (u - v) * 0.5f;
+        const float y = 1.0f - fabsf(x) - fabsf(z);
+        const float length = sqrtf(x * x + y * y + z * z);
+        direction[0] = x / length;
+        direction[1] = y / length;
+        direction[2] = z / length;
+    }
+
+    // CLN: right and up of a view looking back along direction, as FrameBasis() in the shaders
+    void FrameBasis(const float* direction, float* right, float* up)
+    {
+        const float reference[3] = { 0.0f, fabsf(direction[1]) > 0.999f ? 0.0f : 1.0f, fabsf(direction[1]) > 0.999f ? 1.0f : 0.0f };
+        right[0] = reference[1] * direction[2] - reference[2] * direction[1];
+        right[1] = reference[2] * direction[0] - reference[0] * direction[2];
+        right[2] = reference[0] * direction[1] - reference[1] * direction[0];
+        const float length = sqrtf(right[0] * right[0] + right[1] * right[1] + right[2] * right[2]);
+        for (int i = 0; i < 3; ++i)
+            right[i] /= length;
+        up[0] = direction[1] * right[2] - direction[2] * right[1];
+        up[1] = direction[2] * right[0] - direction[0] * right[2];
+        up[2] = direction[0] * right[1] - direction[1] * right[0];
+    }
+
+    int GetMipLevels(int frameSize)
+    {
+        // CLN: down to 4 x 4 texels per frame; below that the frames bleed into each other
+        int levels = 1;
+        while ((frameSize >> levels) >= 4)
+            ++levels;
+        return levels;
+    }
+}
+
+
+OctahedralImpostors::OctahedralImpostors()
+    : bakeProgram(0), drawProgram(0), gridSize(DEFAULT_GRID_SIZE), frameSize(DEFAULT_FRAME_SIZE), enabled(false),
+      instanceVao(0), instanceBuffer(0), instanceBufferBytes(0), bakeMs(0.0), cacheHits(0), drawnInstances(0), drawCalls(0)
+{
+}
+
+
+bool OctahedralImpostors::Create(GLuint bakeProgram, GLuint drawProgram, int gridSize, int frameSize, const std::string& cacheDirectory)
+{
+    this->bakeProgram = bakeProgram;
+    this->drawProgram = drawProgram;
+    this->gridSize = std::max(gridSize, 2);
+    this->frameSize = std::max(frameSize, 4);
+    this->cacheDirectory = cacheDirectory;
+
+    glUseProgram(bakeProgram);
+    glUniform1i(glGetUniformLocation(bakeProgram, "uTextureBase"), 0);
+    glUseProgram(drawProgram);
+    glUniform1i(glGetUniformLocation(drawProgram, "albedoAtlas"), 0);
+    glUniform1i(glGetUniformLocation(drawProgram, "normalAtlas"), 1);
+    glUniform1i(glGetUniformLocation(drawProgram, "depthAtlas"), 2);
+    glUseProgram(0);
+
+    // CLN: the quad corners come from gl_VertexID; the only vertex data are the per-instance attributes
+    glGenVertexArrays(1, &instanceVao);
+    glGenBuffers(1, &instanceBuffer);
+    glBindVertexArray(instanceVao);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    const GLsizei stride = FLOATS_PER_INSTANCE * sizeof(float);
+    for (GLuint attribute = 0; attribute < FLOATS_PER_INSTANCE / 4; ++attribute)
+    {
+        glEnableVertexAttribArray(attribute);
+        glVertexAttribPointer(attribute, 4, GL_FLOAT, GL_FALSE, stride, (const void*)(attribute * 4 * sizeof(float)));
+        glVertexAttribDivisor(attribute, 1);
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return true;
+}
+
+
+void OctahedralImpostors::Destroy()
+{
+    for (Impostor& impostor : impostors)
+    {
+        const GLuint textures[3] = { impostor.albedo, impostor.normal, impostor.depth };
+        glDeleteTextures(3, textures);
+    }
+    impostors.clear();
+    glDeleteBuffers(1, &instanceBuffer);
+    glDeleteVertexArrays(1, &instanceVao);
+    instanceBuffer = instanceVao = 0;
+    instanceBufferBytes = 0;
+    enabled = false;
+}
+
+
+bool OctahedralImpostors::CreateAtlases(Impostor& impostor) const
+{
+    const int size = gridSize * frameSize;
+    const int levels = GetMipLevels(frameSize);
+    const GLenum formats[3] = { GL_RGBA8, GL_RGBA8, GL_R16F };
+    GLuint* textures[3] = { &impostor.albedo, &impostor.normal, &impostor.depth };
+    for (int i = 0; i < 3; ++i)
+    {
+        glGenTextures(1, textures[i]);
+        glBindTexture(GL_TEXTURE_2D, *textures[i]);
+        glTexStorage2D(GL_TEXTURE_2D, levels, formats[i], size, size);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return glGetError() == GL_NO_ERROR;
+}
+
+
+// CLN: one orthographic view per frame, looking at the bounding sphere from the frame's direction (see
+//      impostorBakeVertexShaderSource), into the top mip level; the mipmaps are filtered from it afterwards
+void OctahedralImpostors::RenderFrames(const Impostor& impostor, GLuint vao, GLuint indexCount, GLuint texture)
+{
+    const int size = gridSize * frameSize;
+    GLuint framebuffer, depthBuffer;
+    glGenRenderbuffers(1, &depthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, size, size);
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, impostor.albedo, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, impostor.normal, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, impostor.depth, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+    const GLenum drawBuffers[3] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2 };
+    glDrawBuffers(3, drawBuffers);
+
+    // CLN: uncovered texels are empty (alpha 0) and infinitely deep
+    const GLfloat empty[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    const GLfloat farthest[4] = { 1.0f, 0.0f, 0.0f, 0.0f };
+    glClearBufferfv(GL_COLOR, 0, empty);
+    glClearBufferfv(GL_COLOR, 1, empty);
+    glClearBufferfv(GL_COLOR, 2, farthest);
+    glDepthMask(GL_TRUE);
+    glClear(GL_DEPTH_BUFFER_BIT);
+    glEnable(GL_DEPTH_TEST);
+
+    glUseProgram(bakeProgram);
+    glUniform1f(glGetUniformLocation(bakeProgram, "radius"), impostor.radius);
+    const GLint directionLocation = glGetUniformLocation(bakeProgram, "bakeDirection");
+    const GLint rightLocation = glGetUniformLocation(bakeProgram, "bakeRight");
+    const GLint upLocation = glGetUniformLocation(bakeProgram, "bakeUp");
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glBindVertexArray(vao);
+    for (int y = 0; y < gridSize; ++y)
+    {
+        for (int x = 0; x < gridSize; ++x)
+        {
+            // CLN: the frames sit on the grid's corners, so the outer ones look along the horizon
+            float direction[3], right[3], up[3];
+            HemiOctDecode(2.0f * x / (gridSize - 1) - 1.0f, 2.0f * y / (gridSize - 1) - 1.0f, direction);
+            FrameBasis(direction, right, up);
+            glUniform3fv(directionLocation, 1, direction);
+            glUniform3fv(rightLocation, 1, right);
+            glUniform3fv(upLocation, 1, up);
+            glViewport(x * frameSize, y * frameSize, frameSize, frameSize);
+            glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_SHORT, NULL);
+        }
+    }
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glUseProgram(0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteFramebuffers(1, &framebuffer);
+    glDeleteRenderbuffers(1, &depthBuffer);
+}
+
+
+int OctahedralImpostors::Bake(const std::string& key, GLuint vao, GLuint indexCount, GLuint texture, float radius)
+{
+    if (!IsCreated() || vao == 0 || indexCount == 0 || radius <= 0.0f)
+        return -1;
+
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    Impostor impostor;
+    impostor.key = key;
+    impostor.albedo = impostor.normal = impostor.depth = 0;
+    impostor.radius = radius;
+    if (!CreateAtlases(impostor))
+    {
+        std::cout << "Failed to create the impostor atlases of " << key << std::endl;
+        const GLuint textures[3] = { impostor.albedo, impostor.normal, impostor.depth };
+        glDeleteTextures(3, textures);
+        return -1;
+    }
+
+    if (Load(impostor, indexCount))
+        ++cacheHits;
+    else
+    {
+        RenderFrames(impostor, vao, indexCount, texture);
+        Store(impostor, indexCount);
+    }
+
+    const GLuint textures[3] = { impostor.albedo, impostor.normal, impostor.depth };
+    for (GLuint atlas : textures)
+    {
+        glBindTexture(GL_TEXTURE_2D, atlas);
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    bakeMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    impostors.push_back(impostor);
+    return (int)impostors.size() - 1;
+}
+
+
+std::string OctahedralImpostors::GetFilename(const std::string& key) const
+{
+    std::ostringstream filename;
+    filename << cacheDirectory << "/impostor_" << key << "_" << gridSize << "x" << frameSize << ".bin";
+    return filename.str();
+}
+
+
+bool OctahedralImpostors::Load(Impostor& impostor, GLuint indexCount) const
+{
+    if (cacheDirectory.empty())
+        return false;
+    std::ifstream file(GetFilename(impostor.key).c_str(), std::ios::binary);
+    if (!file)
+        return false;   // not baked yet
+
+    // CLN: a different index count or radius means the mesh changed since it was baked
+    CacheFileHeader header;
+    if (!file.read((char*)&header, sizeof(header)) || memcmp(header.magic, CACHE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.formatVersion != CACHE_FORMAT_VERSION || header.gridSize != (uint32_t)gridSize ||
+        header.frameSize != (uint32_t)frameSize || header.indexCount != indexCount || header.radius != impostor.radius)
+        return false;
+
+    const size_t texels = (size_t)gridSize * frameSize * gridSize * frameSize;
+    std::vector<unsigned char> data(texels * (4 + 4 + 2));
+    if (!file.read((char*)data.data(), data.size()) || Checksum(data) != header.checksum)
+    {
+        std::cout << "INFO: Impostor cache entry " << GetFilename(impostor.key) << " is damaged, baking it again" << std::endl;
+        return false;
+    }
+
+    const int size = gridSize * frameSize;
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glBindTexture(GL_TEXTURE_2D, impostor.albedo);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, size, size, GL_RGBA, GL_UNSIGNED_BYTE, data.data());
+    glBindTexture(GL_TEXTURE_2D, impostor.normal);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, size, size, GL_RGBA, GL_UNSIGNED_BYTE, data.data() + texels * 4);
+    glBindTexture(GL_TEXTURE_2D, impostor.depth);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, size, size, GL_RED, GL_HALF_FLOAT, data.data() + texels * 8);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    return true;
+}
+
+
+bool OctahedralImpostors::Store(const Impostor& impostor, GLuint indexCount) const
+{
+    if (cacheDirectory.empty())
+        return false;
+
+    const size_t texels = (size_t)gridSize * frameSize * gridSize * frameSize;
+    std::vector<unsigned char> data(texels * (4 + 4 + 2));
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glBindTexture(GL_TEXTURE_2D, impostor.albedo);
+    glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, data.data());
+    glBindTexture(GL_TEXTURE_2D, impostor.normal);
+    glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, data.data() + texels * 4);
+    glBindTexture(GL_TEXTURE_2D, impostor.depth);
+    glGetTexImage(GL_TEXTURE_2D, 0, GL_RED, GL_HALF_FLOAT, data.data() + texels * 8);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+    CacheFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CACHE_MAGIC, sizeof(header.magic));
+    header.formatVersion = CACHE_FORMAT_VERSION;
+    header.gridSize = (uint32_t)gridSize;
+    header.frameSize = (uint32_t)frameSize;
+    header.indexCount = indexCount;
+    header.radius = impostor.radius;
+    header.checksum = Checksum(data);
+
+    // CLN: written under a temporary name and renamed into place, as in GeometryCache::Store()
+    const std::string filename = GetFilename(impostor.key);
+    const std::string tempName = filename + ".tmp";
+    {
+        std::ofstream file(tempName.c_str(), std::ios::binary);
+        if (!file || !file.write((const char*)&header, sizeof(header)) || !file.write((const char*)data.data(), data.size()))
+        {
+            std::cout << "Failed to write impostor cache file " << tempName << std::endl;
+            file.close();
+            std::remove(tempName.c_str());
+            return false;
+        }
+    }
+#ifdef _WIN32
+    std::remove(filename.c_str());      // CLN: rename() does not replace an existing file on Windows
+#endif
+    if (std::rename(tempName.c_str(), filename.c_str()) != 0)
+    {
+        std::remove(tempName.c_str());
+        return false;
+    }
+    return true;
+}
+
+
+void OctahedralImpostors::Add(int impostor, const float* model, const float* lightPosition, const float* lightColor, int materialSlot)
+{
+    // CLN: the rows of the affine part of the model matrix, then the light (the slot rides in the color's w)
+    std::vector<float>& instances = impostors[impostor].instances;
+    for (int row = 0; row < 3; ++row)
+    {
+        for (int column = 0; column < 4; ++column)
+            instances.push_back(model[column * 4 + row]);
+    }
+    instances.insert(instances.end(), lightPosition, lightPosition + 3);
+    instances.push_back(1.0f);
+    instances.insert(instances.end(), lightColor, lightColor + 3);
+    instances.push_back((float)materialSlot);
+}
+
+
+void OctahedralImpostors::Draw(const float* viewProjection, const float* cameraPosition, const float* viewPosition)
+{
+    drawnInstances = 0;
+    drawCalls = 0;
+    size_t floats = 0;
+    for (const Impostor& impostor : impostors)
+        floats += impostor.instances.size();
+    if (floats == 0)
+        return;
+
+    // CLN: every impostor's instances go into one buffer (orphaned each frame), and each draw starts at its own
+    //      base instance
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    const size_t bytes = floats * sizeof(float);
+    if (bytes > instanceBufferBytes)
+        instanceBufferBytes = std::max(bytes, instanceBufferBytes * 2);
+    glBufferData(GL_ARRAY_BUFFER, instanceBufferBytes, NULL, GL_STREAM_DRAW);
+    size_t offset = 0;
+    for (const Impostor& impostor : impostors)
+    {
+        glBufferSubData(GL_ARRAY_BUFFER, offset * sizeof(float), impostor.instances.size() * sizeof(float), impostor.instances.data());
+        offset += impostor.instances.size();
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glUseProgram(drawProgram);
+    glUniformMatrix4fv(glGetUniformLocation(drawProgram, "viewProjection"), 1, GL_FALSE, viewProjection);
+    glUniform3fv(glGetUniformLocation(drawProgram, "cameraPosition"), 1, cameraPosition);
+    glUniform3fv(glGetUniformLocation(drawProgram, "viewPosition"), 1, viewPosition);
+    glUniform1i(glGetUniformLocation(drawProgram, "gridSize"), gridSize);
+    const GLint radiusLocation = glGetUniformLocation(drawProgram, "radius");
+    glEnable(GL_DEPTH_TEST);
+    glBindVertexArray(instanceVao);
+
+    GLuint firstInstance = 0;
+    for (Impostor& impostor : impostors)
+    {
+        const GLsizei count = (GLsizei)(impostor.instances.size() / FLOATS_PER_INSTANCE);
+        if (count > 0)
+        {
+            glUniform1f(radiusLocation, impostor.radius);
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, impostor.albedo);
+            glActiveTexture(GL_TEXTURE1);
+            glBindTexture(GL_TEXTURE_2D, impostor.normal);
+            glActiveTexture(GL_TEXTURE2);
+            glBindTexture(GL_TEXTURE_2D, impostor.depth);
+            glDrawArraysInstancedBaseInstance(GL_TRIANGLE_STRIP, 0, 4, count, firstInstance);
+            firstInstance += count;
+            drawnInstances += count;
+            ++drawCalls;
+        }
+        impostor.instances.clear();     // CLN: (keeps the capacity, so queuing allocates nothing after the first frames)
+    }
+
+    for (int unit = 2; unit >= 0; --unit)
+    {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+    glBindVertexArray(0);
+    glUseProgram(0);
+}
+
+
+void OctahedralImpostors::PrintStats(std::ostream& out) const
+{
+    if (!enabled)
+    {
+        out << "INFO: Impostors off" << std::endl;
+        return;
+    }
+
+    // CLN: three atlases of 4 + 4 + 2 bytes a texel, plus a third for the mipmaps
+    const double atlasMB = impostors.size() * (double)gridSize * frameSize * gridSize * frameSize * 10.0 * 4.0 / 3.0 / (1024.0 * 1024.0);
+    const std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(1)
+        << "INFO: Impostors: " << impostors.size() << " baked (" << gridSize << " x " << gridSize << " views of " << frameSize
+        << " px, " << atlasMB << " MB of atlases, " << bakeMs << " ms, " << cacheHits << " loaded from the cache), "
+        << drawnInstances << " instance(s) in " << drawCalls << " draw(s) last frame" << std::endl;
+    out.unsetf(std::ios_base::floatfield);
+    out.precision(precision);
+}
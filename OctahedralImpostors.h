@@ -0,0 +1,102 @@
+//========================================================================================
+// Filename      : OctahedralImpostors.h
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Octahedral impostors for distant props. Bake() captures a mesh (with
+//               : its texture) from gridSize x gridSize view directions spread over the
+//               : upper hemisphere by a hemi-octahedral mapping, each into a frameSize
+//               : square frame of three atlases:
+//               :    albedo: texture color, alpha = coverage (premultiplied, so the
+//               :            mipmaps don't darken the silhouettes)
+//               :    normal: object space normal, premultiplied the same way
+//               :    depth : distance behind the front of the bounding sphere, 0..1
+//               :            of its diameter
+//               : Baking happens at load time; with a cache directory the atlases are
+//               : written there and later runs load them instead.
+//               :
+//               : At runtime every distant instance is one camera-facing quad in front
+//               : of its bounding sphere, drawn instanced (one draw per baked impostor).
+//               : The quad blends the three baked views around the direction it is seen
+//               : from, reconstructs the normal and the depth of the surface from the
+//               : atlases, and is lit with the scene's Phong model, so lights moving
+//               : over a baked prop still light it correctly.
+//========================================================================================
+
+#ifndef OCTAHEDRAL_IMPOSTORS_H
+#define OCTAHEDRAL_IMPOSTORS_H
+
+#include <GL/glew.h>
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+class OctahedralImpostors
+{
+public:
+    static const int DEFAULT_GRID_SIZE = 8;
+    static const int DEFAULT_FRAME_SIZE = 32;
+    static const int FLOATS_PER_INSTANCE = 20;  // model rows (3 x 4), light position (4), light color (3) and material slot
+
+    OctahedralImpostors();
+
+    // bakeProgram renders a mesh into the atlases (impostorBake*ShaderSource in main), drawProgram draws the quads
+    // (impostor*ShaderSource). An empty cacheDirectory bakes every run
+    bool Create(GLuint bakeProgram, GLuint drawProgram, int gridSize, int frameSize, const std::string& cacheDirectory);
+    void Destroy();
+    bool IsCreated() const      { return instanceVao != 0; }
+
+    void SetEnabled(bool enabled)   { this->enabled = enabled && IsCreated(); }
+    bool IsEnabled() const          { return enabled; }
+
+    // Bakes the impostor of the mesh in vao (the scene's vertex layout, unsigned short indices), drawn with texture;
+    // radius bounds the mesh around its origin. key names the cache entry and must change with the mesh or texture.
+    // Returns the impostor's index, -1 on failure
+    int Bake(const std::string& key, GLuint vao, GLuint indexCount, GLuint texture, float radius);
+    int GetCount() const        { return (int)impostors.size(); }
+
+    // queues an instance for the next Draw(): column-major model matrix, the light that lights it, and the slot of
+    // its material in the material buffer (see MaterialLibrary.h), so instances of one impostor can differ in material
+    void Add(int impostor, const float* model, const float* lightPosition, const float* lightColor, int materialSlot);
+    // draws the queued instances and clears them. viewPosition is the eye position the scene's Phong shader is given
+    void Draw(const float* viewProjection, const float* cameraPosition, const float* viewPosition);
+
+    void PrintStats(std::ostream& out) const;
+
+private:
+    struct Impostor
+    {
+        std::string key;
+        GLuint albedo;
+        GLuint normal;
+        GLuint depth;
+        float radius;
+        std::vector<float> instances;   // queued for the next Draw()
+    };
+
+    bool CreateAtlases(Impostor& impostor) const;
+    void RenderFrames(const Impostor& impostor, GLuint vao, GLuint indexCount, GLuint texture);
+    bool Load(Impostor& impostor, GLuint indexCount) const;
+    bool Store(const Impostor& impostor, GLuint indexCount) const;
+    std::string GetFilename(const std::string& key) const;
+
+    GLuint bakeProgram;
+    GLuint drawProgram;
+    int gridSize;
+    int frameSize;
+    std::string cacheDirectory;
+    bool enabled;
+
+    std::vector<Impostor> impostors;
+    GLuint instanceVao;
+    GLuint instanceBuffer;
+    size_t instanceBufferBytes;
+
+    double bakeMs;
+    int cacheHits;
+    size_t drawnInstances;              // by the last Draw()
+    int drawCalls;
+};
+
+#endif
@@ -0,0 +1,254 @@
+//========================================================================================
+// Filename      : OverdrawView.cpp
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Implementation of the OverdrawView class (see OverdrawView.h)
+//========================================================================================
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#include "OverdrawView.h"
+
+namespace
+{
+    // CLN: each live lane adds 12 / (live lanes in its quad), so a quad adds 12 in total (see OverdrawView.h)
+    const double QUAD_SHARE = 12.0;
+
+    GLuint CreateCountImage(int width, int height)
+    {
+        GLuint texture;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexStorage2D(GL_TEXTURE_2D, 1, GL_R32UI, width, height);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        return texture;
+    }
+
+    std::string JsonString(const std::string& text)
+    {
+        std::string quoted = "\"";
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+                quoted += '\\';
+            quoted += c;
+        }
+        return quoted + "\"";
+    }
+}
+
+
+OverdrawView::OverdrawView()
+    : width(0), height(0), mode(OVERDRAW_VIEW_OFF), countProgram(0), resolveProgram(0), emptyVao(0),
+      overdrawImage(0), quadShareImage(0), objectCounterBuffer(0)
+{
+}
+
+
+bool OverdrawView::Create(int width, int height, GLuint countProgram, GLuint resolveProgram)
+{
+    this->width = width;
+    this->height = height;
+    this->countProgram = countProgram;
+    this->resolveProgram = resolveProgram;
+    glGenVertexArrays(1, &emptyVao);
+
+    glGenBuffers(1, &objectCounterBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, objectCounterBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, MAX_OBJECTS * 2 * sizeof(GLuint), NULL, GL_DYNAMIC_READ);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    return CreateImages();
+}
+
+
+bool OverdrawView::Resize(int width, int height)
+{
+    if (!IsCreated() || (width == this->width && height == this->height) || width <= 0 || height <= 0)
+        return true;
+
+    this->width = width;
+    this->height = height;
+    DestroyImages();
+    return CreateImages();
+}
+
+
+void OverdrawView::Destroy()
+{
+    DestroyImages();
+    glDeleteBuffers(1, &objectCounterBuffer);
+    glDeleteVertexArrays(1, &emptyVao);
+    objectCounterBuffer = emptyVao = 0;
+    mode = OVERDRAW_VIEW_OFF;
+}
+
+
+bool OverdrawView::CreateImages()
+{
+    while (glGetError() != GL_NO_ERROR) {}  // CLN: so only errors from here on are checked below
+
+    overdrawImage = CreateCountImage(width, height);
+    quadShareImage = CreateCountImage(width, height);
+
+    if (glGetError() != GL_NO_ERROR)
+    {
+        std::cout << "Failed to create the overdraw view images (" << width << " x " << height << ")" << std::endl;
+        DestroyImages();
+        return false;
+    }
+    return true;
+}
+
+
+void OverdrawView::DestroyImages()
+{
+    glDeleteTextures(1, &overdrawImage);
+    glDeleteTextures(1, &quadShareImage);
+    overdrawImage = quadShareImage = 0;
+}
+
+
+const char* OverdrawView::GetModeName(OverdrawViewMode mode)
+{
+    switch (mode)
+    {
+    case OVERDRAW_VIEW_OVERDRAW:    return "overdraw";
+    case OVERDRAW_VIEW_QUADS:       return "quad efficiency";
+    default:                        return "off";
+    }
+}
+
+
+void OverdrawView::BeginFrame()
+{
+    const GLuint zero = 0;
+    glClearTexImage(overdrawImage, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+    glClearTexImage(quadShareImage, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, objectCounterBuffer);
+    glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    glBindImageTexture(OVERDRAW_IMAGE_UNIT, overdrawImage, 0, GL_FALSE, 0, GL_READ_WRITE, GL_R32UI);
+    glBindImageTexture(QUAD_SHARE_IMAGE_UNIT, quadShareImage, 0, GL_FALSE, 0, GL_READ_WRITE, GL_R32UI);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, OBJECT_COUNTER_BINDING, objectCounterBuffer);
+}
+
+
+GLuint OverdrawView::UseForObject(const std::string& name)
+{
+    size_t id = std::find(objectNames.begin(), objectNames.end(), name) - objectNames.begin();
+    if (id == objectNames.size() && objectNames.size() < MAX_OBJECTS)
+        objectNames.push_back(name);
+    id = std::min(id, (size_t)MAX_OBJECTS - 1);
+
+    glUseProgram(countProgram);
+    glUniform1i(glGetUniformLocation(countProgram, "objectId"), (GLint)id);
+    return countProgram;
+}
+
+
+void OverdrawView::Resolve()
+{
+    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_BLEND);
+    glUseProgram(resolveProgram);
+    glUniform1i(glGetUniformLocation(resolveProgram, "mode"), (GLint)mode);
+    glBindVertexArray(emptyVao);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+    glEnable(GL_DEPTH_TEST);
+}
+
+
+OverdrawStats OverdrawView::ReadStats() const
+{
+    OverdrawStats stats;
+    stats.width = width;
+    stats.height = height;
+    if (!IsCreated())
+        return stats;
+
+    glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+
+    std::vector<GLuint> overdraw((size_t)width * height);
+    glBindTexture(GL_TEXTURE_2D, overdrawImage);
+    glGetTexImage(GL_TEXTURE_2D, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, overdraw.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+    for (GLuint count : overdraw)
+    {
+        stats.coveredPixels += count > 0;
+        stats.maxOverdraw = std::max(stats.maxOverdraw, (unsigned int)count);
+    }
+
+    std::vector<GLuint> counters(objectNames.size() * 2);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, objectCounterBuffer);
+    glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, counters.size() * sizeof(GLuint), counters.data());
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    for (size_t i = 0; i < objectNames.size(); ++i)
+    {
+        OverdrawObjectStats object;
+        object.name = objectNames[i];
+        object.fragments = counters[i * 2];
+        object.quads = counters[i * 2 + 1] / QUAD_SHARE;
+        stats.fragments += object.fragments;
+        stats.quads += object.quads;
+        stats.objects.push_back(object);
+    }
+    return stats;
+}
+
+
+void OverdrawView::PrintStats(const OverdrawStats& stats, std::ostream& out)
+{
+    const std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(2)
+        << "INFO: Overdraw: " << stats.fragments << " fragments over " << stats.coveredPixels << " pixels, "
+        << stats.GetAverageOverdraw() << " average, " << stats.maxOverdraw << " max; "
+        << stats.quads << " quads, " << stats.GetQuadEfficiency() * 100.0 << "% quad efficiency\n";
+    for (const OverdrawObjectStats& object : stats.objects)
+    {
+        out << "INFO:     " << std::left << std::setw(20) << object.name << std::right << std::setw(10) << object.fragments
+            << " fragments " << std::setw(6) << object.GetQuadEfficiency() * 100.0 << "% quad efficiency\n";
+    }
+    out.unsetf(std::ios::floatfield);
+    out.precision(precision);
+    out.flush();
+}
+
+
+bool OverdrawView::WriteReport(const std::string& filename, const OverdrawStats& stats)
+{
+    std::ofstream file(filename.c_str());
+    if (!file)
+    {
+        std::cout << "Failed to write the overdraw report " << filename << std::endl;
+        return false;
+    }
+
+    file << std::fixed << std::setprecision(4)
+         << "{\n"
+         << "  \"width\": " << stats.width << ",\n"
+         << "  \"height\": " << stats.height << ",\n"
+         << "  \"fragments\": " << stats.fragments << ",\n"
+         << "  \"coveredPixels\": " << stats.coveredPixels << ",\n"
+         << "  \"averageOverdraw\": " << stats.GetAverageOverdraw() << ",\n"
+         << "  \"maxOverdraw\": " << stats.maxOverdraw << ",\n"
+         << "  \"quads\": " << stats.quads << ",\n"
+         << "  \"quadEfficiency\": " << stats.GetQuadEfficiency() << ",\n"
+         << "  \"objects\": [";
+    for (size_t i = 0; i < stats.objects.size(); ++i)
+    {
+        const OverdrawObjectStats& object = stats.objects[i];
+        file << (i > 0 ? "," : "") << "\n    { \"name\": " << JsonString(object.name) << ", \"fragments\": " << object.fragments
+             << ", \"quads\": " << object.quads << ", \"quadEfficiency\": " << object.GetQuadEfficiency() << " }";
+    }
+    file << "\n  ]\n}\n";
+    return (bool)file;
+}
@@ -0,0 +1,111 @@
+//========================================================================================
+// Filename      : OverdrawView.h
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Debug views of where the fragment work of a frame goes. While a view
+//               : is on, every object is drawn with a counting shader instead of its
+//               : own; for each fragment that passes the depth test it adds to
+//               :    overdraw   (R32UI image): fragments shaded at the pixel
+//               :    quad share (R32UI image): 12 / (live lanes of the fragment's 2x2 quad),
+//               :                              so 12 per quad, however many lanes it covers
+//               : and to the fragment and quad counters of the object in a storage buffer.
+//               : A full-screen pass then shows one of them as a heat map:
+//               :    OVERDRAW_VIEW_OVERDRAW: 1 shaded fragment blue up to 8 or more red
+//               :    OVERDRAW_VIEW_QUADS   : lanes run per useful fragment, 1 (every lane of
+//               :                            the quad covered) blue up to 4 (one lane) red
+//               : The GPU shades whole 2x2 quads for the derivatives, so tiny triangles,
+//               : such as those of a distant highly tessellated sphere, waste up to three
+//               : helper lanes per fragment.
+//               :
+//               : ReadStats() returns the totals and the per-object breakdown, which
+//               : WriteReport() saves as JSON for headless runs (--overdraw-report).
+//========================================================================================
+
+#ifndef OVERDRAW_VIEW_H
+#define OVERDRAW_VIEW_H
+
+#include <GL/glew.h>
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+enum OverdrawViewMode
+{
+    OVERDRAW_VIEW_OFF,
+    OVERDRAW_VIEW_OVERDRAW,
+    OVERDRAW_VIEW_QUADS,
+    OVERDRAW_VIEW_MODE_COUNT
+};
+
+struct OverdrawObjectStats
+{
+    std::string name;
+    unsigned long long fragments = 0;
+    double quads = 0.0;
+
+    double GetQuadEfficiency() const    { return quads > 0.0 ? fragments / (4.0 * quads) : 1.0; }
+};
+
+struct OverdrawStats
+{
+    int width = 0;
+    int height = 0;
+    unsigned long long fragments = 0;
+    double quads = 0.0;
+    unsigned long long coveredPixels = 0;   // pixels with at least one fragment
+    unsigned int maxOverdraw = 0;
+    std::vector<OverdrawObjectStats> objects;
+
+    double GetAverageOverdraw() const   { return coveredPixels > 0 ? (double)fragments / coveredPixels : 0.0; }
+    double GetQuadEfficiency() const    { return quads > 0.0 ? fragments / (4.0 * quads) : 1.0; }
+};
+
+class OverdrawView
+{
+public:
+    static const int MAX_OBJECTS = 256;         // further names share the last counter
+    static const int OVERDRAW_IMAGE_UNIT = 0;
+    static const int QUAD_SHARE_IMAGE_UNIT = 1;
+    static const int OBJECT_COUNTER_BINDING = 3;
+
+    OverdrawView();
+
+    // countProgram is a scene vertex shader with overdrawCountFragmentShaderSource, resolveProgram a full-screen
+    // triangle with overdrawResolveFragmentShaderSource (see main)
+    bool Create(int width, int height, GLuint countProgram, GLuint resolveProgram);
+    bool Resize(int width, int height);
+    void Destroy();
+    bool IsCreated() const      { return objectCounterBuffer != 0; }
+
+    void SetMode(OverdrawViewMode mode) { this->mode = IsCreated() ? mode : OVERDRAW_VIEW_OFF; }
+    OverdrawViewMode GetMode() const    { return mode; }
+    bool IsActive() const               { return mode != OVERDRAW_VIEW_OFF; }
+    static const char* GetModeName(OverdrawViewMode mode);
+
+    void BeginFrame();                          // clears the counts, binds the images and counters
+    GLuint UseForObject(const std::string& name);   // binds the counting program for the named object, returns it
+    void Resolve();                             // draws the heat map into the bound framebuffer
+
+    OverdrawStats ReadStats() const;            // counts of the last frame drawn with a view on (waits for the GPU)
+    static void PrintStats(const OverdrawStats& stats, std::ostream& out);
+    static bool WriteReport(const std::string& filename, const OverdrawStats& stats);
+
+private:
+    bool CreateImages();
+    void DestroyImages();
+
+    int width;
+    int height;
+    OverdrawViewMode mode;
+    GLuint countProgram;
+    GLuint resolveProgram;
+    GLuint emptyVao;
+    GLuint overdrawImage;
+    GLuint quadShareImage;
+    GLuint objectCounterBuffer;     // uvec2 per object: fragments, quad share
+    std::vector<std::string> objectNames;
+};
+
+#endif
@@ -0,0 +1,168 @@
+//========================================================================================
+// Filename      : PerfCounters.cpp
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Implementation of the PerfCounters class (see PerfCounters.h)
+//========================================================================================
+
+#include <cstring>
+#include <iomanip>
+
+#include "PerfCounters.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+#ifdef __linux__
+    int OpenCounter(unsigned int type, unsigned long long config)
+    {
+        perf_event_attr attributes;
+        memset(&attributes, 0, sizeof(attributes));
+        attributes.size = sizeof(attributes);
+        attributes.type = type;
+        attributes.config = config;
+        attributes.exclude_kernel = 1;      // CLN: (perf_event_paranoid 2, the usual default, allows user space only)
+        attributes.exclude_hv = 1;
+        // CLN: pid 0 and cpu -1: the calling thread, on whichever CPU it runs
+        return (int)syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0);
+    }
+
+    unsigned long long NodeCacheEvent(unsigned long long result)
+    {
+        return PERF_COUNT_HW_CACHE_NODE | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (result << 16);
+    }
+#endif
+}
+
+
+PerfCounterValues& PerfCounterValues::operator+=(const PerfCounterValues& other)
+{
+    nodeLoads += other.nodeLoads;
+    remoteLoads += other.remoteLoads;
+    cpuMigrations += other.cpuMigrations;
+    hasNodeLoads = hasNodeLoads || other.hasNodeLoads;
+    hasMigrations = hasMigrations || other.hasMigrations;
+    return *this;
+}
+
+
+PerfCounterValues PerfCounterValues::operator-(const PerfCounterValues& other) const
+{
+    PerfCounterValues difference = *this;
+    difference.nodeLoads -= other.nodeLoads;
+    difference.remoteLoads -= other.remoteLoads;
+    difference.cpuMigrations -= other.cpuMigrations;
+    return difference;
+}
+
+
+void PerfCounterValues::Print(std::ostream& out) const
+{
+    if (!hasNodeLoads && !hasMigrations)
+    {
+        out << "no performance counters";
+        return;
+    }
+    if (hasNodeLoads)
+    {
+        const std::streamsize precision = out.precision();
+        out << std::fixed << std::setprecision(1) << nodeLoads / 1e6 << "M DRAM loads, " << remoteLoads / 1e6 << "M remote ("
+            << (nodeLoads > 0 ? 100.0 * remoteLoads / nodeLoads : 0.0) << "%)";
+        out.unsetf(std::ios_base::floatfield);
+        out.precision(precision);
+    }
+    else
+        out << "no node load counters";
+    if (hasMigrations)
+        out << ", " << cpuMigrations << " CPU migration(s)";
+}
+
+
+PerfCounters::PerfCounters()
+{
+    for (int& descriptor : descriptors)
+        descriptor = -1;
+}
+
+
+PerfCounters::~PerfCounters()
+{
+    Close();
+}
+
+
+bool PerfCounters::Open()
+{
+    Close();
+#ifdef __linux__
+    descriptors[NODE_LOADS] = OpenCounter(PERF_TYPE_HW_CACHE, NodeCacheEvent(PERF_COUNT_HW_CACHE_RESULT_ACCESS));
+    descriptors[REMOTE_LOADS] = OpenCounter(PERF_TYPE_HW_CACHE, NodeCacheEvent(PERF_COUNT_HW_CACHE_RESULT_MISS));
+    descriptors[CPU_MIGRATIONS] = OpenCounter(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_MIGRATIONS);
+
+    // CLN: the two node counters only mean something together
+    if (descriptors[NODE_LOADS] < 0 || descriptors[REMOTE_LOADS] < 0)
+    {
+        for (int counter : { NODE_LOADS, REMOTE_LOADS })
+        {
+            if (descriptors[counter] >= 0)
+                close(descriptors[counter]);
+            descriptors[counter] = -1;
+        }
+    }
+#endif
+    return IsOpen();
+}
+
+
+void PerfCounters::Close()
+{
+    for (int& descriptor : descriptors)
+    {
+#ifdef __linux__
+        if (descriptor >= 0)
+            close(descriptor);
+#endif
+        descriptor = -1;
+    }
+}
+
+
+bool PerfCounters::IsOpen() const
+{
+    for (int descriptor : descriptors)
+    {
+        if (descriptor >= 0)
+            return true;
+    }
+    return false;
+}
+
+
+PerfCounterValues PerfCounters::Read() const
+{
+    PerfCounterValues values;
+#ifdef __linux__
+    unsigned long long counts[COUNTER_COUNT] = {};
+    bool read[COUNTER_COUNT] = {};
+    for (int counter = 0; counter < COUNTER_COUNT; ++counter)
+    {
+        if (descriptors[counter] >= 0)
+            read[counter] = ::read(descriptors[counter], &counts[counter], sizeof(counts[counter])) == sizeof(counts[counter]);
+    }
+    values.hasNodeLoads = read[NODE_LOADS] && read[REMOTE_LOADS];
+    values.hasMigrations = read[CPU_MIGRATIONS];
+    if (values.hasNodeLoads)
+    {
+        values.nodeLoads = counts[NODE_LOADS];
+        values.remoteLoads = counts[REMOTE_LOADS];
+    }
+    values.cpuMigrations = counts[CPU_MIGRATIONS];
+#endif
+    return values;
+}
@@ -0,0 +1,59 @@
+//========================================================================================
+// Filename      : PerfCounters.h
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Per-thread hardware performance counters (perf_event_open on Linux)
+//               : for the cost of memory placement across NUMA nodes:
+//               :    node loads       : loads that went to DRAM (the generic
+//               :                       "node-loads" event)
+//               :    remote loads     : those served by another node's memory
+//               :                       ("node-load-misses")
+//               :    CPU migrations   : times the scheduler moved the thread to another
+//               :                       CPU (a software counter, there even without a PMU)
+//               : Open() counts the calling thread from then on; Read() can be called
+//               : from any thread. Where the counters can't be opened (other systems,
+//               : perf_event_paranoid, virtual machines without a PMU) Open() returns
+//               : false and the values that are missing read as zero.
+//========================================================================================
+
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <ostream>
+
+struct PerfCounterValues
+{
+    unsigned long long nodeLoads = 0;
+    unsigned long long remoteLoads = 0;
+    unsigned long long cpuMigrations = 0;
+    bool hasNodeLoads = false;          // the PMU counts them (remoteLoads as well)
+    bool hasMigrations = false;
+
+    PerfCounterValues& operator+=(const PerfCounterValues& other);
+    PerfCounterValues operator-(const PerfCounterValues& other) const;
+    // "node loads ..., remote ... (..%), ... CPU migrations", or why there is nothing to show
+    void Print(std::ostream& out) const;
+};
+
+class PerfCounters
+{
+public:
+    PerfCounters();
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool Open();                        // counts the calling thread
+    void Close();
+    bool IsOpen() const;
+
+    PerfCounterValues Read() const;
+
+private:
+    enum { NODE_LOADS, REMOTE_LOADS, CPU_MIGRATIONS, COUNTER_COUNT };
+    int descriptors[COUNTER_COUNT];     // -1 where a counter isn't open
+};
+
+#endif
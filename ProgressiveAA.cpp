@@ -0,0 +1,234 @@
+//========================================================================================
+// Filename      : ProgressiveAA.cpp
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Implementation of the ProgressiveAA class (see ProgressiveAA.h)
+//========================================================================================
+
+#include <algorithm>
+#include <iostream>
+
+#include "ProgressiveAA.h"
+
+namespace
+{
+    const unsigned long long FNV_PRIME = 1099511628211ull;
+}
+
+
+ProgressiveAA::ProgressiveAA()
+    : width(0), height(0), accumulateProgram(0), emptyVao(0), history(0), historyFramebuffer(0),
+      enabled(false), sampleCount(DEFAULT_SAMPLES), samples(0), jitterX(0.0f), jitterY(0.0f),
+      stateHash(0), restarts(0), convergedFrames(0)
+{
+}
+
+
+bool ProgressiveAA::Create(int width, int height, GLuint accumulateProgram)
+{
+    this->width = width;
+    this->height = height;
+    this->accumulateProgram = accumulateProgram;
+    glGenVertexArrays(1, &emptyVao);
+
+    glUseProgram(accumulateProgram);
+    glUniform1i(glGetUniformLocation(accumulateProgram, "sceneTexture"), 0);
+    glUseProgram(0);
+
+    return CreateTargets();
+}
+
+
+bool ProgressiveAA::Resize(int width, int height)
+{
+    if (!IsCreated() || (width == this->width && height == this->height) || width <= 0 || height <= 0)
+        return true;    // CLN: minimized windows report 0 x 0, keep the old target until it comes back
+
+    this->width = width;
+    this->height = height;
+    samples = 0;
+    DestroyTargets();
+    return CreateTargets();
+}
+
+
+void ProgressiveAA::Destroy()
+{
+    DestroyTargets();
+    glDeleteVertexArrays(1, &emptyVao);
+    emptyVao = 0;
+}
+
+
+bool ProgressiveAA::CreateTargets()
+{
+    // CLN: 32-bit floats, since the 1 / n weights of a long average drop below half float precision
+    glGenTextures(1, &history);
+    glBindTexture(GL_TEXTURE_2D, history);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA32F, width, height);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenFramebuffers(1, &historyFramebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, historyFramebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, history, 0);
+    const bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if (!complete)
+    {
+        std::cout << "Failed to create the accumulation history (" << width << " x " << height << ")" << std::endl;
+        DestroyTargets();
+        return false;
+    }
+    return true;
+}
+
+
+void ProgressiveAA::DestroyTargets()
+{
+    glDeleteFramebuffers(1, &historyFramebuffer);
+    glDeleteTextures(1, &history);
+    historyFramebuffer = history = 0;
+}
+
+
+void ProgressiveAA::SetEnabled(bool enabled)
+{
+    this->enabled = enabled && IsCreated();
+    samples = 0;
+}
+
+
+void ProgressiveAA::SetSampleCount(int samples)
+{
+    sampleCount = std::min(std::max(samples, 1), MAX_SAMPLES);
+}
+
+
+unsigned long long ProgressiveAA::Hash(const void* data, size_t bytes, unsigned long long hash)
+{
+    const unsigned char* byte = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < bytes; ++i)
+        hash = (hash ^ byte[i]) * FNV_PRIME;
+    return hash;
+}
+
+
+// CLN: radical inverse of index in base, in [0, 1)
+float ProgressiveAA::Halton(int index, int base)
+{
+    float result = 0.0f;
+    float fraction = 1.0f / base;
+    for (; index > 0; index /= base, fraction /= base)
+        result += fraction * (index % base);
+    return result;
+}
+
+
+void ProgressiveAA::BeginFrame(unsigned long long stateHash)
+{
+    jitterX = jitterY = 0.0f;
+    if (!enabled)
+        return;
+
+    if (stateHash != this->stateHash)
+    {
+        this->stateHash = stateHash;
+        if (samples > 0)
+            ++restarts;
+        samples = 0;
+    }
+
+    // CLN: the first sample (and every moving frame) is unjittered, so the image doesn't shift when the camera
+    //      stops; the rest cover the pixel with the Halton points, centered on it
+    if (samples > 0 && samples < sampleCount)
+    {
+        jitterX = Halton(samples, 2) - 0.5f;
+        jitterY = Halton(samples, 3) - 0.5f;
+    }
+}
+
+
+// CLN: a clip space translation of (2 jitter / size) * w, added to the x and y rows, so it works for the
+//      perspective and the orthographic projection alike
+void ProgressiveAA::JitterProjection(const float* projection, float* jittered) const
+{
+    const float offsetX = 2.0f * jitterX / std::max(width, 1);
+    const float offsetY = 2.0f * jitterY / std::max(height, 1);
+    for (int column = 0; column < 4; ++column)
+    {
+        const float w = projection[column * 4 + 3];
+        jittered[column * 4 + 0] = projection[column * 4 + 0] + offsetX * w;
+        jittered[column * 4 + 1] = projection[column * 4 + 1] + offsetY * w;
+        jittered[column * 4 + 2] = projection[column * 4 + 2];
+        jittered[column * 4 + 3] = w;
+    }
+}
+
+
+void ProgressiveAA::Accumulate(GLuint sceneFramebuffer, GLuint sceneColorTexture, unsigned long long stateHash)
+{
+    if (!enabled)
+        return;
+
+    // CLN: something changed during the frame (after its offset was picked): show the frame as it is, and start the
+    //      history over with the next one (whose BeginFrame() sees the new hash)
+    if (stateHash != this->stateHash && samples > 0)
+    {
+        ++restarts;
+        samples = 0;
+        return;
+    }
+
+    if (samples < sampleCount)
+    {
+        // CLN: history = history + (frame - history) / (n + 1), by blending with a constant alpha of 1 / (n + 1)
+        glBindFramebuffer(GL_FRAMEBUFFER, historyFramebuffer);
+        glViewport(0, 0, width, height);
+        glDisable(GL_DEPTH_TEST);
+        glEnable(GL_BLEND);
+        glBlendColor(0.0f, 0.0f, 0.0f, 1.0f / (samples + 1));
+        glBlendFunc(GL_CONSTANT_ALPHA, GL_ONE_MINUS_CONSTANT_ALPHA);
+
+        glUseProgram(accumulateProgram);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, sceneColorTexture);
+        glBindVertexArray(emptyVao);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glBindVertexArray(0);
+        glUseProgram(0);
+
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glBlendColor(0.0f, 0.0f, 0.0f, 0.0f);
+        glDisable(GL_BLEND);
+        glEnable(GL_DEPTH_TEST);
+        ++samples;
+    }
+    else
+        ++convergedFrames;
+
+    // CLN: the average goes back into the scene color, so the rest of the frame (Present()) is unchanged. A single
+    //      sample is the frame itself, no copy needed
+    if (samples > 1)
+    {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, historyFramebuffer);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, sceneFramebuffer);
+        glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, sceneFramebuffer);
+}
+
+
+void ProgressiveAA::PrintStats(std::ostream& out) const
+{
+    if (!enabled)
+    {
+        out << "INFO: Accumulation AA off" << std::endl;
+        return;
+    }
+    out << "INFO: Accumulation AA: " << samples << " of " << sampleCount << " samples" << (IsConverged() ? " (converged)" : "")
+        << ", restarted " << restarts << " time(s), " << convergedFrames << " idle frame(s) after converging" << std::endl;
+}
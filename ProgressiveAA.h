@@ -0,0 +1,90 @@
+//========================================================================================
+// Filename      : ProgressiveAA.h
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Progressive accumulation anti-aliasing. While the camera, the lights
+//               : and the objects stay still, each frame offsets the projection by a
+//               : different subpixel amount (a Halton 2,3 sequence) and the frame is
+//               : averaged into a history target (RGBA32F), so the image converges to a
+//               : supersampled one with sampleCount samples per pixel. A moving frame
+//               : costs nothing extra: it is drawn unjittered, and only copied to the
+//               : history, which restarts with it.
+//               :
+//               : Changes are found by a hash of the camera, light, settings and scene
+//               : version (bumped when a mesh is replaced), taken twice per frame:
+//               :    BeginFrame(): before the frame is drawn, so a moving frame is never
+//               :                  jittered
+//               :    Accumulate(): after it is drawn, which catches what changed while
+//               :                  drawing (the lamp's orbit moves the light); such a
+//               :                  frame is shown as drawn and the next one starts over
+//               : Once converged, IsConverged() lets the caller render the idle frames
+//               : at a lower rate.
+//========================================================================================
+
+#ifndef PROGRESSIVE_AA_H
+#define PROGRESSIVE_AA_H
+
+#include <GL/glew.h>
+
+#include <ostream>
+
+class ProgressiveAA
+{
+public:
+    static const int MAX_SAMPLES = 256;
+    static const int DEFAULT_SAMPLES = 32;
+
+    ProgressiveAA();
+
+    // accumulateProgram copies a texel of "sceneTexture" (see accumulateFragmentShaderSource in main)
+    bool Create(int width, int height, GLuint accumulateProgram);
+    bool Resize(int width, int height);     // restarts the accumulation
+    void Destroy();
+    bool IsCreated() const      { return historyFramebuffer != 0; }
+
+    void SetEnabled(bool enabled);
+    bool IsEnabled() const      { return enabled; }
+    void SetSampleCount(int samples);
+    int GetSampleCount() const  { return sampleCount; }
+    int GetAccumulatedSamples() const   { return samples; }
+    bool IsConverged() const    { return enabled && samples >= sampleCount; }
+    void Reset()                { samples = 0; }
+
+    // FNV-1a, for the state hash; chain calls through hash
+    static unsigned long long Hash(const void* data, size_t bytes, unsigned long long hash = 14695981039346656037ull);
+
+    // before anything is drawn: stateHash covers everything that moves the image without being drawn differently
+    // (camera, lights, settings). Picks this frame's subpixel offset
+    void BeginFrame(unsigned long long stateHash);
+    // column-major 4x4 projection, offset by this frame's subpixel jitter (copied unchanged when not jittering)
+    void JitterProjection(const float* projection, float* jittered) const;
+    // after the frame is drawn into the scene framebuffer, with the state hash taken again: adds it to the history
+    // and replaces the scene color with the average
+    void Accumulate(GLuint sceneFramebuffer, GLuint sceneColorTexture, unsigned long long stateHash);
+
+    void PrintStats(std::ostream& out) const;
+
+private:
+    bool CreateTargets();
+    void DestroyTargets();
+    static float Halton(int index, int base);
+
+    int width;
+    int height;
+    GLuint accumulateProgram;
+    GLuint emptyVao;
+    GLuint history;
+    GLuint historyFramebuffer;
+
+    bool enabled;
+    int sampleCount;
+    int samples;                            // frames averaged in the history
+    float jitterX;                          // this frame's offset, in pixels
+    float jitterY;
+    unsigned long long stateHash;
+    unsigned long long restarts;
+    unsigned long long convergedFrames;
+};
+
+#endif
@@ -0,0 +1,445 @@
+//========================================================================================
+// Filename      : ReflectionProbes.cpp
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Implementation of the ReflectionProbes class (see ReflectionProbes.h)
+//========================================================================================
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+#include <glm/glm.hpp>
+#include <glm/gtx/transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "ReflectionProbes.h"
+
+namespace
+{
+    // CLN: the casters a probe sees, and the near plane of its faces (scene units)
+    const float CAPTURE_DISTANCE = 30.0f;
+    const float CAPTURE_NEAR = 0.05f;
+
+    // CLN: view direction and up of each cube map face, in the GL_TEXTURE_CUBE_MAP_POSITIVE_X + face order
+    const glm::vec3 FACE_DIRECTIONS[6] = { glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f),
+                                           glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 0.0f, -1.0f) };
+    const glm::vec3 FACE_UPS[6] = { glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f),
+                                    glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f) };
+
+    unsigned long long HashBytes(const void* data, size_t bytes, unsigned long long hash = 14695981039346656037ull)
+    {
+        // CLN: FNV-1a
+        const unsigned char* bytesIn = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < bytes; ++i)
+            hash = (hash ^ bytesIn[i]) * 1099511628211ull;
+        return hash;
+    }
+
+    // CLN: the per-caster hashes are summed (the draw order changes with the camera), so each is scrambled first to
+    //      keep similar ones from cancelling out (the splitmix64 finalizer)
+    unsigned long long Scramble(unsigned long long hash)
+    {
+        hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ull;
+        hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBull;
+        return hash ^ (hash >> 31);
+    }
+
+    float Distance(const float* a, const float* b)
+    {
+        const float x = a[0] - b[0], y = a[1] - b[1], z = a[2] - b[2];
+        return sqrtf(x * x + y * y + z * z);
+    }
+}
+
+
+ReflectionProbes::ReflectionProbes()
+    : captureProgram(0), size(DEFAULT_SIZE), mipLevels(1), facesPerFrame(DEFAULT_FACES_PER_FRAME), enabled(false), texture(0),
+      framebuffer(0), depthBuffer(0), gpuTimer("reflection probe updates"), frame(0), queued(false), current(-1), nextFace(0),
+      updates(0), dynamicUpdates(0), facesRendered(0), framesWithFaces(0), casterDraws(0), lastFrameFaces(0),
+      totalUpdateMs(0.0), totalTrackingMs(0.0), trackedFrames(0)
+{
+}
+
+
+bool ReflectionProbes::Create(GLuint captureProgram, int size, int facesPerFrame)
+{
+    this->captureProgram = captureProgram;
+    this->size = std::max(size, 8);
+    this->facesPerFrame = std::max(facesPerFrame, 1);
+    mipLevels = 1;
+    while ((this->size >> mipLevels) > 0)
+        ++mipLevels;
+
+    // CLN: every probe's six faces are layers of one array; the mips (glGenerateMipmap's box filter) stand in for the
+    //      blurrier reflections of broader highlights, and seamless filtering keeps their face edges from showing
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, texture);
+    glTexStorage3D(GL_TEXTURE_CUBE_MAP_ARRAY, mipLevels, GL_R11F_G11F_B10F, this->size, this->size, 6 * MAX_PROBES);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, 0);
+    glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+
+    glGenRenderbuffers(1, &depthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, this->size, this->size);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, texture, 0, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+    const bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if (!complete)
+    {
+        std::cout << "Failed to create the reflection probe targets (" << this->size << " x " << this->size << ")" << std::endl;
+        Destroy();
+        return false;
+    }
+
+    glUseProgram(captureProgram);
+    glUniform1i(glGetUniformLocation(captureProgram, "uTextureBase"), 0);
+    glUseProgram(0);
+    enabled = true;
+    return true;
+}
+
+
+void ReflectionProbes::Destroy()
+{
+    glDeleteFramebuffers(1, &framebuffer);
+    glDeleteRenderbuffers(1, &depthBuffer);
+    glDeleteTextures(1, &texture);
+    framebuffer = depthBuffer = texture = 0;
+    gpuTimer.Destroy();
+    enabled = false;
+}
+
+
+int ReflectionProbes::AddProbe(const float* center, float radius, const void* owner)
+{
+    if ((int)probes.size() >= MAX_PROBES)
+        return -1;
+
+    Probe probe = {};
+    memcpy(probe.center, center, sizeof(probe.center));
+    probe.radius = radius;
+    probe.owner = owner;
+    probes.push_back(probe);
+    return (int)probes.size() - 1;
+}
+
+
+void ReflectionProbes::AddProgram(GLuint program)
+{
+    ProgramUniforms uniforms;
+    uniforms.program = program;
+    uniforms.probeCount = glGetUniformLocation(program, "probeCount");
+    uniforms.probeSpheres = glGetUniformLocation(program, "probeSpheres");
+    uniforms.probeEyePosition = glGetUniformLocation(program, "probeEyePosition");
+    programs.push_back(uniforms);
+
+    // CLN: the sampler is pointed at its unit even with no probes: left at 0 it would clash with uTextureBase
+    glProgramUniform1i(program, glGetUniformLocation(program, "probeTexture"), PROBE_TEXTURE_UNIT);
+    glProgramUniform1i(program, uniforms.probeCount, 0);
+}
+
+
+void ReflectionProbes::BeginFrame(const float* eyePosition)
+{
+    casters.clear();
+
+    const GLint probeCount = enabled ? (GLint)probes.size() : 0;
+    float spheres[4 * MAX_PROBES];
+    for (size_t i = 0; i < probes.size(); ++i)
+    {
+        memcpy(&spheres[i * 4], probes[i].center, sizeof(probes[i].center));
+        spheres[i * 4 + 3] = probes[i].captured ? probes[i].radius : 0.0f;
+    }
+    for (const ProgramUniforms& uniforms : programs)
+    {
+        glProgramUniform1i(uniforms.program, uniforms.probeCount, probeCount);
+        if (probeCount == 0)
+            continue;
+        glProgramUniform4fv(uniforms.program, uniforms.probeSpheres, probeCount, spheres);
+        glProgramUniform3fv(uniforms.program, uniforms.probeEyePosition, 1, eyePosition);
+    }
+
+    if (enabled)
+    {
+        glActiveTexture(GL_TEXTURE0 + PROBE_TEXTURE_UNIT);
+        glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, texture);
+        glActiveTexture(GL_TEXTURE0);
+    }
+}
+
+
+void ReflectionProbes::AddCaster(const void* owner, GLuint vao, GLuint indexCount, GLuint texture, int materialSlot,
+                                 const float* model, float radius, const float* lightPosition, const float* lightColor)
+{
+    if (!enabled)
+        return;
+
+    // CLN: left out before anything is copied or hashed if no probe sees it (the widest test in EndFrame())
+    bool seen = false;
+    for (const Probe& probe : probes)
+        seen = seen || (owner != probe.owner && (radius <= 0.0f || Distance(model + 12, probe.center) - radius < CAPTURE_DISTANCE));
+    if (!seen)
+        return;
+
+    Caster caster;
+    caster.owner = owner;
+    caster.vao = vao;
+    caster.indexCount = indexCount;
+    caster.texture = texture;
+    caster.materialSlot = materialSlot;
+    memcpy(caster.model, model, sizeof(caster.model));
+    memcpy(caster.center, model + 12, sizeof(caster.center));
+    caster.radius = radius;
+    memcpy(caster.lightPosition, lightPosition, sizeof(caster.lightPosition));
+    memcpy(caster.lightColor, lightColor, sizeof(caster.lightColor));
+
+    const GLuint drawState[4] = { vao, indexCount, texture, (GLuint)materialSlot };
+    caster.geometryHash = Scramble(HashBytes(caster.model, sizeof(caster.model), HashBytes(drawState, sizeof(drawState))));
+    const unsigned long long lightHash = HashBytes(caster.lightColor, sizeof(caster.lightColor),
+                                                   HashBytes(caster.lightPosition, sizeof(caster.lightPosition)));
+    caster.contentHash = Scramble(caster.geometryHash ^ lightHash);
+    casters.push_back(caster);
+}
+
+
+void ReflectionProbes::EndFrame(FrameScheduler& scheduler)
+{
+    if (!enabled)
+        return;
+
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    bool anyStale = false;
+    for (Probe& probe : probes)
+    {
+        // CLN: what the probe sees (its faces reach CAPTURE_DISTANCE), and what is inside its sphere
+        unsigned long long content = 0, inside = 0;
+        for (const Caster& caster : casters)
+        {
+            if (caster.owner == probe.owner)
+                continue;
+            const float distance = caster.radius > 0.0f ? Distance(caster.center, probe.center) - caster.radius : 0.0f;
+            if (distance < CAPTURE_DISTANCE)
+                content += caster.contentHash;
+            if (distance < probe.radius)
+                inside += caster.geometryHash;
+        }
+
+        probe.dynamic = probe.hasInsideHash && inside != probe.insideHash;
+        probe.insideHash = inside;
+        probe.hasInsideHash = true;
+        probe.contentHash = content;
+
+        const bool stale = !probe.captured || content != probe.capturedHash;
+        if (stale && !probe.stale)
+            probe.staleSince = frame;
+        probe.stale = stale;
+        anyStale = anyStale || stale;
+    }
+    ++frame;
+
+    // CLN: one scheduler item per frame draws the next faces; a step that didn't finish would be run again in the
+    //      same frame (the scheduler resumes it while budget is left), so each step finishes and is queued anew here
+    if (anyStale && !queued)
+    {
+        queued = true;
+        scheduler.Enqueue("reflection probes", WORK_PRIORITY_NORMAL, [this](const FrameDeadline& deadline) { return Update(deadline); },
+                          [this] { queued = false; current = -1; });
+    }
+
+    totalTrackingMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    ++trackedFrames;
+}
+
+
+int ReflectionProbes::PickProbe() const
+{
+    // CLN: the longest waiting stale probe, counting those with moving geometry inside as DYNAMIC_PRIORITY_FRAMES older
+    int best = -1;
+    unsigned long long bestWait = 0;
+    for (size_t i = 0; i < probes.size(); ++i)
+    {
+        const Probe& probe = probes[i];
+        if (!probe.stale)
+            continue;
+        const unsigned long long wait = frame - probe.staleSince + (probe.dynamic ? DYNAMIC_PRIORITY_FRAMES : 0);
+        if (best < 0 || wait > bestWait)
+        {
+            best = (int)i;
+            bestWait = wait;
+        }
+    }
+    return best;
+}
+
+
+bool ReflectionProbes::Update(const FrameDeadline& deadline)
+{
+    if (!enabled)
+    {
+        current = -1;
+        queued = false;
+        return true;
+    }
+
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    // CLN: (the scheduler runs before the frame's passes, but the state is put back as found anyway)
+    GLint previousFramebuffer = 0;
+    GLint previousViewport[4];
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebuffer);
+    glGetIntegerv(GL_VIEWPORT, previousViewport);
+    const GLboolean blending = glIsEnabled(GL_BLEND);
+    GLboolean depthWrites = GL_TRUE;
+    glGetBooleanv(GL_DEPTH_WRITEMASK, &depthWrites);
+
+    gpuTimer.Begin();
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(0, 0, size, size);
+    glEnable(GL_DEPTH_TEST);
+    glDisable(GL_BLEND);
+    glDepthMask(GL_TRUE);
+    glUseProgram(captureProgram);
+
+    int faces = 0;
+    while (faces < facesPerFrame)
+    {
+        if (current < 0)
+        {
+            current = PickProbe();
+            if (current < 0)
+                break;
+            nextFace = 0;
+            probes[current].capturingHash = probes[current].contentHash;
+        }
+
+        RenderFace(current, nextFace);
+        ++faces;
+        if (++nextFace == 6)
+        {
+            // CLN: the faces were drawn into level 0 of the whole array, so the mips are rebuilt for every probe
+            glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, texture);
+            glGenerateMipmap(GL_TEXTURE_CUBE_MAP_ARRAY);
+            glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, 0);
+
+            Probe& probe = probes[current];
+            probe.captured = true;
+            probe.capturedHash = probe.capturingHash;
+            probe.stale = false;    // CLN: EndFrame() makes it stale again, and last in line, if it changed since
+            ++updates;
+            if (probe.dynamic)
+                ++dynamicUpdates;
+            current = -1;
+        }
+        if (deadline.Expired())
+            break;
+    }
+
+    glBindVertexArray(0);
+    glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+    glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+    if (blending)
+        glEnable(GL_BLEND);
+    glDepthMask(depthWrites);
+    gpuTimer.End();
+
+    lastFrameFaces = faces;
+    facesRendered += faces;
+    if (faces > 0)
+        ++framesWithFaces;
+    totalUpdateMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    queued = false;
+    return true;
+}
+
+
+void ReflectionProbes::RenderFace(int index, int face)
+{
+    const Probe& probe = probes[index];
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, texture, 0, index * 6 + face);
+    const GLfloat background[4] = { 0.0f, 0.0f, 0.0f, 1.0f };  // CLN: the scene's clear color
+    const GLfloat farDepth = 1.0f;
+    glClearBufferfv(GL_COLOR, 0, background);
+    glClearBufferfv(GL_DEPTH, 0, &farDepth);
+
+    const glm::vec3 center = glm::make_vec3(probe.center);
+    const glm::vec3 direction = FACE_DIRECTIONS[face];
+    const glm::vec3 up = FACE_UPS[face];
+    const glm::vec3 right = glm::cross(direction, up);
+    const glm::mat4 view = glm::lookAt(center, center + direction, up);
+    const glm::mat4 projection = glm::perspective(glm::radians(90.0f), 1.0f, CAPTURE_NEAR, CAPTURE_DISTANCE);
+    glUniformMatrix4fv(glGetUniformLocation(captureProgram, "view"), 1, GL_FALSE, glm::value_ptr(view));
+    glUniformMatrix4fv(glGetUniformLocation(captureProgram, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+
+    const GLint modelLocation = glGetUniformLocation(captureProgram, "model");
+    const GLint lightColorLocation = glGetUniformLocation(captureProgram, "lightColor");
+    const GLint lightPositionLocation = glGetUniformLocation(captureProgram, "lightPos");
+    const GLint materialLocation = glGetUniformLocation(captureProgram, "materialIndex");
+    const float sideSlack = sqrtf(2.0f);
+    glActiveTexture(GL_TEXTURE0);
+    for (const Caster& caster : casters)
+    {
+        if (caster.owner == probe.owner)
+            continue;
+
+        // CLN: bounding sphere against the face's 90 degree frustum (its side planes are at 45 degrees to the axis)
+        if (caster.radius > 0.0f)
+        {
+            const glm::vec3 offset = glm::make_vec3(caster.center) - center;
+            const float depth = glm::dot(offset, direction);
+            const float across = fabsf(glm::dot(offset, right));
+            const float along = fabsf(glm::dot(offset, up));
+            const float slack = caster.radius * sideSlack;
+            if (depth - caster.radius > CAPTURE_DISTANCE || depth - across < -slack || depth - along < -slack)
+                continue;
+        }
+
+        glUniformMatrix4fv(modelLocation, 1, GL_FALSE, caster.model);
+        glUniform3fv(lightColorLocation, 1, caster.lightColor);
+        glUniform3fv(lightPositionLocation, 1, caster.lightPosition);
+        glUniform1i(materialLocation, caster.materialSlot);
+        glBindTexture(GL_TEXTURE_2D, caster.texture);
+        glBindVertexArray(caster.vao);
+        glDrawElements(GL_TRIANGLES, caster.indexCount, GL_UNSIGNED_SHORT, NULL);
+        ++casterDraws;
+    }
+}
+
+
+void ReflectionProbes::PrintStats(std::ostream& out, double budgetMs) const
+{
+    if (!enabled)
+    {
+        out << "INFO: Reflection probes off" << std::endl;
+        return;
+    }
+
+    const double updateMs = framesWithFaces > 0 ? totalUpdateMs / framesWithFaces : 0.0;
+    const std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(3)
+        << "INFO: Reflection probes: " << probes.size() << " probe(s) of " << size << " x " << size << " x 6 (" << mipLevels
+        << " mip levels), at most " << facesPerFrame << " face(s) per frame; " << updates << " update(s) (" << dynamicUpdates
+        << " for moving objects), " << facesRendered << " face(s) with " << casterDraws << " draw(s), " << lastFrameFaces
+        << " face(s) last frame\n"
+        << "      cost: " << updateMs << " ms CPU per frame with faces (" << (budgetMs > 0.0 ? 100.0 * updateMs / budgetMs : 0.0)
+        << "% of the " << budgetMs << " ms scheduler budget), " << (trackedFrames > 0 ? totalTrackingMs / trackedFrames : 0.0)
+        << " ms CPU per frame tracking the casters, GPU " << gpuTimer.GetAverageMs() << " ms average per frame with faces"
+        << std::endl;
+    out.unsetf(std::ios_base::floatfield);
+    out.precision(precision);
+}
@@ -0,0 +1,164 @@
+//========================================================================================
+// Filename      : ReflectionProbes.h
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Cube map reflection probes for the shiny surfaces of the scene (the
+//               : marble plane and the can). Each probe is a point with a sphere of
+//               : influence; the Phong shader reflects the view ray of a fragment
+//               : inside a sphere off the sphere's inside, as seen from the probe, and
+//               : takes the color from the probe's cube map at a mip level as blurry as
+//               : the material's highlight (see MaterialLibrary.h).
+//               :
+//               : Nothing is rendered for a probe per frame by default. The regular
+//               : render path reports the scene objects it draws (AddCaster(); the
+//               : stress objects and proxies aren't reflected), and at the end of
+//               : the frame every probe hashes the casters it can see: when that
+//               : changes, the probe is stale and an update is queued with the frame
+//               : scheduler, which re-renders at most facesPerFrame cube faces per frame
+//               : (one by default) within its time budget, so the cost shows in the
+//               : scheduler's stats. Faces are drawn from last frame's casters with
+//               : the cheap diffuse shader into a reduced-size face, and the mip chain
+//               : is regenerated once all six faces of a probe are done.
+//               :
+//               : Stale probes are updated round-robin, the longest waiting first. A
+//               : probe whose sphere holds geometry that moved since the last frame
+//               : counts as DYNAMIC_PRIORITY_FRAMES frames older, so reflections of
+//               : moving objects catch up first, but no probe waits forever.
+//               :
+//               : All probes share one cube map array; the shaders read it through
+//               : probeTexture on PROBE_TEXTURE_UNIT, and probeSpheres (the radius stays
+//               : 0 until a probe has been captured once). The programs that reflect are
+//               : registered with AddProgram(), and BeginFrame() sets their uniforms and
+//               : binds the array once per frame, not per draw.
+//========================================================================================
+
+#ifndef REFLECTION_PROBES_H
+#define REFLECTION_PROBES_H
+
+#include <GL/glew.h>
+
+#include <ostream>
+#include <vector>
+
+#include "FrameScheduler.h"
+#include "GpuTimer.h"
+
+class ReflectionProbes
+{
+public:
+    static const int MAX_PROBES = 8;                    // size of probeSpheres[] in the shaders
+    static const int DEFAULT_SIZE = 128;                // texels per side of a cube face
+    static const int DEFAULT_FACES_PER_FRAME = 1;
+    static const int PROBE_TEXTURE_UNIT = 3;
+    static const int DYNAMIC_PRIORITY_FRAMES = 30;
+
+    ReflectionProbes();
+
+    // captureProgram draws the casters into the faces (vertexShaderSource with the diffuse-only fragment shader in
+    // main; the uniforms of the Phong shader)
+    bool Create(GLuint captureProgram, int size, int facesPerFrame);
+    void Destroy();
+    bool IsCreated() const      { return texture != 0; }
+
+    void SetEnabled(bool enabled)   { this->enabled = enabled && IsCreated(); }
+    bool IsEnabled() const          { return enabled; }
+
+    // center and radius of the sphere of influence; casters reported with this owner are left out of the probe (a
+    // surface doesn't reflect itself). Returns the probe's index, -1 when all MAX_PROBES are in use
+    int AddProbe(const float* center, float radius, const void* owner);
+
+    // a program with the probe uniforms of the Phong shader (any shading program may be added, created or not)
+    void AddProgram(GLuint program);
+
+    // Main thread. BeginFrame() sets the uniforms of the added programs (eyePosition is the camera the reflections
+    // are seen from) and forgets last frame's casters, so between it and EndFrame() the regular render path reports
+    // the opaque draws of the scene objects: column-major model matrix, and radius the world bounding sphere around
+    // the model's origin (0 if unknown: always seen). A caster no probe sees is dropped. EndFrame() queues the
+    // updates of the probes whose view changed
+    void BeginFrame(const float* eyePosition);
+    void AddCaster(const void* owner, GLuint vao, GLuint indexCount, GLuint texture, int materialSlot, const float* model,
+                   float radius, const float* lightPosition, const float* lightColor);
+    void EndFrame(FrameScheduler& scheduler);
+
+    // probes finished since the start, changes whenever a reflection does
+    unsigned long long GetUpdateCount() const   { return updates; }
+    // budgetMs: the frame scheduler's, for the probes' share of it
+    void PrintStats(std::ostream& out, double budgetMs) const;
+
+private:
+    struct ProgramUniforms
+    {
+        GLuint program;
+        GLint probeCount;
+        GLint probeSpheres;
+        GLint probeEyePosition;
+    };
+
+    struct Caster
+    {
+        const void* owner;
+        GLuint vao;
+        GLuint indexCount;
+        GLuint texture;
+        int materialSlot;
+        float model[16];
+        float center[3];
+        float radius;
+        float lightPosition[3];
+        float lightColor[3];
+        unsigned long long geometryHash;    // mesh, texture, material and transform
+        unsigned long long contentHash;     // and the light
+    };
+
+    struct Probe
+    {
+        float center[3];
+        float radius;
+        const void* owner;
+        bool captured;                      // all six faces drawn at least once
+        bool stale;                         // sees something else than when last captured
+        bool dynamic;                       // the geometry inside the sphere changed last frame
+        bool hasInsideHash;
+        unsigned long long staleSince;      // frame it became stale
+        unsigned long long contentHash;     // of the casters it sees, last frame
+        unsigned long long insideHash;      // of the geometry inside the sphere, last frame
+        unsigned long long capturingHash;   // contentHash when its current update started
+        unsigned long long capturedHash;
+    };
+
+    bool Update(const FrameDeadline& deadline);
+    int PickProbe() const;
+    void RenderFace(int probe, int face);
+
+    GLuint captureProgram;
+    int size;
+    int mipLevels;
+    int facesPerFrame;
+    bool enabled;
+    GLuint texture;
+    GLuint framebuffer;
+    GLuint depthBuffer;
+    GpuTimer gpuTimer;
+
+    std::vector<ProgramUniforms> programs;
+    std::vector<Probe> probes;
+    std::vector<Caster> casters;            // of the last frame
+    unsigned long long frame;
+    bool queued;                            // an update is in the scheduler's queue
+    int current;                            // probe being updated, -1 if none
+    int nextFace;
+
+    // stats
+    unsigned long long updates;
+    unsigned long long dynamicUpdates;
+    unsigned long long facesRendered;
+    unsigned long long framesWithFaces;
+    unsigned long long casterDraws;         // draw calls of the faces
+    int lastFrameFaces;
+    double totalUpdateMs;                   // CPU, inside the scheduler's budget
+    double totalTrackingMs;                 // CPU, hashing the casters in EndFrame()
+    unsigned long long trackedFrames;
+};
+
+#endif
@@ -0,0 +1,223 @@
+//========================================================================================
+// Filename      : ReprojectionCache.cpp
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Implementation of the ReprojectionCache class (see ReprojectionCache.h)
+//========================================================================================
+
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+#include "ReprojectionCache.h"
+
+namespace
+{
+    // CLN: a surface distance below zero is never reused (cleared pixels and the shaders that don't cache)
+    const GLfloat INVALID_SURFACE[4] = { 0.0f, 0.0f, 0.0f, -1.0f };
+
+    GLuint CreateTexture(GLenum internalFormat, int width, int height)
+    {
+        GLuint texture;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexStorage2D(GL_TEXTURE_2D, 1, internalFormat, width, height);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        return texture;
+    }
+}
+
+
+ReprojectionCache::ReprojectionCache()
+    : width(0), height(0), counterBuffer(0), current(0), frame(0), refreshPeriod(8), active(false), lightingVersion(0)
+{
+    shading[0] = shading[1] = 0;
+    surface[0] = surface[1] = 0;
+    memset(viewProjection, 0, sizeof(viewProjection));
+    memset(previousViewProjection, 0, sizeof(previousViewProjection));
+    memset(cameraPosition, 0, sizeof(cameraPosition));
+    memset(previousCameraPosition, 0, sizeof(previousCameraPosition));
+}
+
+
+bool ReprojectionCache::Create(int width, int height)
+{
+    this->width = width;
+    this->height = height;
+
+    glGenBuffers(1, &counterBuffer);
+    glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, counterBuffer);
+    glBufferData(GL_ATOMIC_COUNTER_BUFFER, 2 * sizeof(GLuint), NULL, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, 0);
+
+    return CreateTargets();
+}
+
+
+bool ReprojectionCache::Resize(int width, int height)
+{
+    if (!IsCreated() || (width == this->width && height == this->height) || width <= 0 || height <= 0)
+        return true;
+
+    this->width = width;
+    this->height = height;
+    DestroyTargets();
+    return CreateTargets();
+}
+
+
+void ReprojectionCache::Destroy()
+{
+    DestroyTargets();
+    glDeleteBuffers(1, &counterBuffer);
+    counterBuffer = 0;
+}
+
+
+bool ReprojectionCache::CreateTargets()
+{
+    while (glGetError() != GL_NO_ERROR) {}  // CLN: so only errors from here on are checked below
+
+    for (int i = 0; i < 2; ++i)
+    {
+        shading[i] = CreateTexture(GL_RGBA8, width, height);
+        surface[i] = CreateTexture(GL_RGBA16F, width, height);
+    }
+    Invalidate();
+
+    if (glGetError() != GL_NO_ERROR)
+    {
+        std::cout << "Failed to create the reprojection cache targets (" << width << " x " << height << ")" << std::endl;
+        DestroyTargets();
+        return false;
+    }
+    return true;
+}
+
+
+void ReprojectionCache::DestroyTargets()
+{
+    glDeleteTextures(2, shading);
+    glDeleteTextures(2, surface);
+    shading[0] = shading[1] = 0;
+    surface[0] = surface[1] = 0;
+}
+
+
+void ReprojectionCache::Invalidate()
+{
+    for (int i = 0; i < 2; ++i)
+    {
+        if (surface[i] != 0)
+            glClearTexImage(surface[i], 0, GL_RGBA, GL_FLOAT, INVALID_SURFACE);
+    }
+}
+
+
+void ReprojectionCache::AddProgram(GLuint program)
+{
+    ProgramUniforms uniforms;
+    uniforms.program = program;
+    uniforms.enabled = glGetUniformLocation(program, "reprojectionEnabled");
+    uniforms.previousViewProjection = glGetUniformLocation(program, "previousViewProjection");
+    uniforms.currentCameraPosition = glGetUniformLocation(program, "currentCameraPosition");
+    uniforms.previousCameraPosition = glGetUniformLocation(program, "previousCameraPosition");
+    uniforms.cacheFrame = glGetUniformLocation(program, "cacheFrame");
+    uniforms.refreshPeriod = glGetUniformLocation(program, "refreshPeriod");
+    programs.push_back(uniforms);
+
+    glProgramUniform1i(program, uniforms.enabled, GL_FALSE);
+    glProgramUniform1i(program, glGetUniformLocation(program, "cachedShadingTexture"), SHADING_TEXTURE_UNIT);
+    glProgramUniform1i(program, glGetUniformLocation(program, "cachedSurfaceTexture"), SURFACE_TEXTURE_UNIT);
+}
+
+
+void ReprojectionCache::BeginFrame(const float* viewProjection, const float* cameraPosition, unsigned long long lightingVersion)
+{
+    memcpy(this->viewProjection, viewProjection, sizeof(this->viewProjection));
+    memcpy(this->cameraPosition, cameraPosition, sizeof(this->cameraPosition));
+
+    // CLN: the shaders write this frame's surfaces to output 2; output 1 is the OIT revealage, unused here
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, surface[current], 0);
+    const GLenum drawBuffers[3] = { GL_COLOR_ATTACHMENT0, GL_NONE, GL_COLOR_ATTACHMENT2 };
+    glDrawBuffers(3, drawBuffers);
+    glClearBufferfv(GL_COLOR, 2, INVALID_SURFACE);
+
+    glActiveTexture(GL_TEXTURE0 + SHADING_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_2D, shading[1 - current]);
+    glActiveTexture(GL_TEXTURE0 + SURFACE_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_2D, surface[1 - current]);
+    glActiveTexture(GL_TEXTURE0);
+
+    const GLuint zero[2] = { 0, 0 };
+    glBindBufferBase(GL_ATOMIC_COUNTER_BUFFER, COUNTER_BINDING, counterBuffer);
+    glBufferSubData(GL_ATOMIC_COUNTER_BUFFER, 0, sizeof(zero), zero);
+
+    // CLN: last frame's colors were lit by other lights or materials: a refresh period of one reshades every tile
+    const bool relit = lightingVersion != this->lightingVersion;
+    this->lightingVersion = lightingVersion;
+    const GLint period = relit ? 1 : refreshPeriod;
+    const GLint cacheFrame = relit ? 0 : (GLint)(frame % (unsigned int)refreshPeriod);
+    for (const ProgramUniforms& uniforms : programs)
+    {
+        glProgramUniform1i(uniforms.program, uniforms.enabled, GL_TRUE);
+        glProgramUniformMatrix4fv(uniforms.program, uniforms.previousViewProjection, 1, GL_FALSE, previousViewProjection);
+        glProgramUniform3fv(uniforms.program, uniforms.currentCameraPosition, 1, cameraPosition);
+        glProgramUniform3fv(uniforms.program, uniforms.previousCameraPosition, 1, previousCameraPosition);
+        glProgramUniform1i(uniforms.program, uniforms.cacheFrame, cacheFrame);
+        glProgramUniform1i(uniforms.program, uniforms.refreshPeriod, period);
+    }
+
+    active = true;
+}
+
+
+void ReprojectionCache::EndFrame(GLuint sceneColorTexture)
+{
+    // CLN: the opaque color before the transparent layer is composited over it
+    glCopyImageSubData(sceneColorTexture, GL_TEXTURE_2D, 0, 0, 0, 0, shading[current], GL_TEXTURE_2D, 0, 0, 0, 0, width, height, 1);
+
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, 0, 0);
+    const GLenum drawBuffer = GL_COLOR_ATTACHMENT0;
+    glDrawBuffers(1, &drawBuffer);
+
+    memcpy(previousViewProjection, viewProjection, sizeof(viewProjection));
+    memcpy(previousCameraPosition, cameraPosition, sizeof(cameraPosition));
+    for (const ProgramUniforms& uniforms : programs)
+        glProgramUniform1i(uniforms.program, uniforms.enabled, GL_FALSE);
+    current = 1 - current;
+    ++frame;
+    active = false;
+}
+
+
+void ReprojectionCache::GetFragmentCounts(unsigned int& reused, unsigned int& shaded) const
+{
+    GLuint counts[2] = { 0, 0 };
+    glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, counterBuffer);
+    glGetBufferSubData(GL_ATOMIC_COUNTER_BUFFER, 0, sizeof(counts), counts);
+    glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, 0);
+    reused = counts[0];
+    shaded = counts[1];
+}
+
+
+void ReprojectionCache::PrintStats(std::ostream& out) const
+{
+    unsigned int reused, shaded;
+    GetFragmentCounts(reused, shaded);
+    const double ratio = reused + shaded > 0 ? 100.0 * reused / (reused + shaded) : 0.0;
+
+    const std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(1)
+        << "INFO: Reprojection cache: " << ratio << "% of the Phong fragments reused in the last frame ("
+        << reused << " reused, " << shaded << " shaded), every tile refreshed each " << refreshPeriod << " frames\n";
+    out.unsetf(std::ios::floatfield);
+    out.precision(precision);
+    out.flush();
+}
@@ -0,0 +1,98 @@
+//========================================================================================
+// Filename      : ReprojectionCache.h
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Reverse reprojection cache for the opaque shading (Nehab et al.).
+//               : Each frame keeps two screen-sized targets:
+//               :    shading (RGBA8)  : the lit opaque color, copied from the scene color
+//               :    surface (RGBA16F): world normal and distance to the camera, written by
+//               :                       the scene shaders as a third output (distance < 0
+//               :                       marks pixels that may not be reused)
+//               : The Phong fragment shader projects its world position with the previous
+//               : frame's projection * view, and if the surface stored there has the same
+//               : distance and normal it reuses the stored color instead of lighting the
+//               : fragment. Disoccluded pixels fail the test and are shaded as usual, and
+//               : every 8 x 8 tile is reshaded once per refresh period (staggered across
+//               : frames), so the view-dependent highlights catch up with the camera. A
+//               : frame whose lights or materials changed (the orbiting lamp) reuses nothing.
+//               :
+//               : Two atomic counters in the shader count the reused and shaded fragments
+//               : of the last frame for the reuse ratio.
+//========================================================================================
+
+#ifndef REPROJECTION_CACHE_H
+#define REPROJECTION_CACHE_H
+
+#include <GL/glew.h>
+
+#include <ostream>
+#include <vector>
+
+class ReprojectionCache
+{
+public:
+    // texture units of the previous frame's targets and the binding of the counter buffer
+    static const int SHADING_TEXTURE_UNIT = 1;
+    static const int SURFACE_TEXTURE_UNIT = 2;
+    static const int COUNTER_BINDING = 0;
+
+    ReprojectionCache();
+
+    bool Create(int width, int height);
+    bool Resize(int width, int height);
+    void Destroy();
+    bool IsCreated() const      { return counterBuffer != 0; }
+    void Invalidate();          // marks every cached pixel unusable, the next frame shades all of them
+
+    void SetRefreshPeriod(int frames)   { refreshPeriod = frames < 1 ? 1 : frames; }
+    int GetRefreshPeriod() const        { return refreshPeriod; }
+
+    // a program that reuses the shading (a Phong variant); its uniforms are set once per frame from here on
+    void AddProgram(GLuint program);
+
+    // Between these two, with the scene framebuffer bound: attaches this frame's surface target as color
+    // attachment 2, binds last frame's targets and sets the uniforms of the added programs. viewProjection
+    // is a column-major 4x4. lightingVersion changes whenever the lights or the materials do; a frame lit
+    // differently from the last reuses nothing, it lights every pixel again and caches it
+    void BeginFrame(const float* viewProjection, const float* cameraPosition, unsigned long long lightingVersion);
+    void EndFrame(GLuint sceneColorTexture);    // keeps the lit color, detaches, swaps the frames, turns reuse off
+
+    // reads back the counters of the last frame (waits for it to finish)
+    void GetFragmentCounts(unsigned int& reused, unsigned int& shaded) const;
+    void PrintStats(std::ostream& out) const;
+
+private:
+    struct ProgramUniforms
+    {
+        GLuint program;
+        GLint enabled;
+        GLint previousViewProjection;
+        GLint currentCameraPosition;
+        GLint previousCameraPosition;
+        GLint cacheFrame;
+        GLint refreshPeriod;
+    };
+
+    bool CreateTargets();
+    void DestroyTargets();
+
+    int width;
+    int height;
+    GLuint shading[2];
+    GLuint surface[2];
+    GLuint counterBuffer;
+    int current;                // index of the frame being drawn, 1 - current is the previous one
+    unsigned int frame;
+    int refreshPeriod;
+    bool active;                // between BeginFrame() and EndFrame()
+    unsigned long long lightingVersion;
+    std::vector<ProgramUniforms> programs;
+
+    float viewProjection[16];
+    float previousViewProjection[16];
+    float cameraPosition[3];
+    float previousCameraPosition[3];
+};
+
+#endif
@@ -0,0 +1,874 @@
+//========================================================================================
+// Filename      : SceneStreamer.cpp
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Implementation of StreamWorldWriter and SceneStreamer (see SceneStreamer.h)
+//               :
+//               : Cell file layout (native byte order, every block padded to 4 bytes):
+//               :    header  : "CEL1", version, cellX, cellZ, meshCount, textureCount, objectCount
+//               :    meshes  : floatCount, indexCount, floats, unsigned shorts
+//               :    textures: byteCount, encoded image bytes
+//               :    objects : mesh, texture, 16 floats (model matrix)
+//========================================================================================
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#include "SceneStreamer.h"
+#include "WorkerPool.h"
+#include "FrameScheduler.h"
+#include "stb_image.h"      // CLN: declarations only, STB_IMAGE_IMPLEMENTATION lives in the main source file
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    const char CELL_MAGIC[4] = { 'C', 'E', 'L', '1' };
+    const uint32_t CELL_VERSION = 1;
+    const char* const INDEX_FILENAME = "world.idx";
+
+    // CLN: rows of a texture are uploaded in bands of about this size so one large image can't blow the frame budget
+    const size_t TEXTURE_BAND_BYTES = 256 * 1024;
+
+    struct CellFileHeader
+    {
+        char magic[4];
+        uint32_t version;
+        int32_t cellX;
+        int32_t cellZ;
+        uint32_t meshCount;
+        uint32_t textureCount;
+        uint32_t objectCount;
+    };
+
+    void WritePadded(std::ofstream& file, const void* data, size_t bytes)
+    {
+        static const char zeros[4] = { 0, 0, 0, 0 };
+        file.write((const char*)data, bytes);
+        if (bytes % 4 != 0)
+            file.write(zeros, 4 - bytes % 4);
+    }
+
+    // Reads from a cell file that has been loaded into memory, fails instead of reading past the end
+    class CellReader
+    {
+    public:
+        CellReader(const std::vector<unsigned char>& bytes) : bytes(bytes), offset(0) {}
+
+        bool Read(void* data, size_t count)
+        {
+            if (count > bytes.size() - offset)
+                return false;
+            memcpy(data, &bytes[offset], count);
+            offset += (count + 3) & ~(size_t)3;
+            offset = std::min(offset, bytes.size());
+            return true;
+        }
+
+        template <typename T> bool ReadValue(T& value)  { return Read(&value, sizeof(T)); }
+
+        // whether count items of at least itemBytes each fit in what is left, checked before a count read from the
+        // file sizes anything, so a damaged count fails the load instead of allocating gigabytes
+        bool Holds(uint32_t count, size_t itemBytes) const  { return count <= (bytes.size() - offset) / itemBytes; }
+
+    private:
+        const std::vector<unsigned char>& bytes;
+        size_t offset;
+    };
+
+    void SetVertexLayout()
+    {
+        // CLN: same V/N/T layout as GLObject::CreateMesh()
+        const GLsizei stride = sizeof(float) * MeshData::FLOATS_PER_VERTEX;
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, 0);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(float) * 3));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(float) * 6));
+        glEnableVertexAttribArray(2);
+    }
+
+    // distance on the XZ plane from a point to the closest point of a cell
+    float CellDistance(const glm::vec3& center, float cellSize, const glm::vec3& point)
+    {
+        float dx = std::max(std::fabs(point.x - center.x) - cellSize * 0.5f, 0.0f);
+        float dz = std::max(std::fabs(point.z - center.z) - cellSize * 0.5f, 0.0f);
+        return std::sqrt(dx * dx + dz * dz);
+    }
+}
+
+
+//--------------------------------------------------------------------
+// StreamWorldWriter
+//--------------------------------------------------------------------
+StreamWorldWriter::StreamWorldWriter(const std::string& directory, float cellSize)
+    : directory(directory), cellSize(cellSize)
+{
+}
+
+
+bool StreamWorldWriter::AddCell(int cellX, int cellZ, const StreamCellContents& contents)
+{
+    std::ostringstream name;
+    name << "cell_" << cellX << "_" << cellZ << ".cell";
+
+    std::ofstream file(directory + "/" + name.str(), std::ios::binary);
+    if (!file)
+    {
+        std::cout << "Failed to create cell file " << directory << "/" << name.str() << std::endl;
+        return false;
+    }
+
+    CellFileHeader header;
+    memcpy(header.magic, CELL_MAGIC, sizeof(header.magic));
+    header.version = CELL_VERSION;
+    header.cellX = cellX;
+    header.cellZ = cellZ;
+    header.meshCount = (uint32_t)contents.meshes.size();
+    header.textureCount = (uint32_t)contents.textures.size();
+    header.objectCount = (uint32_t)contents.objects.size();
+    WritePadded(file, &header, sizeof(header));
+
+    for (const MeshData& mesh : contents.meshes)
+    {
+        uint32_t counts[2] = { (uint32_t)mesh.vertices.size(), (uint32_t)mesh.indices.size() };
+        WritePadded(file, counts, sizeof(counts));
+        WritePadded(file, mesh.vertices.data(), mesh.GetVertexBytes());
+        WritePadded(file, mesh.indices.data(), mesh.GetIndexBytes());
+    }
+
+    for (const std::vector<unsigned char>& texture : contents.textures)
+    {
+        uint32_t byteCount = (uint32_t)texture.size();
+        WritePadded(file, &byteCount, sizeof(byteCount));
+        WritePadded(file, texture.data(), texture.size());
+    }
+
+    for (const StreamObject& object : contents.objects)
+    {
+        uint32_t references[2] = { object.mesh, object.texture };
+        WritePadded(file, references, sizeof(references));
+        WritePadded(file, object.model, sizeof(object.model));
+    }
+
+    if (!file)
+        return false;
+
+    std::ostringstream line;
+    line << "cell " << cellX << " " << cellZ << " " << name.str();
+    indexLines.push_back(line.str());
+    return true;
+}
+
+
+bool StreamWorldWriter::Finish()
+{
+    std::ofstream index(directory + "/" + INDEX_FILENAME);
+    if (!index)
+    {
+        std::cout << "Failed to create " << directory << "/" << INDEX_FILENAME << std::endl;
+        return false;
+    }
+
+    index << "STREAMWORLD " << CELL_VERSION << "\n";
+    index << "cellsize " << cellSize << "\n";
+    for (const std::string& line : indexLines)
+        index << line << "\n";
+
+    return (bool)index;
+}
+
+
+bool StreamWorldWriter::ReadFileBytes(const std::string& filename, std::vector<unsigned char>& bytes)
+{
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file)
+        return false;
+
+    std::streamsize size = file.tellg();
+    file.seekg(0, std::ios::beg);
+    bytes.resize((size_t)size);
+    return (bool)file.read((char*)bytes.data(), size);
+}
+
+
+//--------------------------------------------------------------------
+// SceneStreamer
+//--------------------------------------------------------------------
+SceneStreamer::SceneStreamer(WorkerPool& pool, FrameScheduler& scheduler)
+    : pool(pool), scheduler(scheduler), cellSize(0.0f), drawRadius(40.0f), memoryBudget(256u * 1024 * 1024),
+      prefetchSeconds(1.5f), maxConcurrentLoads(4), lastPosition(0.0f), velocity(0.0f), hasLastPosition(false),
+      residentBytes(0), stagingBytes(0), peakBytes(0), loadsInFlight(0), cellsLoaded(0), cellsEvicted(0),
+      budgetEvictions(0), prefetchHits(0), popIns(0), totalPopInMs(0.0), worstPopInMs(0.0), missingCellFrames(0),
+      bytesRead(0.0)
+{
+}
+
+
+SceneStreamer::~SceneStreamer()
+{
+    // CLN: GL resources must be released with ReleaseAll() while the context is alive, only CPU copies are freed here
+    for (auto& entry : cells)
+        FreeStaging(*entry.second);
+}
+
+
+bool SceneStreamer::Open(const std::string& directory)
+{
+    std::ifstream index(directory + "/" + INDEX_FILENAME);
+    std::string tag;
+    unsigned int version = 0;
+    if (!index || !(index >> tag >> version) || tag != "STREAMWORLD" || version != CELL_VERSION)
+    {
+        std::cout << "Failed to open streaming world " << directory << std::endl;
+        return false;
+    }
+
+    this->directory = directory;
+    while (index >> tag)
+    {
+        if (tag == "cellsize")
+        {
+            index >> cellSize;
+        }
+        else if (tag == "cell")
+        {
+            CellPtr cell = std::make_shared<Cell>();
+            index >> cell->x >> cell->z >> cell->filename;
+            cell->state = CELL_UNLOADED;
+            cell->cancelled = false;
+            cell->meshesUploaded = 0;
+            cell->gpuBytes = 0;
+            cell->stagingBytes = 0;
+            cell->neededSince = -1.0;
+            cell->wasNeeded = false;
+            cells[std::make_pair(cell->x, cell->z)] = cell;
+        }
+    }
+
+    for (auto& entry : cells)
+        entry.second->center = glm::vec3((entry.second->x + 0.5f) * cellSize, 0.0f, (entry.second->z + 0.5f) * cellSize);
+
+    std::cout << "INFO: Streaming world " << directory << ": " << cells.size() << " cells of " << cellSize << " units" << std::endl;
+    return cellSize > 0.0f;
+}
+
+
+double SceneStreamer::NowMs() const
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+void SceneStreamer::Update(const glm::vec3& cameraPosition, const glm::vec3& cameraFront, float deltaTime)
+{
+    if (!IsOpen())
+        return;
+
+    // CLN: smoothed camera velocity, used to predict where the camera will be when a load finishes
+    if (hasLastPosition && deltaTime > 0.0f)
+        velocity = velocity * 0.8f + ((cameraPosition - lastPosition) / deltaTime) * 0.2f;
+    lastPosition = cameraPosition;
+    hasLastPosition = true;
+
+    const glm::vec3 predicted = cameraPosition + velocity * prefetchSeconds + cameraFront * (cellSize * 0.5f);
+    const float loadRadius = drawRadius + cellSize;
+    const float evictRadius = loadRadius + cellSize * 1.5f;     // CLN: hysteresis, so cells on the edge don't thrash
+    const double now = NowMs();
+
+    std::vector<std::pair<float, CellPtr> > loadCandidates;
+    std::vector<std::pair<float, CellPtr> > residentByDistance;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (auto& entry : cells)
+    {
+        const CellPtr& cell = entry.second;
+        float distance = CellDistance(cell->center, cellSize, cameraPosition);
+        float predictedDistance = CellDistance(cell->center, cellSize, predicted);
+        bool needed = distance <= drawRadius;
+
+        // pop-in tracking
+        if (needed)
+        {
+            if (cell->state != CELL_RESIDENT)
+            {
+                ++missingCellFrames;
+                if (cell->neededSince < 0.0)
+                    cell->neededSince = now;
+            }
+            else if (!cell->wasNeeded)
+            {
+                ++prefetchHits;
+            }
+        }
+        else
+        {
+            cell->neededSince = -1.0;
+        }
+        cell->wasNeeded = needed;
+
+        bool wanted = distance <= loadRadius || predictedDistance <= loadRadius;
+        if (cell->state == CELL_UNLOADED)
+        {
+            if (wanted)
+                loadCandidates.push_back(std::make_pair(std::min(distance, predictedDistance), cell));
+        }
+        else if (distance > evictRadius && predictedDistance > evictRadius)
+        {
+            Evict(cell);
+        }
+        else
+        {
+            if (wanted)
+                cell->cancelled = false;    // CLN: came back into range before the eviction took effect
+            if (cell->state == CELL_RESIDENT && !needed)
+                residentByDistance.push_back(std::make_pair(distance, cell));
+        }
+    }
+
+    // CLN: over the memory budget, give up the farthest cells that are not being drawn
+    std::sort(residentByDistance.begin(), residentByDistance.end(),
+              [](const std::pair<float, CellPtr>& a, const std::pair<float, CellPtr>& b) { return a.first > b.first; });
+    for (size_t i = 0; i < residentByDistance.size() && residentBytes + stagingBytes > memoryBudget; ++i)
+    {
+        Evict(residentByDistance[i].second);
+        ++budgetEvictions;
+    }
+
+    // CLN: closest (or soonest-reached) cells first, a few at a time, and only while under budget
+    std::sort(loadCandidates.begin(), loadCandidates.end(),
+              [](const std::pair<float, CellPtr>& a, const std::pair<float, CellPtr>& b) { return a.first < b.first; });
+    for (size_t i = 0; i < loadCandidates.size() && loadsInFlight < maxConcurrentLoads; ++i)
+    {
+        if (residentBytes + stagingBytes >= memoryBudget)
+            break;
+        RequestLoad(loadCandidates[i].second);
+    }
+}
+
+
+void SceneStreamer::RequestLoad(const CellPtr& cell)
+{
+    // CLN: called with the mutex held
+    cell->state = CELL_LOADING;
+    cell->cancelled = false;
+    ++loadsInFlight;
+
+    pool.Submit([this, cell] {
+        bool loaded = LoadCell(*cell);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        --loadsInFlight;
+        stagingBytes += cell->stagingBytes;
+        peakBytes = std::max(peakBytes, residentBytes + stagingBytes);
+
+        if (!loaded || cell->cancelled)
+        {
+            stagingBytes -= cell->stagingBytes;
+            FreeStaging(*cell);
+            cell->state = CELL_UNLOADED;
+            cell->cancelled = false;
+            return;
+        }
+
+        cell->state = CELL_UPLOADING;
+        std::ostringstream name;
+        name << "stream cell " << cell->x << "," << cell->z;
+        scheduler.Enqueue(name.str(), WORK_PRIORITY_NORMAL, [this, cell](const FrameDeadline& deadline) {
+            return UploadStep(cell, deadline.RemainingMs());
+        }, [this, cell] {
+            // CLN: dropped at exit, the step's cancelled path frees what was uploaded so far
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                cell->cancelled = true;
+            }
+            UploadStep(cell, 0.0);
+        });
+    });
+}
+
+
+bool SceneStreamer::LoadCell(Cell& cell)
+{
+    // CLN: worker thread, touches only this cell's CPU side
+    std::vector<unsigned char> bytes;
+    if (!StreamWorldWriter::ReadFileBytes(directory + "/" + cell.filename, bytes))
+    {
+        std::cout << "Failed to read cell file " << cell.filename << std::endl;
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        bytesRead += (double)bytes.size();
+    }
+
+    CellReader reader(bytes);
+    CellFileHeader header;
+    if (!reader.ReadValue(header) || memcmp(header.magic, CELL_MAGIC, sizeof(header.magic)) != 0 || header.version != CELL_VERSION)
+    {
+        std::cout << "Invalid cell file " << cell.filename << std::endl;
+        return false;
+    }
+
+    // CLN: (the smallest mesh, texture and object blocks: their counts, and a reference pair and matrix)
+    if (!reader.Holds(header.meshCount, 2 * sizeof(uint32_t)) || !reader.Holds(header.textureCount, sizeof(uint32_t)) ||
+        !reader.Holds(header.objectCount, 2 * sizeof(uint32_t) + 16 * sizeof(float)))
+    {
+        std::cout << "Invalid cell file " << cell.filename << std::endl;
+        return false;
+    }
+
+    StreamCellContents& contents = cell.contents;
+    contents.meshes.resize(header.meshCount);
+    for (MeshData& mesh : contents.meshes)
+    {
+        uint32_t counts[2];
+        if (!reader.Read(counts, sizeof(counts)) || !reader.Holds(counts[0], sizeof(float)) ||
+            !reader.Holds(counts[1], sizeof(unsigned short)))
+            return false;
+        mesh.vertices.resize(counts[0]);
+        mesh.indices.resize(counts[1]);
+        if (!reader.Read(mesh.vertices.data(), mesh.GetVertexBytes()) || !reader.Read(mesh.indices.data(), mesh.GetIndexBytes()))
+            return false;
+        cell.stagingBytes += mesh.GetVertexBytes() + mesh.GetIndexBytes();
+    }
+
+    // CLN: decode the images here so the main thread only has to copy pixels into textures
+    cell.textures.resize(header.textureCount);
+    stbi_set_flip_vertically_on_load_thread(true);
+    for (DecodedTexture& texture : cell.textures)
+    {
+        uint32_t byteCount = 0;
+        std::vector<unsigned char> encoded;
+        if (!reader.ReadValue(byteCount) || !reader.Holds(byteCount, 1))
+            return false;
+        encoded.resize(byteCount);
+        if (!reader.Read(encoded.data(), byteCount))
+            return false;
+
+        texture.id = 0;
+        texture.rowsUploaded = 0;
+        texture.pixels = stbi_load_from_memory(encoded.data(), (int)byteCount, &texture.width, &texture.height, &texture.channels, 0);
+        if (!texture.pixels || (texture.channels != 3 && texture.channels != 4))
+        {
+            std::cout << "Failed to decode texture in cell file " << cell.filename << std::endl;
+            return false;
+        }
+        cell.stagingBytes += (size_t)texture.width * texture.height * texture.channels;
+    }
+
+    contents.objects.resize(header.objectCount);
+    for (StreamObject& object : contents.objects)
+    {
+        uint32_t references[2];
+        if (!reader.Read(references, sizeof(references)) || !reader.Read(object.model, sizeof(object.model)))
+            return false;
+        object.mesh = references[0];
+        object.texture = references[1];
+        if (object.mesh >= header.meshCount)
+            return false;
+    }
+
+    return true;
+}
+
+
+bool SceneStreamer::UploadStep(const CellPtr& cellPtr, double budgetMs)
+{
+    Cell& cell = *cellPtr;
+    const double stepEnd = NowMs() + budgetMs;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (cell.cancelled)
+        {
+            FreeGpu(cell);
+            stagingBytes -= cell.stagingBytes;
+            FreeStaging(cell);
+            cell.state = CELL_UNLOADED;
+            cell.cancelled = false;
+            return true;
+        }
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    // CLN: textures first, in bands of rows, then one mesh at a time, until this frame's budget is spent
+    for (DecodedTexture& texture : cell.textures)
+    {
+        if (texture.rowsUploaded == texture.height)
+            continue;
+
+        GLenum format = texture.channels == 4 ? GL_RGBA : GL_RGB;
+        if (texture.id == 0)
+        {
+            glGenTextures(1, &texture.id);
+            glBindTexture(GL_TEXTURE_2D, texture.id);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexImage2D(GL_TEXTURE_2D, 0, texture.channels == 4 ? GL_RGBA8 : GL_RGB8, texture.width, texture.height, 0, format, GL_UNSIGNED_BYTE, NULL);
+        }
+        else
+        {
+            glBindTexture(GL_TEXTURE_2D, texture.id);
+        }
+
+        const size_t rowBytes = (size_t)texture.width * texture.channels;
+        const int bandRows = std::max(1, (int)(TEXTURE_BAND_BYTES / rowBytes));
+        while (texture.rowsUploaded < texture.height && NowMs() < stepEnd)
+        {
+            int rows = std::min(bandRows, texture.height - texture.rowsUploaded);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, texture.rowsUploaded, texture.width, rows, format, GL_UNSIGNED_BYTE,
+                            texture.pixels + rowBytes * texture.rowsUploaded);
+            texture.rowsUploaded += rows;
+        }
+
+        if (texture.rowsUploaded == texture.height)
+        {
+            glGenerateMipmap(GL_TEXTURE_2D);
+            cell.gpuBytes += rowBytes * texture.height * 4 / 3;     // CLN: level 0 plus the mip chain
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        if (texture.rowsUploaded < texture.height)
+        {
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            return false;
+        }
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    while (cell.meshesUploaded < cell.contents.meshes.size())
+    {
+        if (NowMs() >= stepEnd)
+            return false;
+
+        const MeshData& data = cell.contents.meshes[cell.meshesUploaded];
+        GpuMesh mesh;
+        glGenVertexArrays(1, &mesh.vao);
+        glBindVertexArray(mesh.vao);
+        glGenBuffers(2, mesh.vbos);
+        glBindBuffer(GL_ARRAY_BUFFER, mesh.vbos[0]);
+        glBufferData(GL_ARRAY_BUFFER, data.GetVertexBytes(), data.vertices.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.vbos[1]);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, data.GetIndexBytes(), data.indices.data(), GL_STATIC_DRAW);
+        SetVertexLayout();
+        glBindVertexArray(0);
+        mesh.indexCount = data.GetIndexCount();
+
+        cell.meshes.push_back(mesh);
+        cell.gpuBytes += data.GetVertexBytes() + data.GetIndexBytes();
+        ++cell.meshesUploaded;
+    }
+
+    // CLN: everything is on the GPU, keep only the object list on the CPU
+    std::lock_guard<std::mutex> lock(mutex);
+    stagingBytes -= cell.stagingBytes;
+    FreeStaging(cell);
+    residentBytes += cell.gpuBytes;
+    peakBytes = std::max(peakBytes, residentBytes + stagingBytes);
+    cell.state = CELL_RESIDENT;
+    ++cellsLoaded;
+
+    if (cell.neededSince >= 0.0)
+    {
+        double waitedMs = NowMs() - cell.neededSince;
+        ++popIns;
+        totalPopInMs += waitedMs;
+        worstPopInMs = std::max(worstPopInMs, waitedMs);
+        cell.neededSince = -1.0;
+    }
+    return true;
+}
+
+
+void SceneStreamer::Evict(const CellPtr& cell)
+{
+    // CLN: called with the mutex held. Cells still loading or uploading are cleaned up by their own job
+    if (cell->state == CELL_RESIDENT)
+    {
+        residentBytes -= cell->gpuBytes;
+        FreeGpu(*cell);
+        cell->state = CELL_UNLOADED;
+        ++cellsEvicted;
+    }
+    else if (cell->state != CELL_UNLOADED)
+    {
+        cell->cancelled = true;
+    }
+}
+
+
+void SceneStreamer::FreeGpu(Cell& cell)
+{
+    for (DecodedTexture& texture : cell.textures)
+    {
+        if (texture.pixels)
+            stbi_image_free(texture.pixels);    // CLN: a cell evicted mid-upload still holds decoded pixels
+        texture.pixels = nullptr;
+        if (texture.id != 0)
+            glDeleteTextures(1, &texture.id);
+        texture.id = 0;
+        texture.rowsUploaded = 0;
+    }
+    for (GpuMesh& mesh : cell.meshes)
+    {
+        glDeleteVertexArrays(1, &mesh.vao);
+        glDeleteBuffers(2, mesh.vbos);
+    }
+    cell.meshes.clear();
+    cell.textures.clear();
+    cell.contents.objects.clear();
+    cell.meshesUploaded = 0;
+    cell.gpuBytes = 0;
+}
+
+
+void SceneStreamer::FreeStaging(Cell& cell)
+{
+    // CLN: keep the texture ids and the object list, drop the pixel and vertex copies
+    for (DecodedTexture& texture : cell.textures)
+    {
+        if (texture.pixels)
+            stbi_image_free(texture.pixels);
+        texture.pixels = nullptr;
+    }
+    std::vector<MeshData>().swap(cell.contents.meshes);
+    std::vector<std::vector<unsigned char> >().swap(cell.contents.textures);
+    cell.stagingBytes = 0;
+}
+
+
+void SceneStreamer::Draw(const glm::vec3& cameraPosition, const DrawFunction& draw) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& entry : cells)
+    {
+        const Cell& cell = *entry.second;
+        if (cell.state != CELL_RESIDENT || CellDistance(cell.center, cellSize, cameraPosition) > drawRadius)
+            continue;
+
+        for (const StreamObject& object : cell.contents.objects)
+        {
+            GLuint texture = object.texture < cell.textures.size() ? cell.textures[object.texture].id : 0;
+            const GpuMesh& mesh = cell.meshes[object.mesh];
+            draw(mesh.vao, mesh.indexCount, texture, object.model);
+        }
+    }
+}
+
+
+void SceneStreamer::ReleaseAll()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& entry : cells)
+    {
+        FreeGpu(*entry.second);
+        FreeStaging(*entry.second);
+        entry.second->state = CELL_UNLOADED;
+    }
+    residentBytes = 0;
+    stagingBytes = 0;
+}
+
+
+void SceneStreamer::PrintStats(std::ostream& out)
+{
+    if (!IsOpen())
+        return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    unsigned int resident = 0;
+    for (const auto& entry : cells)
+    {
+        if (entry.second->state == CELL_RESIDENT)
+            ++resident;
+    }
+
+    const double mb = 1024.0 * 1024.0;
+    out << std::fixed << std::setprecision(2);
+    out << "INFO: Scene streaming (" << cells.size() << " cells, draw radius " << drawRadius << ")\n"
+        << "      resident cells   : " << resident << ", loads in flight " << loadsInFlight << "\n"
+        << "      memory           : " << (residentBytes + stagingBytes) / mb << " MB (GPU " << residentBytes / mb
+        << ", staging " << stagingBytes / mb << "), peak " << peakBytes / mb << " MB, budget " << memoryBudget / mb << " MB\n"
+        << "      loaded / evicted : " << cellsLoaded << " / " << cellsEvicted << " (" << budgetEvictions << " for budget), "
+        << bytesRead / mb << " MB read\n"
+        << "      camera velocity  : " << velocity.x << ", " << velocity.y << ", " << velocity.z << "\n"
+        << "      prefetched in time: " << prefetchHits << ", pop-ins: " << popIns << " (avg "
+        << (popIns > 0 ? totalPopInMs / popIns : 0.0) << " ms, worst " << worstPopInMs << " ms), missing cell-frames "
+        << missingCellFrames << std::endl;
+    out.unsetf(std::ios::floatfield);
+}
+
+
+bool SceneStreamer::SelfTest(std::ostream& out)
+{
+    bool passed = true;
+    auto check = [&out, &passed](bool condition, const char* what) {
+        if (!condition)
+        {
+            out << "Failed scene streamer self-test: " << what << std::endl;
+            passed = false;
+        }
+    };
+
+    // CLN: two meshes, a 1 x 1 RGBA PNG and three objects, in a cell of a scratch world
+    const std::string directory = "scene_streamer_self_test";
+#ifdef _WIN32
+    _mkdir(directory.c_str());
+#else
+    mkdir(directory.c_str(), 0755);
+#endif
+    static const unsigned char PNG_1X1[] = {
+        0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a, 0x00, 0x00, 0x00, 0x0d, 0x49, 0x48, 0x44, 0x52, 0x00, 0x00,
+        0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x08, 0x06, 0x00, 0x00, 0x00, 0x1f, 0x15, 0xc4, 0x89, 0x00, 0x00, 0x00,
+        0x0d, 0x49, 0x44, 0x41, 0x54, 0x78, 0x9c, 0x63, 0xf8, 0xdf, 0xe0, 0xf0, 0x1f, 0x00, 0x07, 0x00, 0x02, 0xbf,
+        0x2b, 0xd7, 0xc7, 0xe2, 0x00, 0x00, 0x00, 0x00, 0x49, 0x45, 0x4e, 0x44, 0xae, 0x42, 0x60, 0x82 };
+    StreamCellContents contents;
+    contents.meshes.resize(2);
+    for (size_t m = 0; m < contents.meshes.size(); ++m)
+    {
+        MeshData& mesh = contents.meshes[m];
+        mesh.vertices.resize((3 + m) * MeshData::FLOATS_PER_VERTEX);
+        for (size_t i = 0; i < mesh.vertices.size(); ++i)
+            mesh.vertices[i] = (float)(m * 100 + i) * 0.5f;
+        mesh.indices.resize(3 * (m + 1));
+        for (size_t i = 0; i < mesh.indices.size(); ++i)
+            mesh.indices[i] = (unsigned short)(i % (3 + m));
+    }
+    contents.textures.push_back(std::vector<unsigned char>(PNG_1X1, PNG_1X1 + sizeof(PNG_1X1)));
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+        StreamObject object;
+        object.mesh = i % 2;
+        object.texture = 0;
+        for (int k = 0; k < 16; ++k)
+            object.model[k] = (float)(i * 16 + k);
+        contents.objects.push_back(object);
+    }
+    StreamWorldWriter writer(directory, 10.0f);
+    check(writer.AddCell(0, 0, contents) && writer.Finish(), "the world could not be written");
+
+    WorkerPool pool(1);
+    FrameScheduler scheduler;
+    {
+        SceneStreamer streamer(pool, scheduler);
+        check(streamer.Open(directory) && streamer.cells.size() == 1, "the world could not be opened");
+        if (streamer.cells.size() != 1)
+            return false;
+        const CellPtr cell = streamer.cells.begin()->second;
+        const std::string filename = directory + "/" + cell->filename;
+        std::vector<unsigned char> written;
+        StreamWorldWriter::ReadFileBytes(filename, written);
+
+        // CLN: loads from scratch, as a fresh cell would
+        auto load = [&streamer, &cell] {
+            FreeStaging(*cell);
+            cell->textures.clear();
+            cell->contents.objects.clear();
+            return streamer.LoadCell(*cell);
+        };
+        auto rewrite = [&filename](const std::vector<unsigned char>& bytes, size_t size) {
+            std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+            file.write((const char*)bytes.data(), size);
+        };
+
+        // CLN: a round trip, with the texture decoded
+        bool same = load() && cell->contents.meshes.size() == contents.meshes.size() && cell->textures.size() == 1 &&
+                    cell->textures[0].width == 1 && cell->textures[0].height == 1 && cell->textures[0].channels == 4 &&
+                    cell->contents.objects.size() == contents.objects.size();
+        for (size_t m = 0; same && m < contents.meshes.size(); ++m)
+        {
+            same = cell->contents.meshes[m].vertices == contents.meshes[m].vertices &&
+                   cell->contents.meshes[m].indices == contents.meshes[m].indices;
+        }
+        for (size_t i = 0; same && i < contents.objects.size(); ++i)
+        {
+            const StreamObject& object = cell->contents.objects[i];
+            same = object.mesh == contents.objects[i].mesh && object.texture == 0 &&
+                   memcmp(object.model, contents.objects[i].model, sizeof(object.model)) == 0;
+        }
+        check(same, "a cell did not load back as written");
+
+        // CLN: every cut-off length fails
+        bool truncatedFailed = true;
+        for (size_t size = 0; size < written.size(); ++size)
+        {
+            rewrite(written, size);
+            truncatedFailed = truncatedFailed && !load();
+        }
+        check(truncatedFailed, "a truncated cell loaded");
+
+        // CLN: counts far beyond the file, in the header, the first mesh and the texture, fail before they are
+        //      allocated
+        const size_t meshBlocks = sizeof(CellFileHeader) + 2 * (2 * sizeof(uint32_t)) + contents.meshes[0].GetVertexBytes() +
+                                  ((contents.meshes[0].GetIndexBytes() + 3) & ~(size_t)3) + contents.meshes[1].GetVertexBytes() +
+                                  ((contents.meshes[1].GetIndexBytes() + 3) & ~(size_t)3);
+        const size_t countOffsets[] = { offsetof(CellFileHeader, meshCount), offsetof(CellFileHeader, textureCount),
+                                        offsetof(CellFileHeader, objectCount), sizeof(CellFileHeader),
+                                        sizeof(CellFileHeader) + sizeof(uint32_t), meshBlocks };
+        bool damagedFailed = true;
+        for (size_t offset : countOffsets)
+        {
+            std::vector<unsigned char> damaged = written;
+            const uint32_t count = 0xFFFFFFF0u;
+            memcpy(&damaged[offset], &count, sizeof(count));
+            rewrite(damaged, damaged.size());
+            damagedFailed = damagedFailed && !load();
+        }
+        check(damagedFailed, "a cell with a damaged count loaded");
+        rewrite(written, written.size());
+        FreeStaging(*cell);
+
+        // CLN: the only worker is held, so the cell is still queued when the camera leaves; once the load runs it
+        //      is dropped, and nothing reaches the scheduler
+        std::atomic<bool> held(false);
+        std::atomic<bool> release(false);
+        pool.Submit([&held, &release] {
+            held = true;
+            while (!release)
+                std::this_thread::yield();
+        });
+        while (!held)
+            std::this_thread::yield();
+        const glm::vec3 front(0.0f, 0.0f, -1.0f);
+        streamer.Update(cell->center, front, 0.0f);
+        const bool loading = cell->state == CELL_LOADING;
+        streamer.Update(glm::vec3(1000.0f, 0.0f, 1000.0f), front, 0.0f);
+        check(loading && cell->cancelled, "a cell wasn't marked for eviction while loading");
+        release = true;
+        pool.WaitIdle();
+        check(cell->state == CELL_UNLOADED && !cell->cancelled && streamer.loadsInFlight == 0 && streamer.stagingBytes == 0 &&
+              streamer.cellsLoaded == 0 && scheduler.GetPendingCount() == 0, "a cell evicted while loading was uploaded or leaked");
+
+        std::remove(filename.c_str());
+    }
+
+    std::remove((directory + "/" + INDEX_FILENAME).c_str());
+#ifdef _WIN32
+    _rmdir(directory.c_str());
+#else
+    rmdir(directory.c_str());
+#endif
+    return passed;
+}
@@ -0,0 +1,189 @@
+//========================================================================================
+// Filename      : SceneStreamer.h
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Out-of-core streaming of large scenes. The world is partitioned into
+//               : a grid of square cells on the XZ plane; each cell's meshes, textures
+//               : (the encoded image files) and objects are stored in one ".cell" file,
+//               : and "world.idx" lists the cells of a world directory.
+//               :
+//               : StreamWorldWriter builds such a directory. SceneStreamer keeps the
+//               : cells around the camera resident: cells are read and decoded on the
+//               : WorkerPool, uploaded to the GPU in budgeted steps through the
+//               : FrameScheduler, and evicted by distance or when the memory budget
+//               : is exceeded. Loads are prefetched along the camera's velocity and
+//               : Front vector, and cells that become visible before they are resident
+//               : are counted as pop-in.
+//========================================================================================
+
+#ifndef SCENE_STREAMER_H
+#define SCENE_STREAMER_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "MeshData.h"
+
+class WorkerPool;
+class FrameScheduler;
+
+// One placed object of a cell
+struct StreamObject
+{
+    unsigned int mesh;      // index into the cell's meshes
+    unsigned int texture;   // index into the cell's textures
+    float model[16];        // column-major model matrix (world space)
+};
+
+// Everything stored in one cell file
+struct StreamCellContents
+{
+    std::vector<MeshData> meshes;
+    std::vector<std::vector<unsigned char> > textures;  // encoded image files (jpg/png)
+    std::vector<StreamObject> objects;
+};
+
+
+// Writes a streamable world directory
+class StreamWorldWriter
+{
+public:
+    StreamWorldWriter(const std::string& directory, float cellSize);
+
+    bool AddCell(int cellX, int cellZ, const StreamCellContents& contents);
+    bool Finish();      // writes world.idx
+
+    static bool ReadFileBytes(const std::string& filename, std::vector<unsigned char>& bytes);
+
+private:
+    std::string directory;
+    float cellSize;
+    std::vector<std::string> indexLines;
+};
+
+
+class SceneStreamer
+{
+public:
+    // called for every object of a drawable cell
+    typedef std::function<void(GLuint vao, GLuint indexCount, GLuint texture, const float* model)> DrawFunction;
+
+    SceneStreamer(WorkerPool& pool, FrameScheduler& scheduler);
+    ~SceneStreamer();
+
+    bool Open(const std::string& directory);
+    bool IsOpen() const                         { return cellSize > 0.0f; }
+
+    // settings (world units / bytes)
+    void SetDrawRadius(float radius)            { drawRadius = radius; }
+    void SetMemoryBudget(size_t bytes)          { memoryBudget = bytes; }
+    void SetPrefetchSeconds(float seconds)      { prefetchSeconds = seconds; }
+
+    // once per frame on the main thread, before drawing
+    void Update(const glm::vec3& cameraPosition, const glm::vec3& cameraFront, float deltaTime);
+    void Draw(const glm::vec3& cameraPosition, const DrawFunction& draw) const;
+    // changes whenever a cell becomes resident or is evicted, i.e. when Draw() may draw something new
+    unsigned long long GetResidencyVersion() const  { return cellsLoaded + cellsEvicted; }
+
+    void ReleaseAll();      // frees every GL resource (main thread)
+    void PrintStats(std::ostream& out);
+
+    // reads back a written cell, rejects truncated and damaged ones, and drops a cell evicted while it is still
+    // loading (--self-test)
+    static bool SelfTest(std::ostream& out);
+
+private:
+    enum CellState
+    {
+        CELL_UNLOADED,
+        CELL_LOADING,       // being read and decoded on a worker
+        CELL_UPLOADING,     // queued in the frame scheduler
+        CELL_RESIDENT
+    };
+
+    struct DecodedTexture
+    {
+        int width;
+        int height;
+        int channels;
+        unsigned char* pixels;      // from stb_image
+        GLuint id;
+        int rowsUploaded;
+    };
+
+    struct GpuMesh
+    {
+        GLuint vao;
+        GLuint vbos[2];
+        GLuint indexCount;
+    };
+
+    struct Cell
+    {
+        int x, z;
+        std::string filename;
+        glm::vec3 center;
+        CellState state;
+        bool cancelled;                 // evicted while loading/uploading
+        StreamCellContents contents;    // CPU copy until uploaded
+        std::vector<DecodedTexture> textures;
+        std::vector<GpuMesh> meshes;
+        size_t meshesUploaded;
+        size_t gpuBytes;
+        size_t stagingBytes;
+        double neededSince;             // time the cell entered the draw radius while not resident, < 0 if not waiting
+        bool wasNeeded;                 // inside the draw radius on the previous update
+    };
+
+    typedef std::shared_ptr<Cell> CellPtr;
+
+    void RequestLoad(const CellPtr& cell);
+    bool LoadCell(Cell& cell);                                  // worker thread
+    bool UploadStep(const CellPtr& cell, double deadlineMs);    // main thread, resumable
+    void Evict(const CellPtr& cell);
+    void FreeGpu(Cell& cell);
+    static void FreeStaging(Cell& cell);
+    double NowMs() const;
+
+    WorkerPool& pool;
+    FrameScheduler& scheduler;
+    std::string directory;
+    float cellSize;
+    std::map<std::pair<int, int>, CellPtr> cells;
+    mutable std::mutex mutex;                       // guards cell state shared with the workers
+
+    float drawRadius;
+    size_t memoryBudget;
+    float prefetchSeconds;
+    unsigned int maxConcurrentLoads;
+
+    glm::vec3 lastPosition;
+    glm::vec3 velocity;
+    bool hasLastPosition;
+
+    // stats
+    size_t residentBytes;
+    size_t stagingBytes;
+    size_t peakBytes;
+    unsigned int loadsInFlight;
+    unsigned long long cellsLoaded;
+    unsigned long long cellsEvicted;
+    unsigned long long budgetEvictions;
+    unsigned long long prefetchHits;    // cells resident before they entered the draw radius
+    unsigned long long popIns;          // cells that appeared while already inside the draw radius
+    double totalPopInMs;
+    double worstPopInMs;
+    unsigned long long missingCellFrames;
+    double bytesRead;
+};
+
+#endif
@@ -0,0 +1,462 @@
+//========================================================================================
+// Filename      : ShaderLab.cpp
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Implementation of the ShaderLab class (see ShaderLab.h)
+//========================================================================================
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+#include "ReflectionProbes.h"
+#include "ShaderLab.h"
+
+namespace
+{
+    const double SIGNIFICANCE = 0.05;       // p-value under which a difference is reported
+    const int FLOATS_PER_VERTEX = 8;        // position, normal, texture coordinate
+    const int TEXTURE_SIZE = 512;
+
+    void AddVertex(std::vector<GLfloat>& vertices, float x, float y, float z, float nx, float ny, float nz, float u, float v)
+    {
+        const GLfloat vertex[FLOATS_PER_VERTEX] = { x, y, z, nx, ny, nz, u, v };
+        vertices.insert(vertices.end(), vertex, vertex + FLOATS_PER_VERTEX);
+    }
+
+    // CLN: continued fraction of the incomplete beta function (modified Lentz), from Numerical Recipes 6.4
+    double IncompleteBetaFraction(double a, double b, double x)
+    {
+        const double tiny = 1e-30;
+        double c = 1.0;
+        double d = 1.0 - (a + b) * x / (a + 1.0);
+        d = 1.0 / (std::fabs(d) < tiny ? tiny : d);
+        double h = d;
+        for (int m = 1; m <= 200; ++m)
+        {
+            for (int odd = 0; odd < 2; ++odd)
+            {
+                const double numerator = odd == 0 ? m * (b - m) * x / ((a + 2.0 * m - 1.0) * (a + 2.0 * m))
+                                                  : -(a + m) * (a + b + m) * x / ((a + 2.0 * m) * (a + 2.0 * m + 1.0));
+                d = 1.0 + numerator * d;
+                d = 1.0 / (std::fabs(d) < tiny ? tiny : d);
+                c = 1.0 + numerator / c;
+                c = std::fabs(c) < tiny ? tiny : c;
+                h *= d * c;
+                if (odd == 1 && std::fabs(d * c - 1.0) < 1e-12)
+                    return h;
+            }
+        }
+        return h;
+    }
+
+    // CLN: regularized incomplete beta function I_x(a, b)
+    double IncompleteBeta(double a, double b, double x)
+    {
+        if (x <= 0.0)
+            return 0.0;
+        if (x >= 1.0)
+            return 1.0;
+        const double front = std::exp(std::lgamma(a + b) - std::lgamma(a) - std::lgamma(b) + a * std::log(x) + b * std::log(1.0 - x));
+        if (x < (a + 1.0) / (a + b + 2.0))
+            return front * IncompleteBetaFraction(a, b, x) / a;
+        return 1.0 - front * IncompleteBetaFraction(b, a, 1.0 - x) / b;
+    }
+}
+
+
+ShaderLab::ShaderLab()
+    : framebuffer(0), colorTexture(0), texture(0), query(0), lastIterations(0), lastWallClock(false)
+{
+}
+
+
+bool ShaderLab::Create()
+{
+    while (glGetError() != GL_NO_ERROR) {}  // CLN: so only errors from here on are checked below
+
+    glGenTextures(1, &colorTexture);
+    glBindTexture(GL_TEXTURE_2D, colorTexture);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, TARGET_WIDTH, TARGET_HEIGHT);
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
+    const bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    // CLN: a mipmapped checker with noise, so the texture fetches aren't all one cache line
+    std::vector<GLubyte> texels((size_t)TEXTURE_SIZE * TEXTURE_SIZE * 4);
+    for (int y = 0; y < TEXTURE_SIZE; ++y)
+    {
+        for (int x = 0; x < TEXTURE_SIZE; ++x)
+        {
+            const size_t i = ((size_t)y * TEXTURE_SIZE + x) * 4;
+            const GLubyte checker = ((x / 32 + y / 32) & 1) ? 200 : 80;
+            texels[i] = (GLubyte)(checker + ((i * 2654435761u) >> 28));
+            texels[i + 1] = checker;
+            texels[i + 2] = (GLubyte)(255 - checker);
+            texels[i + 3] = 255;
+        }
+    }
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, TEXTURE_SIZE, TEXTURE_SIZE, 0, GL_RGBA, GL_UNSIGNED_BYTE, texels.data());
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    // CLN: the full-screen quad, facing the camera, with the texture repeated 4 times across
+    std::vector<GLfloat> vertices;
+    AddVertex(vertices, -1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f);
+    AddVertex(vertices,  1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 4.0f, 0.0f);
+    AddVertex(vertices,  1.0f,  1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 4.0f, 4.0f);
+    AddVertex(vertices, -1.0f,  1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 4.0f);
+    bool created = CreateMesh(quad, vertices, { 0, 1, 2, 0, 2, 3 });
+
+    // CLN: the dense mesh: a rippled grid over the whole target, with triangles of a few pixels each.
+    //      The ripple only moves the vertices in depth, so no triangle covers another
+    vertices.clear();
+    std::vector<GLuint> indices;
+    for (int row = 0; row <= GRID_SIZE; ++row)
+    {
+        for (int column = 0; column <= GRID_SIZE; ++column)
+        {
+            const float u = (float)column / GRID_SIZE;
+            const float v = (float)row / GRID_SIZE;
+            const float phase = 12.0f * (u + v);
+            const float slope = 0.3f * std::cos(phase);     // dz/dx = dz/dy of z = 0.05 sin(12 (u + v)), x = 2u - 1
+            const float length = std::sqrt(2.0f * slope * slope + 1.0f);
+            AddVertex(vertices, u * 2.0f - 1.0f, v * 2.0f - 1.0f, 0.05f * std::sin(phase),
+                      -slope / length, -slope / length, 1.0f / length, u * 4.0f, v * 4.0f);
+        }
+    }
+    for (int row = 0; row < GRID_SIZE; ++row)
+    {
+        for (int column = 0; column < GRID_SIZE; ++column)
+        {
+            const GLuint corner = row * (GRID_SIZE + 1) + column;
+            const GLuint quadIndices[6] = { corner, corner + 1, corner + GRID_SIZE + 2, corner, corner + GRID_SIZE + 2, corner + GRID_SIZE + 1 };
+            indices.insert(indices.end(), quadIndices, quadIndices + 6);
+        }
+    }
+    created = CreateMesh(grid, vertices, indices) && created;
+
+    glGenQueries(1, &query);
+
+    if (!complete || !created || glGetError() != GL_NO_ERROR)
+    {
+        std::cout << "Failed to create the shader lab framebuffer and workloads" << std::endl;
+        Destroy();
+        return false;
+    }
+    return true;
+}
+
+
+bool ShaderLab::CreateMesh(Mesh& mesh, const std::vector<GLfloat>& vertices, const std::vector<GLuint>& indices)
+{
+    glGenVertexArrays(1, &mesh.vao);
+    glBindVertexArray(mesh.vao);
+    glGenBuffers(1, &mesh.vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.vbo);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(GLfloat), vertices.data(), GL_STATIC_DRAW);
+    glGenBuffers(1, &mesh.ebo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+    mesh.indexCount = (GLsizei)indices.size();
+
+    const GLsizei stride = FLOATS_PER_VERTEX * sizeof(GLfloat);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, 0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (char*)(sizeof(GLfloat) * 3));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (char*)(sizeof(GLfloat) * 6));
+    glEnableVertexAttribArray(2);
+    glBindVertexArray(0);
+    return mesh.indexCount > 0;
+}
+
+
+void ShaderLab::Destroy()
+{
+    const Mesh* meshes[] = { &quad, &grid };
+    for (const Mesh* mesh : meshes)
+    {
+        glDeleteVertexArrays(1, &mesh->vao);
+        glDeleteBuffers(1, &mesh->vbo);
+        glDeleteBuffers(1, &mesh->ebo);
+    }
+    quad = Mesh();
+    grid = Mesh();
+    glDeleteFramebuffers(1, &framebuffer);
+    glDeleteTextures(1, &colorTexture);
+    glDeleteTextures(1, &texture);
+    glDeleteQueries(1, &query);
+    framebuffer = colorTexture = texture = query = 0;
+}
+
+
+void ShaderLab::AddVariant(const std::string& name, GLuint program)
+{
+    Variant variant;
+    variant.name = name;
+    variant.program = program;
+    variants.push_back(variant);
+}
+
+
+// CLN: identity transforms (the workloads are built in clip space) and a white light in front of the target
+void ShaderLab::SetUniforms(GLuint program)
+{
+    const GLfloat identity[16] = { 1.0f, 0.0f, 0.0f, 0.0f,  0.0f, 1.0f, 0.0f, 0.0f,  0.0f, 0.0f, 1.0f, 0.0f,  0.0f, 0.0f, 0.0f, 1.0f };
+    glUseProgram(program);
+    glUniformMatrix4fv(glGetUniformLocation(program, "model"), 1, GL_FALSE, identity);
+    glUniformMatrix4fv(glGetUniformLocation(program, "view"), 1, GL_FALSE, identity);
+    glUniformMatrix4fv(glGetUniformLocation(program, "projection"), 1, GL_FALSE, identity);
+    glUniform1i(glGetUniformLocation(program, "materialIndex"), 0);   // CLN: the default material (bound by the caller)
+    glUniform1i(glGetUniformLocation(program, "probeTexture"), ReflectionProbes::PROBE_TEXTURE_UNIT);   // CLN: no probes, but off unit 0
+    glUniform3f(glGetUniformLocation(program, "lightColor"), 1.0f, 1.0f, 1.0f);
+    glUniform3f(glGetUniformLocation(program, "lightPos"), 0.5f, 0.5f, 1.0f);
+    glUniform3f(glGetUniformLocation(program, "viewPosition"), 0.0f, 0.0f, 2.0f);
+    glUniform1i(glGetUniformLocation(program, "uTextureBase"), 0);
+    glUniform1i(glGetUniformLocation(program, "transparentPass"), 0);
+    glUniform1f(glGetUniformLocation(program, "opacity"), 1.0f);
+    glUniform1i(glGetUniformLocation(program, "reprojectionEnabled"), 0);
+}
+
+
+void ShaderLab::Draw(ShaderLabWorkload workload, GLuint program)
+{
+    switch (workload)
+    {
+    case SHADER_LAB_FULL_SCREEN:
+        glBindVertexArray(quad.vao);
+        for (int layer = 0; layer < FULL_SCREEN_LAYERS; ++layer)
+            glDrawElements(GL_TRIANGLES, quad.indexCount, GL_UNSIGNED_INT, 0);
+        break;
+
+    case SHADER_LAB_DENSE_MESH:
+        glBindVertexArray(grid.vao);
+        glDrawElements(GL_TRIANGLES, grid.indexCount, GL_UNSIGNED_INT, 0);
+        break;
+
+    case SHADER_LAB_MANY_LIGHTS:
+    {
+        // CLN: forward multi-pass lighting: each light adds its share on top of the last
+        const GLint lightPosLocation = glGetUniformLocation(program, "lightPos");
+        const GLint lightColorLocation = glGetUniformLocation(program, "lightColor");
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_ONE, GL_ONE);
+        glBindVertexArray(quad.vao);
+        for (int light = 0; light < LIGHT_COUNT; ++light)
+        {
+            const float angle = 6.2831853f * light / LIGHT_COUNT;
+            glUniform3f(lightPosLocation, 0.8f * std::cos(angle), 0.8f * std::sin(angle), 0.5f);
+            glUniform3f(lightColorLocation, 2.0f / LIGHT_COUNT, 2.0f / LIGHT_COUNT, 2.0f / LIGHT_COUNT);
+            glDrawElements(GL_TRIANGLES, quad.indexCount, GL_UNSIGNED_INT, 0);
+        }
+        glDisable(GL_BLEND);
+        glUniform3f(lightPosLocation, 0.5f, 0.5f, 1.0f);       // CLN: back to the one light of SetUniforms()
+        glUniform3f(lightColorLocation, 1.0f, 1.0f, 1.0f);
+        break;
+    }
+
+    default:
+        break;
+    }
+}
+
+
+double ShaderLab::Time(ShaderLabWorkload workload, GLuint program, bool wallClock)
+{
+    if (wallClock)
+    {
+        glFinish();
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        Draw(workload, program);
+        glFinish();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // CLN: read back right away: the lab has nothing else to overlap with, and the next draw shouldn't queue behind it
+    glBeginQuery(GL_TIME_ELAPSED, query);
+    Draw(workload, program);
+    glEndQuery(GL_TIME_ELAPSED);
+    GLuint64 nanoseconds = 0;
+    glGetQueryObjectui64v(query, GL_QUERY_RESULT, &nanoseconds);
+    return nanoseconds / 1.0e6;
+}
+
+
+bool ShaderLab::Run(int iterations, bool wallClock)
+{
+    if (!IsCreated() || variants.empty() || iterations < 2)
+        return false;
+
+    while (glGetError() != GL_NO_ERROR) {}
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(0, 0, TARGET_WIDTH, TARGET_HEIGHT);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_CULL_FACE);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+
+    for (Variant& variant : variants)
+    {
+        SetUniforms(variant.program);
+        for (int workload = 0; workload < SHADER_LAB_WORKLOAD_COUNT; ++workload)
+        {
+            variant.samples[workload].clear();
+            for (int i = 0; i < WARMUP_ITERATIONS; ++i)
+                Draw((ShaderLabWorkload)workload, variant.program);
+        }
+    }
+    glFinish();
+
+    // CLN: every iteration times each variant once, starting one variant further along each time
+    const size_t count = variants.size();
+    for (int iteration = 0; iteration < iterations; ++iteration)
+    {
+        for (int workload = 0; workload < SHADER_LAB_WORKLOAD_COUNT; ++workload)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                Variant& variant = variants[(iteration + i) % count];
+                glUseProgram(variant.program);
+                glClear(GL_COLOR_BUFFER_BIT);
+                variant.samples[workload].push_back(Time((ShaderLabWorkload)workload, variant.program, wallClock));
+            }
+        }
+    }
+
+    glBindVertexArray(0);
+    glUseProgram(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glEnable(GL_DEPTH_TEST);
+
+    lastIterations = iterations;
+    lastWallClock = wallClock;
+    if (glGetError() != GL_NO_ERROR)
+    {
+        std::cout << "Failed to run the shader lab workloads" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+
+void ShaderLab::PrintReport(std::ostream& out) const
+{
+    if (variants.empty() || lastIterations == 0)
+        return;
+
+    const std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(3)
+        << "INFO: Shader lab: " << lastIterations << " iterations at " << TARGET_WIDTH << " x " << TARGET_HEIGHT << ", timed with "
+        << (lastWallClock ? "glFinish() and the wall clock" : "GL_TIME_ELAPSED queries") << std::endl;
+    size_t nameWidth = 8;
+    for (const Variant& variant : variants)
+        nameWidth = std::max(nameWidth, variant.name.size() + 2);
+
+    for (int workload = 0; workload < SHADER_LAB_WORKLOAD_COUNT; ++workload)
+    {
+        out << "      " << GetWorkloadName((ShaderLabWorkload)workload) << ":" << std::endl;
+        const std::vector<double>& baseline = variants[0].samples[workload];
+        const ShaderLabStats baselineStats = Summarize(baseline);
+        for (size_t i = 0; i < variants.size(); ++i)
+        {
+            const ShaderLabStats stats = Summarize(variants[i].samples[workload]);
+            out << "        " << std::left << std::setw((int)nameWidth) << variants[i].name << std::right
+                << "median " << std::setw(8) << stats.medianMs << " ms, mean " << std::setw(8) << stats.meanMs
+                << " +- " << std::setw(7) << stats.deviationMs << " ms";
+            if (i == 0)
+                out << "  (baseline)";
+            else if (baselineStats.meanMs > 0.0)
+            {
+                const double p = WelchTest(baseline, variants[i].samples[workload]);
+                const double change = 100.0 * (stats.meanMs - baselineStats.meanMs) / baselineStats.meanMs;
+                out << "  " << std::showpos << std::setprecision(1) << change << std::noshowpos << "%, p = "
+                    << std::setprecision(4) << p << std::setprecision(3)
+                    << (p >= SIGNIFICANCE ? "  no significant difference" : (change < 0.0 ? "  faster" : "  slower"));
+            }
+            out << std::endl;
+        }
+    }
+    out.unsetf(std::ios_base::floatfield);
+    out.precision(precision);
+}
+
+
+bool ShaderLab::IsSoftwareRenderer(const std::string& renderer)
+{
+    const char* names[] = { "llvmpipe", "softpipe", "SwiftShader", "Software Rasterizer" };
+    for (const char* name : names)
+    {
+        if (renderer.find(name) != std::string::npos)
+            return true;
+    }
+    return false;
+}
+
+
+const char* ShaderLab::GetWorkloadName(ShaderLabWorkload workload)
+{
+    switch (workload)
+    {
+    case SHADER_LAB_FULL_SCREEN:    return "full-screen (8 layers)";
+    case SHADER_LAB_DENSE_MESH:     return "dense mesh (256 x 256 quads)";
+    case SHADER_LAB_MANY_LIGHTS:    return "many lights (16 additive passes)";
+    default:                        return "unknown";
+    }
+}
+
+
+ShaderLabStats ShaderLab::Summarize(std::vector<double> samples)
+{
+    ShaderLabStats stats;
+    const size_t count = samples.size();
+    if (count == 0)
+        return stats;
+
+    std::sort(samples.begin(), samples.end());
+    stats.medianMs = count % 2 ? samples[count / 2] : 0.5 * (samples[count / 2 - 1] + samples[count / 2]);
+    double sum = 0.0;
+    for (double sample : samples)
+        sum += sample;
+    stats.meanMs = sum / count;
+    double squares = 0.0;
+    for (double sample : samples)
+        squares += (sample - stats.meanMs) * (sample - stats.meanMs);
+    stats.deviationMs = count > 1 ? std::sqrt(squares / (count - 1)) : 0.0;
+    return stats;
+}
+
+
+// CLN: Welch's unequal variances t-test, with the Welch-Satterthwaite degrees of freedom. The two-sided p-value
+//      is the Student t tail, I_(df / (df + t^2))(df / 2, 1 / 2)
+double ShaderLab::WelchTest(const std::vector<double>& a, const std::vector<double>& b)
+{
+    if (a.size() < 2 || b.size() < 2)
+        return 1.0;
+
+    const ShaderLabStats statsA = Summarize(a);
+    const ShaderLabStats statsB = Summarize(b);
+    const double errorA = statsA.deviationMs * statsA.deviationMs / a.size();
+    const double errorB = statsB.deviationMs * statsB.deviationMs / b.size();
+    const double error = errorA + errorB;
+    if (error <= 0.0)
+        return statsA.meanMs == statsB.meanMs ? 1.0 : 0.0;
+
+    const double t = (statsA.meanMs - statsB.meanMs) / std::sqrt(error);
+    const double degrees = error * error / (errorA * errorA / (a.size() - 1) + errorB * errorB / (b.size() - 1));
+    return IncompleteBeta(0.5 * degrees, 0.5, degrees / (degrees + t * t));
+}
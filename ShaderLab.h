@@ -0,0 +1,116 @@
+//========================================================================================
+// Filename      : ShaderLab.h
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : A/B timing of scene shader variants (--shader-lab). Every variant
+//               : draws the same synthetic workloads into the same offscreen
+//               : framebuffer, with the same texture and uniforms:
+//               :    full-screen : layers of screen-filling quads (fragment cost)
+//               :    dense mesh  : a wavy grid of pixel-sized triangles (vertex cost
+//               :                  and the 2x2 quad waste of tiny triangles)
+//               :    many lights : additive full-screen passes, one per light
+//               : Each iteration times every variant once, in a rotating order, so
+//               : clock and thermal drift are spread over all of them alike. On a GPU
+//               : each draw is timed with a GL_TIME_ELAPSED query; on a software
+//               : rasterizer (llvmpipe, softpipe, SwiftShader), where the queries only
+//               : see the command submission, the draws are bracketed by glFinish()
+//               : and timed with the wall clock, which is the GPU time there.
+//               :
+//               : The report gives the median, mean and standard deviation of each
+//               : variant and compares it with the first one (the baseline) with
+//               : Welch's t-test, so a difference is only called faster or slower
+//               : when it is unlikely to be noise.
+//========================================================================================
+
+#ifndef SHADER_LAB_H
+#define SHADER_LAB_H
+
+#include <GL/glew.h>
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+enum ShaderLabWorkload
+{
+    SHADER_LAB_FULL_SCREEN,
+    SHADER_LAB_DENSE_MESH,
+    SHADER_LAB_MANY_LIGHTS,
+    SHADER_LAB_WORKLOAD_COUNT
+};
+
+struct ShaderLabStats
+{
+    double medianMs = 0.0;
+    double meanMs = 0.0;
+    double deviationMs = 0.0;   // sample standard deviation
+};
+
+class ShaderLab
+{
+public:
+    static const int DEFAULT_ITERATIONS = 50;
+    static const int WARMUP_ITERATIONS = 3;     // untimed, per variant and workload
+    static const int TARGET_WIDTH = 1280;
+    static const int TARGET_HEIGHT = 720;
+    static const int FULL_SCREEN_LAYERS = 8;
+    static const int GRID_SIZE = 256;           // quads per side of the dense mesh
+    static const int LIGHT_COUNT = 16;
+
+    ShaderLab();
+
+    ShaderLab(const ShaderLab&) = delete;
+    ShaderLab& operator=(const ShaderLab&) = delete;
+
+    // the framebuffer, texture and workload meshes; needs the GL context
+    bool Create();
+    void Destroy();
+    bool IsCreated() const      { return framebuffer != 0; }
+
+    // program has the scene vertex layout (position, normal, texture coordinate at 0, 1, 2) and the uniforms of
+    // vertexShaderSource/fragmentShaderSource (see main). The first variant added is the baseline
+    void AddVariant(const std::string& name, GLuint program);
+
+    // wallClock times with glFinish() and the CPU clock instead of timer queries
+    bool Run(int iterations, bool wallClock);
+    void PrintReport(std::ostream& out) const;
+
+    static bool IsSoftwareRenderer(const std::string& renderer);
+    static const char* GetWorkloadName(ShaderLabWorkload workload);
+    static ShaderLabStats Summarize(std::vector<double> samples);
+    static double WelchTest(const std::vector<double>& a, const std::vector<double>& b);   // two-sided p-value
+
+private:
+    struct Variant
+    {
+        std::string name;
+        GLuint program;
+        std::vector<double> samples[SHADER_LAB_WORKLOAD_COUNT];     // ms per iteration
+    };
+
+    struct Mesh
+    {
+        GLuint vao = 0;
+        GLuint vbo = 0;
+        GLuint ebo = 0;
+        GLsizei indexCount = 0;
+    };
+
+    bool CreateMesh(Mesh& mesh, const std::vector<GLfloat>& vertices, const std::vector<GLuint>& indices);
+    void SetUniforms(GLuint program);
+    void Draw(ShaderLabWorkload workload, GLuint program);
+    double Time(ShaderLabWorkload workload, GLuint program, bool wallClock);
+
+    GLuint framebuffer;
+    GLuint colorTexture;
+    GLuint texture;             // bound as uTextureBase
+    GLuint query;
+    Mesh quad;
+    Mesh grid;
+    std::vector<Variant> variants;
+    int lastIterations;
+    bool lastWallClock;
+};
+
+#endif
@@ -119,6 +119,10 @@ void Sphere::printSelf() const
 
 
 
+// CLN: [DebugDraw] Removed the draw methods: they use legacy client arrays, which the core profile doesn't have.
+//      The scene draws the sphere from its own buffers, and wireframes go through DebugDraw::Sphere()
+/*
+
 ///////////////////////////////////////////////////////////////////////////////
 // draw a sphere in VertexArray mode
 // OpenGL RC must be set before calling it
@@ -181,6 +185,7 @@ void Sphere::drawWithLines(const float lineColor[4]) const
     // draw lines with VA
     drawLines(lineColor);
 }
+*/
 
 
 
@@ -23,6 +23,9 @@
 class Sphere
 {
 public:
+    // CLN: [GeometryCache] Bump whenever the generated vertices or indices change, so cached meshes are regenerated
+    static const int GENERATOR_VERSION = 1;
+
     // ctor/dtor
     Sphere(float radius=1.0f, int sectorCount=36, int stackCount=18, bool smooth=true);
     ~Sphere() {}
@@ -67,10 +70,13 @@ public:
     int getInterleavedStride() const                { return interleavedStride; }   // should be 32 bytes
     const float* getInterleavedVertices() const     { return interleavedVertices.data(); }
 
+    // CLN: [DebugDraw] Commented draw functions because draws are done in main code (wireframes by DebugDraw)
+    /*
     // draw in VertexArray mode
     void draw() const;                                  // draw surface
     void drawLines(const float lineColor[4]) const;     // draw lines only
     void drawWithLines(const float lineColor[4]) const; // draw surface and lines
+    */
 
     // debug
     void printSelf() const;
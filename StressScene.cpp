@@ -0,0 +1,391 @@
+//========================================================================================
+// Filename      : StressScene.cpp
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Implementation of the StressScene class (see StressScene.h)
+//========================================================================================
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+#include <glm/glm.hpp>
+#include <glm/gtx/transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "StressScene.h"
+#include "WorkerPool.h"
+
+namespace
+{
+    const float GROUND_HEIGHT = -1.0f;      // same ground as the streaming test world
+    const float OBJECT_SPACING = 1.5f;      // average distance between objects when the extent is picked automatically
+    const float BLOCK_SIZE = 12.0f;         // occluders: city block, walls are its sides
+    const int WALL_EVERY = 8;               // occluders: every 8th object is a wall
+
+    // CLN: distance of the farthest vertex from the origin of each primitive's mesh, at scale 1
+    const float PRIMITIVE_RADIUS[STRESS_PRIMITIVE_COUNT] = {
+        0.866f,     // cube, 1 x 1 x 1
+        1.118f,     // tri-case
+        0.4f,       // sphere
+        0.525f,     // cylinder, radius 0.27, height 0.9
+        2.829f,     // plane, 4 x 4
+    };
+
+    // CLN: SplitMix64 (Steele, Lea and Flood), small and fast with good statistics; one per object or stream
+    class StressRandom
+    {
+    public:
+        StressRandom(unsigned long long seed, unsigned long long stream) : state(seed * 0x9E3779B97F4A7C15ull ^ (stream + 1) * 0xD1B54A32D192ED03ull) {}
+
+        unsigned long long Next()
+        {
+            unsigned long long z = (state += 0x9E3779B97F4A7C15ull);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            return z ^ (z >> 31);
+        }
+
+        unsigned int Below(unsigned int count)  { return (unsigned int)((Next() >> 32) * count >> 32); }
+        float Float()                           { return (Next() >> 40) * (1.0f / 16777216.0f); }   // [0, 1)
+        float Range(float low, float high)      { return low + (high - low) * Float(); }
+
+        // CLN: standard normal, Box-Muller
+        float Gaussian()
+        {
+            const float u = std::max(Float(), 1e-7f);
+            const float v = Float();
+            return std::sqrt(-2.0f * std::log(u)) * std::cos(6.2831853f * v);
+        }
+
+    private:
+        unsigned long long state;
+    };
+
+    // CLN: streams of the scene-wide random numbers, apart from the per-object ones (stream = object index)
+    const unsigned long long LIGHT_STREAM = 1ull << 62;
+    const unsigned long long CLUSTER_STREAM = LIGHT_STREAM + 1;
+
+    void Fnv1a(unsigned long long& hash, const void* data, size_t bytes)
+    {
+        const unsigned char* p = (const unsigned char*)data;
+        for (size_t i = 0; i < bytes; ++i)
+            hash = (hash ^ p[i]) * 0x100000001B3ull;
+    }
+}
+
+
+StressScene::StressScene()
+    : generationMs(0.0)
+{
+}
+
+
+bool StressScene::Generate(const StressSceneSettings& newSettings, WorkerPool* pool)
+{
+    if (newSettings.objectCount == 0 || newSettings.objectCount > MAX_OBJECTS)
+    {
+        std::cout << "Failed to generate the stress scene: " << newSettings.objectCount << " objects (1 to " << MAX_OBJECTS << ")" << std::endl;
+        return false;
+    }
+
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    settings = newSettings;
+    settings.lightCount = std::min(std::max(settings.lightCount, 1), (int)MAX_LIGHTS);
+    settings.textureCount = std::min(std::max(settings.textureCount, 1), 256);
+    if (settings.clusterCount <= 0)
+        settings.clusterCount = (int)std::max<size_t>(1, settings.objectCount / 2000);
+    const float extent = settings.extent > 0.0f ? settings.extent : std::sqrt((float)settings.objectCount) * OBJECT_SPACING;
+
+    // CLN: lights hang above the ground, spread over the whole scene
+    StressRandom lightRandom(settings.seed, LIGHT_STREAM);
+    lights.resize(settings.lightCount);
+    for (StressLight& light : lights)
+    {
+        light.position[0] = lightRandom.Range(-0.5f, 0.5f) * extent;
+        light.position[1] = GROUND_HEIGHT + lightRandom.Range(3.0f, 8.0f);
+        light.position[2] = lightRandom.Range(-0.5f, 0.5f) * extent;
+        const float warmth = lightRandom.Float();   // CLN: from bluish white to warm white
+        light.color[0] = 0.8f + 0.2f * warmth;
+        light.color[1] = 0.85f + 0.1f * lightRandom.Float();
+        light.color[2] = 1.0f - 0.2f * warmth;
+    }
+
+    std::vector<float> clusters;   // x, z of each center
+    if (settings.distribution == STRESS_CLUSTERED)
+    {
+        StressRandom clusterRandom(settings.seed, CLUSTER_STREAM);
+        clusters.resize(settings.clusterCount * 2);
+        for (float& coordinate : clusters)
+            coordinate = clusterRandom.Range(-0.4f, 0.4f) * extent;
+    }
+
+    objects.resize(settings.objectCount);
+    const size_t chunkCount = (settings.objectCount + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    const auto generateChunk = [this, extent, &clusters](size_t chunk) {
+        const size_t end = std::min(objects.size(), (chunk + 1) * CHUNK_SIZE);
+        for (size_t i = chunk * CHUNK_SIZE; i < end; ++i)
+            GenerateObject(i, extent, clusters);
+    };
+    if (pool)
+        pool->ParallelFor(chunkCount, generateChunk);
+    else
+    {
+        for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+            generateChunk(chunk);
+    }
+
+    generationMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+
+void StressScene::GenerateObject(size_t index, float extent, const std::vector<float>& clusters)
+{
+    StressRandom random(settings.seed, index);
+    StressObject& object = objects[index];
+    glm::vec3 position(0.0f, GROUND_HEIGHT, 0.0f);
+    glm::mat4 model;
+
+    if (settings.distribution == STRESS_OCCLUDERS && index % WALL_EVERY == 0)
+    {
+        // CLN: a wall along one side of a random block, a little shorter than the side so the corners stay open
+        const int blocks = std::max(1, (int)(extent / BLOCK_SIZE));
+        const float blockX = (random.Below(blocks) - blocks * 0.5f) * BLOCK_SIZE;
+        const float blockZ = (random.Below(blocks) - blocks * 0.5f) * BLOCK_SIZE;
+        const unsigned int side = random.Below(4);
+        const float height = random.Range(2.0f, 5.0f);
+        const glm::vec3 size(BLOCK_SIZE * 0.8f, height, 0.4f);
+        const float along = random.Range(0.1f, 0.9f) * BLOCK_SIZE;
+        if (side < 2)
+            position = glm::vec3(blockX + along, GROUND_HEIGHT + height * 0.5f, blockZ + side * BLOCK_SIZE);
+        else
+            position = glm::vec3(blockX + (side - 2) * BLOCK_SIZE, GROUND_HEIGHT + height * 0.5f, blockZ + along);
+        model = glm::translate(position) * glm::rotate(glm::radians(side < 2 ? 0.0f : 90.0f), glm::vec3(0.0f, 1.0f, 0.0f)) * glm::scale(size);
+        object.primitive = STRESS_CUBE;
+        object.radius = 0.5f * glm::length(size);
+    }
+    else
+    {
+        if (settings.distribution == STRESS_CLUSTERED)
+        {
+            const unsigned int cluster = random.Below((unsigned int)(clusters.size() / 2));
+            const float spread = extent / (4.0f * std::sqrt((float)(clusters.size() / 2)));
+            position.x = clusters[cluster * 2] + random.Gaussian() * spread;
+            position.z = clusters[cluster * 2 + 1] + random.Gaussian() * spread;
+        }
+        else
+        {
+            position.x = random.Range(-0.5f, 0.5f) * extent;
+            position.z = random.Range(-0.5f, 0.5f) * extent;
+        }
+
+        // CLN: stood on the ground the same way as in the streaming test world
+        object.primitive = (unsigned char)random.Below(STRESS_PRIMITIVE_COUNT);
+        const float scale = random.Range(0.5f, 2.0f);
+        const glm::mat4 spin = glm::rotate(random.Range(0.0f, 6.2831853f), glm::vec3(0.0f, 1.0f, 0.0f));
+        switch (object.primitive)
+        {
+        case STRESS_CYLINDER:   // CLN: cylinder axis is z, stand it up
+            model = glm::translate(position + glm::vec3(0.0f, 0.45f * scale, 0.0f)) * spin * glm::rotate(glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f)) * glm::scale(glm::vec3(scale));
+            break;
+        case STRESS_SPHERE:
+            model = glm::translate(position + glm::vec3(0.0f, 0.4f * scale, 0.0f)) * spin * glm::scale(glm::vec3(scale));
+            break;
+        case STRESS_CUBE:
+            model = glm::translate(position + glm::vec3(0.0f, 0.5f * scale, 0.0f)) * spin * glm::scale(glm::vec3(scale));
+            break;
+        case STRESS_PLANE:      // CLN: a floor tile, just above the ground
+            model = glm::translate(position + glm::vec3(0.0f, 0.01f, 0.0f)) * spin * glm::scale(glm::vec3(scale * 0.5f));
+            break;
+        default:
+            model = glm::translate(position) * spin * glm::scale(glm::vec3(scale));
+            break;
+        }
+        object.radius = PRIMITIVE_RADIUS[object.primitive] * (object.primitive == STRESS_PLANE ? scale * 0.5f : scale);
+    }
+    memcpy(object.model, glm::value_ptr(model), sizeof(object.model));
+    object.texture = (unsigned char)random.Below(settings.textureCount);
+
+    // CLN: the nearest light lights the object
+    float nearest = 1e30f;
+    object.light = 0;
+    for (size_t l = 0; l < lights.size(); ++l)
+    {
+        const float dx = lights[l].position[0] - position.x;
+        const float dz = lights[l].position[2] - position.z;
+        if (dx * dx + dz * dz < nearest)
+        {
+            nearest = dx * dx + dz * dz;
+            object.light = (unsigned short)l;
+        }
+    }
+}
+
+
+void StressScene::Clear()
+{
+    objects.clear();
+    objects.shrink_to_fit();
+    lights.clear();
+    generationMs = 0.0;
+}
+
+
+unsigned long long StressScene::GetChecksum() const
+{
+    unsigned long long hash = 0xCBF29CE484222325ull;
+    for (const StressObject& object : objects)
+    {
+        Fnv1a(hash, object.model, sizeof(object.model));
+        Fnv1a(hash, &object.primitive, sizeof(object.primitive));
+        Fnv1a(hash, &object.texture, sizeof(object.texture));
+        Fnv1a(hash, &object.light, sizeof(object.light));
+    }
+    for (const StressLight& light : lights)
+        Fnv1a(hash, &light, sizeof(light));
+    return hash;
+}
+
+
+void StressScene::PrintStats(std::ostream& out) const
+{
+    if (objects.empty())
+        return;
+
+    size_t counts[STRESS_PRIMITIVE_COUNT] = {};
+    for (const StressObject& object : objects)
+        ++counts[object.primitive];
+
+    const std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(1)
+        << "INFO: Stress scene: " << objects.size() << " objects (" << GetDistributionName(settings.distribution) << ", seed "
+        << settings.seed << ", " << lights.size() << " lights), generated in " << generationMs << " ms, checksum "
+        << std::hex << std::setw(16) << std::setfill('0') << GetChecksum() << std::dec << std::setfill(' ') << std::endl
+        << "      ";
+    for (int p = 0; p < STRESS_PRIMITIVE_COUNT; ++p)
+        out << (p > 0 ? ", " : "") << counts[p] << " " << GetPrimitiveName((StressPrimitive)p);
+    out << std::endl;
+    out.unsetf(std::ios_base::floatfield);
+    out.precision(precision);
+}
+
+
+bool StressScene::ParseDistribution(const std::string& name, StressDistribution& distribution)
+{
+    for (int d = 0; d < STRESS_DISTRIBUTION_COUNT; ++d)
+    {
+        if (name == GetDistributionName((StressDistribution)d))
+        {
+            distribution = (StressDistribution)d;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+const char* StressScene::GetDistributionName(StressDistribution distribution)
+{
+    switch (distribution)
+    {
+    case STRESS_UNIFORM:    return "uniform";
+    case STRESS_CLUSTERED:  return "clustered";
+    case STRESS_OCCLUDERS:  return "occluders";
+    default:                return "unknown";
+    }
+}
+
+
+const char* StressScene::GetPrimitiveName(StressPrimitive primitive)
+{
+    switch (primitive)
+    {
+    case STRESS_CUBE:       return "cubes";
+    case STRESS_TRI_CASE:   return "tri-cases";
+    case STRESS_SPHERE:     return "spheres";
+    case STRESS_CYLINDER:   return "cylinders";
+    case STRESS_PLANE:      return "planes";
+    default:                return "unknown";
+    }
+}
+
+
+bool StressScene::SelfTest(std::ostream& out)
+{
+    bool passed = true;
+    auto check = [&out, &passed](bool condition, const char* what) {
+        if (!condition)
+        {
+            out << "Failed stress scene self-test: " << what << std::endl;
+            passed = false;
+        }
+    };
+    auto sameObjects = [](const std::vector<StressObject>& a, const std::vector<StressObject>& b, size_t count) {
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (memcmp(a[i].model, b[i].model, sizeof(a[i].model)) != 0 || a[i].primitive != b[i].primitive ||
+                a[i].texture != b[i].texture || a[i].light != b[i].light || a[i].radius != b[i].radius)
+                return false;
+        }
+        return true;
+    };
+
+    WorkerPool pool(4);
+    for (int distribution = 0; distribution < STRESS_DISTRIBUTION_COUNT; ++distribution)
+    {
+        // CLN: a partial last chunk, so the chunks the workers take don't line up with the object count
+        StressSceneSettings settings;
+        settings.objectCount = 3 * CHUNK_SIZE + 17;
+        settings.seed = 7;
+        settings.distribution = (StressDistribution)distribution;
+        settings.extent = 120.0f;
+        settings.lightCount = 5;
+        settings.textureCount = 3;
+        settings.clusterCount = 4;      // CLN: or it grows with the object count
+
+        StressScene serial, parallel;
+        serial.Generate(settings, nullptr);
+        parallel.Generate(settings, &pool);
+        check(serial.GetChecksum() == parallel.GetChecksum() && sameObjects(serial.objects, parallel.objects, serial.objects.size()),
+              "a scene generated on the workers differs from the serial one");
+
+        // CLN: each object has its own random stream, so one more chunk of objects leaves the others as they were
+        StressScene larger;
+        settings.objectCount += CHUNK_SIZE;
+        larger.Generate(settings, &pool);
+        check(larger.objects.size() == serial.objects.size() + CHUNK_SIZE && sameObjects(larger.objects, serial.objects, serial.objects.size()),
+              "a larger scene doesn't start with the smaller one");
+
+        StressScene reseeded;
+        settings.objectCount -= CHUNK_SIZE;
+        settings.seed = 8;
+        reseeded.Generate(settings, &pool);
+        check(reseeded.GetChecksum() != serial.GetChecksum(), "another seed generated the same scene");
+
+        bool inRange = serial.lights.size() == 5;
+        for (size_t i = 0; i < serial.objects.size() && inRange; ++i)
+        {
+            const StressObject& object = serial.objects[i];
+            inRange = object.primitive < STRESS_PRIMITIVE_COUNT && object.texture < 3 && object.light < 5 && object.radius > 0.0f;
+            if (distribution == STRESS_UNIFORM)
+                inRange = inRange && std::fabs(object.model[12]) <= 60.0f + 1.0f && std::fabs(object.model[14]) <= 60.0f + 1.0f;
+            if (distribution == STRESS_OCCLUDERS && i % WALL_EVERY == 0)
+                inRange = inRange && object.primitive == STRESS_CUBE;
+        }
+        check(inRange, "an object has an out-of-range primitive, texture, light or position");
+    }
+
+    StressScene empty;
+    StressSceneSettings settings;
+    settings.objectCount = 0;
+    check(!empty.Generate(settings, nullptr), "a scene of no objects was generated");
+    settings.objectCount = MAX_OBJECTS + 1;
+    check(!empty.Generate(settings, nullptr), "a scene over MAX_OBJECTS was generated");
+
+    return passed;
+}
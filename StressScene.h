@@ -0,0 +1,115 @@
+//========================================================================================
+// Filename      : StressScene.h
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Procedural stress scenes for scaling tests (--stress <count>): from a
+//               : thousand to a million copies of the scene's primitives (cube,
+//               : tri-case, sphere, cylinder, plane) with random transforms, textures
+//               : and lights, laid out in one of three distributions:
+//               :    uniform   : spread evenly over a square of the ground
+//               :    clustered : gathered in Gaussian clumps around random centers
+//               :    occluders : city blocks of large walls with small props between
+//               :                them, so most objects are hidden behind others
+//               :
+//               : The scene depends only on the settings and the seed. Every object
+//               : draws its random numbers from its own generator, seeded from the
+//               : seed and its index, so generating on any number of worker threads
+//               : gives the same objects, and the generator is written out here
+//               : rather than taken from <random>, whose distributions differ between
+//               : standard libraries. GetChecksum() lets two runs confirm they
+//               : benchmarked the same scene.
+//========================================================================================
+
+#ifndef STRESS_SCENE_H
+#define STRESS_SCENE_H
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+class WorkerPool;
+
+enum StressDistribution
+{
+    STRESS_UNIFORM,
+    STRESS_CLUSTERED,
+    STRESS_OCCLUDERS,
+    STRESS_DISTRIBUTION_COUNT
+};
+
+enum StressPrimitive
+{
+    STRESS_CUBE,
+    STRESS_TRI_CASE,
+    STRESS_SPHERE,
+    STRESS_CYLINDER,
+    STRESS_PLANE,
+    STRESS_PRIMITIVE_COUNT
+};
+
+struct StressSceneSettings
+{
+    size_t objectCount = 10000;
+    unsigned int seed = 1;
+    StressDistribution distribution = STRESS_UNIFORM;
+    float extent = 0.0f;            // side of the ground square; 0 sizes it to the object count
+    int lightCount = 1;
+    int clusterCount = 0;           // clustered only; 0 picks one per 2000 objects
+    int textureCount = 1;           // objects pick a texture index below this
+};
+
+struct StressObject
+{
+    float model[16];                // column-major model matrix (world space)
+    unsigned char primitive;        // StressPrimitive
+    unsigned char texture;
+    unsigned short light;           // nearest light, which lights the object
+    float radius;                   // bounding sphere radius around the model origin (world units)
+};
+
+struct StressLight
+{
+    float position[3];
+    float color[3];
+};
+
+class StressScene
+{
+public:
+    static const size_t MAX_OBJECTS = 1 << 20;
+    static const int MAX_LIGHTS = 256;
+    static const size_t CHUNK_SIZE = 4096;      // objects per worker job
+
+    StressScene();
+
+    // pool may be null (generates on the calling thread)
+    bool Generate(const StressSceneSettings& settings, WorkerPool* pool);
+    void Clear();
+
+    const StressSceneSettings& GetSettings() const      { return settings; }
+    const std::vector<StressObject>& GetObjects() const { return objects; }
+    const std::vector<StressLight>& GetLights() const   { return lights; }
+    unsigned long long GetChecksum() const;             // FNV-1a of the objects and lights
+    double GetGenerationMs() const                      { return generationMs; }
+
+    void PrintStats(std::ostream& out) const;
+
+    static bool ParseDistribution(const std::string& name, StressDistribution& distribution);
+    static const char* GetDistributionName(StressDistribution distribution);
+    static const char* GetPrimitiveName(StressPrimitive primitive);
+
+    // generates every distribution with and without workers and checks that the scenes match, that a larger scene
+    // starts with the smaller one and that the objects stay in range (--self-test)
+    static bool SelfTest(std::ostream& out);
+
+private:
+    void GenerateObject(size_t index, float extent, const std::vector<float>& clusters);
+
+    StressSceneSettings settings;
+    std::vector<StressObject> objects;
+    std::vector<StressLight> lights;
+    double generationMs;
+};
+
+#endif
@@ -0,0 +1,267 @@
+//========================================================================================
+// Filename      : TaskGraph.cpp
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Implementation of the TaskGraph class (see TaskGraph.h)
+//========================================================================================
+
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <map>
+#include <thread>
+#include "TaskGraph.h"
+#include "WorkerPool.h"
+
+TaskGraph::TaskGraph(WorkerPool& pool) : pool(pool), remainingTasks(0), anyFailed(false), totalMs(0.0)
+{
+}
+
+
+TaskGraph::TaskId TaskGraph::AddTask(const std::string& name, const std::string& phase, TaskAffinity affinity,
+                                     TaskFunction function, const std::vector<TaskId>& dependencies)
+{
+    TaskId id = (TaskId)tasks.size();
+
+    Task task;
+    task.name = name;
+    task.phase = phase;
+    task.affinity = affinity;
+    task.function = std::move(function);
+    task.pendingDependencies = (unsigned int)dependencies.size();
+    task.failed = false;
+    task.skipped = false;
+    task.startMs = 0.0;
+    task.endMs = 0.0;
+    tasks.push_back(std::move(task));
+
+    // CLN: dependencies must already exist, which also guarantees the graph has no cycles
+    for (TaskId dependency : dependencies)
+        tasks[dependency].dependents.push_back(id);
+
+    return id;
+}
+
+
+bool TaskGraph::Run()
+{
+    startTime = std::chrono::steady_clock::now();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    remainingTasks = (unsigned int)tasks.size();
+    anyFailed = false;
+
+    for (TaskId id = 0; id < tasks.size(); ++id)
+    {
+        if (tasks[id].pendingDependencies == 0)
+            Schedule(id);
+    }
+
+    // CLN: the main thread runs GL tasks as their inputs become ready, and sleeps otherwise
+    while (remainingTasks > 0)
+    {
+        if (mainThreadQueue.empty())
+        {
+            stateChanged.wait(lock);
+            continue;
+        }
+
+        TaskId id = mainThreadQueue.front();
+        mainThreadQueue.pop_front();
+
+        lock.unlock();
+        Execute(id);
+        lock.lock();
+    }
+
+    totalMs = ElapsedMs();
+    return !anyFailed;
+}
+
+
+void TaskGraph::Schedule(TaskId id)
+{
+    if (tasks[id].affinity == TASK_MAIN_THREAD)
+    {
+        mainThreadQueue.push_back(id);
+        stateChanged.notify_all();
+    }
+    else
+    {
+        pool.Submit([this, id] { Execute(id); });
+    }
+}
+
+
+void TaskGraph::Execute(TaskId id)
+{
+    Task& task = tasks[id];
+
+    task.startMs = ElapsedMs();
+    bool success = task.function();
+    task.endMs = ElapsedMs();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    Complete(id, success);
+}
+
+
+void TaskGraph::Complete(TaskId id, bool success)
+{
+    Task& task = tasks[id];
+    task.failed = !success;
+    if (!success)
+        anyFailed = true;
+
+    --remainingTasks;
+
+    for (TaskId dependentId : task.dependents)
+    {
+        Task& dependent = tasks[dependentId];
+        if (!success)
+            dependent.skipped = true;
+
+        if (--dependent.pendingDependencies > 0)
+            continue;
+
+        if (dependent.skipped)
+        {
+            // CLN: never run a task whose inputs failed, but still count it off so Run() returns
+            dependent.startMs = dependent.endMs = ElapsedMs();
+            Complete(dependentId, false);
+        }
+        else
+        {
+            Schedule(dependentId);
+        }
+    }
+
+    stateChanged.notify_all();
+}
+
+
+double TaskGraph::ElapsedMs() const
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+
+void TaskGraph::PrintTimeline(std::ostream& out) const
+{
+    struct PhaseSummary
+    {
+        double startMs;
+        double endMs;
+        double busyMs;
+        unsigned int taskCount;
+        unsigned int order;
+    };
+
+    // CLN: phases are listed in the order their first task was added
+    std::map<std::string, PhaseSummary> phases;
+    for (const Task& task : tasks)
+    {
+        auto found = phases.find(task.phase);
+        if (found == phases.end())
+        {
+            PhaseSummary summary = { task.startMs, task.endMs, 0.0, 0, (unsigned int)phases.size() };
+            found = phases.insert(std::make_pair(task.phase, summary)).first;
+        }
+
+        PhaseSummary& summary = found->second;
+        summary.startMs = std::min(summary.startMs, task.startMs);
+        summary.endMs = std::max(summary.endMs, task.endMs);
+        summary.busyMs += task.endMs - task.startMs;
+        ++summary.taskCount;
+    }
+
+    std::vector<std::pair<std::string, PhaseSummary>> ordered(phases.begin(), phases.end());
+    std::sort(ordered.begin(), ordered.end(),
+              [](const std::pair<std::string, PhaseSummary>& a, const std::pair<std::string, PhaseSummary>& b)
+              { return a.second.order < b.second.order; });
+
+    double busyTotal = 0.0;
+    out << "INFO: Startup timeline (" << tasks.size() << " tasks, " << pool.GetWorkerCount() << " workers)\n";
+    out << "      phase        start(ms)    end(ms)   busy(ms)  tasks\n";
+    out << std::fixed << std::setprecision(2);
+    for (const auto& entry : ordered)
+    {
+        const PhaseSummary& summary = entry.second;
+        out << "      " << std::left << std::setw(12) << entry.first << std::right
+            << std::setw(10) << summary.startMs
+            << std::setw(11) << summary.endMs
+            << std::setw(11) << summary.busyMs
+            << std::setw(7) << summary.taskCount << "\n";
+        busyTotal += summary.busyMs;
+    }
+
+    for (const Task& task : tasks)
+    {
+        if (task.failed)
+            out << "      " << (task.skipped ? "skipped: " : "FAILED:  ") << task.name << "\n";
+    }
+
+    // CLN: busy / wall-clock shows how much of the startup work actually overlapped
+    out << "      graph total " << totalMs << " ms, serial work " << busyTotal << " ms, overlap "
+        << (totalMs > 0.0 ? busyTotal / totalMs : 0.0) << "x" << std::endl;
+    out.unsetf(std::ios::floatfield);
+}
+
+
+bool TaskGraph::SelfTest(std::ostream& out)
+{
+    WorkerPool pool(3);
+    bool passed = true;
+    auto check = [&out, &passed](bool condition, const char* what) {
+        if (!condition)
+        {
+            out << "Failed task graph self-test: " << what << std::endl;
+            passed = false;
+        }
+    };
+
+    // CLN: a diamond, a before b and c, both before d; each task takes the next tick of the clock when it starts
+    {
+        TaskGraph graph(pool);
+        std::atomic<int> clock(0);
+        int startedAt[4] = { -1, -1, -1, -1 };
+        std::thread::id mainTaskThread;
+        const TaskId a = graph.AddTask("a", "test", TASK_WORKER, [&] { startedAt[0] = clock++; return true; });
+        const TaskId b = graph.AddTask("b", "test", TASK_MAIN_THREAD, [&] {
+            startedAt[1] = clock++;
+            mainTaskThread = std::this_thread::get_id();
+            return true;
+        }, { a });
+        const TaskId c = graph.AddTask("c", "test", TASK_WORKER, [&] { startedAt[2] = clock++; return true; }, { a });
+        graph.AddTask("d", "test", TASK_WORKER, [&] { startedAt[3] = clock++; return true; }, { b, c });
+
+        check(graph.Run(), "a graph without failures reported one");
+        check(startedAt[0] == 0 && startedAt[1] > 0 && startedAt[2] > 0 && startedAt[3] == 3, "a task started before its dependencies");
+        check(mainTaskThread == std::this_thread::get_id(), "a main thread task ran on another thread");
+    }
+
+    // CLN: a fails: b (directly), c (through b, on the main thread) and e (one of two inputs) must be skipped, while d and
+    //      f, which don't depend on a, still run
+    {
+        TaskGraph graph(pool);
+        std::atomic<int> runs[6];
+        for (std::atomic<int>& count : runs)
+            count = 0;
+        const TaskId a = graph.AddTask("a", "test", TASK_WORKER, [&] { ++runs[0]; return false; });
+        const TaskId b = graph.AddTask("b", "test", TASK_WORKER, [&] { ++runs[1]; return true; }, { a });
+        const TaskId c = graph.AddTask("c", "test", TASK_MAIN_THREAD, [&] { ++runs[2]; return true; }, { b });
+        const TaskId d = graph.AddTask("d", "test", TASK_WORKER, [&] { ++runs[3]; return true; });
+        const TaskId e = graph.AddTask("e", "test", TASK_WORKER, [&] { ++runs[4]; return true; }, { d, a });
+        const TaskId f = graph.AddTask("f", "test", TASK_MAIN_THREAD, [&] { ++runs[5]; return true; }, { d });
+
+        check(!graph.Run(), "a graph with a failed task reported success");
+        check(runs[0] == 1 && runs[3] == 1 && runs[5] == 1, "a task that doesn't depend on the failure didn't run once");
+        check(runs[1] == 0 && runs[2] == 0 && runs[4] == 0, "a dependent of the failed task ran");
+        check(graph.tasks[a].failed && !graph.tasks[a].skipped, "the failed task isn't marked failed");
+        check(graph.tasks[b].skipped && graph.tasks[c].skipped && graph.tasks[e].skipped, "a dependent of the failed task isn't marked skipped");
+        check(!graph.tasks[d].failed && !graph.tasks[f].failed, "an independent task is marked failed");
+    }
+
+    return passed;
+}
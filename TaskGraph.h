@@ -0,0 +1,90 @@
+//========================================================================================
+// Filename      : TaskGraph.h
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Dependency graph of startup tasks. Each task names the tasks it
+//               : depends on and whether it must run on the main (OpenGL context)
+//               : thread or can run on a WorkerPool thread. Run() starts every task
+//               : as soon as its inputs are ready, so image decodes and geometry
+//               : generation overlap with shader compilation, while the GL uploads
+//               : are serialized on the main thread.
+//               :
+//               : Every task is timed, and PrintTimeline() writes a per-phase summary
+//               : of the startup to the log.
+//========================================================================================
+
+#ifndef TASK_GRAPH_H
+#define TASK_GRAPH_H
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+class WorkerPool;
+
+// Where a task is allowed to run
+enum TaskAffinity
+{
+    TASK_WORKER,        // any WorkerPool thread (no OpenGL calls)
+    TASK_MAIN_THREAD    // the thread that calls Run() and owns the GL context
+};
+
+class TaskGraph
+{
+public:
+    typedef unsigned int TaskId;
+    typedef std::function<bool()> TaskFunction;   // returns false on failure
+
+    explicit TaskGraph(WorkerPool& pool);
+
+    // phase groups tasks in the timeline, e.g. "decode", "upload", "shaders"
+    TaskId AddTask(const std::string& name, const std::string& phase, TaskAffinity affinity,
+                   TaskFunction function, const std::vector<TaskId>& dependencies = std::vector<TaskId>());
+
+    // Runs every task, returns false if any task failed (dependents of a failed task are skipped)
+    bool Run();
+
+    void PrintTimeline(std::ostream& out) const;
+
+    // runs small graphs on a pool of its own and checks the order, the main thread tasks and the skipping of the
+    // dependents of a failed task (--self-test)
+    static bool SelfTest(std::ostream& out);
+
+private:
+    struct Task
+    {
+        std::string name;
+        std::string phase;
+        TaskAffinity affinity;
+        TaskFunction function;
+        std::vector<TaskId> dependents;
+        unsigned int pendingDependencies;
+        bool failed;
+        bool skipped;
+        double startMs;
+        double endMs;
+    };
+
+    void Schedule(TaskId id);               // called with the mutex held once a task is ready
+    void Execute(TaskId id);
+    void Complete(TaskId id, bool success); // called with the mutex held
+    double ElapsedMs() const;
+
+    WorkerPool& pool;
+    std::vector<Task> tasks;
+    std::deque<TaskId> mainThreadQueue;
+    unsigned int remainingTasks;
+    bool anyFailed;
+    std::mutex mutex;
+    std::condition_variable stateChanged;
+    std::chrono::steady_clock::time_point startTime;
+    double totalMs;
+};
+
+#endif
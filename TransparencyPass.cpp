@@ -0,0 +1,188 @@
+//========================================================================================
+// Filename      : TransparencyPass.cpp
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Implementation of the TransparencyPass class (see TransparencyPass.h)
+//========================================================================================
+
+#include <iostream>
+
+#include "TransparencyPass.h"
+
+namespace
+{
+    GLuint CreateTexture(GLenum internalFormat, int width, int height)
+    {
+        GLuint texture;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexStorage2D(GL_TEXTURE_2D, 1, internalFormat, width, height);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        return texture;
+    }
+
+    void DeleteTexture(GLuint& texture)
+    {
+        glDeleteTextures(1, &texture);
+        texture = 0;
+    }
+}
+
+
+TransparencyPass::TransparencyPass()
+    : width(0), height(0), compositeProgram(0), emptyVao(0),
+      sceneFramebuffer(0), sceneColor(0), depth(0), oitFramebuffer(0), accumulation(0), revealage(0)
+{
+}
+
+
+bool TransparencyPass::Create(int width, int height, GLuint compositeProgram)
+{
+    this->width = width;
+    this->height = height;
+    this->compositeProgram = compositeProgram;
+    glGenVertexArrays(1, &emptyVao);
+
+    glUseProgram(compositeProgram);
+    glUniform1i(glGetUniformLocation(compositeProgram, "accumulationTexture"), 0);
+    glUniform1i(glGetUniformLocation(compositeProgram, "revealageTexture"), 1);
+    glUseProgram(0);
+
+    return CreateTargets();
+}
+
+
+bool TransparencyPass::Resize(int width, int height)
+{
+    if (!IsCreated() || (width == this->width && height == this->height) || width <= 0 || height <= 0)
+        return true;    // CLN: minimized windows report 0 x 0, keep the old targets until it comes back
+
+    this->width = width;
+    this->height = height;
+    DestroyTargets();
+    return CreateTargets();
+}
+
+
+void TransparencyPass::Destroy()
+{
+    DestroyTargets();
+    glDeleteVertexArrays(1, &emptyVao);
+    emptyVao = 0;
+}
+
+
+bool TransparencyPass::CreateTargets()
+{
+    sceneColor = CreateTexture(GL_RGBA8, width, height);
+    accumulation = CreateTexture(GL_RGBA16F, width, height);
+    revealage = CreateTexture(GL_R16F, width, height);
+
+    // CLN: [Checkerboard] a depth/stencil texture, so the reconstruction can read the depth and the stencil can hold
+    //      the checkerboard mask
+    depth = CreateTexture(GL_DEPTH24_STENCIL8, width, height);
+
+    glGenFramebuffers(1, &sceneFramebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, sceneFramebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, sceneColor, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, depth, 0);
+    bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+
+    glGenFramebuffers(1, &oitFramebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, oitFramebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, accumulation, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, revealage, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, depth, 0);
+    const GLenum drawBuffers[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+    glDrawBuffers(2, drawBuffers);
+    complete = complete && glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (!complete)
+    {
+        std::cout << "Failed to create the transparency framebuffers (" << width << " x " << height << ")" << std::endl;
+        DestroyTargets();
+        return false;
+    }
+    return true;
+}
+
+
+void TransparencyPass::DestroyTargets()
+{
+    glDeleteFramebuffers(1, &sceneFramebuffer);
+    glDeleteFramebuffers(1, &oitFramebuffer);
+    sceneFramebuffer = oitFramebuffer = 0;
+    DeleteTexture(depth);
+    DeleteTexture(sceneColor);
+    DeleteTexture(accumulation);
+    DeleteTexture(revealage);
+}
+
+
+void TransparencyPass::BeginOpaque()
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, sceneFramebuffer);
+    glViewport(0, 0, width, height);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+}
+
+
+void TransparencyPass::BeginTransparent()
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, oitFramebuffer);
+
+    // CLN: accumulation starts at 0 (nothing added), revealage at 1 (background fully visible)
+    const GLfloat clearAccumulation[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    const GLfloat clearRevealage[4] = { 1.0f, 0.0f, 0.0f, 0.0f };
+    glClearBufferfv(GL_COLOR, 0, clearAccumulation);
+    glClearBufferfv(GL_COLOR, 1, clearRevealage);
+
+    // CLN: test against the opaque depth, but don't write it, so the transparent layers never hide each other
+    glEnable(GL_DEPTH_TEST);
+    glDepthMask(GL_FALSE);
+    glEnable(GL_BLEND);
+    glBlendFunci(0, GL_ONE, GL_ONE);
+    glBlendFunci(1, GL_ZERO, GL_ONE_MINUS_SRC_COLOR);
+}
+
+
+void TransparencyPass::EndTransparent()
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, sceneFramebuffer);
+    glDepthMask(GL_TRUE);
+    glDisable(GL_DEPTH_TEST);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    glUseProgram(compositeProgram);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, accumulation);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, revealage);
+    glBindVertexArray(emptyVao);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glDisable(GL_BLEND);
+    glEnable(GL_DEPTH_TEST);
+}
+
+
+void TransparencyPass::Present(int windowWidth, int windowHeight)
+{
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, sceneFramebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    // CLN: [Probe] the scene is smaller than the window when the quality profile scales the resolution down
+    const GLenum filter = (windowWidth == width && windowHeight == height) ? GL_NEAREST : GL_LINEAR;
+    glBlitFramebuffer(0, 0, width, height, 0, 0, windowWidth, windowHeight, GL_COLOR_BUFFER_BIT, filter);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
@@ -0,0 +1,64 @@
+//========================================================================================
+// Filename      : TransparencyPass.h
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Weighted blended order-independent transparency (McGuire and
+//               : Bavoil). The opaque objects are drawn into a scene framebuffer; the
+//               : transparent ones are then drawn in any order, with depth testing
+//               : against the opaque depth but no depth writes, into two targets:
+//               :    accumulation (RGBA16F): sum of weight * (premultiplied color, alpha)
+//               :    revealage    (R16F)   : product of (1 - alpha)
+//               : A full-screen composite pass resolves them over the opaque color, and
+//               : Present() copies the result to the window.
+//               :
+//               : No sorting is needed, so the cost depends on the transparent pixels
+//               : covered, not on the number or order of the transparent objects. The
+//               : Phong fragment shader writes the weighted outputs itself when its
+//               : "transparentPass" uniform is set.
+//========================================================================================
+
+#ifndef TRANSPARENCY_PASS_H
+#define TRANSPARENCY_PASS_H
+
+#include <GL/glew.h>
+
+class TransparencyPass
+{
+public:
+    TransparencyPass();
+
+    // compositeProgram resolves the two targets (see oitCompositeFragmentShaderSource in main)
+    bool Create(int width, int height, GLuint compositeProgram);
+    bool Resize(int width, int height);
+    void Destroy();
+    bool IsCreated() const      { return sceneFramebuffer != 0; }
+
+    void BeginOpaque();         // binds and clears the scene framebuffer
+    void BeginTransparent();    // binds and clears the OIT targets, sets the blend state
+    void EndTransparent();      // composites the transparent layer over the opaque color
+    void Present(int windowWidth, int windowHeight);   // copies (and scales) the scene color to the default framebuffer
+
+    GLuint GetSceneFramebuffer() const  { return sceneFramebuffer; }
+    GLuint GetSceneColorTexture() const { return sceneColor; }
+    GLuint GetSceneDepthTexture() const { return depth; }      // depth/stencil, sampled as depth
+
+private:
+    bool CreateTargets();
+    void DestroyTargets();
+
+    int width;
+    int height;
+    GLuint compositeProgram;
+    GLuint emptyVao;            // CLN: the full-screen triangle is generated from gl_VertexID
+
+    GLuint sceneFramebuffer;
+    GLuint sceneColor;
+    GLuint depth;               // shared by both framebuffers, so transparent surfaces are hidden by opaque ones;
+                                // depth/stencil, the stencil holds the checkerboard mask (see CheckerboardRenderer)
+    GLuint oitFramebuffer;
+    GLuint accumulation;
+    GLuint revealage;
+};
+
+#endif
@@ -0,0 +1,500 @@
+//========================================================================================
+// Filename      : WorkerPool.cpp
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Implementation of the WorkerPool class (see WorkerPool.h)
+//========================================================================================
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+#include "NumaTopology.h"
+#include "WorkerPool.h"
+
+namespace
+{
+    // CLN: the pool and node of the calling thread when it is one of the workers
+    thread_local const WorkerPool* tWorkerPool = nullptr;
+    thread_local int tWorkerNode = 0;
+    thread_local const void* tWorker = nullptr;
+}
+
+
+WorkerPool::WorkerPool(unsigned int workerCount, bool pinThreads)
+    : queuedJobs(0), runningJobs(0), stopping(false), pinThreads(pinThreads), pinnedWorkers(0), localJobs(0), stolenJobs(0)
+{
+    if (workerCount == 0)
+    {
+        // CLN: hardware_concurrency() may return 0 when it cannot be determined
+        unsigned int hardwareThreads = std::thread::hardware_concurrency();
+        workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+    }
+
+    const NumaTopology& topology = NumaTopology::Get();
+    const int nodeCount = pinThreads ? topology.GetNodeCount() : 1;
+    for (int node = 0; node < nodeCount; ++node)
+        nodes.emplace_back(new NodeQueue);
+
+    // CLN: the first CPU of the first node goes to the thread that attaches, unless it is the node's only one
+    std::vector<std::vector<int>> nodeCpus(nodeCount);
+    if (pinThreads)
+    {
+        for (int node = 0; node < nodeCount; ++node)
+            nodeCpus[node] = topology.GetCpus(node);
+        callerCpus.push_back(nodeCpus[0][0]);
+        if (nodeCpus[0].size() > 1)
+            nodeCpus[0].erase(nodeCpus[0].begin());
+    }
+
+    // CLN: each worker goes to the node with the fewest workers per CPU so far, so an explicit workerCount is spread
+    //      like the default one, and the first workers (ParallelFor()'s helpers) alternate between the nodes
+    std::vector<unsigned int> nodeWorkers(nodeCount, 0);
+    for (unsigned int i = 0; i < workerCount; ++i)
+    {
+        int node = 0;
+        for (int other = 1; other < nodeCount; ++other)
+        {
+            if ((double)nodeWorkers[other] / nodeCpus[other].size() < (double)nodeWorkers[node] / nodeCpus[node].size())
+                node = other;
+        }
+        ++nodeWorkers[node];
+        workers.emplace_back(new Worker);
+        workers.back()->node = node;
+        workers.back()->cpus = nodeCpus[node];
+    }
+
+    StartWorkers();
+}
+
+
+WorkerPool::WorkerPool(const std::vector<int>& workerNodes, int nodeCount)
+    : queuedJobs(0), runningJobs(0), stopping(false), pinThreads(false), pinnedWorkers(0), localJobs(0), stolenJobs(0)
+{
+    for (int node = 0; node < nodeCount; ++node)
+        nodes.emplace_back(new NodeQueue);
+    for (int node : workerNodes)
+    {
+        workers.emplace_back(new Worker);
+        workers.back()->node = node;
+    }
+    StartWorkers();
+}
+
+
+// CLN: (started once every Worker exists, so the threads never see the vector grow)
+void WorkerPool::StartWorkers()
+{
+    for (const std::unique_ptr<Worker>& worker : workers)
+        worker->thread = std::thread(&WorkerPool::WorkerLoop, this, std::ref(*worker));
+}
+
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    for (const std::unique_ptr<NodeQueue>& node : nodes)
+        node->jobReady.notify_all();
+
+    for (const std::unique_ptr<Worker>& worker : workers)
+        worker->thread.join();
+}
+
+
+void WorkerPool::Submit(std::function<void()> job)
+{
+    Submit(std::move(job), GetCallerNode());
+}
+
+
+void WorkerPool::Submit(std::function<void()> job, int node)
+{
+    node = std::min(std::max(node, 0), GetNodeCount() - 1);
+    int wake = node;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        nodes[node]->jobs.push_back(std::move(job));
+        ++queuedJobs;
+
+        // CLN: a worker of the job's node if one is idle, otherwise an idle one elsewhere steals it; when none is
+        //      idle the job waits for whichever worker finishes first
+        for (int offset = 0; offset < GetNodeCount(); ++offset)
+        {
+            const int candidate = (node + offset) % GetNodeCount();
+            if (nodes[candidate]->idleWorkers > 0)
+            {
+                wake = candidate;
+                break;
+            }
+        }
+    }
+    nodes[wake]->jobReady.notify_one();
+}
+
+
+void WorkerPool::WaitIdle()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    jobsDone.wait(lock, [this] { return queuedJobs == 0 && runningJobs == 0; });
+}
+
+
+unsigned int WorkerPool::ParallelFor(size_t count, const std::function<void(size_t)>& body)
+{
+    // CLN: one contiguous part of the range per node; a thread works through its own node's part, then helps with
+    //      the others
+    struct Part
+    {
+        std::atomic<size_t> next;
+        size_t end;
+    };
+    // CLN: the helpers are queued like any job, so one may start long after the caller is done or never before the
+    //      caller returns (every worker busy, or all of them waiting in ParallelFor() calls of their own). The caller
+    //      therefore never waits for a helper to start: it works through the whole range itself if it must, then
+    //      closes the call and waits only for the helpers that joined before that, which are already running. A
+    //      helper that starts later finds the call closed and returns, so the state is shared with the queued jobs
+    struct Call
+    {
+        std::unique_ptr<Part[]> parts;
+        int nodeCount;
+        const std::function<void(size_t)>* body;
+        std::mutex mutex;
+        std::condition_variable helpersDone;
+        unsigned int joined = 0;                // helpers that started before the call closed
+        unsigned int running = 0;               // of those, still in the range
+        bool closed = false;
+
+        void Run(int home)
+        {
+            for (int offset = 0; offset < nodeCount; ++offset)
+            {
+                Part& part = parts[(home + offset) % nodeCount];
+                for (size_t i = part.next++; i < part.end; i = part.next++)
+                    (*body)(i);
+            }
+        }
+    };
+    const std::shared_ptr<Call> call = std::make_shared<Call>();
+    call->nodeCount = GetNodeCount();
+    call->body = &body;
+    call->parts.reset(new Part[call->nodeCount]);
+    for (int node = 0; node < call->nodeCount; ++node)
+    {
+        call->parts[node].next = count * node / call->nodeCount;
+        call->parts[node].end = count * (node + 1) / call->nodeCount;
+    }
+
+    // CLN: one helper per worker other than the caller, queued on that worker's node (a calling worker is busy with
+    //      this call, so a helper on its node would only be picked up by a thief). Helpers that start after the caller
+    //      has taken every item just find nothing left to do
+    const void* const caller = tWorkerPool == this ? tWorker : nullptr;
+    const size_t maxHelpers = count > 0 ? count - 1 : 0;
+    size_t helpers = 0;
+    for (size_t w = 0; w < workers.size() && helpers < maxHelpers; ++w)
+    {
+        if (workers[w].get() == caller)
+            continue;
+        ++helpers;
+        Submit([call] {
+            {
+                std::lock_guard<std::mutex> lock(call->mutex);
+                if (call->closed)
+                    return;
+                ++call->joined;
+                ++call->running;
+            }
+            call->Run(tWorkerNode);
+            std::lock_guard<std::mutex> lock(call->mutex);
+            if (--call->running == 0)
+                call->helpersDone.notify_all();
+        }, workers[w]->node);
+    }
+
+    call->Run(GetCallerNode());
+    std::unique_lock<std::mutex> lock(call->mutex);
+    call->closed = true;
+    call->helpersDone.wait(lock, [&call] { return call->running == 0; });
+    return call->joined + 1;
+}
+
+
+bool WorkerPool::AttachCallingThread()
+{
+    const bool pinned = pinThreads && NumaTopology::Get().PinCurrentThread(callerCpus, 0);
+    callerCounters.Open();
+    return pinned;
+}
+
+
+int WorkerPool::GetCallerNode() const
+{
+    if (tWorkerPool == this)
+        return tWorkerNode;
+    return pinThreads ? std::min(NumaTopology::Get().GetCurrentNode(), GetNodeCount() - 1) : 0;
+}
+
+
+bool WorkerPool::TakeJob(int node, std::function<void()>& job)
+{
+    for (int offset = 0; offset < GetNodeCount(); ++offset)
+    {
+        std::deque<std::function<void()>>& jobs = nodes[(node + offset) % GetNodeCount()]->jobs;
+        if (jobs.empty())
+            continue;
+        job = std::move(jobs.front());
+        jobs.pop_front();
+        --queuedJobs;
+        ++(offset == 0 ? localJobs : stolenJobs);
+        return true;
+    }
+    return false;
+}
+
+
+void WorkerPool::WorkerLoop(Worker& worker)
+{
+    tWorkerPool = this;
+    tWorkerNode = worker.node;
+    tWorker = &worker;
+    const bool pinned = pinThreads && NumaTopology::Get().PinCurrentThread(worker.cpus, worker.node);
+    worker.counters.Open();
+    NodeQueue& home = *nodes[worker.node];
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (pinned)
+            ++pinnedWorkers;
+    }
+
+    for (;;)
+    {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            ++home.idleWorkers;
+            home.jobReady.wait(lock, [this] { return stopping || queuedJobs > 0; });
+            --home.idleWorkers;
+
+            // CLN: drain the queue before honouring a stop request so no submitted job is lost
+            if (!TakeJob(worker.node, job))
+                return;
+            ++runningJobs;
+        }
+
+        job();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            --runningJobs;
+            if (queuedJobs == 0 && runningJobs == 0)
+                jobsDone.notify_all();
+        }
+    }
+}
+
+
+PerfCounterValues WorkerPool::ReadWorkerCounters() const
+{
+    PerfCounterValues total;
+    for (const std::unique_ptr<Worker>& worker : workers)
+        total += worker->counters.Read();
+    return total;
+}
+
+
+void WorkerPool::PrintStats(std::ostream& out) const
+{
+    std::vector<unsigned int> nodeWorkers(nodes.size(), 0);
+    for (const std::unique_ptr<Worker>& worker : workers)
+        ++nodeWorkers[worker->node];
+
+    // CLN: (the counts are only written under the mutex, a torn read here just makes the printout a job off)
+    out << "INFO: Worker pool: " << workers.size() << " worker(s)";
+    if (pinThreads)
+    {
+        out << " on " << nodes.size() << " NUMA node(s) (";
+        for (size_t node = 0; node < nodes.size(); ++node)
+            out << (node > 0 ? " + " : "") << nodeWorkers[node];
+        out << "), " << pinnedWorkers << " pinned to their node's CPUs, GL thread on CPU " << callerCpus[0];
+    }
+    else
+        out << ", not pinned (--no-thread-pinning)";
+    out << "; " << localJobs + stolenJobs << " job(s), " << stolenJobs << " taken from another node" << std::endl;
+
+    out << "      workers: ";
+    ReadWorkerCounters().Print(out);
+    out << "; GL thread: ";
+    callerCounters.Read().Print(out);
+    out << std::endl;
+}
+
+
+bool WorkerPool::SelfTest(std::ostream& out)
+{
+    bool passed = true;
+    auto check = [&out, &passed](bool condition, const char* what) {
+        if (!condition)
+        {
+            out << "Failed worker pool self-test: " << what << std::endl;
+            passed = false;
+        }
+    };
+    // CLN: waits up to 10 s for a condition the workers make true
+    auto await = [](const std::function<bool()>& condition) {
+        const std::chrono::steady_clock::time_point timeout = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (!condition())
+        {
+            if (std::chrono::steady_clock::now() > timeout)
+                return false;
+            std::this_thread::yield();
+        }
+        return true;
+    };
+
+    // CLN: no workers, so the queues only change here: a node's own jobs come first, then the other node's in order,
+    //      and out of range nodes are clamped
+    {
+        WorkerPool pool(std::vector<int>(), 2);
+        std::vector<int> ran;
+        pool.Submit([&ran] { ran.push_back(0); }, 0);
+        pool.Submit([&ran] { ran.push_back(1); }, 1);
+        pool.Submit([&ran] { ran.push_back(2); }, -3);
+        pool.Submit([&ran] { ran.push_back(3); }, 7);
+        check(pool.nodes[0]->jobs.size() == 2 && pool.nodes[1]->jobs.size() == 2 && pool.queuedJobs == 4,
+              "jobs went to the wrong node queues");
+
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        std::function<void()> job;
+        while (pool.TakeJob(1, job))
+            job();
+        check(ran == std::vector<int>({ 1, 3, 0, 2 }) && pool.localJobs == 2 && pool.stolenJobs == 2 && pool.queuedJobs == 0,
+              "a node didn't take its own jobs before stealing the other's");
+    }
+
+    // CLN: one worker per node. While one is held by a job, the jobs queued on its node are stolen by the other
+    {
+        WorkerPool pool(std::vector<int>({ 0, 1 }), 2);
+        std::atomic<int> heldNode(-1);
+        std::atomic<bool> release(false);
+        pool.Submit([&heldNode, &release] {
+            heldNode = tWorkerNode;
+            while (!release)
+                std::this_thread::yield();
+        }, 0);
+        check(await([&heldNode] { return heldNode >= 0; }), "a held job never started");
+
+        const int jobCount = 16;
+        std::atomic<int> done(0);
+        std::atomic<int> onHeldNode(0);
+        const int held = heldNode;
+        const unsigned long long stolenBefore = pool.stolenJobs;
+        for (int i = 0; i < jobCount && held >= 0; ++i)
+        {
+            pool.Submit([&done, &onHeldNode, held] {
+                if (tWorkerNode == held)
+                    ++onHeldNode;
+                ++done;
+            }, held);
+        }
+        check(held >= 0 && await([&done, jobCount] { return done == jobCount; }) && onHeldNode == 0,
+              "the jobs of a busy node weren't stolen by the idle one");
+        release = true;
+        pool.WaitIdle();
+        check(pool.stolenJobs - stolenBefore >= (unsigned long long)jobCount, "stolen jobs weren't counted");
+    }
+
+    // CLN: ParallelFor() on three workers over two nodes: every index exactly once, for the empty, single and odd
+    //      ranges
+    {
+        WorkerPool pool(std::vector<int>({ 0, 1, 1 }), 2);
+        const size_t counts[] = { 0, 1, 10007 };
+        for (size_t count : counts)
+        {
+            std::unique_ptr<std::atomic<int>[]> hits(new std::atomic<int>[count + 1]);
+            for (size_t i = 0; i < count; ++i)
+                hits[i] = 0;
+            pool.ParallelFor(count, [&hits](size_t i) { ++hits[i]; });
+            bool once = true;
+            for (size_t i = 0; i < count; ++i)
+                once = once && hits[i] == 1;
+            check(once, "ParallelFor() missed an index or ran one twice");
+        }
+    }
+
+    // CLN: one worker per node, one of them held. A ParallelFor() from a job on the other queues its helper on the
+    //      held worker's node, not on its own (where no one but a thief would take it). The second worker is held, so
+    //      the caller is the first one, which the helpers used to be given to regardless
+    {
+        WorkerPool pool(std::vector<int>({ 0, 1 }), 2);
+        std::atomic<int> heldNode(-1);
+        std::atomic<bool> release(false);
+        // CLN: (both waiting first, or the first worker to start could take the held job off the second's node)
+        check(await([&pool] {
+            std::lock_guard<std::mutex> lock(pool.mutex);
+            return pool.nodes[0]->idleWorkers == 1 && pool.nodes[1]->idleWorkers == 1;
+        }), "the workers never went idle");
+        pool.Submit([&heldNode, &release] {
+            heldNode = tWorkerNode;
+            while (!release)
+                std::this_thread::yield();
+        }, 1);
+        check(await([&heldNode] { return heldNode >= 0; }), "a held job never started");
+
+        const int held = heldNode;
+        std::atomic<int> callerNode(-1);
+        size_t heldQueue = 0, callerQueue = 0;
+        std::atomic<bool> finished(false);
+        pool.Submit([&pool, &callerNode, &heldQueue, &callerQueue, &finished] {
+            callerNode = tWorkerNode;
+            pool.ParallelFor(2, [&pool, &heldQueue, &callerQueue](size_t i) {
+                if (i > 0)
+                    return;
+                std::lock_guard<std::mutex> lock(pool.mutex);
+                heldQueue = pool.nodes[1 - tWorkerNode]->jobs.size();
+                callerQueue = pool.nodes[tWorkerNode]->jobs.size();
+            });
+            finished = true;
+        }, held);
+        check(held >= 0 && await([&finished] { return finished.load(); }) && callerNode == 1 - held && heldQueue == 1 && callerQueue == 0,
+              "a ParallelFor() helper was queued on the calling worker's node");
+        release = true;
+        pool.WaitIdle();
+    }
+
+    // CLN: ParallelFor() from inside jobs while no worker is free to help: on a single worker, and on every worker of
+    //      a pool at once. A pool that deadlocks is leaked rather than destroyed, so the failure is reported instead
+    //      of hanging in the destructor
+    const unsigned int nestedWorkers[] = { 1, 4 };
+    for (unsigned int workerCount : nestedWorkers)
+    {
+        std::unique_ptr<WorkerPool> pool(new WorkerPool(std::vector<int>(workerCount, 0), 1));
+        WorkerPool* const nestedPool = pool.get();
+        std::atomic<unsigned int> started(0);
+        std::atomic<unsigned int> finished(0);
+        std::atomic<size_t> sum(0);
+        for (unsigned int job = 0; job < workerCount; ++job)
+        {
+            pool->Submit([nestedPool, &started, &finished, &sum, workerCount] {
+                // CLN: every worker is inside a job before any of them calls ParallelFor()
+                ++started;
+                while (started < workerCount)
+                    std::this_thread::yield();
+                nestedPool->ParallelFor(1000, [&sum](size_t i) { sum += i; });
+                ++finished;
+            });
+        }
+        const bool done = await([&finished, workerCount] { return finished == workerCount; });
+        check(done, workerCount == 1 ? "a ParallelFor() from the only worker's job never finished"
+                                     : "ParallelFor() calls from every worker at once never finished");
+        check(!done || sum == workerCount * (1000 * 999 / 2), "the nested ParallelFor() calls didn't cover their ranges");
+        if (done)
+            pool->WaitIdle();
+        else
+            pool.release();
+    }
+
+    return passed;
+}
@@ -0,0 +1,114 @@
+//========================================================================================
+// Filename      : WorkerPool.h
+// Author        : Chad Netwig
+// Last Updated  : 10/18/2026
+//               :
+// Description   : Fixed-size pool of worker threads that run jobs submitted from any
+//               : thread. Used for the CPU side of startup work (image decodes, sphere
+//               : and cylinder generation) so the main thread, which owns the OpenGL
+//               : context, only has to do the GL uploads.
+//               :
+//               : With pinThreads the pool follows the NUMA topology (NumaTopology.h):
+//               : the workers are spread over the nodes by their CPU counts and each is
+//               : pinned to its node's CPUs, less one CPU of the first node that is left
+//               : to the calling (GL) thread. Every node has its own job queue; a job
+//               : goes to the queue of the node it was submitted from, and a worker
+//               : takes its own node's jobs first and only then steals from another
+//               : node, so data a job's submitter just wrote is usually still in that
+//               : socket's caches. ParallelFor() gives each node a contiguous part of
+//               : the index range in the same way. Without pinThreads there is one
+//               : queue and the OS places the threads.
+//               :
+//               : Every worker counts its own hardware events (PerfCounters.h), so
+//               : PrintStats() shows the cross-node traffic with and without pinning.
+//               :
+//               : Jobs must not make OpenGL calls, since the workers have no context.
+//========================================================================================
+
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+#include "PerfCounters.h"
+
+class WorkerPool
+{
+public:
+    // workerCount = 0 picks one worker per hardware thread, minus the main thread
+    explicit WorkerPool(unsigned int workerCount = 0, bool pinThreads = false);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    void Submit(std::function<void()> job);             // queue a job on the calling thread's node, returns immediately
+    void Submit(std::function<void()> job, int node);   // queue a job on a node of GetNodeCount()
+    void WaitIdle();                            // block until the queue is empty and no job is running
+
+    // runs body(0..count-1) across the calling thread and the workers that are free to help, returns the number of
+    // threads used. The caller never waits for a helper to start, so jobs may call it too, all at once
+    unsigned int ParallelFor(size_t count, const std::function<void(size_t)>& body);
+
+    // the main thread, once: pins it to the CPU the workers leave free (when pinning) and counts its events too
+    bool AttachCallingThread();
+
+    unsigned int GetWorkerCount() const     { return (unsigned int)workers.size(); }
+    int GetNodeCount() const                { return (int)nodes.size(); }
+
+    PerfCounterValues ReadWorkerCounters() const;       // summed over the workers, from when each started
+    PerfCounterValues ReadCallerCounters() const        { return callerCounters.Read(); }
+    void PrintStats(std::ostream& out) const;
+
+    // steals between simulated node queues, and checks ParallelFor()'s coverage, where its helpers are queued, and
+    // that nested calls finish on a single worker and on every worker at once (--self-test)
+    static bool SelfTest(std::ostream& out);
+
+private:
+    struct Worker
+    {
+        std::thread thread;
+        int node;                               // of the pool's nodes
+        std::vector<int> cpus;                  // it is pinned to
+        PerfCounters counters;                  // opened by the worker itself
+    };
+
+    struct NodeQueue
+    {
+        std::deque<std::function<void()>> jobs;
+        std::condition_variable jobReady;       // signalled when a job is queued for the node or the pool stops
+        unsigned int idleWorkers = 0;
+    };
+
+    // unpinned workers on nodeCount simulated nodes (worker i on workerNodes[i]), so SelfTest() has several node
+    // queues on any machine
+    WorkerPool(const std::vector<int>& workerNodes, int nodeCount);
+    void StartWorkers();
+    void WorkerLoop(Worker& worker);
+    int GetCallerNode() const;
+    bool TakeJob(int node, std::function<void()>& job);    // with the mutex held
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::unique_ptr<NodeQueue>> nodes;
+    std::mutex mutex;
+    std::condition_variable jobsDone;           // signalled when the pool goes idle
+    size_t queuedJobs;                          // in all the node queues
+    unsigned int runningJobs;
+    bool stopping;
+
+    const bool pinThreads;
+    std::vector<int> callerCpus;                // left to the thread that attaches
+    PerfCounters callerCounters;
+    unsigned int pinnedWorkers;
+    unsigned long long localJobs;               // taken from the worker's own node
+    unsigned long long stolenJobs;              // taken from another node
+};
+
+#endif